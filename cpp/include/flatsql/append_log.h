@@ -0,0 +1,105 @@
+#ifndef FLATSQL_APPEND_LOG_H
+#define FLATSQL_APPEND_LOG_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace flatsql {
+
+// When appended frames reach disk
+enum class Durability {
+    None,          // Written to the file after each batch, never fdatasync'd
+    GroupCommit,   // Written and fdatasync'd by a background thread
+    SyncPerBatch   // Written and fdatasync'd before each batch returns
+};
+
+struct AppendLogOptions {
+    Durability durability = Durability::GroupCommit;
+    uint32_t groupCommitMs = 10;               // Longest a frame waits for fdatasync
+    size_t groupCommitBytes = 4 * 1024 * 1024; // Pending bytes that trigger an early commit
+};
+
+/**
+ * Write-ahead append file.
+ *
+ * File format: [4-byte LE payload size][4-byte LE CRC32C of payload][payload]...
+ *
+ * Frames are buffered in memory and written in order. Checksums are
+ * computed when a frame is written, so in GroupCommit mode the caller only
+ * pays for a copy. A crash can leave a torn final frame; recover() drops
+ * it, along with anything after the first frame that fails its checksum.
+ */
+class AppendLog {
+public:
+    static constexpr size_t FRAME_HEADER_LENGTH = 8;
+
+    // Open (creating if needed) a log for appending.
+    // Throws std::runtime_error if the file can't be opened.
+    AppendLog(const std::string& path, const AppendLogOptions& options = {});
+
+    // Writes and syncs pending frames
+    ~AppendLog();
+
+    AppendLog(const AppendLog&) = delete;
+    AppendLog& operator=(const AppendLog&) = delete;
+
+    // Buffer one frame
+    void append(const uint8_t* payload, size_t length);
+
+    // End of a batch of frames: writes them (None) or writes and syncs them
+    // (SyncPerBatch). GroupCommit leaves them to the background thread.
+    void commitBatch();
+
+    // Write and fdatasync every frame appended so far.
+    // Throws std::runtime_error if a write or sync failed, here or earlier
+    // on the background thread.
+    void sync();
+
+    const std::string& getPath() const { return path_; }
+    const AppendLogOptions& getOptions() const { return options_; }
+
+    // Bytes written to the file, including frame headers
+    uint64_t getWrittenBytes() const;
+
+    // Number of fdatasync calls made
+    uint64_t getSyncCount() const;
+
+    /**
+     * Read a log's payloads, concatenated in order. The file is truncated
+     * after the last intact frame, so appends continue from there.
+     * A missing file recovers as empty.
+     *
+     * @param droppedBytes  Set to the bytes cut from the tail (optional)
+     */
+    static std::vector<uint8_t> recover(const std::string& path, uint64_t* droppedBytes = nullptr);
+
+private:
+    // Write pending frames, then fdatasync if durable
+    void flush(bool durable);
+
+    void flusherLoop();
+
+    std::string path_;
+    AppendLogOptions options_;
+    int fd_ = -1;
+
+    mutable std::mutex mutex_;     // Guards pending_, error_, stopping_ and the counters
+    std::condition_variable wake_;
+    std::vector<uint8_t> pending_; // Frames not yet written, checksums unset
+    std::string error_;            // First write or sync failure
+    bool stopping_ = false;
+    uint64_t writtenBytes_ = 0;
+    uint64_t syncCount_ = 0;
+
+    std::mutex writeMutex_;        // Serializes flushes so frames stay in order
+    std::vector<uint8_t> writing_; // Frames being written (reuses capacity)
+    std::thread flusher_;          // GroupCommit only
+};
+
+}  // namespace flatsql
+
+#endif  // FLATSQL_APPEND_LOG_H
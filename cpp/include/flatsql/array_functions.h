@@ -0,0 +1,27 @@
+#ifndef FLATSQL_ARRAY_FUNCTIONS_H
+#define FLATSQL_ARRAY_FUNCTIONS_H
+
+#include <sqlite3.h>
+
+namespace flatsql {
+
+/**
+ * Register array SQL functions on a SQLite database.
+ *
+ * Vector columns ([string], [int], ...) read as JSON array text, so these
+ * also work on any JSON array:
+ *   array_contains(array, value)   -> 0/1, NULL if either argument is NULL
+ *                                     or array isn't a JSON array
+ *
+ * Strings match strings exactly; numbers match numerically (true/false count
+ * as 1/0). array_contains(col, ?) is pushed down to the element index when
+ * col is an indexed vector column of a FlatBuffer table.
+ */
+void registerArrayFunctions(sqlite3* db);
+
+// array_contains implementation, exposed so virtual tables can overload it
+void arrayContainsFunc(sqlite3_context* ctx, int argc, sqlite3_value** argv);
+
+}  // namespace flatsql
+
+#endif  // FLATSQL_ARRAY_FUNCTIONS_H
@@ -3,7 +3,11 @@
 
 #include "flatsql/types.h"
 #include "flatsql/storage.h"
+#include "flatsql/append_log.h"
 #include "flatsql/sqlite_index.h"
+#include "flatsql/spatial_index.h"
+#include "flatsql/learned_index.h"
+#include "flatsql/radix_index.h"
 #include "flatsql/schema_parser.h"
 #include "flatsql/sqlite_engine.h"
 #include "flatbuffers/encryption.h"
@@ -24,16 +28,33 @@ public:
     // This is the streaming index builder - called for each FlatBuffer as it arrives
     void onIngest(const uint8_t* data, size_t length, uint64_t sequence, uint64_t offset);
 
-    // Find by indexed column
+    // Find by indexed column. A radix index, or a learned index on a column
+    // without a B-tree index, returns every match as a minimal record.
     std::vector<StoredRecord> findByIndex(const std::string& column, const Value& value);
 
-    // Find by range on indexed column
+    // Find by range on indexed column (a radix or learned index when there is one)
     std::vector<StoredRecord> findByRange(const std::string& column,
                                           const Value& minValue, const Value& maxValue);
 
-    // Full table scan (by file_id)
+    // Full table scan (copies every record)
     std::vector<StoredRecord> scanAll();
 
+    // Zero-copy record visitor. data points into storage and stays valid
+    // until the next ingest. Return false to stop.
+    using RecordVisitor = std::function<bool(const StreamingFlatBufferStore::RecordRef& record)>;
+
+    // Visit every record whose column equals value / lies in [minValue,
+    // maxValue], in index order (ingest order when the column has no index
+    // and the field extractor is used instead). Uses the same index as
+    // findByRange. Returns the number of records visited.
+    size_t forEachByIndex(const std::string& column, const Value& value, const RecordVisitor& visit) const;
+    size_t forEachByRange(const std::string& column, const Value& minValue, const Value& maxValue,
+                          const RecordVisitor& visit) const;
+
+    // Visit every record of the table in ingest order (storage order after
+    // FlatSQLDatabase::reorganizeStorage)
+    size_t scanRefs(const RecordVisitor& visit) const;
+
     // Get table definition
     const TableDef& getTableDef() const { return tableDef_; }
 
@@ -49,13 +70,31 @@ public:
     // Get index names
     std::vector<std::string> getIndexNames() const;
 
+    // Indexes in getIndexNames() order (element indexes named "col[]")
+    std::vector<std::pair<std::string, const SqliteIndex*>> getIndexList() const;
+
     // Field extractor function type - extracts field values from raw FlatBuffer
     using FieldExtractor = std::function<Value(const uint8_t* data, size_t length, const std::string& fieldName)>;
     using FastFieldExtractor = flatsql::FastFieldExtractor;
     using BatchExtractor = flatsql::BatchExtractor;
 
-    // Set field extractor (required for indexing and queries)
-    void setFieldExtractor(FieldExtractor extractor) { fieldExtractor_ = extractor; }
+    // Set field extractor (required for indexing and queries). Vector
+    // columns then go through it too, unless setVectorsInPlace(), and are
+    // indexed on the extractor's value rather than per element.
+    void setFieldExtractor(FieldExtractor extractor);
+
+    // Decode vector columns from the buffer even with a field extractor
+    void setVectorsInPlace(bool enabled);
+    bool getVectorsInPlace() const { return vectorsInPlace_; }
+
+    // Whether a vector column is decoded from the buffer: its slot is known
+    // and there is no field extractor, or setVectorsInPlace() opted in
+    bool readsVectorInPlace(const ColumnDef& col) const;
+
+    // Layout of an indexed column's index (element index included).
+    // IndexLayout::Rows unless set; changing it rebuilds the index.
+    void setIndexLayout(const std::string& column, IndexLayout layout);
+    IndexLayout getIndexLayout(const std::string& column) const;
 
     // Set fast field extractor (optional, for bypassing Value construction)
     void setFastFieldExtractor(FastFieldExtractor extractor) { fastFieldExtractor_ = extractor; }
@@ -72,27 +111,130 @@ public:
     // Get batch extractor
     BatchExtractor getBatchExtractor() const { return batchExtractor_; }
 
+    // Record verifier - checks a FlatBuffer before ingest verification
+    // publishes it (e.g. a generated VerifyXBuffer). Called from worker
+    // threads, so it must be thread-safe.
+    using RecordVerifier = std::function<bool(const uint8_t* data, size_t length)>;
+    void setRecordVerifier(RecordVerifier verifier) { recordVerifier_ = verifier; }
+
+    // Check a record with the verifier, or against the table definition
+    // (fbVerifyRootTable) when there is none. Tables whose columns can't
+    // all be mapped to vtable slots (unions, unknown types) need a verifier;
+    // without one their records are rejected.
+    bool verifyRecord(const uint8_t* data, size_t length) const;
+
     // Get index for a column (returns nullptr if not indexed)
     SqliteIndex* getIndex(const std::string& columnName) {
         auto it = indexes_.find(columnName);
         return it != indexes_.end() ? it->second.get() : nullptr;
     }
 
+    // Get the element index of an indexed vector column (value -> records
+    // containing it; returns nullptr if none). Listed as "column[]". Only
+    // vectors read in place (readsVectorInPlace) have one.
+    SqliteIndex* getElementIndex(const std::string& columnName) {
+        auto it = elementIndexes_.find(columnName);
+        return it != elementIndexes_.end() ? it->second.get() : nullptr;
+    }
+
+    // Create the spatial index over a lat/lon column pair and backfill it
+    // from records already ingested. Requires a field extractor.
+    SpatialIndex* createSpatialIndex(const std::string& latColumn, const std::string& lonColumn);
+
+    // Get the spatial index (returns nullptr if none)
+    SpatialIndex* getSpatialIndex() const { return spatialIndex_.get(); }
+
+    // Create a learned index over a numeric column and backfill it from
+    // records already ingested. Requires a field extractor.
+    LearnedIndex* createLearnedIndex(const std::string& column);
+
+    // Get the learned index for a column (returns nullptr if none)
+    LearnedIndex* getLearnedIndex(const std::string& column) const {
+        auto it = learnedIndexes_.find(column);
+        return it != learnedIndexes_.end() ? it->second.get() : nullptr;
+    }
+
+    // Learned indexes by column, for virtual table registration
+    std::unordered_map<std::string, LearnedIndex*> getLearnedIndexes() const;
+
+    // Create a radix (ART) index over a string or blob column and backfill
+    // it from records already ingested. Requires a field extractor.
+    RadixIndex* createRadixIndex(const std::string& column);
+
+    // Get the radix index for a column (returns nullptr if none)
+    RadixIndex* getRadixIndex(const std::string& column) const {
+        auto it = radixIndexes_.find(column);
+        return it != radixIndexes_.end() ? it->second.get() : nullptr;
+    }
+
+    // Radix indexes by column, for virtual table registration
+    std::unordered_map<std::string, RadixIndex*> getRadixIndexes() const;
+
+    // Records whose (latColumn, lonColumn) point lies within radiusKm of
+    // (lat, lon), or inside the box. Uses the spatial index when it covers the
+    // same columns, otherwise scans with the batch geo kernels. Results are
+    // minimal records (offset, sequence, length; no data copy).
+    std::vector<StoredRecord> findWithinRadius(const std::string& latColumn, const std::string& lonColumn,
+                                               double lat, double lon, double radiusKm);
+    std::vector<StoredRecord> findInBox(const std::string& latColumn, const std::string& lonColumn,
+                                        double minLat, double maxLat, double minLon, double maxLon);
+
+    // Count of findWithinRadius() matches without materializing records
+    size_t countWithinRadius(const std::string& latColumn, const std::string& lonColumn,
+                             double lat, double lon, double radiusKm);
+
     // Get record infos for this specific table (for source-specific iteration)
     const std::vector<StreamingFlatBufferStore::FileRecordInfo>& getRecordInfos() const {
         return recordInfos_;
     }
 
+    // Forget every record and index entry, keeping the indexes themselves
+    // (reorganizeStorage ingests the records again once they have moved)
+    void clearRecords();
+
 private:
+    // Visit the records an open index cursor yields
+    size_t visitCursor(IndexCursor& cursor, const RecordVisitor& visit) const;
+
+    // Visit the records whose column value satisfies match (no index)
+    size_t visitMatching(const std::string& column, const std::function<bool(const Value&)>& match,
+                         const RecordVisitor& visit) const;
+
+    // Spatial index usable for these columns, or nullptr
+    SpatialIndex* spatialIndexFor(const std::string& latColumn, const std::string& lonColumn) const;
+
+    // Decode (lat, lon) for every record in chunks and hand each chunk over as
+    // columns. Records without numeric coordinates are skipped.
+    using PointChunkFn = std::function<void(const StoredRecord* records, const double* lats,
+                                            const double* lons, size_t n)>;
+    void scanPointChunks(const std::string& latColumn, const std::string& lonColumn,
+                         const PointChunkFn& fn) const;
+
+    // Give each indexed vector column an element index or a plain one, as
+    // readsVectorInPlace() now says
+    void updateVectorIndexes();
+
+    // Index each distinct element of a record's vector column
+    static void indexElements(const ColumnDef& col, SqliteIndex& index, const uint8_t* data,
+                              size_t length, uint64_t offset, uint64_t sequence);
+
     TableDef tableDef_;
     std::string fileId_;  // 4-byte file identifier for routing
     StreamingFlatBufferStore& storage_;
     sqlite3* indexDb_;    // SQLite database for indexes (not owned)
     std::map<std::string, std::unique_ptr<SqliteIndex>> indexes_;
+    // Indexed vector columns are indexed per element instead of as a whole
+    std::map<std::string, std::unique_ptr<SqliteIndex>> elementIndexes_;
+    std::unique_ptr<SpatialIndex> spatialIndex_;
+    std::map<std::string, std::unique_ptr<LearnedIndex>> learnedIndexes_;
+    std::map<std::string, std::unique_ptr<RadixIndex>> radixIndexes_;
     uint64_t recordCount_ = 0;
     FieldExtractor fieldExtractor_;
-    FastFieldExtractor fastFieldExtractor_;
+    FastFieldExtractor fastFieldExtractor_ = nullptr;
     BatchExtractor batchExtractor_ = nullptr;
+    RecordVerifier recordVerifier_;
+    bool vectorsInPlace_ = false;
+    std::map<std::string, IndexLayout> indexLayouts_;  // Columns not using Rows
 
     // Per-table record tracking (for source-specific tables)
     std::vector<StreamingFlatBufferStore::FileRecordInfo> recordInfos_;
@@ -110,6 +252,9 @@ private:
  * - Multiple sources with same schema (multi-source queries)
  * - Unified views for cross-source queries
  * - Tombstone-based deletes with compaction
+ * - Vector fields ([string], [int], ...) as JSON array columns; indexed ones
+ *   get a per-element index used by array_contains(col, ?), and
+ *   fb_each(table, column) unnests them in place
  */
 class FlatSQLDatabase {
 public:
@@ -133,7 +278,25 @@ public:
     // File identifier is read from bytes 4-7
     uint64_t ingestOne(const uint8_t* flatbuffer, size_t length);
 
-    // Load existing stream data and rebuild indexes
+    /**
+     * Verify records before they are stored (off by default). ingest() and
+     * ingestWithSource() check a batch's records across up to `threads`
+     * worker threads (0 = one per core), then store the ones that pass in
+     * order; rejected records are consumed but not stored. ingestOne()
+     * throws std::runtime_error for a record that fails. Records whose file
+     * ID maps to no table are stored unchecked. Tables with unions or field
+     * types the schema parser doesn't know need setRecordVerifier().
+     */
+    void setIngestVerification(bool enabled, unsigned threads = 0);
+    bool isIngestVerificationEnabled() const { return verifyIngest_; }
+
+    // Positions (0-based, within the call) of the records the last ingest
+    // call rejected
+    const std::vector<size_t>& getRejectedRecords() const { return rejectedRecords_; }
+
+    // Load existing stream data and rebuild indexes. A stream exported with
+    // checksums is verified first (throws std::runtime_error on a mismatch
+    // or a truncated tail).
     void loadAndRebuild(const uint8_t* data, size_t length);
 
     // Execute SQL query (uses SQLite virtual tables)
@@ -145,6 +308,11 @@ public:
     // Execute SQL query with a single integer parameter (most optimized for int key lookups)
     QueryResult query(const std::string& sql, int64_t param);
 
+    // Execute one statement for many parameter sets, streaming each result
+    // row to the sink with the index of its set. Returns the row count.
+    size_t executeBatch(const std::string& sql, const std::vector<std::vector<Value>>& paramSets,
+                        const BatchRowSink& sink);
+
     // Execute and count without building QueryResult (for benchmarking)
     size_t queryCount(const std::string& sql, const std::vector<Value>& params = {});
 
@@ -170,6 +338,15 @@ public:
                                   uint32_t* outLength,
                                   uint64_t* outSequence = nullptr);
 
+    // Batched findRawByIndex: out[i] is the first record whose column equals
+    // keys[i] (data == nullptr if there is none), for i < count. The table and
+    // index are resolved once, keys are probed in index order and record
+    // headers are prefetched ahead of use. Returns the number found.
+    size_t findRawByIndexBatch(const std::string& tableName,
+                               const std::string& column,
+                               const Value* keys, size_t count,
+                               StreamingFlatBufferStore::RecordRef* out);
+
     // Direct iteration over all records - bypasses SQLite completely
     // Callback receives raw FlatBuffer data for zero-copy access
     // Returns count of records iterated
@@ -180,16 +357,21 @@ public:
             return 0;
         }
 
-        const std::string& fileId = it->second->getFileId();
-        size_t count = 0;
-        storage_.iterateRefsByFileId(fileId, [&](const StreamingFlatBufferStore::RecordRef& ref) {
+        return it->second->scanRefs([&](const StreamingFlatBufferStore::RecordRef& ref) {
             callback(ref.data, ref.length, ref.sequence);
-            count++;
             return true;
         });
-        return count;
     }
 
+    // Zero-copy forms of findByIndex/findByRange/iterateAll (see TableStore).
+    // Return the number of records visited, 0 for an unknown table.
+    size_t forEachByIndex(const std::string& tableName, const std::string& column, const Value& value,
+                          const TableStore::RecordVisitor& visit) const;
+    size_t forEachByRange(const std::string& tableName, const std::string& column,
+                          const Value& minValue, const Value& maxValue,
+                          const TableStore::RecordVisitor& visit) const;
+    size_t scanRefs(const std::string& tableName, const TableStore::RecordVisitor& visit) const;
+
     // Get storage for direct access
     const StreamingFlatBufferStore& getStorage() const { return storage_; }
 
@@ -202,8 +384,87 @@ public:
     // Set batch extractor for a table (optional, for efficient batch extraction)
     void setBatchExtractor(const std::string& tableName, TableStore::BatchExtractor extractor);
 
-    // Get raw storage data (for export)
-    std::vector<uint8_t> exportData() const { return storage_.exportData(); }
+    // Decode a table's vector columns from the buffer even though it has a
+    // field extractor (see TableStore::readsVectorInPlace). Call before
+    // ingesting or querying the table.
+    void setVectorsInPlace(const std::string& tableName, bool enabled = true);
+
+    // Set the record verifier for a table (see setIngestVerification)
+    void setRecordVerifier(const std::string& tableName, TableStore::RecordVerifier verifier);
+
+    // Store an indexed column's index in the given layout (Rows by
+    // default). Compact blocks take less space for keys sharing long
+    // prefixes but make inserts and point lookups slower. Existing
+    // entries are rebuilt.
+    void setIndexLayout(const std::string& tableName, const std::string& column, IndexLayout layout);
+
+    /**
+     * Create an R*Tree spatial index over a table's latitude/longitude columns.
+     * Queries filtering on geo_within_radius(_geo, geo_circle(...)),
+     * geo_bbox_contains(_geo, geo_bbox(...)) or geo_contains(_geo, polygon)
+     * then probe the index instead of scanning. The geo_knn(table, lat, lon, k)
+     * table-valued function returns the k nearest rows in distance order.
+     * One spatial index per table; the field extractor must be set.
+     */
+    void createSpatialIndex(const std::string& tableName,
+                            const std::string& latColumn,
+                            const std::string& lonColumn);
+
+    /**
+     * Create a learned (piecewise-linear) index over a numeric column whose
+     * values arrive roughly in order, such as an epoch or sequence number.
+     * Equality and range predicates on the column are then served from it,
+     * ahead of a B-tree index on the same column. The field extractor must
+     * be set.
+     */
+    void createLearnedIndex(const std::string& tableName, const std::string& column);
+
+    /**
+     * Create an adaptive radix tree index over a string or blob column, for
+     * keys such as emails and entity ids. Equality, range and anchored
+     * LIKE/GLOB predicates on the column, and findRawByIndex(), are then
+     * served from it ahead of a B-tree index on the same column. The field
+     * extractor must be set.
+     */
+    void createRadixIndex(const std::string& tableName, const std::string& column);
+
+    /**
+     * Native geo scans that bypass SQLite. Distances and box tests run over
+     * columns of decoded coordinates with the batch kernels in geo_kernels.h
+     * (AVX2/NEON where available), or probe the table's spatial index when it
+     * covers the same columns. Results match geo_within_radius() and
+     * geo_bbox_contains() exactly. Tombstones are not applied, as with
+     * findByIndex().
+     */
+    std::vector<StoredRecord> findWithinRadius(const std::string& tableName,
+                                               const std::string& latColumn,
+                                               const std::string& lonColumn,
+                                               double lat, double lon, double radiusKm);
+
+    std::vector<StoredRecord> findInBox(const std::string& tableName,
+                                        const std::string& latColumn,
+                                        const std::string& lonColumn,
+                                        double minLat, double maxLat,
+                                        double minLon, double maxLon);
+
+    // COUNT(*) of findWithinRadius() without materializing results
+    size_t countWithinRadius(const std::string& tableName,
+                             const std::string& latColumn,
+                             const std::string& lonColumn,
+                             double lat, double lon, double radiusKm);
+
+    // Get raw storage data (for export), with checksum frames when
+    // setExportChecksums() is on
+    std::vector<uint8_t> exportData() const;
+
+    // Start every stored FlatBuffer on a multiple of `alignment` bytes so
+    // 8-byte scalars can be read in place (see
+    // StreamingFlatBufferStore::setRecordAlignment). Exports then carry
+    // padding frames, which every loader here skips. Call before ingesting.
+    void setRecordAlignment(size_t alignment) { storage_.setRecordAlignment(alignment); }
+
+    // Sequence of the last stored record (0 when empty)
+    uint64_t getLastSequence() const { return storage_.getLastSequence(); }
 
     // Get schema
     const DatabaseSchema& getSchema() const { return schema_; }
@@ -215,11 +476,22 @@ public:
     const TableDef* getTableDef(const std::string& tableName) const;
 
     // Get statistics
+    struct IndexStats {
+        std::string name;
+        bool compact = false;       // IndexLayout::Compact
+        bool learned = false;       // LearnedIndex, named after its column
+        bool radix = false;         // RadixIndex, named after its column
+        uint64_t entryCount = 0;
+        uint64_t storageBytes = 0;  // Index record payload (SqliteIndex::getStorageBytes),
+                                    // or memory for a learned or radix index
+        double bytesPerEntry = 0.0;
+    };
     struct TableStats {
         std::string tableName;
         std::string fileId;
         uint64_t recordCount;
         std::vector<std::string> indexes;
+        std::vector<IndexStats> indexStats;
     };
     std::vector<TableStats> getStats() const;
 
@@ -310,6 +582,137 @@ public:
      */
     void clearTombstones(const std::string& tableName);
 
+    /**
+     * Give a table's file ID its own chain of storage segments (see
+     * StreamingFlatBufferStore::setClustered), so a scan of the table reads
+     * contiguous bytes however its records arrive interleaved with other
+     * tables'. Applies to records ingested afterwards;
+     * reorganizeStorage() moves earlier ones. Sequences stay global.
+     */
+    void setClusteredStorage(const std::string& tableName,
+                             size_t segmentBytes = StreamingFlatBufferStore::DEFAULT_SEGMENT_BYTES);
+
+    /**
+     * Rewrite storage table by table, so each table's records are
+     * contiguous. A table named in clusterKeys has its records ordered by
+     * those columns (NaN after all other values), then by sequence, so
+     * scans and range scans in key order read storage sequentially.
+     * Records no table holds follow, in sequence order. Every index is
+     * rebuilt.
+     *
+     * Sequences, tombstones and deleted records are kept, so exports, the
+     * change feed and the append log are unchanged (they stay in sequence
+     * order). Not for use while a query is stepping.
+     *
+     * @throws std::runtime_error for an unknown table or column, or a
+     *         cluster key on a table without a field extractor
+     */
+    void reorganizeStorage(const std::map<std::string, std::vector<std::string>>& clusterKeys = {});
+
+    // ==================== Change Feed ====================
+
+    // Kind of tombstone frames in a change feed: control frames (see
+    // isControlFrame; flagged, so never a record) holding the 8-byte LE
+    // sequence and the table name. Only applyChanges() understands them.
+    static constexpr const char* TOMBSTONE_FILE_ID = "FSQT";
+
+    // Kind of checksum frames: control frames holding a 4-byte LE CRC32C.
+    // A checksummed stream starts with one covering nothing; each later one
+    // covers the bytes since the previous one.
+    static constexpr const char* CHECKSUM_FILE_ID = "FSQC";
+
+    // Kind of sequence frames: control frames holding the 8-byte LE last
+    // sequence the source had stored before the records that follow. A
+    // non-empty feed starts with one.
+    static constexpr const char* SEQUENCE_FILE_ID = "FSQS";
+    static constexpr size_t DEFAULT_CHECKSUM_BLOCK_SIZE = 1024 * 1024;
+
+    /**
+     * Add checksum frames to exportData() and exportSince() output, one
+     * after about every blockSize bytes of records (0 turns them off, the
+     * default). loadAndRebuild() and applyChanges() verify the blocks in
+     * parallel and skip the frames, so sequences are unaffected.
+     */
+    void setExportChecksums(size_t blockSize = DEFAULT_CHECKSUM_BLOCK_SIZE) { checksumBlockSize_ = blockSize; }
+
+    /**
+     * Write every change after a watermark to a file descriptor: a
+     * sequence frame holding `since`, the records with sequence > since,
+     * exactly as stored (size-prefixed, with any padding frames between
+     * them), and a tombstone frame for every delete made since then, in
+     * the order they happened. Record bytes are written straight from
+     * storage. Nothing is written when there are no changes (apart from
+     * the leading checksum frame, if checksums are on).
+     *
+     * Returns the new watermark (the last sequence written, or since).
+     * Consumers resume by passing back the last watermark they applied.
+     * Deletes are stamped with the last sequence stored when they were
+     * made, and deletes stamped with exactly `since` are sent again, so a
+     * consumer can see a tombstone twice (applying one is idempotent).
+     *
+     * Deletes are kept in memory (24 bytes each) until trimChangeFeed().
+     *
+     * @throws std::runtime_error if the descriptor can't be written, or
+     *         `since` is before the trimChangeFeed() watermark
+     */
+    uint64_t exportSince(uint64_t since, int fd) const;
+
+    // Same, appending the feed to a buffer (for hosts without descriptors,
+    // such as WASM builds without a filesystem)
+    uint64_t exportSince(uint64_t since, std::vector<uint8_t>& out) const;
+
+    /**
+     * Forget the deletes only feeds from before `watermark` need, once
+     * every consumer has applied the changes up to it (e.g. the lowest
+     * ReplicationLeader::getShippedSequence()). exportSince() with an
+     * earlier watermark throws afterwards.
+     */
+    void trimChangeFeed(uint64_t watermark);
+
+    /**
+     * Apply a change feed from exportSince() on a replica: ingest records
+     * and apply tombstones. The replica must have applied every earlier
+     * change of the same source (its sequences then match the source's);
+     * each sequence frame is checked against the last local sequence, and
+     * the records after it must all be stored.
+     * Returns bytes consumed; a trailing partial frame is left for the
+     * next call, as with ingest().
+     *
+     * Once a feed has carried checksum frames, only blocks closed by a
+     * verified checksum are applied; the bytes after the last one are left
+     * for the next call like a partial frame.
+     *
+     * @throws std::runtime_error on a checksum mismatch (nothing is
+     *         applied), or when the feed doesn't continue from the last
+     *         local sequence (what came before the mismatch is applied)
+     */
+    size_t applyChanges(const uint8_t* data, size_t length, size_t* recordsIngested = nullptr);
+
+    // ==================== Append Log ====================
+
+    /**
+     * Make changes durable in a write-ahead append file. Replays what the
+     * file already holds (recovery, dropping a torn tail), then appends
+     * every later ingest and delete as one frame per call.
+     *
+     * Call on an empty database after registering file IDs and extractors,
+     * as with loadAndRebuild(). Records ingested with a source are replayed
+     * without it.
+     *
+     * @throws std::runtime_error if the file can't be opened or the
+     *         database already holds records
+     */
+    void openAppendLog(const std::string& path, const AppendLogOptions& options = {});
+
+    // Write and fdatasync every change logged so far (no-op without a log)
+    void syncAppendLog();
+
+    // Sync and close the append log; later changes are not logged
+    void closeAppendLog();
+
+    // The open append log, or nullptr
+    const AppendLog* getAppendLog() const { return appendLog_.get(); }
+
     // ==================== Encryption API ====================
 
     /**
@@ -385,6 +788,25 @@ private:
     // Initialize SQLite engine with registered tables
     void initializeSQLiteEngine();
 
+    // Store size-prefixed records through callback, verifying them first
+    // when ingest verification is on
+    size_t ingestVerified(const uint8_t* data, size_t length, size_t* recordsIngested,
+                          const StreamingFlatBufferStore::IngestCallback& callback);
+
+    // Table a FlatBuffer routes to by file identifier, or nullptr
+    const TableStore* tableForRecord(const uint8_t* flatbuffer, size_t length) const;
+
+    // Pass the change feed after a watermark to sink; returns the new one
+    uint64_t writeChanges(uint64_t since,
+                          const std::function<void(const uint8_t*, size_t)>& sink) const;
+
+    // Apply records, tombstones and checksum frames without verifying
+    size_t applyFrames(const uint8_t* data, size_t length, size_t* recordsIngested = nullptr);
+
+    // Append the records stored after a sequence to the append log as one
+    // frame and commit the batch (no-op without a log)
+    void logStored(uint64_t afterSequence);
+
     // Re-register a table with SQLite after extractor is set
     void updateSQLiteTable(const std::string& tableName);
 
@@ -423,6 +845,29 @@ private:
 
     // HMAC verification
     bool hmacEnabled_ = false;
+
+    // Deletes in the order they were made, for the change feed, back to
+    // the trimChangeFeed() watermark
+    struct DeleteEvent {
+        uint64_t watermark;   // Last sequence stored when the delete was made
+        uint64_t sequence;    // Deleted record
+        uint32_t table;       // Index into deleteLogTables_
+    };
+    std::vector<DeleteEvent> deleteLog_;
+    std::vector<std::string> deleteLogTables_;
+    uint64_t deleteLogStart_ = 0;     // Feeds since an earlier watermark are gone
+
+    // Ingest verification
+    bool verifyIngest_ = false;
+    unsigned verifyThreads_ = 0;
+    std::vector<size_t> rejectedRecords_;
+
+    // Checksum frames (see setExportChecksums)
+    size_t checksumBlockSize_ = 0;
+    bool checksummedFeed_ = false;    // applyChanges has seen checksum frames
+
+    // Write-ahead append file (optional)
+    std::unique_ptr<AppendLog> appendLog_;
 };
 
 }  // namespace flatsql
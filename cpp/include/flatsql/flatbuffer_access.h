@@ -0,0 +1,76 @@
+#ifndef FLATSQL_FLATBUFFER_ACCESS_H
+#define FLATSQL_FLATBUFFER_ACCESS_H
+
+#include "flatsql/types.h"
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+namespace flatsql {
+
+// Position of a root-table field by vtable slot; pos is 0 when the field is
+// absent. Returns false if the buffer is malformed.
+bool fbRootFieldPosition(const uint8_t* data, size_t length, uint16_t fieldId, uint32_t& pos);
+
+// Read a little-endian scalar field of the root table by vtable slot.
+// Absent fields take the default. Returns false if the buffer is malformed.
+template <typename T>
+bool fbReadRootScalar(const uint8_t* data, size_t length, uint16_t fieldId, T defaultValue, T& out) {
+    uint32_t pos;
+    if (!fbRootFieldPosition(data, length, fieldId, pos)) return false;
+    if (pos == 0) {
+        out = defaultValue;
+        return true;
+    }
+    if (static_cast<uint64_t>(pos) + sizeof(T) > length) return false;
+    std::memcpy(&out, data + pos, sizeof(T));
+    return true;
+}
+
+// Bytes per vector element of this type (0 if it can't be a vector element)
+size_t fbVectorElementSize(ValueType type);
+
+// Check that a root table's offsets and vtable, and the fields the table
+// definition declares (scalars in bounds and aligned, strings terminated,
+// vectors and their string elements in bounds), lie inside the buffer.
+// Fields of types the schema parser doesn't know (structs, tables, enums)
+// are read as strings; register a generated verifier for those tables.
+// Columns without a known slot (after a union or an unknown type) are
+// not checked.
+bool fbVerifyRootTable(const uint8_t* data, size_t length, const TableDef& table);
+
+/**
+ * A vector-of-scalars or vector-of-strings field of a root table, read in
+ * place. Nothing is copied on open(); elements are decoded on access, and
+ * string elements are returned as pointers into the buffer.
+ */
+class FbVectorView {
+public:
+    // Open vector field fieldId. An absent field is an empty vector.
+    // Returns false if the buffer is malformed.
+    bool open(const uint8_t* data, size_t length, uint16_t fieldId, ValueType elementType);
+
+    uint32_t size() const { return count_; }
+    ValueType getElementType() const { return type_; }
+
+    // String element i (not NUL-terminated). Returns false if malformed.
+    bool stringAt(uint32_t i, const char*& str, uint32_t& len) const;
+
+    // Element i as a Value of the element type; NULL if malformed
+    Value at(uint32_t i) const;
+
+    // Elements as a JSON array, e.g. ["a","b"] or [1,2,3]
+    std::string toJson() const;
+
+private:
+    const uint8_t* data_ = nullptr;
+    size_t length_ = 0;
+    uint32_t elements_ = 0;  // Position of the first element
+    uint32_t count_ = 0;
+    ValueType type_ = ValueType::Null;
+};
+
+}  // namespace flatsql
+
+#endif  // FLATSQL_FLATBUFFER_ACCESS_H
@@ -5,6 +5,28 @@
 
 namespace flatsql {
 
+// Mean Earth radius used by all distance calculations
+constexpr double GEO_EARTH_RADIUS_KM = 6371.0;
+
+// Geometry values passed between SQL functions as fixed-size blobs of doubles
+struct GeoPoint {
+    double lat;
+    double lon;
+};
+
+struct GeoCircle {
+    double lat;
+    double lon;
+    double radiusKm;
+};
+
+struct GeoBox {
+    double minLat;
+    double maxLat;
+    double minLon;
+    double maxLon;
+};
+
 /**
  * Register geo/spatial SQL functions on a SQLite database.
  *
@@ -12,9 +34,36 @@ namespace flatsql {
  *   geo_distance(lat1, lon1, lat2, lon2)        -> km (Haversine)
  *   geo_bbox_contains(minLat, maxLat, minLon, maxLon, lat, lon) -> 0/1
  *   geo_within_radius(centerLat, centerLon, lat, lon, radiusKm)  -> 0/1
+ *   geo_contains(polygon, lat, lon)             -> 0/1 (polygon is WKB)
+ *
+ * Geometry constructors and two-argument forms. The two-argument forms can be
+ * pushed down to a spatial index when the first argument is a table's _geo column:
+ *   geo_point(lat, lon)                         -> point blob
+ *   geo_circle(centerLat, centerLon, radiusKm)  -> circle blob
+ *   geo_bbox(minLat, maxLat, minLon, maxLon)    -> box blob
+ *   geo_polygon(lat1, lon1, lat2, lon2, ...)    -> WKB polygon blob
+ *   geo_within_radius(point, circle)            -> 0/1
+ *   geo_bbox_contains(point, box)               -> 0/1
+ *   geo_contains(point, polygon)                -> 0/1
+ *
+ * Polygons are parsed once per statement (see GeoPolygon) and cached with
+ * sqlite3_set_auxdata when the polygon argument is constant.
  */
 void registerGeoFunctions(sqlite3* db);
 
+// Great-circle distance between two lat/lon points in degrees (returns km)
+double geoHaversineKm(double lat1, double lon1, double lat2, double lon2);
+
+// Decode geometry blobs. Return false for NULL or malformed values.
+bool geoPointFromValue(sqlite3_value* value, GeoPoint& out);
+bool geoCircleFromValue(sqlite3_value* value, GeoCircle& out);
+bool geoBoxFromValue(sqlite3_value* value, GeoBox& out);
+
+// Two-argument implementations, exposed so virtual tables can overload them
+void geoWithinRadiusPointFunc(sqlite3_context* ctx, int argc, sqlite3_value** argv);
+void geoBboxContainsPointFunc(sqlite3_context* ctx, int argc, sqlite3_value** argv);
+void geoContainsPointFunc(sqlite3_context* ctx, int argc, sqlite3_value** argv);
+
 }  // namespace flatsql
 
 #endif  // FLATSQL_GEO_FUNCTIONS_H
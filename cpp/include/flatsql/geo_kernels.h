@@ -0,0 +1,44 @@
+#ifndef FLATSQL_GEO_KERNELS_H
+#define FLATSQL_GEO_KERNELS_H
+
+#include <cstddef>
+#include <cstdint>
+
+namespace flatsql {
+
+/**
+ * Batch geo kernels over columns of coordinates (degrees).
+ *
+ * Distances use polynomial sin/asin approximations evaluated 4 lanes at a
+ * time with AVX2+FMA, 2 lanes with NEON, or one at a time otherwise. The ISA
+ * is picked once at runtime on x86. Distances are within
+ * GEO_BATCH_MAX_ERROR_KM of geoHaversineKm(); the radius predicate re-checks
+ * points that close to the boundary with libm, so it agrees exactly with
+ * geo_within_radius().
+ */
+
+// Absolute error bound of geoHaversineBatch() against geoHaversineKm()
+constexpr double GEO_BATCH_MAX_ERROR_KM = 1e-6;
+
+// outKm[i] = great-circle distance from (lat, lon) to (lats[i], lons[i])
+void geoHaversineBatch(double lat, double lon, const double* lats, const double* lons,
+                       size_t n, double* outKm);
+
+// outMask[i] = 1 if (lats[i], lons[i]) is within radiusKm of (lat, lon).
+// outKm (optional) receives the distances. Returns the number of matches.
+size_t geoWithinRadiusBatch(double lat, double lon, double radiusKm,
+                            const double* lats, const double* lons, size_t n,
+                            uint8_t* outMask, double* outKm = nullptr);
+
+// outMask[i] = 1 if minLat <= lats[i] <= maxLat and minLon <= lons[i] <= maxLon.
+// Returns the number of matches.
+size_t geoBboxContainsBatch(double minLat, double maxLat, double minLon, double maxLon,
+                            const double* lats, const double* lons, size_t n,
+                            uint8_t* outMask);
+
+// Name of the instruction set the kernels run on ("avx2", "neon" or "scalar")
+const char* geoKernelIsa();
+
+}  // namespace flatsql
+
+#endif  // FLATSQL_GEO_KERNELS_H
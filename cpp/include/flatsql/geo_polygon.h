@@ -0,0 +1,78 @@
+#ifndef FLATSQL_GEO_POLYGON_H
+#define FLATSQL_GEO_POLYGON_H
+
+#include <sqlite3.h>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+namespace flatsql {
+
+/**
+ * A polygon prepared for repeated point-in-polygon tests.
+ *
+ * Parsed from WKB (Polygon or MultiPolygon, 2D, either byte order) with x as
+ * longitude and y as latitude. Containment uses the even-odd rule over all
+ * rings, so holes and disjoint parts need no special handling. Coordinates
+ * are treated as planar: polygons must not cross the antimeridian, and points
+ * exactly on an edge may fall on either side.
+ *
+ * Edges are bucketed into horizontal latitude bands; a test only casts its
+ * ray against the edges of the band the point falls in, so the cost per point
+ * depends on the local edge density rather than the total vertex count.
+ */
+class GeoPolygon {
+public:
+    // Parse a WKB polygon. Returns nullptr for malformed or unsupported input.
+    static std::unique_ptr<GeoPolygon> fromWkb(const uint8_t* data, size_t length);
+
+    // Parse a polygon blob argument. Returns nullptr for NULL or malformed values.
+    static std::unique_ptr<GeoPolygon> fromValue(sqlite3_value* value);
+
+    // Encode a single-ring polygon as little-endian WKB. Vertices are
+    // (lat, lon) pairs; the ring is closed if the last vertex differs from the first.
+    static std::vector<uint8_t> toWkb(const std::vector<double>& latLonPairs);
+
+    bool contains(double lat, double lon) const;
+
+    // Bounding box
+    double getMinLat() const { return minLat_; }
+    double getMaxLat() const { return maxLat_; }
+    double getMinLon() const { return minLon_; }
+    double getMaxLon() const { return maxLon_; }
+
+    size_t getEdgeCount() const { return edges_.size(); }
+    size_t getBandCount() const { return bandStart_.empty() ? 0 : bandStart_.size() - 1; }
+
+private:
+    GeoPolygon() = default;
+
+    // Edge normalized so that lat0 < lat1; crosses latitudes [lat0, lat1)
+    struct Edge {
+        double lat0;
+        double lat1;
+        double lon0;
+        double dLonPerLat;
+    };
+
+    void addRing(const std::vector<double>& lons, const std::vector<double>& lats);
+    void buildBands();
+    size_t bandOf(double lat) const;
+
+    std::vector<Edge> edges_;
+
+    // Band b holds edges bandEdges_[bandStart_[b] .. bandStart_[b + 1])
+    std::vector<uint32_t> bandStart_;
+    std::vector<uint32_t> bandEdges_;
+    double bandScale_ = 0.0;  // bands per degree of latitude
+
+    double minLat_ = 0.0;
+    double maxLat_ = 0.0;
+    double minLon_ = 0.0;
+    double maxLon_ = 0.0;
+};
+
+}  // namespace flatsql
+
+#endif  // FLATSQL_GEO_POLYGON_H
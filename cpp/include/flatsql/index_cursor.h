@@ -0,0 +1,126 @@
+#ifndef FLATSQL_INDEX_CURSOR_H
+#define FLATSQL_INDEX_CURSOR_H
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace flatsql {
+
+/**
+ * Lazy iterator over the entries an index query matches, in (key, sequence)
+ * order, yielding (offset, sequence) pairs.
+ *
+ * An index opens the cursor with the query's encoded key bounds and a
+ * refill function. The cursor hands out entries from a small buffer; when
+ * the buffer runs dry it asks the index for the next BATCH_SIZE entries
+ * after the last one it handed out (keyset paging). Memory per query is
+ * therefore bounded whatever the number of matches, nothing is held open
+ * in the index between refills, and entries inserted while a cursor is
+ * open never invalidate it (they are returned if they sort after the
+ * cursor's position).
+ *
+ * The cursor must not outlive the index that opened it.
+ */
+class IndexCursor {
+public:
+    static constexpr size_t BATCH_SIZE = 64;
+
+    // Fetches the entries after the cursor's position (see push)
+    using Refill = std::function<void(IndexCursor&)>;
+
+    // Next entry. Returns false once the query is exhausted or closed.
+    bool next(uint64_t& offset, uint64_t& sequence) {
+        if (position_ == batch_.size()) {
+            if (done_ || !refill_) return false;
+            batch_.clear();
+            position_ = 0;
+            refill_(*this);
+            // A short batch means the index ran out of entries
+            done_ = batch_.size() < BATCH_SIZE;
+            if (batch_.empty()) return false;
+        }
+        offset = batch_[position_].offset;
+        sequence = batch_[position_].sequence;
+        position_++;
+        return true;
+    }
+
+    // Start a query. The index sets the bounds below before the first next().
+    void open(Refill refill) {
+        refill_ = std::move(refill);
+        batch_.clear();
+        batch_.reserve(BATCH_SIZE);
+        position_ = 0;
+        done_ = false;
+        from.clear();
+        fromResume = false;
+        fromSequence = 0;
+        to.clear();
+        hasTo = false;
+        toInclusive = true;
+    }
+
+    // End the query. A closed cursor returns no entries.
+    void close() {
+        refill_ = nullptr;
+        batch_.clear();
+        position_ = 0;
+        done_ = true;
+    }
+
+    // Exclude every entry with key == from (an exclusive lower bound)
+    void excludeFrom() {
+        fromResume = true;
+        fromSequence = UINT64_MAX;
+    }
+
+    // For refill: append the next entry in order and move the resume
+    // position to it. Returns false once the batch is full.
+    bool push(const char* key, size_t keyLength, uint64_t offset, uint64_t sequence) {
+        batch_.push_back({offset, sequence});
+        from.assign(key, keyLength);
+        fromResume = true;
+        fromSequence = sequence;
+        return batch_.size() < BATCH_SIZE;
+    }
+    bool push(const std::string& key, uint64_t offset, uint64_t sequence) {
+        return push(key.data(), key.size(), offset, sequence);
+    }
+
+    // For refill: whether an encoded key is past the upper bound
+    bool pastEnd(const char* key, size_t keyLength) const {
+        if (!hasTo) return false;
+        int c = std::string::traits_type::compare(key, to.data(), std::min(keyLength, to.size()));
+        if (c == 0) c = keyLength < to.size() ? -1 : (keyLength > to.size() ? 1 : 0);
+        return c > 0 || (c == 0 && !toInclusive);
+    }
+
+    // Query state, kept by the index. Entries returned have key >= from,
+    // excluding key == from with sequence <= fromSequence when fromResume
+    // is set, and key <= to (key < to unless toInclusive) when hasTo is set.
+    std::string from;
+    bool fromResume = false;
+    uint64_t fromSequence = 0;
+    std::string to;
+    bool hasTo = false;
+    bool toInclusive = true;
+
+private:
+    struct Posting {
+        uint64_t offset;
+        uint64_t sequence;
+    };
+
+    Refill refill_;
+    std::vector<Posting> batch_;
+    size_t position_ = 0;
+    bool done_ = true;
+};
+
+}  // namespace flatsql
+
+#endif  // FLATSQL_INDEX_CURSOR_H
@@ -0,0 +1,77 @@
+#ifndef FLATSQL_KEY_CODEC_H
+#define FLATSQL_KEY_CODEC_H
+
+#include "flatsql/types.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace flatsql {
+
+/**
+ * Order-preserving ("normalized") key encoding.
+ *
+ * A key is encoded for its index's key type so that comparing encodings with
+ * memcmp, shorter first on a tie, orders them like compareValues():
+ *
+ *   signed ints    8 bytes big-endian, sign bit flipped
+ *   unsigned ints  8 bytes big-endian
+ *   floats         8 bytes big-endian IEEE-754 double; positives get the sign
+ *                  bit set, negatives are inverted. -0 encodes as +0 and NaN
+ *                  sorts after +inf.
+ *   bool           1 byte
+ *   strings/blobs  the bytes, with 0x00 escaped as 00 FF and 0xFF as FF 00,
+ *                  terminated by 00 01
+ *
+ * Every encoding is self-delimiting, so a composite key is the concatenation
+ * of its column encodings and still compares column by column. An encoded
+ * string prefix (appendBytes without the terminator) is a byte prefix of the
+ * encoding of every string that starts with it.
+ *
+ * Encodings are byte strings held in std::string for its small-buffer storage.
+ */
+class KeyCodec {
+public:
+    // How a probe value is mapped onto the key type
+    enum class Bound {
+        Exact,  // The key equal to value; fails if no key of the type can be
+        Lower,  // The smallest key >= value; fails if there is none
+        Upper   // The largest key <= value; fails if there is none
+    };
+
+    // Append the encoding of value converted to keyType, with SQLite's
+    // comparison rules for mixed types (numeric text compares as a number,
+    // numbers < text < blobs). Returns false when the bound has no key.
+    static bool append(ValueType keyType, const Value& value, std::string& out,
+                       Bound bound = Bound::Exact);
+
+    // Typed encoders, no Value involved
+    static void appendInt64(int64_t v, std::string& out);
+    static void appendUInt64(uint64_t v, std::string& out);
+    static void appendDouble(double v, std::string& out);
+    static void appendBool(bool v, std::string& out);
+    static void appendBytes(const char* data, size_t length, std::string& out, bool terminate = true);
+
+    // Encoding greater than every single-column key (an open upper bound)
+    static void appendMax(std::string& out);
+
+    // Smallest byte string greater than every string starting with prefix.
+    // Returns false when no such bound exists (empty or all-0xFF prefix).
+    static bool prefixSuccessor(const std::string& prefix, std::string& out);
+
+    // Encode values as a composite key, one column type per value
+    static bool appendComposite(const std::vector<ValueType>& keyTypes, const std::vector<Value>& values,
+                                std::string& out, Bound bound = Bound::Exact);
+
+    // Decode one key of keyType at data[pos], advancing pos. Returns false if malformed.
+    static bool decode(ValueType keyType, const uint8_t* data, size_t length, size_t& pos, Value& out);
+
+    // Big-endian prefix of an encoding as an integer; comparing prefixes
+    // orders keys like memcmp up to the first 8 bytes (ties need the rest)
+    static uint64_t prefix64(const uint8_t* data, size_t length);
+};
+
+}  // namespace flatsql
+
+#endif  // FLATSQL_KEY_CODEC_H
@@ -0,0 +1,156 @@
+#ifndef FLATSQL_LEARNED_INDEX_H
+#define FLATSQL_LEARNED_INDEX_H
+
+#include "flatsql/types.h"
+#include "flatsql/key_codec.h"
+#include "flatsql/index_cursor.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace flatsql {
+
+/**
+ * Piecewise-linear learned index (PGM-style) for monotonic numeric columns
+ * such as epochs, timestamps and sequence numbers.
+ *
+ * Entries live in memory in one array sorted by (key, sequence). A short
+ * list of linear segments predicts where a key sits in that array to within
+ * epsilon positions, and a binary search over the predicted window finds it
+ * exactly. Segments are fitted in one pass with the shrinking-cone method,
+ * so a key stream that is close to linear needs only a handful of them.
+ *
+ * Inserts are append-optimized: a key >= the last key extends the array and
+ * the open tail segment in O(1). Keys arriving out of order go to a small
+ * sorted buffer that is merged in (and the segments refitted) once it grows
+ * past a fraction of the index. Queries read both.
+ *
+ * Keys are held as 64-bit ordinals built from their KeyCodec encoding, so
+ * probes get the same type conversion and ordering as SqliteIndex. Cost is
+ * 24 bytes per entry plus 24 bytes per segment, with no per-lookup I/O.
+ */
+class LearnedIndex {
+public:
+    // Maximum distance between a predicted and an actual position
+    static constexpr size_t DEFAULT_EPSILON = 32;
+
+    // Comparison applied by query()
+    using Op = KeyOp;
+
+    /**
+     * @param columnName Column being indexed
+     * @param keyType    Numeric or bool key type (see supportsType)
+     * @param epsilon    Segment error bound; smaller means more segments
+     */
+    LearnedIndex(const std::string& columnName, ValueType keyType,
+                 size_t epsilon = DEFAULT_EPSILON);
+
+    // Whether keys of this type can be learned (numbers and bools)
+    static bool supportsType(ValueType type);
+
+    // Insert an entry. Null and non-numeric keys throw.
+    void insert(const Value& key, uint64_t dataOffset, uint64_t sequence);
+
+    // Entries with exactly this key, in sequence order
+    std::vector<IndexEntry> search(const Value& key) const;
+
+    // First entry with this key. Returns false if there is none.
+    bool searchFirst(const Value& key, IndexEntry& result) const;
+
+    // Range query: minKey <= key <= maxKey
+    std::vector<IndexEntry> range(const Value& minKey, const Value& maxKey) const;
+
+    // Entries satisfying every (op, value) constraint, in key order. A
+    // constraint no key can satisfy (e.g. a NULL value) matches nothing.
+    std::vector<IndexEntry> query(const std::vector<std::pair<Op, Value>>& constraints) const;
+
+    // All entries in key order
+    std::vector<IndexEntry> all() const;
+
+    // Lazy form of query: open cursor on the same entries
+    void openQuery(const std::vector<std::pair<Op, Value>>& constraints, IndexCursor& cursor) const;
+
+    // Statistics
+    uint64_t getEntryCount() const { return keys_.size() + pending_.size(); }
+    size_t getSegmentCount() const { return segments_.size(); }
+    size_t getEpsilon() const { return epsilon_; }
+    size_t getPendingCount() const { return pending_.size(); }
+
+    // Bytes held by entries, segments and the out-of-order buffer
+    size_t getMemoryBytes() const;
+
+    // Bytes held by the segments alone (the learned model)
+    size_t getModelBytes() const { return segments_.size() * sizeof(Segment); }
+
+    // Clear all entries
+    void clear();
+
+    const std::string& getColumnName() const { return columnName_; }
+    ValueType getKeyType() const { return keyType_; }
+
+private:
+    struct Segment {
+        int64_t firstKey;  // Ordinal of the segment's first key
+        double slope;      // Positions per ordinal step
+        size_t start;      // Position of firstKey in keys_
+    };
+
+    struct Pending {
+        int64_t key;
+        uint64_t offset;
+        uint64_t sequence;
+    };
+
+    // Closed ordinal interval [lo, hi]; empty when lo > hi
+    struct OrdinalRange {
+        int64_t lo = INT64_MIN;
+        int64_t hi = INT64_MAX;
+        bool empty = false;
+    };
+
+    // Narrow range by one constraint
+    void applyConstraint(OrdinalRange& range, Op op, const Value& value) const;
+
+    // Ordinal of value mapped with bound. Returns false if no key of the type qualifies.
+    bool toOrdinal(const Value& value, KeyCodec::Bound bound, int64_t& out) const;
+    Value fromOrdinal(int64_t ordinal) const;
+
+    // First position in keys_ whose key >= ordinal
+    size_t lowerBound(int64_t ordinal) const;
+
+    // Fitting: feed distinct keys in order
+    void fitPoint(int64_t key, size_t position);
+    void refit();
+
+    // Merge the out-of-order buffer into the sorted arrays and refit
+    void mergePending();
+
+    std::vector<IndexEntry> collect(const OrdinalRange& range) const;
+
+    // Cursor keys are ordinals as 8 big-endian bytes (sign bit flipped)
+    void fillCursor(IndexCursor& cursor) const;
+
+    std::string columnName_;
+    ValueType keyType_;
+    size_t epsilon_;
+
+    // Sorted by (key, sequence); huge-page backed once large
+    PageVector<int64_t> keys_;
+    PageVector<uint64_t> offsets_;
+    PageVector<uint64_t> sequences_;
+
+    // The last segment is open and grows as keys are appended
+    std::vector<Segment> segments_;
+    double coneLow_ = 0.0;   // Slopes that keep the open segment within epsilon
+    double coneHigh_ = 0.0;
+    bool coneOpen_ = false;  // False until the open segment has a second point
+
+    // Out-of-order entries, sorted by (key, sequence)
+    std::vector<Pending> pending_;
+};
+
+}  // namespace flatsql
+
+#endif  // FLATSQL_LEARNED_INDEX_H
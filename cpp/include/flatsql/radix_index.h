@@ -0,0 +1,172 @@
+#ifndef FLATSQL_RADIX_INDEX_H
+#define FLATSQL_RADIX_INDEX_H
+
+#include "flatsql/types.h"
+#include "flatsql/key_codec.h"
+#include "flatsql/index_cursor.h"
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace flatsql {
+
+/**
+ * Adaptive radix tree (ART) index for string and blob keys such as emails
+ * and entity ids.
+ *
+ * Keys are stored as their KeyCodec encoding, which is memcmp-ordered and
+ * prefix-free (every string encoding ends in 00 01), so an in-order walk of
+ * the tree visits keys in index order and no key ends inside another. Inner
+ * nodes grow through 4, 16, 48 and 256 children as they fill, and chains of
+ * single-child nodes are collapsed into a compressed prefix held on the
+ * node: up to PREFIX_INLINE bytes inline, the rest read back from a leaf
+ * below it when a range walk needs them. A lookup touches one node per
+ * distinguishing byte rather than comparing whole keys at each level, so
+ * its cost follows the length of the key's unique part, not the number of
+ * keys or how long their shared prefixes are.
+ *
+ * Each leaf holds one distinct key and its postings in sequence order. The
+ * tree is in memory only and supports insert and clear, like the other
+ * index types.
+ */
+class RadixIndex {
+public:
+    using Op = KeyOp;
+
+    // Compressed-prefix bytes kept in the node itself
+    static constexpr size_t PREFIX_INLINE = 10;
+
+    /**
+     * @param columnName Column being indexed
+     * @param keyType    String or Bytes (see supportsType)
+     */
+    RadixIndex(const std::string& columnName, ValueType keyType);
+    ~RadixIndex();
+
+    RadixIndex(const RadixIndex&) = delete;
+    RadixIndex& operator=(const RadixIndex&) = delete;
+
+    // Whether keys of this type can be indexed (strings and blobs)
+    static bool supportsType(ValueType type);
+
+    // Insert an entry. Null keys throw; other types convert like SqliteIndex.
+    void insert(const Value& key, uint64_t dataOffset, uint64_t sequence);
+
+    // Entries with exactly this key, in sequence order
+    std::vector<IndexEntry> search(const Value& key) const;
+
+    // First entry with this key. Returns false if there is none.
+    bool searchFirst(const Value& key, IndexEntry& result) const;
+
+    // Fast path for string keys (no Value or IndexEntry construction)
+    bool searchFirstString(const std::string& key, uint64_t& outOffset, uint64_t& outSequence) const;
+
+    // Lookup by a key already encoded with KeyCodec::append(getKeyType(), ...)
+    bool searchFirstEncoded(const std::string& key, uint64_t& outOffset, uint64_t& outSequence) const;
+
+    // Range query: minKey <= key <= maxKey
+    std::vector<IndexEntry> range(const Value& minKey, const Value& maxKey) const;
+
+    // Prefix range on string keys: lowKey <= key < successor(highPrefix),
+    // with the same meaning as SqliteIndex::prefixRange
+    std::vector<IndexEntry> prefixRange(const std::string& lowKey, const std::string& highPrefix) const;
+
+    // Entries satisfying every (op, value) constraint, in key order. A
+    // constraint no key can satisfy (e.g. a NULL value) matches nothing.
+    std::vector<IndexEntry> query(const std::vector<std::pair<Op, Value>>& constraints) const;
+
+    // All entries in key order
+    std::vector<IndexEntry> all() const;
+
+    // Lazy forms of query and prefixRange: open cursor on the same entries
+    void openQuery(const std::vector<std::pair<Op, Value>>& constraints, IndexCursor& cursor) const;
+    void openPrefixRange(const std::string& lowKey, const std::string& highPrefix, IndexCursor& cursor) const;
+
+    // Statistics
+    uint64_t getEntryCount() const { return entryCount_; }
+    uint64_t getKeyCount() const { return keyCount_; }    // Distinct keys (leaves)
+    size_t getNodeCount() const { return nodeCount_; }     // Inner nodes
+
+    // Bytes held by nodes, leaves, keys and postings
+    size_t getMemoryBytes() const { return memoryBytes_; }
+
+    // Clear all entries
+    void clear();
+
+    const std::string& getColumnName() const { return columnName_; }
+    ValueType getKeyType() const { return keyType_; }
+
+private:
+    struct Node;
+    struct Leaf;
+    struct Inner;
+    struct Node4;
+    struct Node16;
+    struct Node48;
+    struct Node256;
+
+    // Visitor for walks: encoded key and one posting; return false to stop
+    using Visitor = std::function<bool(const std::string& key, uint64_t offset, uint64_t sequence)>;
+
+    // Encoded key bounds for a walk. An unset bound is open.
+    struct Bounds {
+        std::string low;
+        std::string high;
+        bool hasLow = false;
+        bool hasHigh = false;
+        bool lowInclusive = true;
+        bool highInclusive = true;
+        bool empty = false;
+    };
+
+    // Narrow bounds by one constraint
+    void applyConstraint(Bounds& bounds, Op op, const Value& value) const;
+    static void setLow(Bounds& bounds, const std::string& key, bool inclusive);
+    static void setHigh(Bounds& bounds, const std::string& key, bool inclusive);
+
+    const Leaf* findLeaf(const uint8_t* key, size_t length) const;
+    void insertEncoded(const std::string& key, uint64_t offset, uint64_t sequence);
+
+    // Node operations
+    static Node** findChild(Inner* node, uint8_t byte);
+    static const Leaf* minimumLeaf(const Node* node);
+    static size_t prefixMismatch(const Inner* node, const std::string& key, size_t depth);
+    template <typename N>
+    static void insertSorted(N* node, uint8_t byte, Node* child);
+    static void copyHeader(Inner* to, const Inner* from);
+    // Add a child, replacing *ref with a larger node when node is full
+    void addChild(Node** ref, Inner* node, uint8_t byte, Node* child);
+    Node4* newNode4(const uint8_t* prefix, size_t prefixLength);
+
+    // Walk keys within bounds in order. path holds the bytes above node.
+    bool walk(const Node* node, std::string& path, const Bounds& bounds,
+              bool lowOpen, bool highOpen, const Visitor& visit) const;
+    void scan(const Bounds& bounds, const Visitor& visit) const;
+    std::vector<IndexEntry> collect(const Bounds& bounds) const;
+
+    // Cursors hold encoded bounds; refill resumes after the cursor's position
+    void openBounds(const Bounds& bounds, IndexCursor& cursor) const;
+    void fillCursor(IndexCursor& cursor) const;
+    IndexEntry makeEntry(const std::string& key, uint64_t offset, uint64_t sequence) const;
+
+    Leaf* newLeaf(const std::string& key, uint64_t offset, uint64_t sequence);
+    void freeNode(Node* node);
+
+    std::string columnName_;
+    ValueType keyType_;
+    Node* root_ = nullptr;
+    uint64_t entryCount_ = 0;
+    uint64_t keyCount_ = 0;
+    size_t nodeCount_ = 0;
+    size_t memoryBytes_ = 0;
+
+    // Encoded probe scratch space for the string fast path
+    mutable std::string keyBuffer_;
+};
+
+}  // namespace flatsql
+
+#endif  // FLATSQL_RADIX_INDEX_H
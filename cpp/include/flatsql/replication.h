@@ -0,0 +1,111 @@
+#ifndef FLATSQL_REPLICATION_H
+#define FLATSQL_REPLICATION_H
+
+#include "flatsql/database.h"
+#include <cstdint>
+#include <vector>
+
+namespace flatsql {
+
+/**
+ * Log-shipping replication between databases on one host.
+ *
+ * On each shipment the leader writes a follower, over a stream descriptor
+ * (a Unix socket or the write end of a pipe), a watermark frame carrying the
+ * leader's last sequence and then its change feed up to there (see
+ * FlatSQLDatabase::exportSince). The follower applies records and tombstones
+ * as bytes arrive and reports how many sequences it is behind the last
+ * watermark it saw. With FlatSQLDatabase::setExportChecksums() on the
+ * leader, shipments carry checksum frames and the follower applies only
+ * verified blocks.
+ *
+ * A follower must start empty, or from a copy of the leader's storage up to
+ * the sequence it is added with, so that its sequences match the leader's
+ * (each shipment's sequence frame is checked; receive() throws otherwise).
+ * Writes to a closed socket or pipe raise SIGPIPE; leaders that outlive
+ * their followers should ignore it. The leader's database keeps deletes
+ * for the feed until trimmed (FlatSQLDatabase::trimChangeFeed with
+ * getLowestShippedSequence()).
+ */
+class ReplicationLeader {
+public:
+    // Watermark frame: a control frame (see isControlFrame) of this kind
+    // holding the 8-byte LE sequence
+    static constexpr const char* WATERMARK_FILE_ID = "FSQW";
+
+    explicit ReplicationLeader(const FlatSQLDatabase& db) : db_(db) {}
+
+    // Ship to fd (not owned), whose follower has applied every change up to
+    // `since`. Returns the follower's id.
+    size_t addFollower(int fd, uint64_t since = 0);
+
+    // Stop shipping to a follower
+    void removeFollower(size_t id);
+
+    // Send every follower a watermark frame and the changes since its last
+    // shipment. A follower whose descriptor fails is removed.
+    // Returns the number of followers shipped to.
+    size_t ship();
+
+    // Whether a follower is still shipped to
+    bool isActive(size_t id) const { return id < followers_.size() && followers_[id].active; }
+
+    // Last sequence shipped to a follower
+    uint64_t getShippedSequence(size_t id) const { return followers_.at(id).shipped; }
+
+    // Lowest sequence shipped to an active follower (the database's last
+    // sequence if there is none): the watermark to trimChangeFeed() with
+    uint64_t getLowestShippedSequence() const;
+
+private:
+    struct Follower {
+        int fd;
+        uint64_t shipped;
+        bool active;
+    };
+
+    const FlatSQLDatabase& db_;
+    std::vector<Follower> followers_;
+};
+
+/**
+ * Applies a leader's replication stream to a database. Indexes are updated
+ * through applyChanges(), one SQLite transaction per received run.
+ */
+class ReplicationFollower {
+public:
+    explicit ReplicationFollower(FlatSQLDatabase& db) : db_(db) {}
+
+    // Read what is available from fd (blocking until some bytes arrive) and
+    // apply every complete frame. Returns false once the leader has closed
+    // the stream.
+    bool poll(int fd);
+
+    // Apply bytes received by other means. Incomplete frames are kept until
+    // the rest arrives. Returns the number of records ingested. Throws what
+    // applyChanges() throws; the follower is failed from then on (every
+    // later call throws) and must be rebuilt from a fresh copy.
+    size_t receive(const uint8_t* data, size_t length);
+
+    // Last sequence applied (matches the leader's numbering)
+    uint64_t getAppliedSequence() const { return db_.getLastSequence(); }
+
+    // Leader's last sequence as of the latest watermark frame
+    uint64_t getLeaderSequence() const { return leaderSequence_; }
+
+    // Sequences the follower is behind the latest watermark
+    uint64_t getLag() const {
+        uint64_t applied = getAppliedSequence();
+        return leaderSequence_ > applied ? leaderSequence_ - applied : 0;
+    }
+
+private:
+    FlatSQLDatabase& db_;
+    std::vector<uint8_t> pending_;  // Received bytes not yet applied
+    uint64_t leaderSequence_ = 0;
+    bool failed_ = false;  // A run failed to apply
+};
+
+}  // namespace flatsql
+
+#endif  // FLATSQL_REPLICATION_H
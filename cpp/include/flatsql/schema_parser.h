@@ -24,6 +24,8 @@ public:
 
 private:
     static ValueType idlTypeToValueType(const std::string& idlType);
+    // Element type of a vector of scalars or strings ([int], [string], ...)
+    static bool idlVectorElementType(const std::string& idlType, ValueType& elementType);
     static ValueType jsonTypeToValueType(const std::string& jsonType, const std::string& format = "");
 };
 
@@ -0,0 +1,80 @@
+#ifndef FLATSQL_SGP4_H
+#define FLATSQL_SGP4_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace flatsql {
+
+// Mean elements in CCSDS OMM / MPE units
+struct Sgp4Elements {
+    double epoch;            // UNIX seconds
+    double meanMotion;       // rev/day (Kozai)
+    double eccentricity;
+    double inclination;      // degrees
+    double raOfAscNode;      // degrees
+    double argOfPericenter;  // degrees
+    double meanAnomaly;      // degrees
+    double bstar;            // 1/earth radii
+};
+
+// Per-satellite status, following the reference implementation's codes
+enum Sgp4Error : int32_t {
+    SGP4_OK = 0,
+    SGP4_BAD_ECCENTRICITY = 1,    // Mean eccentricity out of range
+    SGP4_BAD_MEAN_MOTION = 2,     // Mean motion <= 0
+    SGP4_BAD_SEMILATUS = 4,       // Semi-latus rectum < 0
+    SGP4_DECAYED = 6,             // Satellite has decayed
+    SGP4_DEEP_SPACE = 7           // Period >= 225 min (SDP4 not implemented)
+};
+
+// Position (km) and velocity (km/s) in the TEME frame
+struct Sgp4State {
+    double x, y, z;
+    double vx, vy, vz;
+};
+
+/**
+ * Near-earth SGP4 (WGS-72) over a batch of satellites.
+ *
+ * Elements are initialized once into structure-of-arrays form; propagate()
+ * then advances a range of satellites to a time in a single tight loop with
+ * no per-satellite allocation or dispatch. Deep-space orbits (period of 225
+ * minutes or more) need SDP4's lunar/solar terms and are reported as
+ * SGP4_DEEP_SPACE instead of being propagated.
+ */
+class Sgp4Batch {
+public:
+    // Initialize a satellite. Returns its index in the batch.
+    size_t add(const Sgp4Elements& elements);
+
+    size_t size() const { return epoch_.size(); }
+
+    // Initialization status of satellite i
+    Sgp4Error getInitError(size_t i) const { return static_cast<Sgp4Error>(initError_[i]); }
+
+    // Propagate satellites [begin, end) to unixTime. out and errors are
+    // indexed by satellite (out[i], errors[i] for satellite i).
+    void propagate(double unixTime, size_t begin, size_t end,
+                   Sgp4State* out, int32_t* errors) const;
+
+    // Propagate every satellite to each time t0 + k * step, k = 0..steps-1,
+    // splitting satellites across up to `threads` worker threads (0 = one per
+    // core). Results are step-major: out[k * size() + i].
+    void propagateGrid(double t0, double step, size_t steps, unsigned threads,
+                       Sgp4State* out, int32_t* errors) const;
+
+private:
+    // Elements and derived constants, one array per term
+    std::vector<int32_t> initError_;
+    std::vector<uint8_t> isimp_;
+    std::vector<double> epoch_, ecco_, inclo_, nodeo_, argpo_, mo_, bstar_, noUnkozai_;
+    std::vector<double> aycof_, con41_, cc1_, cc4_, cc5_, d2_, d3_, d4_, delmo_, eta_;
+    std::vector<double> argpdot_, omgcof_, sinmao_, t2cof_, t3cof_, t4cof_, t5cof_;
+    std::vector<double> x1mth2_, x7thm1_, mdot_, nodedot_, xlcof_, xmcof_, nodecf_;
+};
+
+}  // namespace flatsql
+
+#endif  // FLATSQL_SGP4_H
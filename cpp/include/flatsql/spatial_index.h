@@ -0,0 +1,102 @@
+#ifndef FLATSQL_SPATIAL_INDEX_H
+#define FLATSQL_SPATIAL_INDEX_H
+
+#include "flatsql/types.h"
+#include "flatsql/geo_polygon.h"
+#include <sqlite3.h>
+#include <string>
+#include <vector>
+#include <unordered_set>
+
+namespace flatsql {
+
+/**
+ * R*Tree-backed spatial index over a pair of latitude/longitude columns.
+ * Points are stored as degenerate boxes in a SQLite rtree virtual table;
+ * searches probe the tree with a bounding box and then apply the exact
+ * predicate, so results never contain false positives.
+ */
+class SpatialIndex {
+public:
+    /**
+     * Create a spatial index backed by the given SQLite database.
+     *
+     * @param db         SQLite database connection (must remain valid for index lifetime)
+     * @param tableName  Base table name (used to create unique rtree table)
+     * @param latColumn  Column holding latitude in degrees
+     * @param lonColumn  Column holding longitude in degrees
+     */
+    SpatialIndex(sqlite3* db, const std::string& tableName,
+                 const std::string& latColumn, const std::string& lonColumn);
+
+    ~SpatialIndex();
+
+    // Disable copy (SQLite statements can't be copied)
+    SpatialIndex(const SpatialIndex&) = delete;
+    SpatialIndex& operator=(const SpatialIndex&) = delete;
+
+    // Insert a point. The sequence number identifies the record; inserting
+    // one again replaces its entry.
+    void insert(double lat, double lon, uint64_t dataOffset, uint32_t dataLength, uint64_t sequence);
+
+    // Points with minLat <= lat <= maxLat and minLon <= lon <= maxLon.
+    // Entry keys are left null.
+    std::vector<IndexEntry> searchBox(double minLat, double maxLat,
+                                      double minLon, double maxLon) const;
+
+    // Points within radiusKm (great-circle) of the center.
+    // Entry keys hold the distance in km.
+    std::vector<IndexEntry> searchRadius(double centerLat, double centerLon, double radiusKm) const;
+
+    // Points inside the polygon: probes its bounding box, then tests each
+    // candidate against the prepared polygon. Entry keys are left null.
+    std::vector<IndexEntry> searchPolygon(const GeoPolygon& polygon) const;
+
+    // The k points nearest to (lat, lon), closest first. Walks the tree
+    // best-first by lower-bound distance and prunes subtrees farther than the
+    // current k-th candidate. Sequences in exclude (e.g. tombstones) are skipped.
+    // Entry keys hold the distance in km.
+    std::vector<IndexEntry> nearest(double lat, double lon, size_t k,
+                                    const std::unordered_set<uint64_t>* exclude = nullptr) const;
+
+    // Statistics
+    uint64_t getEntryCount() const { return entryCount_; }
+
+    // Clear all entries
+    void clear();
+
+    const std::string& getIndexTableName() const { return indexTableName_; }
+    const std::string& getLatColumn() const { return latColumn_; }
+    const std::string& getLonColumn() const { return lonColumn_; }
+
+    // Numeric Value -> double. Returns false for null, strings and blobs.
+    static bool toDouble(const Value& v, double& out);
+
+private:
+    void probe(double minLat, double maxLat, double minLon, double maxLon,
+               std::vector<IndexEntry>& results,
+               std::vector<double>* lats, std::vector<double>* lons) const;
+
+    // rtree scoring callback for nearest(); pContext is the index
+    static int knnScore(sqlite3_rtree_query_info* info);
+
+    sqlite3* db_;
+    std::string indexTableName_;
+    std::string latColumn_;
+    std::string lonColumn_;
+    uint64_t entryCount_ = 0;
+
+    // Per-index rtree query function and the pruning bound it reads
+    std::string knnFunction_;
+    mutable double knnBoundKm_ = 0.0;
+
+    mutable sqlite3_stmt* insertStmt_ = nullptr;
+    mutable sqlite3_stmt* existsStmt_ = nullptr;
+    mutable sqlite3_stmt* searchStmt_ = nullptr;
+    mutable sqlite3_stmt* nearestStmt_ = nullptr;
+    mutable sqlite3_stmt* clearStmt_ = nullptr;
+};
+
+}  // namespace flatsql
+
+#endif  // FLATSQL_SPATIAL_INDEX_H
@@ -24,6 +24,9 @@ struct SourceInfo {
     FastFieldExtractor fastExtractor;
     BatchExtractor batchExtractor = nullptr;      // Optional batch extractor
     std::unordered_map<std::string, SqliteIndex*> indexes;  // Not owned
+    SpatialIndex* spatialIndex = nullptr;         // Not owned
+    std::unordered_map<std::string, LearnedIndex*> learnedIndexes;  // Not owned
+    std::unordered_map<std::string, RadixIndex*> radixIndexes;      // Not owned
     std::unordered_set<uint64_t> tombstones;      // Owned - deleted sequences
     VTabCreateInfo vtabInfo;                      // Info passed to xCreate
     // Source-specific record infos pointer (for multi-source routing)
@@ -32,6 +35,13 @@ struct SourceInfo {
     const flatbuffers::EncryptionContext* encryptionCtx = nullptr;
 };
 
+/**
+ * Receives one result row of a batched execution, tagged with the index of
+ * the parameter set that produced it. The row is reused between calls.
+ * Return false to stop the batch.
+ */
+using BatchRowSink = std::function<bool(size_t batchIndex, const std::vector<Value>& row)>;
+
 /**
  * High-level SQLite wrapper for FlatBuffer queries.
  *
@@ -66,6 +76,10 @@ public:
      * @param fastExtractor Optional fast field extractor
      * @param batchExtractor Optional batch extractor
      * @param sourceRecordInfos Optional source-specific record infos (for multi-source routing)
+     * @param spatialIndex Optional spatial index backing the hidden _geo column
+     * @param learnedIndexes Map of column name -> learned index
+     * @param radixIndexes Map of column name -> radix index
+     * @param vectorsInPlace Decode vector columns in place despite an extractor
      */
     void registerSource(
         const std::string& sourceName,
@@ -76,9 +90,45 @@ public:
         const std::unordered_map<std::string, SqliteIndex*>& indexes = {},
         FastFieldExtractor fastExtractor = nullptr,
         BatchExtractor batchExtractor = nullptr,
-        const std::vector<StreamingFlatBufferStore::FileRecordInfo>* sourceRecordInfos = nullptr
+        const std::vector<StreamingFlatBufferStore::FileRecordInfo>* sourceRecordInfos = nullptr,
+        SpatialIndex* spatialIndex = nullptr,
+        const std::unordered_map<std::string, LearnedIndex*>& learnedIndexes = {},
+        const std::unordered_map<std::string, RadixIndex*>& radixIndexes = {},
+        bool vectorsInPlace = false
     );
 
+    /**
+     * Replace an already registered source's B-tree indexes (a vector
+     * column's index changes kind with its decoding) and whether vectors
+     * are decoded in place. Recreates the virtual table.
+     */
+    void setIndexes(const std::string& sourceName,
+                    const std::unordered_map<std::string, SqliteIndex*>& indexes,
+                    bool vectorsInPlace);
+
+    /**
+     * Attach a spatial index to an already registered source.
+     * Recreates the source's virtual table so new queries can push
+     * geo_within_radius / geo_bbox_contains predicates down to it.
+     */
+    void setSpatialIndex(const std::string& sourceName, SpatialIndex* spatialIndex);
+
+    /**
+     * Attach a learned index over one column to an already registered
+     * source. Recreates the virtual table so equality and range predicates
+     * on the column are served by the index.
+     */
+    void setLearnedIndex(const std::string& sourceName, const std::string& column,
+                         LearnedIndex* learnedIndex);
+
+    /**
+     * Attach a radix index over one column to an already registered source.
+     * Recreates the virtual table so equality, range and prefix predicates
+     * on the column are served by the index.
+     */
+    void setRadixIndex(const std::string& sourceName, const std::string& column,
+                       RadixIndex* radixIndex);
+
     /**
      * Create a unified view that combines multiple sources with the same schema.
      * Generates a UNION ALL view with _source column.
@@ -111,6 +161,21 @@ public:
      */
     QueryResult execute(const std::string& sql, const std::vector<Value>& params);
 
+    /**
+     * Execute one parameterized statement for many parameter sets.
+     * The statement is prepared (or fetched from the cache) once, then
+     * rebound and stepped for each set in order; rows stream to the sink
+     * without building a QueryResult per set.
+     *
+     * @param sql        SQL query string with ? placeholders
+     * @param paramSets  Values to bind for each execution
+     * @param sink       Receives every result row with its set's index
+     * @return Number of rows passed to the sink
+     * @throws std::runtime_error on SQL error
+     */
+    size_t executeBatch(const std::string& sql, const std::vector<std::vector<Value>>& paramSets,
+                        const BatchRowSink& sink);
+
     /**
      * Mark a record as deleted in a source.
      * The record will be skipped in future queries.
@@ -181,6 +246,9 @@ private:
     // Fast path for executeAndCount - returns true if intercepted
     bool tryFastPathCount(const std::string& sql, const std::vector<Value>& params, size_t& count);
 
+    // Drop and recreate a source's virtual table after its create info changed
+    void reconnectVirtualTable(const std::string& sourceName);
+
     // Helper to find source with case-insensitive matching
     SourceInfo* findSourceCaseInsensitive(const std::string& lowerTableName);
 
@@ -2,30 +2,60 @@
 #define FLATSQL_SQLITE_INDEX_H
 
 #include "flatsql/types.h"
+#include "flatsql/key_codec.h"
+#include "flatsql/index_cursor.h"
 #include <sqlite3.h>
+#include <functional>
 #include <string>
 #include <vector>
 #include <memory>
 
 namespace flatsql {
 
+// How index entries are laid out in the index table
+enum class IndexLayout {
+    Rows,     // One SQLite row per entry: (key, data_offset, sequence)
+    Compact   // Blocks of up to COMPACT_BLOCK_ENTRIES entries per row, keys
+              // front-coded and sequences/offsets delta-encoded as varints
+};
+
 /**
  * SQLite-backed index for FlatBuffer records.
  * Uses SQLite's highly optimized B-tree for fast lookups.
  * Keys point to offsets in the stacked FlatBuffer storage.
+ *
+ * Keys are stored as KeyCodec normalized BLOBs, so the B-tree orders them
+ * with a plain memcmp whatever the key type (and uint64 keys above
+ * INT64_MAX sort correctly). Probe values of another type are converted
+ * with SQLite's affinity rules before encoding.
+ *
+ * Record lengths aren't stored: every record in storage starts with its
+ * size prefix, so IndexEntry::dataLength is 0 and callers read the length
+ * with getDataAtOffset(). The Compact layout turns the B-tree into an
+ * index over leaf blocks keyed by their first (key, sequence): a lookup
+ * decodes one or two blocks, and sorted keys that share a prefix (entity
+ * ids, emails, repeated non-unique keys) are stored once per block.
  */
 class SqliteIndex {
 public:
+    // A Compact block splits in two past either limit. The byte limit keeps
+    // rows under SQLite's ~1000-byte local payload for index b-trees, past
+    // which a row spills to overflow pages.
+    static constexpr uint32_t COMPACT_BLOCK_ENTRIES = 32;
+    static constexpr size_t COMPACT_BLOCK_BYTES = 768;
+
     /**
      * Create an index backed by the given SQLite database.
      *
      * @param db        SQLite database connection (must remain valid for index lifetime)
      * @param tableName Base table name (used to create unique index table)
      * @param columnName Column being indexed
-     * @param keyType   Type of the key (determines SQLite column affinity)
+     * @param keyType   Type of the key (determines the key encoding)
+     * @param layout    Row-per-entry or compact block layout
      */
     SqliteIndex(sqlite3* db, const std::string& tableName,
-                const std::string& columnName, ValueType keyType);
+                const std::string& columnName, ValueType keyType,
+                IndexLayout layout = IndexLayout::Rows);
 
     ~SqliteIndex();
 
@@ -37,7 +67,7 @@ public:
     SqliteIndex(SqliteIndex&& other) noexcept;
     SqliteIndex& operator=(SqliteIndex&& other) noexcept;
 
-    // Insert an entry
+    // Insert an entry. dataLength is not stored (see class comment).
     void insert(const Value& key, uint64_t dataOffset, uint32_t dataLength, uint64_t sequence);
 
     // Search for entries with exact key match
@@ -48,20 +78,44 @@ public:
     bool searchFirst(const Value& key, IndexEntry& result) const;
 
     // Fast path for string key lookups (avoids Value/variant overhead)
-    // Returns true if found, sets outOffset and outLength
-    bool searchFirstString(const std::string& key, uint64_t& outOffset, uint32_t& outLength, uint64_t& outSequence) const;
+    // Returns true if found, sets outOffset and outSequence
+    bool searchFirstString(const std::string& key, uint64_t& outOffset, uint64_t& outSequence) const;
 
     // Fast path for int64 key lookups (avoids Value/variant overhead)
-    bool searchFirstInt64(int64_t key, uint64_t& outOffset, uint32_t& outLength, uint64_t& outSequence) const;
+    bool searchFirstInt64(int64_t key, uint64_t& outOffset, uint64_t& outSequence) const;
+
+    // Lookup by a key already encoded with KeyCodec::append(getKeyType(), ...).
+    // Batched callers encode once and probe in encoded (index) order.
+    bool searchFirstEncoded(const std::string& key, uint64_t& outOffset, uint64_t& outSequence) const;
 
     // Range query: minKey <= key <= maxKey
     std::vector<IndexEntry> range(const Value& minKey, const Value& maxKey) const;
 
+    // Prefix range query on string keys: lowKey <= key < successor(highPrefix)
+    // Pass the same prefix twice for an exact-case prefix scan (GLOB 'abc*').
+    // Passing the upper- and lower-cased prefix brackets every ASCII case
+    // variant (LIKE 'abc%'); callers re-check matches against the pattern.
+    std::vector<IndexEntry> prefixRange(const std::string& lowKey, const std::string& highPrefix) const;
+
     // Get all entries (full scan)
     std::vector<IndexEntry> all() const;
 
+    // Lazy forms of search, range, prefixRange and all: open cursor on the
+    // same entries, fetched a batch at a time as it is advanced
+    void openSearch(const Value& key, IndexCursor& cursor) const;
+    void openRange(const Value& minKey, const Value& maxKey, IndexCursor& cursor) const;
+    void openPrefixRange(const std::string& lowKey, const std::string& highPrefix, IndexCursor& cursor) const;
+    void openAll(IndexCursor& cursor) const;
+
     // Statistics
     uint64_t getEntryCount() const { return entryCount_; }
+    IndexLayout getLayout() const { return layout_; }
+    ValueType getKeyType() const { return keyType_; }
+
+    // Bytes of index record payload (keys, offsets, sequences and record
+    // headers), not counting SQLite page overhead. Kept as rows and blocks
+    // are written.
+    uint64_t getStorageBytes() const { return storageBytes_; }
 
     // Clear all entries
     void clear();
@@ -70,24 +124,63 @@ public:
     const std::string& getIndexTableName() const { return indexTableName_; }
 
 private:
-    void bindKey(sqlite3_stmt* stmt, int index, const Value& key) const;
+    // Encode key into buffer and bind it. Returns false if no key of
+    // keyType_ satisfies the bound (the query can't match anything).
+    bool bindKey(sqlite3_stmt* stmt, int index, const Value& key, std::string& buffer,
+                 KeyCodec::Bound bound = KeyCodec::Bound::Exact) const;
     Value extractKey(sqlite3_stmt* stmt, int column) const;
     IndexEntry extractEntry(sqlite3_stmt* stmt) const;
-    std::string getSqliteType() const;
+    bool stepFirst(const std::string& key, uint64_t& outOffset, uint64_t& outSequence) const;
+    void prepare(const std::string& sql, sqlite3_stmt** stmt, const char* what);
+    void finalizeAll();
+
+    // Cursor refill: the next batch after the cursor's position
+    void fillCursor(IndexCursor& cursor) const;
+
+    // Compact layout. Entries are visited in (key, sequence) order; the
+    // callback gets the encoded key and returns false to stop.
+    using BlockVisitor = std::function<bool(const std::string& key, uint64_t offset, uint64_t sequence)>;
+    void compactInsert(const std::string& key, uint64_t offset, uint64_t sequence);
+    void compactScan(const std::string& low, const std::string& high, bool highInclusive,
+                     const BlockVisitor& visit) const;
+    void compactScanAll(const BlockVisitor& visit) const;
+    void compactFillCursor(IndexCursor& cursor) const;
+    void compactPut(const std::string& block);
+    // oldSize/size: the block's stored size, for the byte count
+    void compactUpdate(const std::string& firstKey, int64_t firstSeq, size_t oldSize, const std::string& block);
+    void compactDelete(const std::string& firstKey, int64_t firstSeq, size_t size);
+    IndexEntry makeEntry(const std::string& key, uint64_t offset, uint64_t sequence) const;
 
     sqlite3* db_;
     std::string indexTableName_;
     ValueType keyType_;
+    IndexLayout layout_;
     uint64_t entryCount_ = 0;
+    uint64_t storageBytes_ = 0;
 
     // Prepared statements for performance
     mutable sqlite3_stmt* insertStmt_ = nullptr;
     mutable sqlite3_stmt* searchStmt_ = nullptr;
     mutable sqlite3_stmt* searchFirstStmt_ = nullptr;
     mutable sqlite3_stmt* rangeStmt_ = nullptr;
+    mutable sqlite3_stmt* prefixStmt_ = nullptr;
     mutable sqlite3_stmt* allStmt_ = nullptr;
+    mutable sqlite3_stmt* afterStmt_ = nullptr;         // Entries after (key, sequence), for cursors
     mutable sqlite3_stmt* countStmt_ = nullptr;
     mutable sqlite3_stmt* clearStmt_ = nullptr;
+
+    // Compact layout statements (rows are (first_key, first_seq, block))
+    mutable sqlite3_stmt* blockFloorStmt_ = nullptr;    // Last block starting <= (key, seq)
+    mutable sqlite3_stmt* blockHeadStmt_ = nullptr;     // First block
+    mutable sqlite3_stmt* blockBeforeStmt_ = nullptr;   // Last block with first_key < key
+    mutable sqlite3_stmt* blockRangeStmt_ = nullptr;    // Blocks with low <= first_key <= high
+    mutable sqlite3_stmt* blockAfterStmt_ = nullptr;    // Blocks starting after (key, seq)
+    mutable sqlite3_stmt* blockUpdateStmt_ = nullptr;
+    mutable sqlite3_stmt* blockDeleteStmt_ = nullptr;
+
+    // Encoded key scratch space, bound SQLITE_STATIC until the next reset
+    mutable std::string keyBuffer_;
+    mutable std::string keyBuffer2_;
 };
 
 }  // namespace flatsql
@@ -4,7 +4,11 @@
 #include "flatsql/types.h"
 #include "flatsql/storage.h"
 #include "flatsql/sqlite_index.h"
+#include "flatsql/spatial_index.h"
+#include "flatsql/learned_index.h"
+#include "flatsql/radix_index.h"
 #include <sqlite3.h>
+#include <array>
 #include <functional>
 #include <unordered_set>
 
@@ -31,9 +35,9 @@ using BatchExtractor = void(*)(const uint8_t* data, size_t length, std::vector<V
 // Scan type for cursor
 enum class ScanType {
     FullScan,           // Iterate all records
-    IndexEquality,      // Use index for = lookup (may return multiple)
     IndexSingleLookup,  // Fast path for unique index = lookup (single result)
-    IndexRange,         // Use index for range query
+    IndexRange,         // Materialized index results (spatial queries)
+    IndexStream,        // Walk an index cursor in key order, a batch at a time
     RowidLookup         // Lookup by rowid (sequence)
 };
 
@@ -55,11 +59,25 @@ struct FlatBufferVTab : public sqlite3_vtab {
     FieldExtractor extractor;               // Extracts values from FlatBuffers
     FastFieldExtractor fastExtractor;       // Optional fast path that writes directly to SQLite
     std::unordered_map<std::string, SqliteIndex*> indexes;  // Column name -> SQLite index (not owned)
+    std::unordered_map<std::string, LearnedIndex*> learnedIndexes;  // Column name -> learned index (not owned)
+    std::unordered_map<std::string, RadixIndex*> radixIndexes;      // Column name -> radix index (not owned)
     std::unordered_set<uint64_t>* tombstones; // Deleted sequences (not owned, may be nullptr)
 
     // Column index for virtual _source column (-1 if not enabled)
     int sourceColumnIndex;
 
+    // Spatial index over a lat/lon column pair (not owned, may be nullptr).
+    // Exposed through the hidden _geo column, which holds a geo_point blob.
+    SpatialIndex* spatialIndex;
+    int geoColumnIndex;
+    int geoLatColumn;   // Real column index of latitude (-1 if no spatial index)
+    int geoLonColumn;   // Real column index of longitude (-1 if no spatial index)
+
+    // Per real column: 1 if it's an unencrypted vector, read from the buffer
+    // as a JSON array (see VTabCreateInfo::vectorsInPlace). Empty if the
+    // table has no such columns.
+    std::vector<uint8_t> vectorColumns;
+
     // Source-specific record infos (for multi-source routing)
     // When set, uses these instead of store->getRecordInfoVector(fileId)
     const std::vector<StreamingFlatBufferStore::FileRecordInfo>* sourceRecordInfos;
@@ -95,10 +113,13 @@ struct FlatBufferCursor : public sqlite3_vtab_cursor {
     // Scan configuration
     ScanType scanType;
 
-    // For index-based scans (multi-result)
+    // For index-based scans (multi-result, materialized: spatial queries)
     std::vector<IndexEntry> indexResults;
     size_t indexPosition;
 
+    // For index-based scans in key order, fetched lazily
+    IndexCursor indexCursor;
+
     // For single lookup - no allocation
     IndexEntry singleResult;
     bool singleResultReturned;
@@ -114,6 +135,16 @@ struct FlatBufferCursor : public sqlite3_vtab_cursor {
     const std::vector<StreamingFlatBufferStore::FileRecordInfo>* scanRecordInfos;
     const uint8_t* scanDataBuffer;  // Cached data buffer pointer for inline access
 
+    // Full scan rows are resolved SCAN_BATCH at a time (tombstones skipped,
+    // size prefixes read) into this buffer; scanFileIndex is the next record
+    // info to resolve
+    static constexpr size_t SCAN_BATCH = 16;
+    std::array<RecordRef, SCAN_BATCH> scanBatch;
+    size_t scanBatchPos;
+    size_t scanBatchCount;
+    uint64_t scanLowSequence;       // Rowid bounds checked per record when the
+    uint64_t scanHighSequence;      // record list isn't in sequence order
+
     // For lazy full scan iteration (legacy)
     bool useLazyScan;
 
@@ -134,6 +165,9 @@ struct FlatBufferCursor : public sqlite3_vtab_cursor {
 
     // Cached tombstone flag - true if there are tombstones to check
     bool hasTombstones;
+
+    // Cached vtab->vectorColumns data (nullptr if the table has none)
+    const uint8_t* vectorColumns;
 };
 
 /**
@@ -161,6 +195,9 @@ public:
     static int xEof(sqlite3_vtab_cursor* pCursor);
     static int xColumn(sqlite3_vtab_cursor* pCursor, sqlite3_context* ctx, int N);
     static int xRowid(sqlite3_vtab_cursor* pCursor, sqlite3_int64* pRowid);
+    static int xFindFunction(sqlite3_vtab* pVTab, int nArg, const char* zName,
+                             void (**pxFunc)(sqlite3_context*, int, sqlite3_value**),
+                             void** ppArg);
 
 private:
     static sqlite3_module module_;
@@ -174,6 +211,9 @@ private:
 
     // Helper to get Value from sqlite3_value
     static Value valueFromSqlite(sqlite3_value* val);
+
+    // Extract (and decrypt) every real column of the current row into the cache
+    static void fillColumnCache(FlatBufferCursor* cursor);
 };
 
 /**
@@ -188,12 +228,20 @@ struct VTabCreateInfo {
     FieldExtractor extractor;
     FastFieldExtractor fastExtractor;
     std::unordered_map<std::string, SqliteIndex*> indexes;
+    // Learned indexes over monotonic numeric columns (not owned)
+    std::unordered_map<std::string, LearnedIndex*> learnedIndexes;
+    // Radix (ART) indexes over string and blob columns (not owned)
+    std::unordered_map<std::string, RadixIndex*> radixIndexes;
     std::unordered_set<uint64_t>* tombstones;
+    // Spatial index backing the _geo column (not owned, may be nullptr)
+    SpatialIndex* spatialIndex = nullptr;
     // Source-specific record infos (for multi-source routing)
     // When set, uses these instead of store->getRecordInfoVector(fileId)
     const std::vector<StreamingFlatBufferStore::FileRecordInfo>* sourceRecordInfos = nullptr;
     // Encryption context for field-level decryption (not owned)
     const flatbuffers::EncryptionContext* encryptionCtx = nullptr;
+    // Decode vector columns in place even with an extractor
+    bool vectorsInPlace = false;
 };
 
 }  // namespace flatsql
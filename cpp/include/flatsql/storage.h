@@ -2,6 +2,7 @@
 #define FLATSQL_STORAGE_H
 
 #include "flatsql/types.h"
+#include <cstddef>
 #include <functional>
 #include <unordered_map>
 #include <optional>
@@ -23,6 +24,15 @@ namespace flatsql {
  *
  * This is a pure streaming format - no custom headers, no conversion.
  * Indexes are built during streaming ingest.
+ *
+ * With setRecordAlignment(), padding frames (see PADDING_FRAME_FLAG) are
+ * placed so that every FlatBuffer starts on an aligned offset. Every reader
+ * here skips them, so aligned and packed streams load into either kind of
+ * store.
+ *
+ * Records are appended in sequence order unless a file ID is clustered
+ * (setClustered) or the store has been relocated; storage order then
+ * differs, and exports are put back in sequence order.
  */
 class StreamingFlatBufferStore {
 public:
@@ -36,8 +46,48 @@ public:
         uint64_t offset
     )>;
 
+    // Largest record alignment: what the storage buffer's allocation guarantees
+    static constexpr size_t MAX_RECORD_ALIGNMENT = alignof(std::max_align_t);
+
     explicit StreamingFlatBufferStore(size_t initialCapacity = 1024 * 1024);
 
+    // Start every stored FlatBuffer on a multiple of `alignment` bytes, a
+    // power of two up to MAX_RECORD_ALIGNMENT (1 packs records back to back,
+    // the default). Throws std::runtime_error if records are already stored
+    // or the alignment is unsupported.
+    void setRecordAlignment(size_t alignment);
+    size_t getRecordAlignment() const { return alignment_; }
+
+    static constexpr size_t DEFAULT_SEGMENT_BYTES = 64 * 1024;
+
+    // Store later records with this file ID in segments of their own, so
+    // reading them doesn't stride over other file IDs' records. Sequences
+    // stay global. A segment's unused tail is a padding frame; a record
+    // larger than segmentBytes gets a segment of its own size.
+    void setClustered(const std::string& fileId, size_t segmentBytes = DEFAULT_SEGMENT_BYTES);
+    bool isClustered(std::string_view fileId) const { return clusters_.count(std::string(fileId)) > 0; }
+
+    // Whether records are stored in sequence order, so the records after a
+    // sequence are one byte range to the end of storage
+    bool isSequential() const { return sequential_; }
+
+    // Whether every getRecordInfoVector() list ascends by sequence (lists
+    // always ascend by offset). False once relocate() orders them otherwise.
+    bool isRecordListSequenceOrdered() const { return listsSequenceOrdered_; }
+
+    // Call visit with the size-prefixed records in (after, upTo], in
+    // sequence order, as runs of contiguous storage bytes (one run, padding
+    // included, while the store is sequential)
+    void visitRecords(uint64_t after, uint64_t upTo,
+                      const std::function<void(const uint8_t*, size_t)>& visit) const;
+
+    // Rewrite storage to hold only these records, back to back in this
+    // order, keeping their sequences. Every offset changes, so indexes
+    // built on them must be rebuilt. Later records of clustered file IDs
+    // start new segments. Throws std::runtime_error, leaving the store
+    // unchanged, for a sequence that is missing or listed twice.
+    void relocate(const std::vector<uint64_t>& sequences);
+
     // Stream raw size-prefixed FlatBuffers
     // Calls callback for each complete FlatBuffer ingested
     // Returns number of bytes consumed (for buffer management)
@@ -71,7 +121,7 @@ public:
     // Get offset for sequence
     std::optional<uint64_t> getOffsetForSequence(uint64_t sequence) const;
 
-    // Iterate all records
+    // Iterate all records, in storage order
     void iterateRecords(std::function<bool(const StoredRecord&)> callback) const;
 
     // Iterate records with specific file identifier
@@ -105,14 +155,16 @@ public:
                         uint64_t* outOffset, uint64_t* outSequence,
                         const uint8_t** outData, uint32_t* outLength) const;
 
-    // Export raw stream data
-    const std::vector<uint8_t>& getData() const { return data_; }
-    std::vector<uint8_t> exportData() const {
-        return std::vector<uint8_t>(data_.begin(), data_.begin() + writeOffset_);
-    }
+    // Raw storage, padding frames included
+    const PageVector<uint8_t>& getData() const { return data_; }
+
+    // Export the records as a stream in sequence order (raw storage while
+    // the store is sequential)
+    std::vector<uint8_t> exportData() const;
 
     // Statistics
     uint64_t getRecordCount() const { return recordCount_; }
+    uint64_t getLastSequence() const { return nextSequence_ - 1; }  // 0 when empty
     uint64_t getDataSize() const { return writeOffset_; }
 
     // Extract file identifier from a FlatBuffer (bytes 4-7)
@@ -136,12 +188,32 @@ public:
 
 private:
     void ensureCapacity(size_t needed);
+
+    // Bytes of padding a record placed at offset needs before it
+    size_t paddingBefore(uint64_t offset) const;
+    void writePadding(uint64_t offset, size_t bytes);
+
+    // Reserve room for a record of fileId (frameBytes, size prefix
+    // included), at the end of storage or in its file ID's segment.
+    // Returns the offset to write it at.
+    uint64_t placeRecord(const std::string& fileId, size_t frameBytes);
     void indexRecord(const std::string& fileId, uint64_t offset);
 
-    std::vector<uint8_t> data_;
+    PageVector<uint8_t> data_;  // Huge-page backed once it reaches HUGE_PAGE_SIZE
     uint64_t writeOffset_ = 0;
     uint64_t recordCount_ = 0;
     uint64_t nextSequence_ = 1;
+    size_t alignment_ = 1;
+    bool sequential_ = true;
+    bool listsSequenceOrdered_ = true;
+
+    // Current segment of each clustered file ID
+    struct Segment {
+        size_t bytes;       // Size of new segments
+        uint64_t next = 0;  // Where the next record goes
+        uint64_t end = 0;   // End of the current segment (0: none yet)
+    };
+    std::unordered_map<std::string, Segment> clusters_;
 
     // sequence → offset for O(1) lookups
     std::unordered_map<uint64_t, uint64_t> sequenceToOffset_;
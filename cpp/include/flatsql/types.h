@@ -2,6 +2,7 @@
 #define FLATSQL_TYPES_H
 
 #include <cstdint>
+#include <cstring>
 #include <string>
 #include <vector>
 #include <variant>
@@ -18,6 +19,43 @@ constexpr size_t SIZE_PREFIX_LENGTH = 4;
 constexpr size_t FILE_IDENTIFIER_OFFSET = 4;  // Offset within FlatBuffer
 constexpr size_t FILE_IDENTIFIER_LENGTH = 4;
 
+// A size prefix with this bit set starts a padding frame: the prefix and
+// then (prefix & ~PADDING_FRAME_FLAG) zero bytes. Aligned stores put one
+// before any record whose payload would start off its boundary (see
+// StreamingFlatBufferStore::setRecordAlignment); readers skip them.
+// FlatBuffers are under 2 GiB, so the bit is never set for a record.
+constexpr uint32_t PADDING_FRAME_FLAG = 0x80000000u;
+
+// Bytes a frame occupies, size prefix included
+inline size_t frameLength(uint32_t sizePrefix) {
+    return SIZE_PREFIX_LENGTH + (sizePrefix & ~PADDING_FRAME_FLAG);
+}
+
+// Control frames in change feeds and replication streams (tombstones,
+// checksums, watermarks) are flagged like padding, with a body of 4 zero
+// bytes, a 4-byte kind and the payload:
+// [PADDING_FRAME_FLAG | 8 + payload][4 zero bytes][kind][payload].
+// No record carries the flag and padding bodies are all zero, so neither
+// can be taken for a control frame; readers that don't know a kind skip
+// it as padding.
+constexpr size_t CONTROL_FRAME_HEADER_LENGTH = 8;
+
+inline uint32_t controlFramePrefix(size_t payloadLength) {
+    return PADDING_FRAME_FLAG | static_cast<uint32_t>(CONTROL_FRAME_HEADER_LENGTH + payloadLength);
+}
+
+// Whether the frame at `frame` (its size prefix) is a control frame of
+// this kind with a payload of `payloadLength` bytes (any length if -1)
+inline bool isControlFrame(const uint8_t* frame, const char* kind, int64_t payloadLength = -1) {
+    uint32_t prefix = static_cast<uint32_t>(frame[0]) | (static_cast<uint32_t>(frame[1]) << 8) |
+                      (static_cast<uint32_t>(frame[2]) << 16) | (static_cast<uint32_t>(frame[3]) << 24);
+    if (!(prefix & PADDING_FRAME_FLAG)) return false;
+    uint32_t body = prefix & ~PADDING_FRAME_FLAG;
+    if (body < CONTROL_FRAME_HEADER_LENGTH) return false;
+    if (payloadLength >= 0 && body != CONTROL_FRAME_HEADER_LENGTH + static_cast<uint64_t>(payloadLength)) return false;
+    return std::memcmp(frame + SIZE_PREFIX_LENGTH + 4, kind, 4) == 0;
+}
+
 // Value types supported in FlatSQL
 enum class ValueType {
     Null,
@@ -71,6 +109,9 @@ struct ColumnDef {
     bool primaryKey = false;
     bool encrypted = false;         // Field uses FlatBuffer field-level encryption
     uint16_t fieldId = 0;           // FlatBuffer field ID (for encryption key derivation)
+    bool slotKnown = true;          // fieldId is also the field's vtable slot (see SchemaParser::parseIDL)
+    bool isVector = false;          // Vector of scalars or strings ([T]); surfaced as a JSON array
+    ValueType elementType = ValueType::Null;  // Element type when isVector
     std::optional<Value> defaultValue;
 };
 
@@ -128,14 +169,61 @@ struct QueryResult {
 struct IndexEntry {
     Value key;
     uint64_t dataOffset;
-    uint32_t dataLength;
+    uint32_t dataLength;    // 0 from SqliteIndex; the size prefix at dataOffset has it
     uint64_t sequence;
 };
 
+// Comparison in an index range query (LearnedIndex, RadixIndex)
+enum class KeyOp { Eq, Gt, Ge, Lt, Le };
+
 // CRC32 checksum
 uint32_t crc32(const uint8_t* data, size_t length);
 uint32_t crc32(const std::vector<uint8_t>& data);
 
+// CRC32C (Castagnoli) checksum. Pass a previous result as crc to extend it.
+uint32_t crc32c(const uint8_t* data, size_t length, uint32_t crc = 0);
+
+// Huge pages for large buffers (the record store, LearnedIndex arrays).
+// Buffers of HUGE_PAGE_SIZE or more are mapped with mmap whatever the mode;
+// smaller ones come from the heap. Linux only, heap everywhere else.
+enum class HugePages {
+    Off,          // Normal pages
+    Transparent,  // 2 MiB-aligned mappings with MADV_HUGEPAGE (default)
+    Explicit      // hugetlbfs pages (MAP_HUGETLB) when reserved, else Transparent
+};
+constexpr size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+// Process-wide; applies to buffers allocated afterwards
+void setHugePages(HugePages mode);
+HugePages getHugePages();
+
+void* allocatePages(size_t bytes);
+void freePages(void* pointer, size_t bytes);
+
+// How a range of memory is about to be read (madvise hints; pages of the
+// range that aren't mapped are ignored). The advice applies to every page
+// the range touches, so only pass memory whose pages you own.
+enum class PageAccess { Normal, Sequential, WillNeed };
+void advisePages(const void* data, size_t length, PageAccess access);
+
+// Allocator for vectors that may grow to many huge pages
+template <typename T>
+struct PageAllocator {
+    using value_type = T;
+    PageAllocator() = default;
+    template <typename U>
+    PageAllocator(const PageAllocator<U>&) {}
+    T* allocate(size_t n) { return static_cast<T*>(allocatePages(n * sizeof(T))); }
+    void deallocate(T* p, size_t n) { freePages(p, n * sizeof(T)); }
+    template <typename U>
+    bool operator==(const PageAllocator<U>&) const { return true; }
+    template <typename U>
+    bool operator!=(const PageAllocator<U>&) const { return false; }
+};
+
+template <typename T>
+using PageVector = std::vector<T, PageAllocator<T>>;
+
 }  // namespace flatsql
 
 #endif  // FLATSQL_TYPES_H
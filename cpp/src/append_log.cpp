@@ -0,0 +1,224 @@
+#include "flatsql/append_log.h"
+#include "flatsql/types.h"
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <fcntl.h>
+#include <stdexcept>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace flatsql {
+
+static inline void writeLE32(uint8_t* dest, uint32_t value) {
+    dest[0] = static_cast<uint8_t>(value);
+    dest[1] = static_cast<uint8_t>(value >> 8);
+    dest[2] = static_cast<uint8_t>(value >> 16);
+    dest[3] = static_cast<uint8_t>(value >> 24);
+}
+
+static inline uint32_t readLE32(const uint8_t* src) {
+    return static_cast<uint32_t>(src[0]) |
+           (static_cast<uint32_t>(src[1]) << 8) |
+           (static_cast<uint32_t>(src[2]) << 16) |
+           (static_cast<uint32_t>(src[3]) << 24);
+}
+
+static std::string errnoMessage(const std::string& what, const std::string& path) {
+    return what + " " + path + ": " + std::strerror(errno);
+}
+
+AppendLog::AppendLog(const std::string& path, const AppendLogOptions& options)
+    : path_(path), options_(options) {
+    fd_ = ::open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+    if (fd_ < 0) {
+        throw std::runtime_error(errnoMessage("Cannot open append log", path));
+    }
+    if (options_.durability == Durability::GroupCommit) {
+        flusher_ = std::thread(&AppendLog::flusherLoop, this);
+    }
+}
+
+AppendLog::~AppendLog() {
+    if (flusher_.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stopping_ = true;
+        }
+        wake_.notify_one();
+        flusher_.join();
+    }
+    try {
+        flush(true);
+    } catch (const std::runtime_error&) {
+        // Nowhere to report it
+    }
+    ::close(fd_);
+}
+
+void AppendLog::append(const uint8_t* payload, size_t length) {
+    bool wake;
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!error_.empty()) {
+            throw std::runtime_error(error_);
+        }
+        size_t start = pending_.size();
+        pending_.resize(start + FRAME_HEADER_LENGTH + length);
+        writeLE32(&pending_[start], static_cast<uint32_t>(length));
+        std::memcpy(&pending_[start + FRAME_HEADER_LENGTH], payload, length);
+        wake = pending_.size() >= options_.groupCommitBytes;
+    }
+    if (wake && flusher_.joinable()) {
+        wake_.notify_one();
+    }
+}
+
+void AppendLog::commitBatch() {
+    switch (options_.durability) {
+        case Durability::None:
+            flush(false);
+            break;
+        case Durability::SyncPerBatch:
+            flush(true);
+            break;
+        case Durability::GroupCommit:
+            break;
+    }
+}
+
+void AppendLog::sync() {
+    flush(true);
+}
+
+uint64_t AppendLog::getWrittenBytes() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return writtenBytes_;
+}
+
+uint64_t AppendLog::getSyncCount() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return syncCount_;
+}
+
+void AppendLog::flush(bool durable) {
+    std::lock_guard<std::mutex> writeLock(writeMutex_);
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (!error_.empty()) {
+            throw std::runtime_error(error_);
+        }
+        writing_.swap(pending_);
+    }
+
+    std::string error;
+    if (!writing_.empty()) {
+        // Fill in the checksums, off the appending thread in GroupCommit mode
+        for (size_t pos = 0; pos < writing_.size();) {
+            uint32_t length = readLE32(&writing_[pos]);
+            writeLE32(&writing_[pos + 4], crc32c(&writing_[pos + FRAME_HEADER_LENGTH], length));
+            pos += FRAME_HEADER_LENGTH + length;
+        }
+
+        const uint8_t* data = writing_.data();
+        size_t remaining = writing_.size();
+        while (remaining > 0) {
+            ssize_t n = ::write(fd_, data, remaining);
+            if (n < 0) {
+                if (errno == EINTR) continue;
+                error = errnoMessage("Append log write failed for", path_);
+                break;
+            }
+            data += n;
+            remaining -= static_cast<size_t>(n);
+        }
+    }
+    size_t written = writing_.size();
+    writing_.clear();
+
+    bool synced = false;
+    if (durable && error.empty() && written > 0) {
+        if (::fdatasync(fd_) != 0) {
+            error = errnoMessage("Append log sync failed for", path_);
+        } else {
+            synced = true;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(mutex_);
+    writtenBytes_ += written;
+    if (synced) syncCount_++;
+    if (!error.empty()) {
+        // The file's tail is now unknown; refuse further appends
+        if (error_.empty()) error_ = error;
+        throw std::runtime_error(error);
+    }
+}
+
+void AppendLog::flusherLoop() {
+    auto interval = std::chrono::milliseconds(options_.groupCommitMs);
+    std::unique_lock<std::mutex> lock(mutex_);
+    while (!stopping_) {
+        wake_.wait_for(lock, interval, [this] {
+            return stopping_ || pending_.size() >= options_.groupCommitBytes;
+        });
+        if (stopping_ || pending_.empty() || !error_.empty()) continue;
+
+        lock.unlock();
+        try {
+            flush(true);
+        } catch (const std::runtime_error&) {
+            // Recorded in error_ and reported by the next append or sync
+        }
+        lock.lock();
+    }
+}
+
+std::vector<uint8_t> AppendLog::recover(const std::string& path, uint64_t* droppedBytes) {
+    std::vector<uint8_t> payloads;
+    if (droppedBytes) *droppedBytes = 0;
+
+    int fd = ::open(path.c_str(), O_RDWR | O_CLOEXEC);
+    if (fd < 0) {
+        if (errno == ENOENT) return payloads;
+        throw std::runtime_error(errnoMessage("Cannot open append log", path));
+    }
+
+    struct stat st;
+    std::vector<uint8_t> file;
+    if (::fstat(fd, &st) == 0) {
+        file.resize(static_cast<size_t>(st.st_size));
+    }
+    size_t size = 0;
+    while (size < file.size()) {
+        ssize_t n = ::read(fd, file.data() + size, file.size() - size);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) break;
+        size += static_cast<size_t>(n);
+    }
+    file.resize(size);
+
+    // Keep frames up to the first one that is incomplete or corrupt
+    size_t valid = 0;
+    while (valid + FRAME_HEADER_LENGTH <= file.size()) {
+        uint32_t length = readLE32(&file[valid]);
+        if (length > file.size() - valid - FRAME_HEADER_LENGTH) break;
+        const uint8_t* payload = &file[valid + FRAME_HEADER_LENGTH];
+        if (crc32c(payload, length) != readLE32(&file[valid + 4])) break;
+        payloads.insert(payloads.end(), payload, payload + length);
+        valid += FRAME_HEADER_LENGTH + length;
+    }
+
+    if (valid < file.size()) {
+        if (::ftruncate(fd, static_cast<off_t>(valid)) != 0 || ::fdatasync(fd) != 0) {
+            std::string message = errnoMessage("Cannot truncate append log", path);
+            ::close(fd);
+            throw std::runtime_error(message);
+        }
+        if (droppedBytes) *droppedBytes = file.size() - valid;
+    }
+    ::close(fd);
+    return payloads;
+}
+
+}  // namespace flatsql
@@ -0,0 +1,291 @@
+#include "flatsql/array_functions.h"
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+namespace flatsql {
+
+namespace {
+
+// Forward-only scanner over the top level of a JSON array. Nested arrays
+// and objects are skipped; they never match a scalar.
+class JsonArrayScanner {
+public:
+    explicit JsonArrayScanner(const char* p) : p_(p) {}
+
+    enum class Kind { String, Integer, Real, Other };
+
+    // Consume the opening bracket
+    bool begin() {
+        skipSpace();
+        if (*p_ != '[') return false;
+        p_++;
+        skipSpace();
+        if (*p_ == ']') {
+            p_++;
+            done_ = true;
+        }
+        return true;
+    }
+
+    // Read the next element. Returns false at the end of the array; check
+    // malformed() to tell the end from a parse error.
+    bool next(Kind& kind) {
+        if (done_ || malformed_) return false;
+        if (!first_) {
+            skipSpace();
+            if (*p_ == ']') {
+                p_++;
+                done_ = true;
+                return false;
+            }
+            if (*p_ != ',') return fail();
+            p_++;
+        }
+        first_ = false;
+        skipSpace();
+
+        char c = *p_;
+        if (c == '"') {
+            kind = Kind::String;
+            return readString();
+        }
+        if (c == '-' || (c >= '0' && c <= '9')) {
+            return readNumber(kind);
+        }
+        if (std::strncmp(p_, "true", 4) == 0 || std::strncmp(p_, "false", 5) == 0) {
+            kind = Kind::Integer;
+            integer_ = c == 't' ? 1 : 0;
+            p_ += c == 't' ? 4 : 5;
+            return true;
+        }
+        if (std::strncmp(p_, "null", 4) == 0) {
+            kind = Kind::Other;
+            p_ += 4;
+            return true;
+        }
+        if (c == '[' || c == '{') {
+            kind = Kind::Other;
+            return skipNested();
+        }
+        return fail();
+    }
+
+    bool malformed() const { return malformed_; }
+    // Trailing characters after the closing bracket
+    bool trailing() {
+        skipSpace();
+        return *p_ != '\0';
+    }
+
+    const std::string& string() const { return string_; }
+    sqlite3_int64 integer() const { return integer_; }
+    double real() const { return real_; }
+
+private:
+    bool fail() {
+        malformed_ = true;
+        return false;
+    }
+
+    void skipSpace() {
+        while (*p_ == ' ' || *p_ == '\t' || *p_ == '\n' || *p_ == '\r') p_++;
+    }
+
+    static int hexDigit(char c) {
+        if (c >= '0' && c <= '9') return c - '0';
+        if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+        if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+        return -1;
+    }
+
+    bool readHex4(uint32_t& out) {
+        out = 0;
+        for (int i = 0; i < 4; i++) {
+            int d = hexDigit(p_[i]);
+            if (d < 0) return false;
+            out = (out << 4) | static_cast<uint32_t>(d);
+        }
+        p_ += 4;
+        return true;
+    }
+
+    void appendUtf8(uint32_t cp) {
+        if (cp < 0x80) {
+            string_ += static_cast<char>(cp);
+        } else if (cp < 0x800) {
+            string_ += static_cast<char>(0xC0 | (cp >> 6));
+            string_ += static_cast<char>(0x80 | (cp & 0x3F));
+        } else if (cp < 0x10000) {
+            string_ += static_cast<char>(0xE0 | (cp >> 12));
+            string_ += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+            string_ += static_cast<char>(0x80 | (cp & 0x3F));
+        } else {
+            string_ += static_cast<char>(0xF0 | (cp >> 18));
+            string_ += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+            string_ += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+            string_ += static_cast<char>(0x80 | (cp & 0x3F));
+        }
+    }
+
+    bool readString() {
+        string_.clear();
+        p_++;  // Opening quote
+        while (true) {
+            char c = *p_;
+            if (c == '\0') return fail();
+            p_++;
+            if (c == '"') return true;
+            if (c != '\\') {
+                string_ += c;
+                continue;
+            }
+            char e = *p_++;
+            switch (e) {
+                case '"':  string_ += '"'; break;
+                case '\\': string_ += '\\'; break;
+                case '/':  string_ += '/'; break;
+                case 'b':  string_ += '\b'; break;
+                case 'f':  string_ += '\f'; break;
+                case 'n':  string_ += '\n'; break;
+                case 'r':  string_ += '\r'; break;
+                case 't':  string_ += '\t'; break;
+                case 'u': {
+                    uint32_t cp;
+                    if (!readHex4(cp)) return fail();
+                    // Combine a UTF-16 surrogate pair
+                    if (cp >= 0xD800 && cp < 0xDC00 && p_[0] == '\\' && p_[1] == 'u') {
+                        const char* save = p_;
+                        p_ += 2;
+                        uint32_t low;
+                        if (readHex4(low) && low >= 0xDC00 && low < 0xE000) {
+                            cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+                        } else {
+                            p_ = save;
+                        }
+                    }
+                    appendUtf8(cp);
+                    break;
+                }
+                default:
+                    return fail();
+            }
+        }
+    }
+
+    bool readNumber(Kind& kind) {
+        const char* start = p_;
+        bool integral = true;
+        if (*p_ == '-') p_++;
+        while ((*p_ >= '0' && *p_ <= '9') || *p_ == '.' || *p_ == 'e' || *p_ == 'E' ||
+               *p_ == '+' || *p_ == '-') {
+            if (*p_ == '.' || *p_ == 'e' || *p_ == 'E') integral = false;
+            p_++;
+        }
+
+        char* end = nullptr;
+        if (integral) {
+            errno = 0;
+            long long v = std::strtoll(start, &end, 10);
+            if (end == p_ && errno == 0) {
+                kind = Kind::Integer;
+                integer_ = static_cast<sqlite3_int64>(v);
+                return true;
+            }
+        }
+        real_ = std::strtod(start, &end);
+        if (end != p_) return fail();
+        kind = Kind::Real;
+        return true;
+    }
+
+    bool skipNested() {
+        int depth = 0;
+        do {
+            char c = *p_;
+            if (c == '\0') return fail();
+            if (c == '"') {
+                if (!readString()) return false;
+                continue;
+            }
+            if (c == '[' || c == '{') depth++;
+            if (c == ']' || c == '}') depth--;
+            p_++;
+        } while (depth > 0);
+        return true;
+    }
+
+    const char* p_;
+    bool first_ = true;
+    bool done_ = false;
+    bool malformed_ = false;
+    std::string string_;
+    sqlite3_int64 integer_ = 0;
+    double real_ = 0.0;
+};
+
+}  // namespace
+
+void arrayContainsFunc(sqlite3_context* ctx, int argc, sqlite3_value** argv) {
+    if (argc != 2 || sqlite3_value_type(argv[0]) == SQLITE_NULL ||
+        sqlite3_value_type(argv[1]) == SQLITE_NULL) {
+        sqlite3_result_null(ctx);
+        return;
+    }
+
+    const char* json = reinterpret_cast<const char*>(sqlite3_value_text(argv[0]));
+    JsonArrayScanner scanner(json ? json : "");
+    if (!scanner.begin()) {
+        sqlite3_result_null(ctx);
+        return;
+    }
+
+    sqlite3_value* needle = argv[1];
+    int needleType = sqlite3_value_type(needle);
+    const char* needleText = nullptr;
+    int needleLen = 0;
+    if (needleType == SQLITE_TEXT) {
+        needleText = reinterpret_cast<const char*>(sqlite3_value_text(needle));
+        needleLen = sqlite3_value_bytes(needle);
+    }
+    bool needleIsNumber = needleType == SQLITE_INTEGER || needleType == SQLITE_FLOAT;
+
+    JsonArrayScanner::Kind kind;
+    bool found = false;
+    while (!found && scanner.next(kind)) {
+        switch (kind) {
+            case JsonArrayScanner::Kind::String:
+                found = needleText && scanner.string().size() == static_cast<size_t>(needleLen) &&
+                        std::memcmp(scanner.string().data(), needleText, needleLen) == 0;
+                break;
+            case JsonArrayScanner::Kind::Integer:
+                if (needleIsNumber) {
+                    found = needleType == SQLITE_INTEGER
+                        ? sqlite3_value_int64(needle) == scanner.integer()
+                        : sqlite3_value_double(needle) == static_cast<double>(scanner.integer());
+                }
+                break;
+            case JsonArrayScanner::Kind::Real:
+                found = needleIsNumber && sqlite3_value_double(needle) == scanner.real();
+                break;
+            case JsonArrayScanner::Kind::Other:
+                break;
+        }
+    }
+
+    // Only a fully scanned, well-formed array can say "not found"
+    if (!found && (scanner.malformed() || scanner.trailing())) {
+        sqlite3_result_null(ctx);
+        return;
+    }
+    sqlite3_result_int(ctx, found ? 1 : 0);
+}
+
+void registerArrayFunctions(sqlite3* db) {
+    int flags = SQLITE_UTF8 | SQLITE_DETERMINISTIC;
+    sqlite3_create_function(db, "array_contains", 2, flags, nullptr, arrayContainsFunc, nullptr, nullptr);
+}
+
+}  // namespace flatsql
@@ -1,6 +1,13 @@
 #include "flatsql/database.h"
+#include "flatsql/flatbuffer_access.h"
+#include "flatsql/geo_kernels.h"
 #include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
 #include <stdexcept>
+#include <thread>
+#include <unistd.h>
 
 #ifdef FLATSQL_HAVE_OPENSSL
 #include <openssl/hmac.h>
@@ -8,6 +15,21 @@
 
 namespace flatsql {
 
+static inline uint32_t readLE32(const uint8_t* src) {
+    return static_cast<uint32_t>(src[0]) |
+           (static_cast<uint32_t>(src[1]) << 8) |
+           (static_cast<uint32_t>(src[2]) << 16) |
+           (static_cast<uint32_t>(src[3]) << 24);
+}
+
+// Checksum frame: a control frame ("FSQC") holding a 4-byte LE CRC32C.
+// frame points at its size prefix, which must be in the buffer with the body.
+static bool isChecksumFrame(const uint8_t* frame) {
+    return isControlFrame(frame, FlatSQLDatabase::CHECKSUM_FILE_ID, 4);
+}
+
+static size_t verifyChecksumBlocks(const uint8_t* data, size_t length);
+
 // ==================== TableStore ====================
 
 TableStore::TableStore(const TableDef& tableDef, StreamingFlatBufferStore& storage, sqlite3* indexDb)
@@ -15,13 +37,110 @@ TableStore::TableStore(const TableDef& tableDef, StreamingFlatBufferStore& stora
 
     // Create indexes for indexed columns using SQLite's optimized B-tree
     for (const auto& col : tableDef_.columns) {
-        if (col.indexed || col.primaryKey) {
+        if (!col.indexed && !col.primaryKey) continue;
+        if (!col.isVector || col.encrypted) {
             indexes_[col.name] = std::make_unique<SqliteIndex>(
-                indexDb_, tableDef_.name, col.name, col.type);
+                indexDb_, tableDef_.name, col.name, col.type, getIndexLayout(col.name));
+        }
+    }
+    updateVectorIndexes();
+}
+
+bool TableStore::readsVectorInPlace(const ColumnDef& col) const {
+    return col.isVector && !col.encrypted && col.slotKnown && (vectorsInPlace_ || !fieldExtractor_);
+}
+
+// An indexed vector read in place gets an element index; otherwise the
+// extractor's value is indexed like any other column
+void TableStore::updateVectorIndexes() {
+    for (const auto& col : tableDef_.columns) {
+        if ((!col.indexed && !col.primaryKey) || !col.isVector || col.encrypted) continue;
+        if (readsVectorInPlace(col)) {
+            if (elementIndexes_.count(col.name)) continue;
+            bool replacing = indexes_.erase(col.name) > 0;
+            auto index = std::make_unique<SqliteIndex>(
+                indexDb_, tableDef_.name, col.name + "[]", col.elementType, getIndexLayout(col.name));
+            if (replacing) index->clear();  // Rows left from an earlier configuration
+            elementIndexes_[col.name] = std::move(index);
+        } else {
+            if (indexes_.count(col.name)) continue;
+            bool replacing = elementIndexes_.erase(col.name) > 0;
+            auto index = std::make_unique<SqliteIndex>(
+                indexDb_, tableDef_.name, col.name, col.type, getIndexLayout(col.name));
+            if (replacing) index->clear();
+            indexes_[col.name] = std::move(index);
         }
     }
 }
 
+IndexLayout TableStore::getIndexLayout(const std::string& column) const {
+    auto it = indexLayouts_.find(column);
+    return it != indexLayouts_.end() ? it->second : IndexLayout::Rows;
+}
+
+void TableStore::setIndexLayout(const std::string& column, IndexLayout layout) {
+    int colIndex = tableDef_.getColumnIndex(column);
+    if (colIndex < 0) {
+        throw std::runtime_error("Column not found: " + tableDef_.name + "." + column);
+    }
+    const ColumnDef& col = tableDef_.columns[colIndex];
+    if (!col.indexed && !col.primaryKey) {
+        throw std::runtime_error("Column is not indexed: " + tableDef_.name + "." + column);
+    }
+    if (getIndexLayout(column) == layout) return;
+    indexLayouts_[column] = layout;
+
+    // Each layout has its own index table: empty the old one and rebuild
+    // the entries in the other (which may hold rows from an earlier switch)
+    bool element = elementIndexes_.count(column) > 0;
+    auto& indexes = element ? elementIndexes_ : indexes_;
+    auto old = indexes.find(column);
+    if (old != indexes.end()) {
+        old->second->clear();
+        indexes.erase(old);
+    }
+    auto index = element
+        ? std::make_unique<SqliteIndex>(indexDb_, tableDef_.name, column + "[]", col.elementType, layout)
+        : std::make_unique<SqliteIndex>(indexDb_, tableDef_.name, column, col.type, layout);
+    index->clear();
+    for (const auto& info : recordInfos_) {
+        uint32_t length = 0;
+        const uint8_t* data = storage_.getDataAtOffset(info.offset, &length);
+        if (element) {
+            indexElements(col, *index, data, length, info.offset, info.sequence);
+        } else if (fieldExtractor_) {
+            index->insert(fieldExtractor_(data, length, column), info.offset, length, info.sequence);
+        }
+    }
+    indexes[column] = std::move(index);
+}
+
+void TableStore::setFieldExtractor(FieldExtractor extractor) {
+    fieldExtractor_ = extractor;
+    updateVectorIndexes();
+}
+
+void TableStore::setVectorsInPlace(bool enabled) {
+    vectorsInPlace_ = enabled;
+    updateVectorIndexes();
+}
+
+void TableStore::indexElements(const ColumnDef& col, SqliteIndex& index, const uint8_t* data,
+                               size_t length, uint64_t offset, uint64_t sequence) {
+    FbVectorView vector;
+    if (!vector.open(data, length, col.fieldId, col.elementType)) return;
+    std::vector<Value> elements;
+    for (uint32_t i = 0; i < vector.size(); i++) {
+        elements.push_back(vector.at(i));
+    }
+    std::sort(elements.begin(), elements.end());
+    elements.erase(std::unique(elements.begin(), elements.end()), elements.end());
+    for (const auto& element : elements) {
+        if (element.index() == 0) continue;  // Malformed string element
+        index.insert(element, offset, static_cast<uint32_t>(length), sequence);
+    }
+}
+
 void TableStore::onIngest(const uint8_t* data, size_t length, uint64_t sequence, uint64_t offset) {
     // This is the streaming index builder
     // Called for each FlatBuffer as it arrives
@@ -31,6 +150,13 @@ void TableStore::onIngest(const uint8_t* data, size_t length, uint64_t sequence,
     // Track this record for source-specific iteration
     recordInfos_.push_back({offset, sequence});
 
+    // Vector elements are read straight from the buffer, one index entry per
+    // distinct element (the index key is (element, sequence))
+    for (auto& [colName, index] : elementIndexes_) {
+        indexElements(tableDef_.columns[tableDef_.getColumnIndex(colName)], *index,
+                      data, length, offset, sequence);
+    }
+
     if (!fieldExtractor_) {
         return;  // No extractor, can't index
     }
@@ -40,36 +166,310 @@ void TableStore::onIngest(const uint8_t* data, size_t length, uint64_t sequence,
         Value key = fieldExtractor_(data, length, colName);
         index->insert(key, offset, static_cast<uint32_t>(length), sequence);
     }
+
+    // NULL keys never match a comparison, so they aren't learned
+    for (auto& [colName, index] : learnedIndexes_) {
+        Value key = fieldExtractor_(data, length, colName);
+        if (key.index() != 0) index->insert(key, offset, sequence);
+    }
+
+    for (auto& [colName, index] : radixIndexes_) {
+        Value key = fieldExtractor_(data, length, colName);
+        if (key.index() != 0) index->insert(key, offset, sequence);
+    }
+
+    // Records without numeric coordinates are simply not spatially indexed
+    if (spatialIndex_) {
+        double lat, lon;
+        if (SpatialIndex::toDouble(fieldExtractor_(data, length, spatialIndex_->getLatColumn()), lat) &&
+            SpatialIndex::toDouble(fieldExtractor_(data, length, spatialIndex_->getLonColumn()), lon)) {
+            spatialIndex_->insert(lat, lon, offset, static_cast<uint32_t>(length), sequence);
+        }
+    }
+}
+
+SpatialIndex* TableStore::createSpatialIndex(const std::string& latColumn, const std::string& lonColumn) {
+    if (spatialIndex_) {
+        throw std::runtime_error("Table already has a spatial index: " + tableDef_.name);
+    }
+    if (!fieldExtractor_) {
+        throw std::runtime_error("Spatial index requires a field extractor: " + tableDef_.name);
+    }
+
+    bool hasLat = false, hasLon = false;
+    for (const auto& col : tableDef_.columns) {
+        if (col.name == latColumn) hasLat = true;
+        if (col.name == lonColumn) hasLon = true;
+    }
+    if (!hasLat || !hasLon) {
+        throw std::runtime_error("Spatial index columns not found in table: " + tableDef_.name);
+    }
+
+    auto index = std::make_unique<SpatialIndex>(indexDb_, tableDef_.name, latColumn, lonColumn);
+
+    // Backfill from records ingested so far
+    for (const auto& info : recordInfos_) {
+        uint32_t len = 0;
+        const uint8_t* data = storage_.getDataAtOffset(info.offset, &len);
+        if (!data) continue;
+        double lat, lon;
+        if (SpatialIndex::toDouble(fieldExtractor_(data, len, latColumn), lat) &&
+            SpatialIndex::toDouble(fieldExtractor_(data, len, lonColumn), lon)) {
+            index->insert(lat, lon, info.offset, len, info.sequence);
+        }
+    }
+
+    spatialIndex_ = std::move(index);
+    return spatialIndex_.get();
+}
+
+LearnedIndex* TableStore::createLearnedIndex(const std::string& column) {
+    if (learnedIndexes_.count(column)) {
+        throw std::runtime_error("Column already has a learned index: " + tableDef_.name + "." + column);
+    }
+    if (!fieldExtractor_) {
+        throw std::runtime_error("Learned index requires a field extractor: " + tableDef_.name);
+    }
+
+    int colIdx = tableDef_.getColumnIndex(column);
+    if (colIdx < 0) {
+        throw std::runtime_error("Learned index column not found in table: " + tableDef_.name);
+    }
+    const ColumnDef& col = tableDef_.columns[colIdx];
+    if (col.isVector || col.encrypted || !LearnedIndex::supportsType(col.type)) {
+        throw std::runtime_error("Learned index requires a plain numeric column: " + tableDef_.name + "." + column);
+    }
+
+    auto index = std::make_unique<LearnedIndex>(column, col.type);
+
+    // Backfill in ingest order, which keeps monotonic keys on the append path
+    for (const auto& info : recordInfos_) {
+        uint32_t len = 0;
+        const uint8_t* data = storage_.getDataAtOffset(info.offset, &len);
+        if (!data) continue;
+        Value key = fieldExtractor_(data, len, column);
+        if (key.index() != 0) index->insert(key, info.offset, info.sequence);
+    }
+
+    LearnedIndex* result = index.get();
+    learnedIndexes_[column] = std::move(index);
+    return result;
+}
+
+std::unordered_map<std::string, LearnedIndex*> TableStore::getLearnedIndexes() const {
+    std::unordered_map<std::string, LearnedIndex*> indexes;
+    for (const auto& [column, index] : learnedIndexes_) {
+        indexes[column] = index.get();
+    }
+    return indexes;
+}
+
+RadixIndex* TableStore::createRadixIndex(const std::string& column) {
+    if (radixIndexes_.count(column)) {
+        throw std::runtime_error("Column already has a radix index: " + tableDef_.name + "." + column);
+    }
+    if (!fieldExtractor_) {
+        throw std::runtime_error("Radix index requires a field extractor: " + tableDef_.name);
+    }
+
+    int colIdx = tableDef_.getColumnIndex(column);
+    if (colIdx < 0) {
+        throw std::runtime_error("Radix index column not found in table: " + tableDef_.name);
+    }
+    const ColumnDef& col = tableDef_.columns[colIdx];
+    if (col.isVector || col.encrypted || !RadixIndex::supportsType(col.type)) {
+        throw std::runtime_error("Radix index requires a plain string or blob column: " + tableDef_.name + "." + column);
+    }
+
+    auto index = std::make_unique<RadixIndex>(column, col.type);
+    for (const auto& info : recordInfos_) {
+        uint32_t len = 0;
+        const uint8_t* data = storage_.getDataAtOffset(info.offset, &len);
+        if (!data) continue;
+        Value key = fieldExtractor_(data, len, column);
+        if (key.index() != 0) index->insert(key, info.offset, info.sequence);
+    }
+
+    RadixIndex* result = index.get();
+    radixIndexes_[column] = std::move(index);
+    return result;
+}
+
+std::unordered_map<std::string, RadixIndex*> TableStore::getRadixIndexes() const {
+    std::unordered_map<std::string, RadixIndex*> indexes;
+    for (const auto& [column, index] : radixIndexes_) {
+        indexes[column] = index.get();
+    }
+    return indexes;
+}
+
+SpatialIndex* TableStore::spatialIndexFor(const std::string& latColumn, const std::string& lonColumn) const {
+    if (spatialIndex_ && spatialIndex_->getLatColumn() == latColumn &&
+        spatialIndex_->getLonColumn() == lonColumn) {
+        return spatialIndex_.get();
+    }
+    return nullptr;
+}
+
+void TableStore::scanPointChunks(const std::string& latColumn, const std::string& lonColumn,
+                                 const PointChunkFn& fn) const {
+    if (!fieldExtractor_) {
+        throw std::runtime_error("Geo scan requires a field extractor: " + tableDef_.name);
+    }
+
+    // Chunk small enough that the coordinate columns stay in L1
+    constexpr size_t CHUNK = 512;
+    std::vector<StoredRecord> records;
+    std::vector<double> lats;
+    std::vector<double> lons;
+    records.reserve(CHUNK);
+    lats.reserve(CHUNK);
+    lons.reserve(CHUNK);
+
+    auto flush = [&]() {
+        if (records.empty()) return;
+        fn(records.data(), lats.data(), lons.data(), records.size());
+        records.clear();
+        lats.clear();
+        lons.clear();
+    };
+
+    for (const auto& info : recordInfos_) {
+        uint32_t len = 0;
+        const uint8_t* data = storage_.getDataAtOffset(info.offset, &len);
+        if (!data) continue;
+        double lat, lon;
+        if (!SpatialIndex::toDouble(fieldExtractor_(data, len, latColumn), lat) ||
+            !SpatialIndex::toDouble(fieldExtractor_(data, len, lonColumn), lon)) {
+            continue;
+        }
+
+        StoredRecord record;
+        record.offset = info.offset;
+        record.header.sequence = info.sequence;
+        record.header.dataLength = len;
+        records.push_back(std::move(record));
+        lats.push_back(lat);
+        lons.push_back(lon);
+        if (records.size() == CHUNK) flush();
+    }
+    flush();
+}
+
+// Offset, sequence and length of an index hit, without a data copy. Index
+// entries may carry dataLength 0, so the length comes from the size prefix.
+static StoredRecord minimalRecord(const StreamingFlatBufferStore& storage, const IndexEntry& entry) {
+    StoredRecord record;
+    record.offset = entry.dataOffset;
+    record.header.sequence = entry.sequence;
+    record.header.dataLength = 0;
+    storage.getDataAtOffset(entry.dataOffset, &record.header.dataLength);
+    return record;
+}
+
+std::vector<StoredRecord> TableStore::findWithinRadius(const std::string& latColumn, const std::string& lonColumn,
+                                                       double lat, double lon, double radiusKm) {
+    std::vector<StoredRecord> results;
+
+    if (SpatialIndex* index = spatialIndexFor(latColumn, lonColumn)) {
+        for (const auto& entry : index->searchRadius(lat, lon, radiusKm)) {
+            results.push_back(minimalRecord(storage_, entry));
+        }
+        return results;
+    }
+
+    std::vector<uint8_t> mask;
+    scanPointChunks(latColumn, lonColumn, [&](const StoredRecord* records, const double* lats,
+                                              const double* lons, size_t n) {
+        mask.resize(n);
+        if (geoWithinRadiusBatch(lat, lon, radiusKm, lats, lons, n, mask.data()) == 0) return;
+        for (size_t i = 0; i < n; i++) {
+            if (mask[i]) results.push_back(records[i]);
+        }
+    });
+    return results;
+}
+
+std::vector<StoredRecord> TableStore::findInBox(const std::string& latColumn, const std::string& lonColumn,
+                                                double minLat, double maxLat, double minLon, double maxLon) {
+    std::vector<StoredRecord> results;
+
+    if (SpatialIndex* index = spatialIndexFor(latColumn, lonColumn)) {
+        for (const auto& entry : index->searchBox(minLat, maxLat, minLon, maxLon)) {
+            results.push_back(minimalRecord(storage_, entry));
+        }
+        return results;
+    }
+
+    std::vector<uint8_t> mask;
+    scanPointChunks(latColumn, lonColumn, [&](const StoredRecord* records, const double* lats,
+                                              const double* lons, size_t n) {
+        mask.resize(n);
+        if (geoBboxContainsBatch(minLat, maxLat, minLon, maxLon, lats, lons, n, mask.data()) == 0) return;
+        for (size_t i = 0; i < n; i++) {
+            if (mask[i]) results.push_back(records[i]);
+        }
+    });
+    return results;
+}
+
+size_t TableStore::countWithinRadius(const std::string& latColumn, const std::string& lonColumn,
+                                     double lat, double lon, double radiusKm) {
+    if (SpatialIndex* index = spatialIndexFor(latColumn, lonColumn)) {
+        return index->searchRadius(lat, lon, radiusKm).size();
+    }
+
+    size_t count = 0;
+    std::vector<uint8_t> mask;
+    scanPointChunks(latColumn, lonColumn, [&](const StoredRecord*, const double* lats,
+                                              const double* lons, size_t n) {
+        mask.resize(n);
+        count += geoWithinRadiusBatch(lat, lon, radiusKm, lats, lons, n, mask.data());
+    });
+    return count;
+}
+
+// Copy of a record for the StoredRecord-returning APIs
+static StoredRecord copyRecord(const StreamingFlatBufferStore::RecordRef& ref) {
+    StoredRecord record;
+    record.offset = ref.offset;
+    record.header.sequence = ref.sequence;
+    record.header.dataLength = ref.length;
+    record.header.fileId = StreamingFlatBufferStore::extractFileId(ref.data, ref.length);
+    record.data.assign(ref.data, ref.data + ref.length);
+    return record;
 }
 
 std::vector<StoredRecord> TableStore::findByIndex(const std::string& column, const Value& value) {
     std::vector<StoredRecord> results;
 
     auto it = indexes_.find(column);
+    if (getRadixIndex(column) || (it == indexes_.end() && getLearnedIndex(column))) {
+        forEachByIndex(column, value, [&](const StreamingFlatBufferStore::RecordRef& ref) {
+            StoredRecord record;
+            record.offset = ref.offset;
+            record.header.sequence = ref.sequence;
+            record.header.dataLength = ref.length;
+            results.push_back(std::move(record));
+            return true;
+        });
+        return results;
+    }
+
     if (it == indexes_.end()) {
-        // No index - fall back to scan
-        auto all = scanAll();
-        for (auto& record : all) {
-            if (fieldExtractor_) {
-                Value fieldValue = fieldExtractor_(record.data.data(), record.data.size(), column);
-                if (compareValues(fieldValue, value) == 0) {
-                    results.push_back(std::move(record));
-                }
-            }
-        }
+        // No index - fall back to scan, copying only the matches
+        forEachByIndex(column, value, [&](const StreamingFlatBufferStore::RecordRef& ref) {
+            results.push_back(copyRecord(ref));
+            return true;
+        });
         return results;
     }
 
     // Try fast path for single result (common for primary key lookups)
     IndexEntry entry;
     if (it->second->searchFirst(value, entry)) {
-        // Minimal record - just offset and sequence, no data copy
-        StoredRecord record;
-        record.offset = entry.dataOffset;
-        record.header.sequence = entry.sequence;
-        record.header.dataLength = entry.dataLength;
         // Data is left empty - caller can use offset to read if needed
-        results.push_back(std::move(record));
+        results.push_back(minimalRecord(storage_, entry));
     }
 
     return results;
@@ -78,40 +478,96 @@ std::vector<StoredRecord> TableStore::findByIndex(const std::string& column, con
 std::vector<StoredRecord> TableStore::findByRange(const std::string& column,
                                                    const Value& minValue, const Value& maxValue) {
     std::vector<StoredRecord> results;
+    forEachByRange(column, minValue, maxValue, [&](const StreamingFlatBufferStore::RecordRef& ref) {
+        results.push_back(copyRecord(ref));
+        return true;
+    });
+    return results;
+}
 
+std::vector<StoredRecord> TableStore::scanAll() {
+    std::vector<StoredRecord> results;
+    results.reserve(recordInfos_.size());
+    scanRefs([&](const StreamingFlatBufferStore::RecordRef& ref) {
+        results.push_back(copyRecord(ref));
+        return true;
+    });
+    return results;
+}
+
+size_t TableStore::forEachByIndex(const std::string& column, const Value& value,
+                                  const RecordVisitor& visit) const {
+    IndexCursor cursor;
     auto it = indexes_.find(column);
-    if (it == indexes_.end()) {
-        // No index - fall back to scan
-        auto all = scanAll();
-        for (auto& record : all) {
-            if (fieldExtractor_) {
-                Value fieldValue = fieldExtractor_(record.data.data(), record.data.size(), column);
-                if (compareValues(fieldValue, minValue) >= 0 &&
-                    compareValues(fieldValue, maxValue) <= 0) {
-                    results.push_back(std::move(record));
-                }
-            }
-        }
-        return results;
+    if (RadixIndex* radix = getRadixIndex(column)) {
+        radix->openQuery({{KeyOp::Eq, value}}, cursor);
+    } else if (it != indexes_.end()) {
+        it->second->openSearch(value, cursor);
+    } else if (LearnedIndex* learned = getLearnedIndex(column)) {
+        learned->openQuery({{KeyOp::Eq, value}}, cursor);
+    } else {
+        return visitMatching(column, [&](const Value& v) { return compareValues(v, value) == 0; }, visit);
     }
+    return visitCursor(cursor, visit);
+}
 
-    auto entries = it->second->range(minValue, maxValue);
-    for (const auto& entry : entries) {
-        results.push_back(storage_.readRecordAtOffset(entry.dataOffset));
+size_t TableStore::forEachByRange(const std::string& column, const Value& minValue, const Value& maxValue,
+                                  const RecordVisitor& visit) const {
+    IndexCursor cursor;
+    auto it = indexes_.find(column);
+    if (RadixIndex* radix = getRadixIndex(column)) {
+        radix->openQuery({{KeyOp::Ge, minValue}, {KeyOp::Le, maxValue}}, cursor);
+    } else if (LearnedIndex* learned = getLearnedIndex(column)) {
+        learned->openQuery({{KeyOp::Ge, minValue}, {KeyOp::Le, maxValue}}, cursor);
+    } else if (it != indexes_.end()) {
+        it->second->openRange(minValue, maxValue, cursor);
+    } else {
+        return visitMatching(column, [&](const Value& v) {
+            return compareValues(v, minValue) >= 0 && compareValues(v, maxValue) <= 0;
+        }, visit);
     }
+    return visitCursor(cursor, visit);
+}
 
-    return results;
+size_t TableStore::scanRefs(const RecordVisitor& visit) const {
+    size_t count = 0;
+    for (const auto& info : recordInfos_) {
+        StreamingFlatBufferStore::RecordRef ref;
+        ref.data = storage_.getDataAtOffset(info.offset, &ref.length);
+        if (!ref.data) continue;
+        ref.offset = info.offset;
+        ref.sequence = info.sequence;
+        count++;
+        if (!visit(ref)) break;
+    }
+    return count;
 }
 
-std::vector<StoredRecord> TableStore::scanAll() {
-    std::vector<StoredRecord> results;
+size_t TableStore::visitCursor(IndexCursor& cursor, const RecordVisitor& visit) const {
+    size_t count = 0;
+    uint64_t offset, sequence;
+    while (cursor.next(offset, sequence)) {
+        StreamingFlatBufferStore::RecordRef ref;
+        ref.data = storage_.getDataAtOffset(offset, &ref.length);
+        if (!ref.data) continue;
+        ref.offset = offset;
+        ref.sequence = sequence;
+        count++;
+        if (!visit(ref)) break;
+    }
+    return count;
+}
 
-    storage_.iterateByFileId(fileId_, [&](const StoredRecord& record) {
-        results.push_back(record);
-        return true;
+size_t TableStore::visitMatching(const std::string& column, const std::function<bool(const Value&)>& match,
+                                 const RecordVisitor& visit) const {
+    if (!fieldExtractor_) return 0;
+    size_t count = 0;
+    scanRefs([&](const StreamingFlatBufferStore::RecordRef& ref) {
+        if (!match(fieldExtractor_(ref.data, ref.length, column))) return true;
+        count++;
+        return visit(ref);
     });
-
-    return results;
+    return count;
 }
 
 std::vector<std::string> TableStore::getIndexNames() const {
@@ -119,9 +575,23 @@ std::vector<std::string> TableStore::getIndexNames() const {
     for (const auto& [name, _] : indexes_) {
         names.push_back(name);
     }
+    for (const auto& [name, _] : elementIndexes_) {
+        names.push_back(name + "[]");
+    }
     return names;
 }
 
+std::vector<std::pair<std::string, const SqliteIndex*>> TableStore::getIndexList() const {
+    std::vector<std::pair<std::string, const SqliteIndex*>> list;
+    for (const auto& [name, index] : indexes_) {
+        list.emplace_back(name, index.get());
+    }
+    for (const auto& [name, index] : elementIndexes_) {
+        list.emplace_back(name + "[]", index.get());
+    }
+    return list;
+}
+
 // ==================== FlatSQLDatabase ====================
 
 FlatSQLDatabase::FlatSQLDatabase(const DatabaseSchema& schema)
@@ -169,27 +639,174 @@ void FlatSQLDatabase::onIngest(std::string_view fileId, const uint8_t* data, siz
 }
 
 size_t FlatSQLDatabase::ingest(const uint8_t* data, size_t length, size_t* recordsIngested) {
-    return storage_.ingest(data, length,
+    uint64_t logAfter = storage_.getLastSequence();
+    size_t consumed = ingestVerified(data, length, recordsIngested,
         [this](std::string_view fileId, const uint8_t* data, size_t len,
                uint64_t seq, uint64_t offset) {
             onIngest(fileId, data, len, seq, offset);
-        }, recordsIngested);
+        });
+    logStored(logAfter);
+    return consumed;
 }
 
 uint64_t FlatSQLDatabase::ingestOne(const uint8_t* flatbuffer, size_t length) {
-    return storage_.ingestFlatBuffer(flatbuffer, length,
+    if (verifyIngest_) {
+        const TableStore* table = tableForRecord(flatbuffer, length);
+        rejectedRecords_.clear();
+        if (table && !table->verifyRecord(flatbuffer, length)) {
+            rejectedRecords_.push_back(0);
+            throw std::runtime_error("Record failed verification for table " + table->getTableDef().name);
+        }
+    }
+    uint64_t logAfter = storage_.getLastSequence();
+    uint64_t sequence = storage_.ingestFlatBuffer(flatbuffer, length,
         [this](std::string_view fileId, const uint8_t* data, size_t len,
                uint64_t seq, uint64_t offset) {
             onIngest(fileId, data, len, seq, offset);
         });
+    logStored(logAfter);
+    return sequence;
+}
+
+void TableStore::clearRecords() {
+    recordCount_ = 0;
+    recordInfos_.clear();
+    for (auto& [colName, index] : indexes_) index->clear();
+    for (auto& [colName, index] : elementIndexes_) index->clear();
+    for (auto& [colName, index] : learnedIndexes_) index->clear();
+    for (auto& [colName, index] : radixIndexes_) index->clear();
+    if (spatialIndex_) spatialIndex_->clear();
+}
+
+// ==================== Ingest Verification ====================
+
+bool TableStore::verifyRecord(const uint8_t* data, size_t length) const {
+    if (recordVerifier_) return recordVerifier_(data, length);
+    for (const auto& col : tableDef_.columns) {
+        if (!col.slotKnown) return false;  // The schema checks would read the wrong slots
+    }
+    return fbVerifyRootTable(data, length, tableDef_);
+}
+
+void FlatSQLDatabase::setIngestVerification(bool enabled, unsigned threads) {
+    verifyIngest_ = enabled;
+    verifyThreads_ = threads;
+}
+
+const TableStore* FlatSQLDatabase::tableForRecord(const uint8_t* flatbuffer, size_t length) const {
+    if (length < FILE_IDENTIFIER_OFFSET + FILE_IDENTIFIER_LENGTH) return nullptr;
+    auto mapIt = fileIdToTable_.find(std::string(
+        reinterpret_cast<const char*>(flatbuffer + FILE_IDENTIFIER_OFFSET), FILE_IDENTIFIER_LENGTH));
+    if (mapIt == fileIdToTable_.end()) return nullptr;
+    auto tableIt = tables_.find(mapIt->second);
+    return tableIt != tables_.end() ? tableIt->second.get() : nullptr;
+}
+
+size_t FlatSQLDatabase::ingestVerified(const uint8_t* data, size_t length, size_t* recordsIngested,
+                                       const StreamingFlatBufferStore::IngestCallback& callback) {
+    if (!verifyIngest_) {
+        return storage_.ingest(data, length, callback, recordsIngested);
+    }
+    rejectedRecords_.clear();
+
+    // Frame the batch and route each record to its table
+    struct Frame {
+        size_t offset;
+        uint32_t size;
+        const TableStore* table;
+    };
+    std::vector<Frame> frames;
+    size_t consumed = 0;
+    const TableStore* lastTable = nullptr;
+    char lastId[FILE_IDENTIFIER_LENGTH] = {};
+    while (consumed + SIZE_PREFIX_LENGTH <= length) {
+        uint32_t size = readLE32(data + consumed);
+        if (consumed + frameLength(size) > length) break;
+        if (size & PADDING_FRAME_FLAG) {
+            // Not a record; stored runs pass it on to be skipped
+            consumed += frameLength(size);
+            continue;
+        }
+        const uint8_t* record = data + consumed + SIZE_PREFIX_LENGTH;
+        const TableStore* table = nullptr;
+        if (size >= FILE_IDENTIFIER_OFFSET + FILE_IDENTIFIER_LENGTH) {
+            // Batches are usually runs of one file ID
+            if (!lastTable || std::memcmp(lastId, record + FILE_IDENTIFIER_OFFSET, FILE_IDENTIFIER_LENGTH) != 0) {
+                std::memcpy(lastId, record + FILE_IDENTIFIER_OFFSET, FILE_IDENTIFIER_LENGTH);
+                lastTable = tableForRecord(record, size);
+            }
+            table = lastTable;
+        }
+        frames.push_back({consumed, size, table});
+        consumed += SIZE_PREFIX_LENGTH + size;
+    }
+
+    std::vector<uint8_t> valid(frames.size(), 1);
+    auto work = [&](size_t begin, size_t end) {
+        for (size_t i = begin; i < end; i++) {
+            const Frame& f = frames[i];
+            if (f.table) valid[i] = f.table->verifyRecord(data + f.offset + SIZE_PREFIX_LENGTH, f.size);
+        }
+    };
+    size_t n = frames.size();
+#if defined(__EMSCRIPTEN__) && !defined(__EMSCRIPTEN_PTHREADS__)
+    work(0, n);
+#else
+    unsigned threads = verifyThreads_ ? verifyThreads_ : std::max(1u, std::thread::hardware_concurrency());
+    // Not worth a thread for fewer than ~1024 records
+    size_t workers = std::min<size_t>({threads, std::max<size_t>(1, n / 1024), std::max<size_t>(1, n)});
+    std::vector<std::thread> pool;
+    size_t chunk = (n + workers - 1) / workers;
+    for (size_t w = 1; w < workers; w++) {
+        size_t begin = w * chunk;
+        size_t end = std::min(n, begin + chunk);
+        if (begin >= end) break;
+        pool.emplace_back(work, begin, end);
+    }
+    work(0, std::min(n, chunk));
+    for (auto& thread : pool) thread.join();
+#endif
+
+    // Store the runs of records between rejected ones, in order
+    size_t records = 0;
+    size_t runStart = 0;
+    auto storeRun = [&](size_t runEnd) {
+        if (runEnd > runStart) {
+            size_t stored = 0;
+            storage_.ingest(data + runStart, runEnd - runStart, callback, &stored);
+            records += stored;
+        }
+    };
+    for (size_t i = 0; i < n; i++) {
+        if (valid[i]) continue;
+        rejectedRecords_.push_back(i);
+        storeRun(frames[i].offset);
+        runStart = frames[i].offset + SIZE_PREFIX_LENGTH + frames[i].size;
+    }
+    storeRun(consumed);
+
+    if (recordsIngested) {
+        *recordsIngested = records;
+    }
+    return consumed;
 }
 
 void FlatSQLDatabase::loadAndRebuild(const uint8_t* data, size_t length) {
+    // A checksummed export is verified as a whole before anything is loaded
+    if (length >= 16 && isChecksumFrame(data)) {
+        if (verifyChecksumBlocks(data, length) != length) {
+            throw std::runtime_error("Checksummed stream is truncated after its last checksum");
+        }
+        applyFrames(data, length);
+        return;
+    }
+
     storage_.loadAndRebuild(data, length,
         [this](std::string_view fileId, const uint8_t* data, size_t len,
                uint64_t seq, uint64_t offset) {
             onIngest(fileId, data, len, seq, offset);
         });
+    logStored(0);
 }
 
 void FlatSQLDatabase::initializeSQLiteEngine() {
@@ -206,6 +823,25 @@ void FlatSQLDatabase::initializeSQLiteEngine() {
     sqliteInitialized_ = true;
 }
 
+// Index map (SqliteIndex* pointers) handed to the SQLite engine
+static std::unordered_map<std::string, SqliteIndex*> sqliteIndexMap(TableStore* tableStore) {
+    std::unordered_map<std::string, SqliteIndex*> indexes;
+    for (const auto& col : tableStore->getTableDef().columns) {
+        if (col.indexed || col.primaryKey) {
+            SqliteIndex* index = tableStore->getIndex(col.name);
+            if (index) {
+                indexes[col.name] = index;
+            }
+            // The vtab finds element indexes for array_contains as "column[]"
+            SqliteIndex* elementIndex = tableStore->getElementIndex(col.name);
+            if (elementIndex) {
+                indexes[col.name + "[]"] = elementIndex;
+            }
+        }
+    }
+    return indexes;
+}
+
 void FlatSQLDatabase::updateSQLiteTable(const std::string& tableName) {
     auto it = tables_.find(tableName);
     if (it == tables_.end()) {
@@ -219,16 +855,7 @@ void FlatSQLDatabase::updateSQLiteTable(const std::string& tableName) {
         return;
     }
 
-    // Build index map (SqliteIndex* pointers)
-    std::unordered_map<std::string, SqliteIndex*> indexes;
-    for (const auto& col : tableStore->getTableDef().columns) {
-        if (col.indexed || col.primaryKey) {
-            SqliteIndex* index = tableStore->getIndex(col.name);
-            if (index) {
-                indexes[col.name] = index;
-            }
-        }
-    }
+    std::unordered_map<std::string, SqliteIndex*> indexes = sqliteIndexMap(tableStore);
 
     // Register with SQLite engine
     // Pass source-specific record infos for multi-source routing
@@ -241,7 +868,11 @@ void FlatSQLDatabase::updateSQLiteTable(const std::string& tableName) {
         indexes,
         tableStore->getFastFieldExtractor(),
         tableStore->getBatchExtractor(),
-        &tableStore->getRecordInfos()
+        &tableStore->getRecordInfos(),
+        tableStore->getSpatialIndex(),
+        tableStore->getLearnedIndexes(),
+        tableStore->getRadixIndexes(),
+        tableStore->getVectorsInPlace()
     );
 
     // Propagate encryption context to the registered source
@@ -284,6 +915,14 @@ QueryResult FlatSQLDatabase::query(const std::string& sql, int64_t param) {
     return sqliteEngine_->execute(sql, singleParam);
 }
 
+size_t FlatSQLDatabase::executeBatch(const std::string& sql, const std::vector<std::vector<Value>>& paramSets,
+                                     const BatchRowSink& sink) {
+    // Ensure SQLite engine is initialized
+    initializeSQLiteEngine();
+
+    return sqliteEngine_->executeBatch(sql, paramSets, sink);
+}
+
 size_t FlatSQLDatabase::queryCount(const std::string& sql, const std::vector<Value>& params) {
     // Ensure SQLite engine is initialized
     initializeSQLiteEngine();
@@ -302,6 +941,33 @@ std::vector<StoredRecord> FlatSQLDatabase::findByIndex(const std::string& tableN
     return it->second->findByIndex(column, value);
 }
 
+size_t FlatSQLDatabase::forEachByIndex(const std::string& tableName, const std::string& column,
+                                       const Value& value, const TableStore::RecordVisitor& visit) const {
+    auto it = tables_.find(tableName);
+    if (it == tables_.end()) {
+        return 0;
+    }
+    return it->second->forEachByIndex(column, value, visit);
+}
+
+size_t FlatSQLDatabase::forEachByRange(const std::string& tableName, const std::string& column,
+                                       const Value& minValue, const Value& maxValue,
+                                       const TableStore::RecordVisitor& visit) const {
+    auto it = tables_.find(tableName);
+    if (it == tables_.end()) {
+        return 0;
+    }
+    return it->second->forEachByRange(column, minValue, maxValue, visit);
+}
+
+size_t FlatSQLDatabase::scanRefs(const std::string& tableName, const TableStore::RecordVisitor& visit) const {
+    auto it = tables_.find(tableName);
+    if (it == tables_.end()) {
+        return 0;
+    }
+    return it->second->scanRefs(visit);
+}
+
 bool FlatSQLDatabase::findOneByIndex(const std::string& tableName,
                                       const std::string& column,
                                       const Value& value,
@@ -311,16 +977,18 @@ bool FlatSQLDatabase::findOneByIndex(const std::string& tableName,
         return false;
     }
 
-    SqliteIndex* index = it->second->getIndex(column);
-    if (!index) {
+    RadixIndex* radix = it->second->getRadixIndex(column);
+    SqliteIndex* index = radix ? nullptr : it->second->getIndex(column);
+    if (!radix && !index) {
         return false;
     }
 
     IndexEntry entry;
-    if (index->searchFirst(value, entry)) {
+    if (radix ? radix->searchFirst(value, entry) : index->searchFirst(value, entry)) {
         // Minimal record info - avoid data copy
         result.offset = entry.dataOffset;
-        result.header.dataLength = entry.dataLength;
+        result.header.dataLength = 0;
+        storage_.getDataAtOffset(entry.dataOffset, &result.header.dataLength);
         result.header.sequence = entry.sequence;
         // Clear data vector without deallocating (reuse memory)
         result.data.clear();
@@ -340,6 +1008,22 @@ const uint8_t* FlatSQLDatabase::findRawByIndex(const std::string& tableName,
         return nullptr;
     }
 
+    // Radix index: one node per distinguishing key byte, no SQLite statement
+    if (RadixIndex* radix = it->second->getRadixIndex(column)) {
+        IndexEntry entry;
+        if (auto* strKey = std::get_if<std::string>(&value)) {
+            if (!radix->searchFirstString(*strKey, entry.dataOffset, entry.sequence)) {
+                return nullptr;
+            }
+        } else if (!radix->searchFirst(value, entry)) {
+            return nullptr;
+        }
+        if (outSequence) {
+            *outSequence = entry.sequence;
+        }
+        return storage_.getDataAtOffset(entry.dataOffset, outLength);
+    }
+
     SqliteIndex* index = it->second->getIndex(column);
     if (!index) {
         return nullptr;
@@ -348,8 +1032,7 @@ const uint8_t* FlatSQLDatabase::findRawByIndex(const std::string& tableName,
     // Fast path for string keys - avoid Value construction overhead
     if (auto* strKey = std::get_if<std::string>(&value)) {
         uint64_t offset, seq;
-        uint32_t len;
-        if (index->searchFirstString(*strKey, offset, len, seq)) {
+        if (index->searchFirstString(*strKey, offset, seq)) {
             if (outSequence) {
                 *outSequence = seq;
             }
@@ -361,8 +1044,7 @@ const uint8_t* FlatSQLDatabase::findRawByIndex(const std::string& tableName,
     // Fast path for int64 keys
     if (auto* intKey = std::get_if<int64_t>(&value)) {
         uint64_t offset, seq;
-        uint32_t len;
-        if (index->searchFirstInt64(*intKey, offset, len, seq)) {
+        if (index->searchFirstInt64(*intKey, offset, seq)) {
             if (outSequence) {
                 *outSequence = seq;
             }
@@ -383,6 +1065,70 @@ const uint8_t* FlatSQLDatabase::findRawByIndex(const std::string& tableName,
     return nullptr;
 }
 
+size_t FlatSQLDatabase::findRawByIndexBatch(const std::string& tableName,
+                                            const std::string& column,
+                                            const Value* keys, size_t count,
+                                            StreamingFlatBufferStore::RecordRef* out) {
+    for (size_t i = 0; i < count; i++) {
+        out[i] = {0, 0, nullptr, 0};
+    }
+
+    auto it = tables_.find(tableName);
+    if (it == tables_.end()) {
+        return 0;
+    }
+    RadixIndex* radix = it->second->getRadixIndex(column);
+    SqliteIndex* index = radix ? nullptr : it->second->getIndex(column);
+    if (!radix && !index) {
+        return 0;
+    }
+
+    // Encode each key once and probe in encoded order: neighbouring probes
+    // then walk the same B-tree pages or radix nodes, and repeated keys are
+    // looked up once
+    ValueType keyType = radix ? radix->getKeyType() : index->getKeyType();
+    std::vector<std::string> encoded(count);
+    std::vector<size_t> order;
+    order.reserve(count);
+    for (size_t i = 0; i < count; i++) {
+        if (KeyCodec::append(keyType, keys[i], encoded[i])) {
+            order.push_back(i);
+        }
+    }
+    std::sort(order.begin(), order.end(), [&](size_t a, size_t b) { return encoded[a] < encoded[b]; });
+
+    std::vector<uint8_t> hit(count, 0);
+    const size_t* previous = nullptr;
+    for (const size_t& i : order) {
+        if (previous && encoded[*previous] == encoded[i]) {
+            out[i] = out[*previous];
+            hit[i] = hit[*previous];
+        } else if (radix ? radix->searchFirstEncoded(encoded[i], out[i].offset, out[i].sequence)
+                         : index->searchFirstEncoded(encoded[i], out[i].offset, out[i].sequence)) {
+            hit[i] = 1;
+        }
+        previous = &i;
+    }
+
+    // Resolve records in input order, prefetching the size prefix of the
+    // record a few slots ahead so its cache miss overlaps this one
+    constexpr size_t PREFETCH_DISTANCE = 8;
+    const uint8_t* base = storage_.getDataBuffer();
+    size_t found = 0;
+    for (size_t i = 0; i < count; i++) {
+        size_t ahead = i + PREFETCH_DISTANCE;
+        if (ahead < count && hit[ahead]) {
+            __builtin_prefetch(base + out[ahead].offset);
+        }
+        if (!hit[i]) {
+            continue;
+        }
+        out[i].data = storage_.getDataAtOffset(out[i].offset, &out[i].length);
+        found++;
+    }
+    return found;
+}
+
 void FlatSQLDatabase::setFieldExtractor(const std::string& tableName, TableStore::FieldExtractor extractor) {
     auto it = tables_.find(tableName);
     if (it == tables_.end()) {
@@ -392,7 +1138,10 @@ void FlatSQLDatabase::setFieldExtractor(const std::string& tableName, TableStore
     it->second->setFieldExtractor(extractor);
 
     // If table has a file ID registered, update SQLite registration
-    if (!it->second->getFileId().empty()) {
+    if (sqliteRegisteredTables_.count(tableName)) {
+        sqliteEngine_->setIndexes(tableName, sqliteIndexMap(it->second.get()),
+                                  it->second->getVectorsInPlace());
+    } else if (!it->second->getFileId().empty()) {
         updateSQLiteTable(tableName);
     }
 }
@@ -411,6 +1160,14 @@ void FlatSQLDatabase::setFastFieldExtractor(const std::string& tableName, TableS
     }
 }
 
+void FlatSQLDatabase::setRecordVerifier(const std::string& tableName, TableStore::RecordVerifier verifier) {
+    auto it = tables_.find(tableName);
+    if (it == tables_.end()) {
+        throw std::runtime_error("Table not found: " + tableName);
+    }
+    it->second->setRecordVerifier(verifier);
+}
+
 void FlatSQLDatabase::setBatchExtractor(const std::string& tableName, TableStore::BatchExtractor extractor) {
     auto it = tables_.find(tableName);
     if (it == tables_.end()) {
@@ -425,6 +1182,109 @@ void FlatSQLDatabase::setBatchExtractor(const std::string& tableName, TableStore
     }
 }
 
+void FlatSQLDatabase::setVectorsInPlace(const std::string& tableName, bool enabled) {
+    auto it = tables_.find(tableName);
+    if (it == tables_.end()) {
+        throw std::runtime_error("Table not found: " + tableName);
+    }
+    it->second->setVectorsInPlace(enabled);
+
+    // A registered table's vector indexes may have changed kind
+    if (sqliteRegisteredTables_.count(tableName)) {
+        sqliteEngine_->setIndexes(tableName, sqliteIndexMap(it->second.get()), enabled);
+    }
+}
+
+void FlatSQLDatabase::setIndexLayout(const std::string& tableName, const std::string& column, IndexLayout layout) {
+    auto it = tables_.find(tableName);
+    if (it == tables_.end()) {
+        throw std::runtime_error("Table not found: " + tableName);
+    }
+    it->second->setIndexLayout(column, layout);
+
+    // The engine holds the replaced index
+    if (sqliteRegisteredTables_.count(tableName)) {
+        sqliteEngine_->setIndexes(tableName, sqliteIndexMap(it->second.get()),
+                                  it->second->getVectorsInPlace());
+    }
+}
+
+void FlatSQLDatabase::createSpatialIndex(const std::string& tableName,
+                                         const std::string& latColumn,
+                                         const std::string& lonColumn) {
+    auto it = tables_.find(tableName);
+    if (it == tables_.end()) {
+        throw std::runtime_error("Table not found: " + tableName);
+    }
+
+    SpatialIndex* index = it->second->createSpatialIndex(latColumn, lonColumn);
+
+    // Tables registered earlier need their virtual table reconnected
+    if (sqliteRegisteredTables_.count(tableName)) {
+        sqliteEngine_->setSpatialIndex(tableName, index);
+    }
+}
+
+void FlatSQLDatabase::createLearnedIndex(const std::string& tableName, const std::string& column) {
+    auto it = tables_.find(tableName);
+    if (it == tables_.end()) {
+        throw std::runtime_error("Table not found: " + tableName);
+    }
+
+    LearnedIndex* index = it->second->createLearnedIndex(column);
+
+    if (sqliteRegisteredTables_.count(tableName)) {
+        sqliteEngine_->setLearnedIndex(tableName, column, index);
+    }
+}
+
+void FlatSQLDatabase::createRadixIndex(const std::string& tableName, const std::string& column) {
+    auto it = tables_.find(tableName);
+    if (it == tables_.end()) {
+        throw std::runtime_error("Table not found: " + tableName);
+    }
+
+    RadixIndex* index = it->second->createRadixIndex(column);
+
+    if (sqliteRegisteredTables_.count(tableName)) {
+        sqliteEngine_->setRadixIndex(tableName, column, index);
+    }
+}
+
+std::vector<StoredRecord> FlatSQLDatabase::findWithinRadius(const std::string& tableName,
+                                                             const std::string& latColumn,
+                                                             const std::string& lonColumn,
+                                                             double lat, double lon, double radiusKm) {
+    auto it = tables_.find(tableName);
+    if (it == tables_.end()) {
+        return {};
+    }
+    return it->second->findWithinRadius(latColumn, lonColumn, lat, lon, radiusKm);
+}
+
+std::vector<StoredRecord> FlatSQLDatabase::findInBox(const std::string& tableName,
+                                                      const std::string& latColumn,
+                                                      const std::string& lonColumn,
+                                                      double minLat, double maxLat,
+                                                      double minLon, double maxLon) {
+    auto it = tables_.find(tableName);
+    if (it == tables_.end()) {
+        return {};
+    }
+    return it->second->findInBox(latColumn, lonColumn, minLat, maxLat, minLon, maxLon);
+}
+
+size_t FlatSQLDatabase::countWithinRadius(const std::string& tableName,
+                                          const std::string& latColumn,
+                                          const std::string& lonColumn,
+                                          double lat, double lon, double radiusKm) {
+    auto it = tables_.find(tableName);
+    if (it == tables_.end()) {
+        return 0;
+    }
+    return it->second->countWithinRadius(latColumn, lonColumn, lat, lon, radiusKm);
+}
+
 std::vector<std::string> FlatSQLDatabase::listTables() const {
     std::vector<std::string> names;
     for (const auto& [name, _] : tables_) {
@@ -449,6 +1309,43 @@ std::vector<FlatSQLDatabase::TableStats> FlatSQLDatabase::getStats() const {
         ts.fileId = store->getFileId();
         ts.recordCount = store->getRecordCount();
         ts.indexes = store->getIndexNames();
+        for (const auto& [indexName, index] : store->getIndexList()) {
+            IndexStats is;
+            is.name = indexName;
+            is.compact = index->getLayout() == IndexLayout::Compact;
+            is.entryCount = index->getEntryCount();
+            is.storageBytes = index->getStorageBytes();
+            if (is.entryCount > 0) {
+                is.bytesPerEntry = static_cast<double>(is.storageBytes) / static_cast<double>(is.entryCount);
+            }
+            ts.indexStats.push_back(is);
+        }
+        for (const auto& col : store->getTableDef().columns) {
+            const LearnedIndex* index = store->getLearnedIndex(col.name);
+            if (!index) continue;
+            IndexStats is;
+            is.name = col.name;
+            is.learned = true;
+            is.entryCount = index->getEntryCount();
+            is.storageBytes = index->getMemoryBytes();
+            if (is.entryCount > 0) {
+                is.bytesPerEntry = static_cast<double>(is.storageBytes) / static_cast<double>(is.entryCount);
+            }
+            ts.indexStats.push_back(is);
+        }
+        for (const auto& col : store->getTableDef().columns) {
+            const RadixIndex* index = store->getRadixIndex(col.name);
+            if (!index) continue;
+            IndexStats is;
+            is.name = col.name;
+            is.radix = true;
+            is.entryCount = index->getEntryCount();
+            is.storageBytes = index->getMemoryBytes();
+            if (is.entryCount > 0) {
+                is.bytesPerEntry = static_cast<double>(is.storageBytes) / static_cast<double>(is.entryCount);
+            }
+            ts.indexStats.push_back(is);
+        }
         stats.push_back(ts);
     }
     return stats;
@@ -495,6 +1392,12 @@ void FlatSQLDatabase::createSourceTable(const std::string& baseTableName, const
         sourceFileIdToTable_[sourceKey] = sourceTableName;
         tables_[sourceTableName]->setFileId(fileId);
 
+        tables_[sourceTableName]->setVectorsInPlace(baseIt->second->getVectorsInPlace());
+        for (const auto& col : baseDef.columns) {
+            IndexLayout layout = baseIt->second->getIndexLayout(col.name);
+            if (layout != IndexLayout::Rows) tables_[sourceTableName]->setIndexLayout(col.name, layout);
+        }
+
         // Copy field extractor from base table
         auto extractor = baseIt->second->getFieldExtractor();
         if (extractor) {
@@ -560,20 +1463,34 @@ void FlatSQLDatabase::onIngestWithSource(std::string_view fileId, const uint8_t*
 size_t FlatSQLDatabase::ingestWithSource(const uint8_t* data, size_t length,
                                           const std::string& source,
                                           size_t* recordsIngested) {
-    return storage_.ingest(data, length,
+    uint64_t logAfter = storage_.getLastSequence();
+    size_t consumed = ingestVerified(data, length, recordsIngested,
         [this, &source](std::string_view fileId, const uint8_t* data, size_t len,
                uint64_t seq, uint64_t offset) {
             onIngestWithSource(fileId, data, len, seq, offset, source);
-        }, recordsIngested);
+        });
+    logStored(logAfter);
+    return consumed;
 }
 
 uint64_t FlatSQLDatabase::ingestOneWithSource(const uint8_t* flatbuffer, size_t length,
                                                const std::string& source) {
-    return storage_.ingestFlatBuffer(flatbuffer, length,
+    if (verifyIngest_) {
+        const TableStore* table = tableForRecord(flatbuffer, length);
+        rejectedRecords_.clear();
+        if (table && !table->verifyRecord(flatbuffer, length)) {
+            rejectedRecords_.push_back(0);
+            throw std::runtime_error("Record failed verification for table " + table->getTableDef().name);
+        }
+    }
+    uint64_t logAfter = storage_.getLastSequence();
+    uint64_t sequence = storage_.ingestFlatBuffer(flatbuffer, length,
         [this, &source](std::string_view fileId, const uint8_t* data, size_t len,
                uint64_t seq, uint64_t offset) {
             onIngestWithSource(fileId, data, len, seq, offset, source);
         });
+    logStored(logAfter);
+    return sequence;
 }
 
 // Legacy multi-source API (external storage)
@@ -606,8 +1523,32 @@ void FlatSQLDatabase::createUnifiedView(
 
 // ==================== Delete Support ====================
 
+// Tombstone frame: a control frame ("FSQT") holding the 8-byte LE sequence
+// and the table name
+static void encodeTombstone(uint64_t sequence, const std::string& tableName, std::vector<uint8_t>& frame) {
+    uint32_t size = controlFramePrefix(8 + tableName.size());
+    frame.assign(frameLength(size), 0);
+    for (int i = 0; i < 4; i++) frame[i] = static_cast<uint8_t>(size >> (8 * i));
+    std::memcpy(frame.data() + 8, FlatSQLDatabase::TOMBSTONE_FILE_ID, 4);
+    for (int i = 0; i < 8; i++) frame[12 + i] = static_cast<uint8_t>(sequence >> (8 * i));
+    std::memcpy(frame.data() + 20, tableName.data(), tableName.size());
+}
+
 void FlatSQLDatabase::markDeleted(const std::string& tableName, uint64_t sequence) {
     sqliteEngine_->markDeleted(tableName, sequence);
+    auto table = std::find(deleteLogTables_.begin(), deleteLogTables_.end(), tableName);
+    if (table == deleteLogTables_.end()) {
+        table = deleteLogTables_.insert(table, tableName);
+    }
+    deleteLog_.push_back({storage_.getLastSequence(), sequence,
+                          static_cast<uint32_t>(table - deleteLogTables_.begin())});
+
+    if (appendLog_) {
+        std::vector<uint8_t> frame;
+        encodeTombstone(sequence, tableName, frame);
+        appendLog_->append(frame.data(), frame.size());
+        appendLog_->commitBatch();
+    }
 }
 
 size_t FlatSQLDatabase::getDeletedCount(const std::string& tableName) const {
@@ -618,6 +1559,467 @@ void FlatSQLDatabase::clearTombstones(const std::string& tableName) {
     sqliteEngine_->clearTombstones(tableName);
 }
 
+// ==================== Storage Layout ====================
+
+// Cluster key order: compareValues, with NaN (which compares equal to every
+// number there) after all other values and equal to itself
+static int compareClusterValues(const Value& a, const Value& b) {
+    auto isNaN = [](const Value& v) {
+        if (auto* f = std::get_if<float>(&v)) return std::isnan(*f);
+        if (auto* d = std::get_if<double>(&v)) return std::isnan(*d);
+        return false;
+    };
+    bool aNaN = isNaN(a), bNaN = isNaN(b);
+    if (aNaN || bNaN) return aNaN == bNaN ? 0 : (aNaN ? 1 : -1);
+    return compareValues(a, b);
+}
+
+void FlatSQLDatabase::setClusteredStorage(const std::string& tableName, size_t segmentBytes) {
+    auto it = tables_.find(tableName);
+    if (it == tables_.end()) {
+        throw std::runtime_error("Table not found: " + tableName);
+    }
+    if (it->second->getFileId().empty()) {
+        throw std::runtime_error("Table has no file ID: " + tableName);
+    }
+    storage_.setClustered(it->second->getFileId(), segmentBytes);
+}
+
+void FlatSQLDatabase::reorganizeStorage(const std::map<std::string, std::vector<std::string>>& clusterKeys) {
+    for (const auto& [tableName, columns] : clusterKeys) {
+        auto it = tables_.find(tableName);
+        if (it == tables_.end()) {
+            throw std::runtime_error("Table not found: " + tableName);
+        }
+        if (!it->second->getFieldExtractor()) {
+            throw std::runtime_error("Clustering requires a field extractor: " + tableName);
+        }
+        for (const auto& column : columns) {
+            if (it->second->getTableDef().getColumnIndex(column) < 0) {
+                throw std::runtime_error("Column not found: " + tableName + "." + column);
+            }
+        }
+    }
+
+    // Each table's records, in their new order
+    std::map<std::string, std::vector<uint64_t>> tableOrder;
+    std::vector<uint8_t> held(static_cast<size_t>(storage_.getLastSequence()) + 1, 0);
+    for (const auto& [tableName, table] : tables_) {
+        std::vector<uint64_t>& sequences = tableOrder[tableName];
+        for (const auto& info : table->getRecordInfos()) {
+            held[info.sequence] = 1;
+            sequences.push_back(info.sequence);
+        }
+
+        auto keyIt = clusterKeys.find(tableName);
+        if (keyIt == clusterKeys.end() || keyIt->second.empty()) {
+            std::sort(sequences.begin(), sequences.end());
+            continue;
+        }
+        auto extractor = table->getFieldExtractor();
+        std::vector<std::pair<std::vector<Value>, uint64_t>> keyed;
+        keyed.reserve(sequences.size());
+        for (uint64_t sequence : sequences) {
+            uint32_t length = 0;
+            const uint8_t* data = storage_.getDataAtOffset(*storage_.getOffsetForSequence(sequence), &length);
+            std::vector<Value> key;
+            for (const auto& column : keyIt->second) {
+                key.push_back(extractor(data, length, column));
+            }
+            keyed.push_back({std::move(key), sequence});
+        }
+        std::sort(keyed.begin(), keyed.end(), [](const auto& a, const auto& b) {
+            for (size_t i = 0; i < a.first.size(); i++) {
+                int cmp = compareClusterValues(a.first[i], b.first[i]);
+                if (cmp != 0) return cmp < 0;
+            }
+            return a.second < b.second;
+        });
+        for (size_t i = 0; i < keyed.size(); i++) {
+            sequences[i] = keyed[i].second;
+        }
+    }
+
+    std::vector<uint64_t> order;
+    order.reserve(storage_.getRecordCount());
+    for (const auto& [tableName, sequences] : tableOrder) {
+        order.insert(order.end(), sequences.begin(), sequences.end());
+    }
+    for (uint64_t sequence = 1; sequence < held.size(); sequence++) {
+        if (!held[sequence] && storage_.hasRecord(sequence)) {
+            order.push_back(sequence);
+        }
+    }
+    storage_.relocate(order);
+
+    // Index the records at their new offsets
+    for (const auto& [tableName, sequences] : tableOrder) {
+        TableStore* table = tables_.at(tableName).get();
+        table->clearRecords();
+        for (uint64_t sequence : sequences) {
+            uint64_t offset = *storage_.getOffsetForSequence(sequence);
+            uint32_t length = 0;
+            const uint8_t* data = storage_.getDataAtOffset(offset, &length);
+            table->onIngest(data, length, sequence, offset);
+        }
+    }
+}
+
+// ==================== Change Feed ====================
+
+// Write all of buffer to fd, retrying short and interrupted writes
+static void writeAll(int fd, const uint8_t* buffer, size_t length) {
+    while (length > 0) {
+        ssize_t n = ::write(fd, buffer, length);
+        if (n < 0) {
+            if (errno == EINTR) continue;
+            throw std::runtime_error(std::string("Change feed write failed: ") + std::strerror(errno));
+        }
+        buffer += n;
+        length -= static_cast<size_t>(n);
+    }
+}
+
+
+// Passes whole size-prefixed frames through to a sink, adding checksum
+// frames when blockSize > 0: an empty leading block, then one closing each
+// block at the first frame boundary past blockSize bytes
+class ChecksumFramer {
+public:
+    using Sink = std::function<void(const uint8_t*, size_t)>;
+
+    ChecksumFramer(size_t blockSize, Sink sink) : blockSize_(blockSize), sink_(std::move(sink)) {
+        if (blockSize_ > 0) closeBlock();
+    }
+
+    void write(const uint8_t* frames, size_t length) {
+        if (blockSize_ == 0) {
+            sink_(frames, length);
+            return;
+        }
+        while (length > 0) {
+            size_t take = 0;
+            while (take < length && blockBytes_ + take < blockSize_) {
+                take += frameLength(readLE32(frames + take));
+            }
+            crc_ = crc32c(frames, take, crc_);
+            sink_(frames, take);
+            blockBytes_ += take;
+            frames += take;
+            length -= take;
+            if (blockBytes_ >= blockSize_) closeBlock();
+        }
+    }
+
+    // Close the last block
+    void finish() {
+        if (blockSize_ > 0 && blockBytes_ > 0) closeBlock();
+    }
+
+private:
+    void closeBlock() {
+        uint8_t frame[16] = {};
+        uint32_t prefix = controlFramePrefix(4);
+        for (int i = 0; i < 4; i++) frame[i] = static_cast<uint8_t>(prefix >> (8 * i));
+        std::memcpy(frame + 8, FlatSQLDatabase::CHECKSUM_FILE_ID, 4);
+        for (int i = 0; i < 4; i++) frame[12 + i] = static_cast<uint8_t>(crc_ >> (8 * i));
+        sink_(frame, sizeof(frame));
+        crc_ = 0;
+        blockBytes_ = 0;
+    }
+
+    size_t blockSize_;
+    Sink sink_;
+    uint32_t crc_ = 0;
+    size_t blockBytes_ = 0;
+};
+
+// Check every block of a checksummed stream against the checksum frame
+// closing it, spreading blocks across threads. Returns the end of the last
+// checksum frame; bytes after it are unchecked.
+static size_t verifyChecksumBlocks(const uint8_t* data, size_t length) {
+    struct Block {
+        size_t begin;
+        size_t end;
+        uint32_t expected;
+    };
+    std::vector<Block> blocks;
+    size_t pos = 0;
+    size_t blockStart = 0;
+    while (pos + 4 <= length) {
+        uint32_t size = readLE32(data + pos);
+        if (pos + frameLength(size) > length) break;
+        if (isChecksumFrame(data + pos)) {
+            blocks.push_back({blockStart, pos, readLE32(data + pos + 12)});
+            blockStart = pos + frameLength(size);
+        }
+        pos += frameLength(size);
+    }
+
+    std::vector<uint8_t> valid(blocks.size(), 0);
+    auto work = [&](size_t first, size_t stride) {
+        for (size_t i = first; i < blocks.size(); i += stride) {
+            const Block& b = blocks[i];
+            valid[i] = crc32c(data + b.begin, b.end - b.begin) == b.expected;
+        }
+    };
+#if defined(__EMSCRIPTEN__) && !defined(__EMSCRIPTEN_PTHREADS__)
+    work(0, 1);
+#else
+    // Not worth a thread for less than ~4 MB; blocks are about the same size
+    size_t workers = std::min<size_t>({std::max(1u, std::thread::hardware_concurrency()),
+                                       std::max<size_t>(1, blockStart / (4 * 1024 * 1024)),
+                                       std::max<size_t>(1, blocks.size())});
+    std::vector<std::thread> pool;
+    for (size_t w = 1; w < workers; w++) {
+        pool.emplace_back(work, w, workers);
+    }
+    work(0, workers);
+    for (auto& thread : pool) thread.join();
+#endif
+
+    for (size_t i = 0; i < blocks.size(); i++) {
+        if (!valid[i]) {
+            throw std::runtime_error("Checksum mismatch in stream block at byte " +
+                                     std::to_string(blocks[i].begin));
+        }
+    }
+    return blockStart;
+}
+
+std::vector<uint8_t> FlatSQLDatabase::exportData() const {
+    if (checksumBlockSize_ == 0) {
+        return storage_.exportData();
+    }
+    std::vector<uint8_t> out;
+    out.reserve(static_cast<size_t>(storage_.getWriteOffset()) +
+                16 * (static_cast<size_t>(storage_.getWriteOffset()) / checksumBlockSize_ + 2));
+    ChecksumFramer framer(checksumBlockSize_, [&](const uint8_t* bytes, size_t length) {
+        out.insert(out.end(), bytes, bytes + length);
+    });
+    storage_.visitRecords(0, storage_.getLastSequence(), [&](const uint8_t* bytes, size_t length) {
+        framer.write(bytes, length);
+    });
+    framer.finish();
+    return out;
+}
+
+uint64_t FlatSQLDatabase::exportSince(uint64_t since, int fd) const {
+    // Large runs go straight from storage; the single records a clustered
+    // store yields are gathered into larger writes
+    constexpr size_t WRITE_BYTES = 64 * 1024;
+    std::vector<uint8_t> pending;
+    uint64_t watermark = writeChanges(since, [&](const uint8_t* bytes, size_t length) {
+        if (length >= WRITE_BYTES && pending.empty()) {
+            writeAll(fd, bytes, length);
+            return;
+        }
+        pending.insert(pending.end(), bytes, bytes + length);
+        if (pending.size() >= WRITE_BYTES) {
+            writeAll(fd, pending.data(), pending.size());
+            pending.clear();
+        }
+    });
+    writeAll(fd, pending.data(), pending.size());
+    return watermark;
+}
+
+uint64_t FlatSQLDatabase::exportSince(uint64_t since, std::vector<uint8_t>& out) const {
+    return writeChanges(since, [&](const uint8_t* bytes, size_t length) {
+        out.insert(out.end(), bytes, bytes + length);
+    });
+}
+
+uint64_t FlatSQLDatabase::writeChanges(uint64_t since,
+                                       const std::function<void(const uint8_t*, size_t)>& sink) const {
+    if (since < deleteLogStart_) {
+        throw std::runtime_error("Change feed trimmed: deletes before sequence " +
+                                 std::to_string(deleteLogStart_) + " are gone");
+    }
+    uint64_t last = storage_.getLastSequence();
+    ChecksumFramer framer(checksumBlockSize_, sink);
+
+    uint64_t written = since;
+    auto writeRecords = [&](uint64_t to) {
+        if (to <= written) return;
+        storage_.visitRecords(written, to, [&](const uint8_t* bytes, size_t length) {
+            framer.write(bytes, length);
+        });
+        written = to;
+    };
+
+    auto event = std::lower_bound(deleteLog_.begin(), deleteLog_.end(), since,
+        [](const DeleteEvent& e, uint64_t watermark) { return e.watermark < watermark; });
+    if (last > since || event != deleteLog_.end()) {
+        // The replica checks the feed continues from its last sequence
+        uint8_t base[20] = {};
+        uint32_t prefix = controlFramePrefix(8);
+        for (int i = 0; i < 4; i++) base[i] = static_cast<uint8_t>(prefix >> (8 * i));
+        std::memcpy(base + 8, SEQUENCE_FILE_ID, 4);
+        for (int i = 0; i < 8; i++) base[12 + i] = static_cast<uint8_t>(since >> (8 * i));
+        framer.write(base, sizeof(base));
+    }
+    std::vector<uint8_t> frame;
+    for (; event != deleteLog_.end(); ++event) {
+        writeRecords(event->watermark);
+        encodeTombstone(event->sequence, deleteLogTables_[event->table], frame);
+        framer.write(frame.data(), frame.size());
+    }
+    writeRecords(last);
+    framer.finish();
+    return written;
+}
+
+void FlatSQLDatabase::trimChangeFeed(uint64_t watermark) {
+    if (watermark <= deleteLogStart_) return;
+    // Deletes stamped with the watermark itself are still sent from it
+    auto keep = std::lower_bound(deleteLog_.begin(), deleteLog_.end(), watermark,
+        [](const DeleteEvent& e, uint64_t w) { return e.watermark < w; });
+    deleteLog_.erase(deleteLog_.begin(), keep);
+    deleteLogStart_ = watermark;
+}
+
+size_t FlatSQLDatabase::applyChanges(const uint8_t* data, size_t length, size_t* recordsIngested) {
+    // Once a feed has carried checksums, only verified blocks are applied;
+    // the rest waits for the checksum frame closing it
+    if (length >= 16 && isChecksumFrame(data)) {
+        checksummedFeed_ = true;
+    }
+    if (checksummedFeed_) {
+        length = verifyChecksumBlocks(data, length);
+    }
+    return applyFrames(data, length, recordsIngested);
+}
+
+size_t FlatSQLDatabase::applyFrames(const uint8_t* data, size_t length, size_t* recordsIngested) {
+    initializeSQLiteEngine();
+
+    // Index inserts for the whole feed share one transaction instead of
+    // committing per record
+    sqlite3* db = sqliteEngine_->getDb();
+    bool ownTransaction = sqlite3_get_autocommit(db) != 0;
+    if (ownTransaction) {
+        sqlite3_exec(db, "BEGIN", nullptr, nullptr, nullptr);
+    }
+
+    size_t consumed = 0;
+    size_t records = 0;
+    size_t runStart = 0;  // Start of the records not yet ingested
+    size_t runRecords = 0;
+    bool sequenced = false;  // After a sequence frame, every record must be stored
+    auto flushRecords = [&](size_t runEnd) {
+        if (runEnd > runStart) {
+            uint64_t expected = storage_.getLastSequence() + runRecords;
+            size_t ingested = 0;
+            ingest(data + runStart, runEnd - runStart, &ingested);
+            records += ingested;
+            if (sequenced && storage_.getLastSequence() != expected) {
+                throw std::runtime_error("Change feed records were not all stored: at sequence " +
+                                         std::to_string(storage_.getLastSequence()) +
+                                         ", expected " + std::to_string(expected));
+            }
+        }
+        runRecords = 0;
+    };
+
+    try {
+        while (consumed + 4 <= length) {
+            uint32_t size = readLE32(data + consumed);
+            if (consumed + frameLength(size) > length) break;
+
+            // Padding frames stay in record runs; ingest skips them
+            const uint8_t* frame = data + consumed;
+            if (isControlFrame(frame, TOMBSTONE_FILE_ID) &&
+                frameLength(size) >= SIZE_PREFIX_LENGTH + CONTROL_FRAME_HEADER_LENGTH + 8) {
+                flushRecords(consumed);
+                const uint8_t* payload = frame + SIZE_PREFIX_LENGTH + CONTROL_FRAME_HEADER_LENGTH;
+                uint64_t sequence = 0;
+                for (int i = 0; i < 8; i++) sequence |= static_cast<uint64_t>(payload[i]) << (8 * i);
+                markDeleted(std::string(reinterpret_cast<const char*>(payload + 8),
+                                        frame + frameLength(size) - (payload + 8)), sequence);
+                runStart = consumed + frameLength(size);
+            } else if (isControlFrame(frame, SEQUENCE_FILE_ID, 8)) {
+                flushRecords(consumed);
+                uint64_t base = 0;
+                for (int i = 0; i < 8; i++) base |= static_cast<uint64_t>(frame[12 + i]) << (8 * i);
+                if (base != storage_.getLastSequence()) {
+                    throw std::runtime_error("Change feed continues from sequence " + std::to_string(base) +
+                                             ", but this database is at " +
+                                             std::to_string(storage_.getLastSequence()));
+                }
+                sequenced = true;
+                runStart = consumed + frameLength(size);
+            } else if (isChecksumFrame(frame)) {
+                flushRecords(consumed);
+                runStart = consumed + frameLength(size);
+            } else if (!(size & PADDING_FRAME_FLAG)) {
+                runRecords++;
+            }
+            consumed += frameLength(size);
+        }
+        flushRecords(consumed);
+    } catch (...) {
+        // Storage can't take back what was ingested, so keep the index entries too
+        if (ownTransaction) {
+            sqlite3_exec(db, "COMMIT", nullptr, nullptr, nullptr);
+        }
+        throw;
+    }
+
+    if (ownTransaction) {
+        sqlite3_exec(db, "COMMIT", nullptr, nullptr, nullptr);
+    }
+    if (recordsIngested) {
+        *recordsIngested = records;
+    }
+    return consumed;
+}
+
+// ==================== Append Log ====================
+
+void FlatSQLDatabase::openAppendLog(const std::string& path, const AppendLogOptions& options) {
+    if (appendLog_) {
+        throw std::runtime_error("An append log is already open: " + appendLog_->getPath());
+    }
+    if (storage_.getRecordCount() > 0 || !deleteLog_.empty() || deleteLogStart_ > 0) {
+        throw std::runtime_error("openAppendLog must be called before ingesting");
+    }
+
+    std::vector<uint8_t> changes = AppendLog::recover(path);
+    applyChanges(changes.data(), changes.size());
+    appendLog_ = std::make_unique<AppendLog>(path, options);
+}
+
+void FlatSQLDatabase::syncAppendLog() {
+    if (appendLog_) {
+        appendLog_->sync();
+    }
+}
+
+void FlatSQLDatabase::closeAppendLog() {
+    if (appendLog_) {
+        appendLog_->sync();
+        appendLog_.reset();
+    }
+}
+
+void FlatSQLDatabase::logStored(uint64_t afterSequence) {
+    if (!appendLog_) return;
+    // One run unless file IDs are clustered
+    std::vector<std::pair<const uint8_t*, size_t>> runs;
+    storage_.visitRecords(afterSequence, storage_.getLastSequence(), [&](const uint8_t* bytes, size_t length) {
+        runs.push_back({bytes, length});
+    });
+    if (runs.size() == 1) {
+        appendLog_->append(runs[0].first, runs[0].second);
+    } else if (runs.size() > 1) {
+        std::vector<uint8_t> frame;
+        for (const auto& [bytes, length] : runs) frame.insert(frame.end(), bytes, bytes + length);
+        appendLog_->append(frame.data(), frame.size());
+    }
+    appendLog_->commitBatch();
+}
+
 // ==================== Encryption ====================
 
 void FlatSQLDatabase::setEncryptionKey(const uint8_t* key, size_t keySize) {
@@ -0,0 +1,265 @@
+#include "flatsql/flatbuffer_access.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+namespace flatsql {
+
+static uint32_t readU32(const uint8_t* p) {
+    uint32_t v;
+    std::memcpy(&v, p, 4);
+    return v;
+}
+
+bool fbRootFieldPosition(const uint8_t* data, size_t length, uint16_t fieldId, uint32_t& pos) {
+    if (length < 8) return false;
+    uint32_t root = readU32(data);
+    if (static_cast<uint64_t>(root) + 4 > length) return false;
+    int32_t vtableDelta;
+    std::memcpy(&vtableDelta, data + root, 4);
+    int64_t vtable = static_cast<int64_t>(root) - vtableDelta;
+    if (vtable < 0 || static_cast<uint64_t>(vtable) + 4 > length) return false;
+    uint16_t vtableSize;
+    std::memcpy(&vtableSize, data + vtable, 2);
+    if (static_cast<uint64_t>(vtable) + vtableSize > length) return false;
+
+    uint32_t slot = 4 + 2u * fieldId;
+    uint16_t fieldOffset = 0;
+    if (slot + 2 <= vtableSize) std::memcpy(&fieldOffset, data + vtable + slot, 2);
+    pos = fieldOffset == 0 ? 0 : root + fieldOffset;
+    return true;
+}
+
+size_t fbVectorElementSize(ValueType type) {
+    switch (type) {
+        case ValueType::Bool:
+        case ValueType::Int8:
+        case ValueType::UInt8:   return 1;
+        case ValueType::Int16:
+        case ValueType::UInt16:  return 2;
+        case ValueType::Int32:
+        case ValueType::UInt32:
+        case ValueType::Float32:
+        case ValueType::String:  return 4;  // Offset to the string
+        case ValueType::Int64:
+        case ValueType::UInt64:
+        case ValueType::Float64: return 8;
+        default:                 return 0;
+    }
+}
+
+bool FbVectorView::open(const uint8_t* data, size_t length, uint16_t fieldId, ValueType elementType) {
+    data_ = data;
+    length_ = length;
+    elements_ = 0;
+    count_ = 0;
+    type_ = elementType;
+
+    size_t elementSize = fbVectorElementSize(elementType);
+    uint32_t pos;
+    if (elementSize == 0 || !fbRootFieldPosition(data, length, fieldId, pos)) return false;
+    if (pos == 0) return true;
+    if (static_cast<uint64_t>(pos) + 4 > length) return false;
+
+    uint64_t vector = static_cast<uint64_t>(pos) + readU32(data + pos);
+    if (vector + 4 > length) return false;
+    uint32_t count = readU32(data + vector);
+    if (vector + 4 + static_cast<uint64_t>(count) * elementSize > length) return false;
+
+    elements_ = static_cast<uint32_t>(vector + 4);
+    count_ = count;
+    return true;
+}
+
+bool FbVectorView::stringAt(uint32_t i, const char*& str, uint32_t& len) const {
+    if (type_ != ValueType::String || i >= count_) return false;
+    uint64_t slot = static_cast<uint64_t>(elements_) + 4ull * i;
+    uint64_t pos = slot + readU32(data_ + slot);
+    if (pos + 4 > length_) return false;
+    len = readU32(data_ + pos);
+    if (pos + 4 + len > length_) return false;
+    str = reinterpret_cast<const char*>(data_ + pos + 4);
+    return true;
+}
+
+template <typename T>
+static T readElement(const uint8_t* p) {
+    T v;
+    std::memcpy(&v, p, sizeof(T));
+    return v;
+}
+
+Value FbVectorView::at(uint32_t i) const {
+    if (i >= count_) return std::monostate{};
+    const uint8_t* p = data_ + elements_ + fbVectorElementSize(type_) * i;
+    switch (type_) {
+        case ValueType::Bool:    return *p != 0;
+        case ValueType::Int8:    return readElement<int8_t>(p);
+        case ValueType::UInt8:   return readElement<uint8_t>(p);
+        case ValueType::Int16:   return readElement<int16_t>(p);
+        case ValueType::UInt16:  return readElement<uint16_t>(p);
+        case ValueType::Int32:   return readElement<int32_t>(p);
+        case ValueType::UInt32:  return readElement<uint32_t>(p);
+        case ValueType::Int64:   return readElement<int64_t>(p);
+        case ValueType::UInt64:  return readElement<uint64_t>(p);
+        case ValueType::Float32: return readElement<float>(p);
+        case ValueType::Float64: return readElement<double>(p);
+        case ValueType::String: {
+            const char* str;
+            uint32_t len;
+            if (!stringAt(i, str, len)) return std::monostate{};
+            return std::string(str, len);
+        }
+        default:
+            return std::monostate{};
+    }
+}
+
+static void appendJsonString(std::string& out, const char* str, uint32_t len) {
+    static const char HEX[] = "0123456789abcdef";
+    out += '"';
+    for (uint32_t i = 0; i < len; i++) {
+        unsigned char c = static_cast<unsigned char>(str[i]);
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += static_cast<char>(c);
+        } else if (c < 0x20) {
+            out += "\\u00";
+            out += HEX[c >> 4];
+            out += HEX[c & 0xF];
+        } else {
+            out += static_cast<char>(c);
+        }
+    }
+    out += '"';
+}
+
+std::string FbVectorView::toJson() const {
+    std::string out = "[";
+    char buf[32];
+    for (uint32_t i = 0; i < count_; i++) {
+        if (i > 0) out += ',';
+        if (type_ == ValueType::String) {
+            const char* str;
+            uint32_t len;
+            if (stringAt(i, str, len)) {
+                appendJsonString(out, str, len);
+            } else {
+                out += "null";
+            }
+            continue;
+        }
+
+        Value v = at(i);
+        switch (v.index()) {
+            case 1: out += std::get<bool>(v) ? "true" : "false"; break;
+            case 2: out += std::to_string(std::get<int8_t>(v)); break;
+            case 3: out += std::to_string(std::get<int16_t>(v)); break;
+            case 4: out += std::to_string(std::get<int32_t>(v)); break;
+            case 5: out += std::to_string(std::get<int64_t>(v)); break;
+            case 6: out += std::to_string(std::get<uint8_t>(v)); break;
+            case 7: out += std::to_string(std::get<uint16_t>(v)); break;
+            case 8: out += std::to_string(std::get<uint32_t>(v)); break;
+            case 9: out += std::to_string(std::get<uint64_t>(v)); break;
+            case 10:
+            case 11: {
+                // JSON has no NaN or Infinity
+                double d = v.index() == 10 ? std::get<float>(v) : std::get<double>(v);
+                if (std::isfinite(d)) {
+                    std::snprintf(buf, sizeof(buf), v.index() == 10 ? "%.9g" : "%.17g", d);
+                    out += buf;
+                } else {
+                    out += "null";
+                }
+                break;
+            }
+            default: out += "null"; break;
+        }
+    }
+    out += ']';
+    return out;
+}
+
+// ==================== Verification ====================
+
+static uint16_t readU16(const uint8_t* p) {
+    uint16_t v;
+    std::memcpy(&v, p, 2);
+    return v;
+}
+
+// Bytes of a scalar field of this type inline in a table (0 if not a scalar)
+static size_t scalarSize(ValueType type) {
+    return type == ValueType::String ? 0 : fbVectorElementSize(type);
+}
+
+// Check the string or vector an offset field at pos points to. Elements
+// of elementSize bytes; strings need room for the NUL terminator.
+static bool verifyOffsetTarget(const uint8_t* data, size_t length, uint64_t pos,
+                               size_t elementSize, bool isString, bool checkTerminator,
+                               uint64_t& first, uint32_t& count) {
+    if (pos % 4 != 0 || pos + 4 > length) return false;
+    uint64_t target = pos + readU32(data + pos);
+    if (target % 4 != 0 || target + 4 > length) return false;
+    count = readU32(data + target);
+    first = target + 4;
+    uint64_t end = first + static_cast<uint64_t>(count) * elementSize + (isString ? 1 : 0);
+    if (end > length) return false;
+    return !(isString && checkTerminator && data[first + count] != 0);
+}
+
+bool fbVerifyRootTable(const uint8_t* data, size_t length, const TableDef& table) {
+    // Root offset, vtable and table bounds, as flatbuffers::Verifier checks them
+    if (length < 8) return false;
+    uint32_t root = readU32(data);
+    if (root % 4 != 0 || static_cast<uint64_t>(root) + 4 > length) return false;
+    int32_t vtableDelta;
+    std::memcpy(&vtableDelta, data + root, 4);
+    int64_t vtable = static_cast<int64_t>(root) - vtableDelta;
+    if (vtable < 0 || vtable % 2 != 0 || static_cast<uint64_t>(vtable) + 4 > length) return false;
+    uint16_t vtableSize = readU16(data + vtable);
+    uint16_t tableSize = readU16(data + vtable + 2);
+    if (vtableSize < 4 || vtableSize % 2 != 0 || static_cast<uint64_t>(vtable) + vtableSize > length) return false;
+    if (tableSize < 4 || static_cast<uint64_t>(root) + tableSize > length) return false;
+
+    for (const auto& col : table.columns) {
+        if (!col.slotKnown) continue;         // Slot unknown: see verifyRecord
+        uint32_t slot = 4 + 2u * col.fieldId;
+        if (slot + 2 > vtableSize) continue;  // Written by an older schema
+        uint16_t fieldOffset = readU16(data + vtable + slot);
+        if (fieldOffset == 0) continue;       // Absent: default value
+
+        uint64_t pos = static_cast<uint64_t>(root) + fieldOffset;
+        size_t inlineSize = col.isVector || col.type == ValueType::String || col.type == ValueType::Bytes
+            ? 4 : scalarSize(col.type);
+        if (inlineSize == 0) continue;
+        // Alignment is checked up to 4 bytes: FinishSizePrefixed() aligns 8-byte
+        // fields relative to the size prefix, not to the table's buffer
+        if (static_cast<uint64_t>(fieldOffset) + inlineSize > tableSize) return false;
+        if (pos % std::min<size_t>(inlineSize, 4) != 0) return false;
+
+        uint64_t first;
+        uint32_t count;
+        if (col.isVector) {
+            size_t elementSize = fbVectorElementSize(col.elementType);
+            if (elementSize == 0) continue;
+            if (!verifyOffsetTarget(data, length, pos, elementSize, false, false, first, count)) return false;
+            if (col.elementType == ValueType::String) {
+                for (uint32_t i = 0; i < count; i++) {
+                    uint64_t elementFirst;
+                    uint32_t elementCount;
+                    if (!verifyOffsetTarget(data, length, first + 4ull * i, 1, true, true,
+                                            elementFirst, elementCount)) return false;
+                }
+            }
+        } else if (col.type == ValueType::String) {
+            // Encrypted strings keep their length, not their terminator
+            if (!verifyOffsetTarget(data, length, pos, 1, true, !col.encrypted, first, count)) return false;
+        } else if (col.type == ValueType::Bytes) {
+            if (!verifyOffsetTarget(data, length, pos, 1, false, false, first, count)) return false;
+        }
+    }
+    return true;
+}
+
+}  // namespace flatsql
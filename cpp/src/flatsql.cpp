@@ -4,6 +4,7 @@
 #include <fstream>
 #include <vector>
 #include <cstring>
+#include <cstdio>
 
 #ifdef __EMSCRIPTEN__
 #include <emscripten/bind.h>
@@ -436,6 +437,17 @@ public:
                 indexes.call<void>("push", val(idx));
             }
             stat.set("indexes", indexes);
+            val indexStats = val::array();
+            for (const auto& is : s.indexStats) {
+                val entry = val::object();
+                entry.set("name", val(is.name));
+                entry.set("layout", val(is.learned ? "learned" : is.radix ? "radix" : is.compact ? "compact" : "rows"));
+                entry.set("entryCount", val(static_cast<double>(is.entryCount)));
+                entry.set("storageBytes", val(static_cast<double>(is.storageBytes)));
+                entry.set("bytesPerEntry", val(is.bytesPerEntry));
+                indexStats.call<void>("push", entry);
+            }
+            stat.set("indexStats", indexStats);
             result.call<void>("push", stat);
         }
         return result;
@@ -560,6 +572,10 @@ EMSCRIPTEN_BINDINGS(flatsql) {
 #else
 // Native build - CLI tool with stdin piping support
 
+#include <cstdlib>
+#include <fcntl.h>
+#include <unistd.h>
+
 namespace flatsql {
 
 void printUsage(const char* prog) {
@@ -571,8 +587,13 @@ void printUsage(const char* prog) {
               << "  --schema <file>     Schema file (IDL format)\n"
               << "  --map <id>=<table>  Map file identifier to table (repeatable)\n"
               << "  --query <sql>       SQL query to run after ingesting\n"
-              << "  --export <file>     Export storage to file after ingesting\n"
+              << "  --export <file>     Export storage to file after ingesting ('-' for stdout)\n"
+              << "  --since <sequence>  With --export, write only the changes after this\n"
+              << "                      sequence (records and tombstones); the new\n"
+              << "                      watermark is printed to stderr\n"
+              << "  --checksums         With --export, add CRC32C checksum frames\n"
               << "  --load <file>       Load existing storage file before stdin\n"
+              << "                      (checksummed files are verified)\n"
               << "  --stats             Print statistics after ingesting\n"
               << "  --help              Show this help\n"
               << "\n"
@@ -588,6 +609,9 @@ int runCLI(int argc, char* argv[]) {
     std::string querySQL;
     std::string exportFile;
     std::string loadFile;
+    bool exportChanges = false;
+    bool exportChecksums = false;
+    uint64_t exportSince = 0;
     std::vector<std::pair<std::string, std::string>> fileIdMappings;
     bool showStats = false;
 
@@ -612,6 +636,11 @@ int runCLI(int argc, char* argv[]) {
             querySQL = argv[++i];
         } else if (arg == "--export" && i + 1 < argc) {
             exportFile = argv[++i];
+        } else if (arg == "--since" && i + 1 < argc) {
+            exportChanges = true;
+            exportSince = std::strtoull(argv[++i], nullptr, 10);
+        } else if (arg == "--checksums") {
+            exportChecksums = true;
         } else if (arg == "--load" && i + 1 < argc) {
             loadFile = argv[++i];
         } else if (arg == "--stats") {
@@ -625,6 +654,12 @@ int runCLI(int argc, char* argv[]) {
         return 1;
     }
 
+    if (exportChanges && exportFile.empty()) {
+        std::cerr << "Error: --since requires --export\n";
+        printUsage(argv[0]);
+        return 1;
+    }
+
     // Read schema file
     std::ifstream schemaStream(schemaFile);
     if (!schemaStream) {
@@ -641,6 +676,9 @@ int runCLI(int argc, char* argv[]) {
     for (const auto& [fileId, tableName] : fileIdMappings) {
         db.registerFileId(fileId, tableName);
     }
+    if (exportChecksums) {
+        db.setExportChecksums();
+    }
 
     // Load existing data if specified
     if (!loadFile.empty()) {
@@ -651,7 +689,12 @@ int runCLI(int argc, char* argv[]) {
         }
         std::vector<uint8_t> loadData((std::istreambuf_iterator<char>(loadStream)),
                                        std::istreambuf_iterator<char>());
-        db.loadAndRebuild(loadData.data(), loadData.size());
+        try {
+            db.loadAndRebuild(loadData.data(), loadData.size());
+        } catch (const std::exception& e) {
+            std::cerr << "Load error: " << e.what() << "\n";
+            return 1;
+        }
         std::cerr << "Loaded " << loadData.size() << " bytes from " << loadFile << "\n";
     }
 
@@ -702,6 +745,12 @@ int runCLI(int argc, char* argv[]) {
                 }
             }
             std::cerr << "\n";
+            for (const auto& is : s.indexStats) {
+                char bytesPerEntry[32];
+                std::snprintf(bytesPerEntry, sizeof(bytesPerEntry), "%.1f", is.bytesPerEntry);
+                std::cerr << "    " << is.name << ": " << is.entryCount << " entries, "
+                          << bytesPerEntry << " bytes/entry (" << (is.learned ? "learned" : is.radix ? "radix" : is.compact ? "compact" : "rows") << ")\n";
+            }
         }
     }
 
@@ -744,6 +793,25 @@ int runCLI(int argc, char* argv[]) {
         }
     }
 
+    // Export changes after a watermark, streamed from storage
+    if (!exportFile.empty() && exportChanges) {
+        int fd = exportFile == "-" ? STDOUT_FILENO : ::open(exportFile.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0) {
+            std::cerr << "Error: Cannot open export file: " << exportFile << "\n";
+            return 1;
+        }
+        try {
+            uint64_t watermark = db.exportSince(exportSince, fd);
+            std::cerr << "Exported changes after " << exportSince << " up to " << watermark << "\n";
+        } catch (const std::exception& e) {
+            std::cerr << "Export error: " << e.what() << "\n";
+            if (fd != STDOUT_FILENO) ::close(fd);
+            return 1;
+        }
+        if (fd != STDOUT_FILENO) ::close(fd);
+        return 0;
+    }
+
     // Export if specified
     if (!exportFile.empty()) {
         std::vector<uint8_t> exportData = db.exportData();
@@ -395,6 +395,42 @@ int flatsql_export_size() {
     return static_cast<int>(g_exportBuffer.size());
 }
 
+// Change feed: exports the changes after `since` into the export buffer
+// (read with flatsql_export_buffer/flatsql_export_size). Returns the new
+// watermark, or -1 on error (see flatsql_get_error).
+EMSCRIPTEN_KEEPALIVE
+double flatsql_export_since(void* handle, double since) {
+    try {
+        g_exportBuffer.clear();
+        uint64_t watermark = static_cast<FlatSQLDatabase*>(handle)->exportSince(
+            static_cast<uint64_t>(since), g_exportBuffer);
+        g_lastError.clear();
+        return static_cast<double>(watermark);
+    } catch (const std::exception& e) {
+        g_exportBuffer.clear();
+        g_lastError = e.what();
+        return -1;
+    }
+}
+
+EMSCRIPTEN_KEEPALIVE
+const uint8_t* flatsql_export_buffer() {
+    return g_exportBuffer.data();
+}
+
+// Applies a change feed on a replica. Returns bytes consumed, or -1 on error.
+EMSCRIPTEN_KEEPALIVE
+double flatsql_apply_changes(void* handle, const uint8_t* data, size_t length) {
+    try {
+        size_t consumed = static_cast<FlatSQLDatabase*>(handle)->applyChanges(data, length);
+        g_lastError.clear();
+        return static_cast<double>(consumed);
+    } catch (const std::exception& e) {
+        g_lastError = e.what();
+        return -1;
+    }
+}
+
 EMSCRIPTEN_KEEPALIVE
 void flatsql_load_and_rebuild(void* handle, const uint8_t* data, size_t length) {
     static_cast<FlatSQLDatabase*>(handle)->loadAndRebuild(data, length);
@@ -1,11 +1,49 @@
 #include "flatsql/geo_functions.h"
+#include "flatsql/geo_polygon.h"
 #include <cmath>
+#include <cstring>
+#include <vector>
 
 namespace flatsql {
 
-static constexpr double EARTH_RADIUS_KM = 6371.0;
+static constexpr double EARTH_RADIUS_KM = GEO_EARTH_RADIUS_KM;
 static constexpr double DEG_TO_RAD = M_PI / 180.0;
 
+double geoHaversineKm(double lat1, double lon1, double lat2, double lon2) {
+    lat1 *= DEG_TO_RAD;
+    lon1 *= DEG_TO_RAD;
+    lat2 *= DEG_TO_RAD;
+    lon2 *= DEG_TO_RAD;
+
+    double dlat = lat2 - lat1;
+    double dlon = lon2 - lon1;
+    double a = sin(dlat / 2) * sin(dlat / 2) +
+               cos(lat1) * cos(lat2) * sin(dlon / 2) * sin(dlon / 2);
+    double c = 2 * atan2(sqrt(a), sqrt(1 - a));
+    return EARTH_RADIUS_KM * c;
+}
+
+// Copy a fixed-size geometry blob into a struct of doubles
+template <typename T>
+static bool geoBlobToStruct(sqlite3_value* value, T& out) {
+    if (sqlite3_value_type(value) != SQLITE_BLOB) return false;
+    if (sqlite3_value_bytes(value) != static_cast<int>(sizeof(T))) return false;
+    std::memcpy(&out, sqlite3_value_blob(value), sizeof(T));
+    return true;
+}
+
+bool geoPointFromValue(sqlite3_value* value, GeoPoint& out) {
+    return geoBlobToStruct(value, out);
+}
+
+bool geoCircleFromValue(sqlite3_value* value, GeoCircle& out) {
+    return geoBlobToStruct(value, out);
+}
+
+bool geoBoxFromValue(sqlite3_value* value, GeoBox& out) {
+    return geoBlobToStruct(value, out);
+}
+
 // Haversine distance between two lat/lon points (returns km)
 static void geoDistanceFunc(sqlite3_context* ctx, int argc, sqlite3_value** argv) {
     if (argc != 4) {
@@ -19,18 +57,10 @@ static void geoDistanceFunc(sqlite3_context* ctx, int argc, sqlite3_value** argv
         }
     }
 
-    double lat1 = sqlite3_value_double(argv[0]) * DEG_TO_RAD;
-    double lon1 = sqlite3_value_double(argv[1]) * DEG_TO_RAD;
-    double lat2 = sqlite3_value_double(argv[2]) * DEG_TO_RAD;
-    double lon2 = sqlite3_value_double(argv[3]) * DEG_TO_RAD;
-
-    double dlat = lat2 - lat1;
-    double dlon = lon2 - lon1;
-    double a = sin(dlat / 2) * sin(dlat / 2) +
-               cos(lat1) * cos(lat2) * sin(dlon / 2) * sin(dlon / 2);
-    double c = 2 * atan2(sqrt(a), sqrt(1 - a));
-
-    sqlite3_result_double(ctx, EARTH_RADIUS_KM * c);
+    sqlite3_result_double(ctx, geoHaversineKm(sqlite3_value_double(argv[0]),
+                                              sqlite3_value_double(argv[1]),
+                                              sqlite3_value_double(argv[2]),
+                                              sqlite3_value_double(argv[3])));
 }
 
 // Check if point is within bounding box
@@ -70,27 +100,155 @@ static void geoWithinRadiusFunc(sqlite3_context* ctx, int argc, sqlite3_value**
         }
     }
 
-    double lat1 = sqlite3_value_double(argv[0]) * DEG_TO_RAD;
-    double lon1 = sqlite3_value_double(argv[1]) * DEG_TO_RAD;
-    double lat2 = sqlite3_value_double(argv[2]) * DEG_TO_RAD;
-    double lon2 = sqlite3_value_double(argv[3]) * DEG_TO_RAD;
+    double distance = geoHaversineKm(sqlite3_value_double(argv[0]),
+                                     sqlite3_value_double(argv[1]),
+                                     sqlite3_value_double(argv[2]),
+                                     sqlite3_value_double(argv[3]));
     double radiusKm = sqlite3_value_double(argv[4]);
 
-    double dlat = lat2 - lat1;
-    double dlon = lon2 - lon1;
-    double a = sin(dlat / 2) * sin(dlat / 2) +
-               cos(lat1) * cos(lat2) * sin(dlon / 2) * sin(dlon / 2);
-    double c = 2 * atan2(sqrt(a), sqrt(1 - a));
-    double distance = EARTH_RADIUS_KM * c;
-
     sqlite3_result_int(ctx, distance <= radiusKm ? 1 : 0);
 }
 
+// geo_point(lat, lon) -> point blob
+static void geoPointFunc(sqlite3_context* ctx, int argc, sqlite3_value** argv) {
+    for (int i = 0; i < argc; i++) {
+        if (sqlite3_value_type(argv[i]) == SQLITE_NULL) {
+            sqlite3_result_null(ctx);
+            return;
+        }
+    }
+    GeoPoint p{sqlite3_value_double(argv[0]), sqlite3_value_double(argv[1])};
+    sqlite3_result_blob(ctx, &p, sizeof(p), SQLITE_TRANSIENT);
+}
+
+// geo_circle(centerLat, centerLon, radiusKm) -> circle blob
+static void geoCircleFunc(sqlite3_context* ctx, int argc, sqlite3_value** argv) {
+    for (int i = 0; i < argc; i++) {
+        if (sqlite3_value_type(argv[i]) == SQLITE_NULL) {
+            sqlite3_result_null(ctx);
+            return;
+        }
+    }
+    GeoCircle c{sqlite3_value_double(argv[0]), sqlite3_value_double(argv[1]),
+                sqlite3_value_double(argv[2])};
+    sqlite3_result_blob(ctx, &c, sizeof(c), SQLITE_TRANSIENT);
+}
+
+// geo_bbox(minLat, maxLat, minLon, maxLon) -> box blob
+static void geoBboxFunc(sqlite3_context* ctx, int argc, sqlite3_value** argv) {
+    for (int i = 0; i < argc; i++) {
+        if (sqlite3_value_type(argv[i]) == SQLITE_NULL) {
+            sqlite3_result_null(ctx);
+            return;
+        }
+    }
+    GeoBox b{sqlite3_value_double(argv[0]), sqlite3_value_double(argv[1]),
+             sqlite3_value_double(argv[2]), sqlite3_value_double(argv[3])};
+    sqlite3_result_blob(ctx, &b, sizeof(b), SQLITE_TRANSIENT);
+}
+
+void geoWithinRadiusPointFunc(sqlite3_context* ctx, int argc, sqlite3_value** argv) {
+    GeoPoint p;
+    GeoCircle c;
+    if (argc != 2 || !geoPointFromValue(argv[0], p) || !geoCircleFromValue(argv[1], c)) {
+        sqlite3_result_null(ctx);
+        return;
+    }
+    double distance = geoHaversineKm(c.lat, c.lon, p.lat, p.lon);
+    sqlite3_result_int(ctx, distance <= c.radiusKm ? 1 : 0);
+}
+
+void geoBboxContainsPointFunc(sqlite3_context* ctx, int argc, sqlite3_value** argv) {
+    GeoPoint p;
+    GeoBox b;
+    if (argc != 2 || !geoPointFromValue(argv[0], p) || !geoBoxFromValue(argv[1], b)) {
+        sqlite3_result_null(ctx);
+        return;
+    }
+    int contained = (p.lat >= b.minLat && p.lat <= b.maxLat &&
+                     p.lon >= b.minLon && p.lon <= b.maxLon) ? 1 : 0;
+    sqlite3_result_int(ctx, contained);
+}
+
+// geo_polygon(lat1, lon1, lat2, lon2, lat3, lon3, ...) -> WKB polygon blob
+static void geoPolygonFunc(sqlite3_context* ctx, int argc, sqlite3_value** argv) {
+    if (argc < 6 || argc % 2 != 0) {
+        sqlite3_result_error(ctx, "geo_polygon requires at least 3 lat, lon pairs", -1);
+        return;
+    }
+    std::vector<double> latLonPairs(argc);
+    for (int i = 0; i < argc; i++) {
+        if (sqlite3_value_type(argv[i]) == SQLITE_NULL) {
+            sqlite3_result_null(ctx);
+            return;
+        }
+        latLonPairs[i] = sqlite3_value_double(argv[i]);
+    }
+    std::vector<uint8_t> wkb = GeoPolygon::toWkb(latLonPairs);
+    sqlite3_result_blob(ctx, wkb.data(), static_cast<int>(wkb.size()), SQLITE_TRANSIENT);
+}
+
+// Prepared polygon for argument i, parsed once per statement. SQLite keeps
+// auxdata for constant arguments across rows and discards it otherwise.
+static const GeoPolygon* preparedPolygonArg(sqlite3_context* ctx, sqlite3_value** argv, int i) {
+    auto* cached = static_cast<const GeoPolygon*>(sqlite3_get_auxdata(ctx, i));
+    if (cached) return cached;
+
+    std::unique_ptr<GeoPolygon> polygon = GeoPolygon::fromValue(argv[i]);
+    if (!polygon) return nullptr;
+    sqlite3_set_auxdata(ctx, i, polygon.release(), [](void* p) {
+        delete static_cast<GeoPolygon*>(p);
+    });
+    // set_auxdata may free the value straight away (e.g. on OOM)
+    return static_cast<const GeoPolygon*>(sqlite3_get_auxdata(ctx, i));
+}
+
+// geo_contains(polygon, lat, lon) -> 0/1
+static void geoContainsFunc(sqlite3_context* ctx, int argc, sqlite3_value** argv) {
+    if (argc != 3) {
+        sqlite3_result_error(ctx, "geo_contains requires 3 args: polygon, lat, lon", -1);
+        return;
+    }
+    if (sqlite3_value_type(argv[1]) == SQLITE_NULL || sqlite3_value_type(argv[2]) == SQLITE_NULL) {
+        sqlite3_result_null(ctx);
+        return;
+    }
+    const GeoPolygon* polygon = preparedPolygonArg(ctx, argv, 0);
+    if (!polygon) {
+        sqlite3_result_null(ctx);
+        return;
+    }
+    bool inside = polygon->contains(sqlite3_value_double(argv[1]), sqlite3_value_double(argv[2]));
+    sqlite3_result_int(ctx, inside ? 1 : 0);
+}
+
+void geoContainsPointFunc(sqlite3_context* ctx, int argc, sqlite3_value** argv) {
+    GeoPoint p;
+    if (argc != 2 || !geoPointFromValue(argv[0], p)) {
+        sqlite3_result_null(ctx);
+        return;
+    }
+    const GeoPolygon* polygon = preparedPolygonArg(ctx, argv, 1);
+    if (!polygon) {
+        sqlite3_result_null(ctx);
+        return;
+    }
+    sqlite3_result_int(ctx, polygon->contains(p.lat, p.lon) ? 1 : 0);
+}
+
 void registerGeoFunctions(sqlite3* db) {
     int flags = SQLITE_UTF8 | SQLITE_DETERMINISTIC;
     sqlite3_create_function(db, "geo_distance", 4, flags, nullptr, geoDistanceFunc, nullptr, nullptr);
     sqlite3_create_function(db, "geo_bbox_contains", 6, flags, nullptr, geoBboxContainsFunc, nullptr, nullptr);
     sqlite3_create_function(db, "geo_within_radius", 5, flags, nullptr, geoWithinRadiusFunc, nullptr, nullptr);
+    sqlite3_create_function(db, "geo_point", 2, flags, nullptr, geoPointFunc, nullptr, nullptr);
+    sqlite3_create_function(db, "geo_circle", 3, flags, nullptr, geoCircleFunc, nullptr, nullptr);
+    sqlite3_create_function(db, "geo_bbox", 4, flags, nullptr, geoBboxFunc, nullptr, nullptr);
+    sqlite3_create_function(db, "geo_within_radius", 2, flags, nullptr, geoWithinRadiusPointFunc, nullptr, nullptr);
+    sqlite3_create_function(db, "geo_bbox_contains", 2, flags, nullptr, geoBboxContainsPointFunc, nullptr, nullptr);
+    sqlite3_create_function(db, "geo_polygon", -1, flags, nullptr, geoPolygonFunc, nullptr, nullptr);
+    sqlite3_create_function(db, "geo_contains", 3, flags, nullptr, geoContainsFunc, nullptr, nullptr);
+    sqlite3_create_function(db, "geo_contains", 2, flags, nullptr, geoContainsPointFunc, nullptr, nullptr);
 }
 
 }  // namespace flatsql
@@ -0,0 +1,348 @@
+#include "flatsql/geo_kernels.h"
+#include "flatsql/geo_functions.h"
+#include <cmath>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define FLATSQL_GEO_AVX2 1
+#include <immintrin.h>
+#endif
+
+#if defined(__aarch64__) && defined(__ARM_NEON)
+#define FLATSQL_GEO_NEON 1
+#include <arm_neon.h>
+#endif
+
+namespace flatsql {
+
+static constexpr double DEG_TO_RAD = M_PI / 180.0;
+static constexpr double TWO_PI = 2.0 * M_PI;
+static constexpr double HALF_PI = 0.5 * M_PI;
+
+// Beyond this the batch distance is within a few km of antipodal, where
+// haversine is ill-conditioned; such points are always re-checked with libm
+static constexpr double ANTIPODAL_KM = 20000.0;
+
+// Taylor coefficients, generated at compile time.
+// sin(x) = x + x^3 * sum_k SIN_C[k] x^(2k), |x| <= pi/2, error < 1e-18
+// asin(x) = x + x^3 * sum_k ASIN_C[k] x^(2k), 0 <= x <= 0.5, error < 2e-11
+constexpr int SIN_TERMS = 10;
+constexpr int ASIN_TERMS = 13;
+
+constexpr double sinCoeff(int k) {
+    // (-1)^k / (2k+1)!
+    double c = 1.0;
+    for (int i = 2; i <= 2 * k + 1; i++) c /= i;
+    return (k % 2) ? -c : c;
+}
+
+constexpr double asinCoeff(int n) {
+    // (2n)! / (4^n (n!)^2 (2n+1))
+    double c = 1.0;
+    for (int k = 1; k <= n; k++) c *= (2.0 * k - 1.0) / (2.0 * k);
+    return c / (2 * n + 1);
+}
+
+struct GeoPolyTables {
+    double sinC[SIN_TERMS];
+    double asinC[ASIN_TERMS];
+};
+
+constexpr GeoPolyTables makePolyTables() {
+    GeoPolyTables t{};
+    for (int k = 0; k < SIN_TERMS; k++) t.sinC[k] = sinCoeff(k + 1);
+    for (int n = 0; n < ASIN_TERMS; n++) t.asinC[n] = asinCoeff(n + 1);
+    return t;
+}
+
+static constexpr GeoPolyTables POLY = makePolyTables();
+
+// ==================== Scalar ====================
+
+static inline double sinPoly(double x) {
+    double x2 = x * x;
+    double p = POLY.sinC[SIN_TERMS - 1];
+    for (int k = SIN_TERMS - 2; k >= 0; k--) p = p * x2 + POLY.sinC[k];
+    return x + x * x2 * p;
+}
+
+static inline double asinPoly(double x) {
+    double x2 = x * x;
+    double p = POLY.asinC[ASIN_TERMS - 1];
+    for (int n = ASIN_TERMS - 2; n >= 0; n--) p = p * x2 + POLY.asinC[n];
+    return x + x * x2 * p;
+}
+
+// asin on [0, 1] via asin(x) = pi/2 - 2 asin(sqrt((1 - x) / 2)) above 0.5
+static inline double asinUnit(double x) {
+    if (x <= 0.5) return asinPoly(x);
+    return HALF_PI - 2.0 * asinPoly(std::sqrt((1.0 - x) * 0.5));
+}
+
+// Haversine with the center's latitude and cosine precomputed (radians)
+static inline double haversineOne(double lat1, double lon1, double cosLat1,
+                                  double latDeg, double lonDeg) {
+    double lat2 = latDeg * DEG_TO_RAD;
+    double dlat = lat2 - lat1;
+    double dlon = lonDeg * DEG_TO_RAD - lon1;
+    dlon -= TWO_PI * std::nearbyint(dlon / TWO_PI);
+
+    double s1 = sinPoly(0.5 * dlat);
+    double s2 = sinPoly(0.5 * dlon);
+    double cosLat2 = sinPoly(HALF_PI - std::fabs(lat2));
+    double a = s1 * s1 + cosLat1 * cosLat2 * s2 * s2;
+    if (a > 1.0) a = 1.0;
+    return 2.0 * GEO_EARTH_RADIUS_KM * asinUnit(std::sqrt(a));
+}
+
+static void haversineScalar(double lat1, double lon1, double cosLat1,
+                            const double* lats, const double* lons, size_t n, double* out) {
+    for (size_t i = 0; i < n; i++) {
+        out[i] = haversineOne(lat1, lon1, cosLat1, lats[i], lons[i]);
+    }
+}
+
+// ==================== AVX2 + FMA ====================
+
+#ifdef FLATSQL_GEO_AVX2
+#define FLATSQL_TARGET_AVX2 __attribute__((target("avx2,fma")))
+
+FLATSQL_TARGET_AVX2 static inline __m256d sinPoly4(__m256d x) {
+    __m256d x2 = _mm256_mul_pd(x, x);
+    __m256d p = _mm256_set1_pd(POLY.sinC[SIN_TERMS - 1]);
+    for (int k = SIN_TERMS - 2; k >= 0; k--) {
+        p = _mm256_fmadd_pd(p, x2, _mm256_set1_pd(POLY.sinC[k]));
+    }
+    return _mm256_fmadd_pd(_mm256_mul_pd(x, x2), p, x);
+}
+
+FLATSQL_TARGET_AVX2 static inline __m256d asinPoly4(__m256d x) {
+    __m256d x2 = _mm256_mul_pd(x, x);
+    __m256d p = _mm256_set1_pd(POLY.asinC[ASIN_TERMS - 1]);
+    for (int n = ASIN_TERMS - 2; n >= 0; n--) {
+        p = _mm256_fmadd_pd(p, x2, _mm256_set1_pd(POLY.asinC[n]));
+    }
+    return _mm256_fmadd_pd(_mm256_mul_pd(x, x2), p, x);
+}
+
+FLATSQL_TARGET_AVX2 static void haversineAvx2(double lat1, double lon1, double cosLat1,
+                                              const double* lats, const double* lons,
+                                              size_t n, double* out) {
+    const __m256d vDegToRad = _mm256_set1_pd(DEG_TO_RAD);
+    const __m256d vLat1 = _mm256_set1_pd(lat1);
+    const __m256d vLon1 = _mm256_set1_pd(lon1);
+    const __m256d vCosLat1 = _mm256_set1_pd(cosLat1);
+    const __m256d vTwoPi = _mm256_set1_pd(TWO_PI);
+    const __m256d vInvTwoPi = _mm256_set1_pd(1.0 / TWO_PI);
+    const __m256d vHalfPi = _mm256_set1_pd(HALF_PI);
+    const __m256d vHalf = _mm256_set1_pd(0.5);
+    const __m256d vOne = _mm256_set1_pd(1.0);
+    const __m256d vTwo = _mm256_set1_pd(2.0);
+    const __m256d vDiameter = _mm256_set1_pd(2.0 * GEO_EARTH_RADIUS_KM);
+    const __m256d vSignMask = _mm256_set1_pd(-0.0);
+
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256d lat2 = _mm256_mul_pd(_mm256_loadu_pd(lats + i), vDegToRad);
+        __m256d lon2 = _mm256_mul_pd(_mm256_loadu_pd(lons + i), vDegToRad);
+        __m256d dlat = _mm256_sub_pd(lat2, vLat1);
+        __m256d dlon = _mm256_sub_pd(lon2, vLon1);
+        __m256d turns = _mm256_round_pd(_mm256_mul_pd(dlon, vInvTwoPi),
+                                        _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+        dlon = _mm256_fnmadd_pd(turns, vTwoPi, dlon);
+
+        __m256d s1 = sinPoly4(_mm256_mul_pd(vHalf, dlat));
+        __m256d s2 = sinPoly4(_mm256_mul_pd(vHalf, dlon));
+        __m256d cosLat2 = sinPoly4(_mm256_sub_pd(vHalfPi, _mm256_andnot_pd(vSignMask, lat2)));
+        __m256d a = _mm256_fmadd_pd(_mm256_mul_pd(vCosLat1, cosLat2), _mm256_mul_pd(s2, s2),
+                                    _mm256_mul_pd(s1, s1));
+        a = _mm256_min_pd(a, vOne);
+
+        // asin(h) with the half-angle identity in lanes where h > 0.5
+        __m256d h = _mm256_sqrt_pd(a);
+        __m256d big = _mm256_cmp_pd(h, vHalf, _CMP_GT_OQ);
+        __m256d reduced = _mm256_sqrt_pd(_mm256_mul_pd(_mm256_sub_pd(vOne, h), vHalf));
+        __m256d arg = _mm256_blendv_pd(h, reduced, big);
+        __m256d r = asinPoly4(arg);
+        __m256d asinH = _mm256_blendv_pd(r, _mm256_fnmadd_pd(vTwo, r, vHalfPi), big);
+
+        _mm256_storeu_pd(out + i, _mm256_mul_pd(vDiameter, asinH));
+    }
+    haversineScalar(lat1, lon1, cosLat1, lats + i, lons + i, n - i, out + i);
+}
+
+FLATSQL_TARGET_AVX2 static size_t bboxAvx2(double minLat, double maxLat, double minLon, double maxLon,
+                                           const double* lats, const double* lons, size_t n,
+                                           uint8_t* outMask) {
+    const __m256d vMinLat = _mm256_set1_pd(minLat);
+    const __m256d vMaxLat = _mm256_set1_pd(maxLat);
+    const __m256d vMinLon = _mm256_set1_pd(minLon);
+    const __m256d vMaxLon = _mm256_set1_pd(maxLon);
+
+    size_t count = 0;
+    size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m256d lat = _mm256_loadu_pd(lats + i);
+        __m256d lon = _mm256_loadu_pd(lons + i);
+        __m256d in = _mm256_and_pd(
+            _mm256_and_pd(_mm256_cmp_pd(lat, vMinLat, _CMP_GE_OQ), _mm256_cmp_pd(lat, vMaxLat, _CMP_LE_OQ)),
+            _mm256_and_pd(_mm256_cmp_pd(lon, vMinLon, _CMP_GE_OQ), _mm256_cmp_pd(lon, vMaxLon, _CMP_LE_OQ)));
+        int bits = _mm256_movemask_pd(in);
+        for (int lane = 0; lane < 4; lane++) {
+            outMask[i + lane] = static_cast<uint8_t>((bits >> lane) & 1);
+        }
+        count += static_cast<size_t>(__builtin_popcount(static_cast<unsigned>(bits)));
+    }
+    for (; i < n; i++) {
+        uint8_t in = (lats[i] >= minLat && lats[i] <= maxLat &&
+                      lons[i] >= minLon && lons[i] <= maxLon) ? 1 : 0;
+        outMask[i] = in;
+        count += in;
+    }
+    return count;
+}
+#endif  // FLATSQL_GEO_AVX2
+
+// ==================== NEON ====================
+
+#ifdef FLATSQL_GEO_NEON
+static inline float64x2_t sinPoly2(float64x2_t x) {
+    float64x2_t x2 = vmulq_f64(x, x);
+    float64x2_t p = vdupq_n_f64(POLY.sinC[SIN_TERMS - 1]);
+    for (int k = SIN_TERMS - 2; k >= 0; k--) {
+        p = vfmaq_f64(vdupq_n_f64(POLY.sinC[k]), p, x2);
+    }
+    return vfmaq_f64(x, vmulq_f64(x, x2), p);
+}
+
+static inline float64x2_t asinPoly2(float64x2_t x) {
+    float64x2_t x2 = vmulq_f64(x, x);
+    float64x2_t p = vdupq_n_f64(POLY.asinC[ASIN_TERMS - 1]);
+    for (int n = ASIN_TERMS - 2; n >= 0; n--) {
+        p = vfmaq_f64(vdupq_n_f64(POLY.asinC[n]), p, x2);
+    }
+    return vfmaq_f64(x, vmulq_f64(x, x2), p);
+}
+
+static void haversineNeon(double lat1, double lon1, double cosLat1,
+                          const double* lats, const double* lons, size_t n, double* out) {
+    const float64x2_t vDegToRad = vdupq_n_f64(DEG_TO_RAD);
+    const float64x2_t vLat1 = vdupq_n_f64(lat1);
+    const float64x2_t vLon1 = vdupq_n_f64(lon1);
+    const float64x2_t vCosLat1 = vdupq_n_f64(cosLat1);
+    const float64x2_t vTwoPi = vdupq_n_f64(TWO_PI);
+    const float64x2_t vInvTwoPi = vdupq_n_f64(1.0 / TWO_PI);
+    const float64x2_t vHalfPi = vdupq_n_f64(HALF_PI);
+    const float64x2_t vHalf = vdupq_n_f64(0.5);
+    const float64x2_t vOne = vdupq_n_f64(1.0);
+    const float64x2_t vTwo = vdupq_n_f64(2.0);
+    const float64x2_t vDiameter = vdupq_n_f64(2.0 * GEO_EARTH_RADIUS_KM);
+
+    size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        float64x2_t lat2 = vmulq_f64(vld1q_f64(lats + i), vDegToRad);
+        float64x2_t lon2 = vmulq_f64(vld1q_f64(lons + i), vDegToRad);
+        float64x2_t dlat = vsubq_f64(lat2, vLat1);
+        float64x2_t dlon = vsubq_f64(lon2, vLon1);
+        float64x2_t turns = vrndnq_f64(vmulq_f64(dlon, vInvTwoPi));
+        dlon = vfmsq_f64(dlon, turns, vTwoPi);
+
+        float64x2_t s1 = sinPoly2(vmulq_f64(vHalf, dlat));
+        float64x2_t s2 = sinPoly2(vmulq_f64(vHalf, dlon));
+        float64x2_t cosLat2 = sinPoly2(vsubq_f64(vHalfPi, vabsq_f64(lat2)));
+        float64x2_t a = vfmaq_f64(vmulq_f64(s1, s1), vmulq_f64(vCosLat1, cosLat2), vmulq_f64(s2, s2));
+        a = vminq_f64(a, vOne);
+
+        float64x2_t h = vsqrtq_f64(a);
+        uint64x2_t big = vcgtq_f64(h, vHalf);
+        float64x2_t reduced = vsqrtq_f64(vmulq_f64(vsubq_f64(vOne, h), vHalf));
+        float64x2_t r = asinPoly2(vbslq_f64(big, reduced, h));
+        float64x2_t asinH = vbslq_f64(big, vfmsq_f64(vHalfPi, vTwo, r), r);
+
+        vst1q_f64(out + i, vmulq_f64(vDiameter, asinH));
+    }
+    haversineScalar(lat1, lon1, cosLat1, lats + i, lons + i, n - i, out + i);
+}
+#endif  // FLATSQL_GEO_NEON
+
+// ==================== Dispatch ====================
+
+using HaversineKernel = void (*)(double, double, double, const double*, const double*, size_t, double*);
+
+static bool useAvx2() {
+#ifdef FLATSQL_GEO_AVX2
+    static const bool supported = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+    return supported;
+#else
+    return false;
+#endif
+}
+
+static HaversineKernel haversineKernel() {
+#if defined(FLATSQL_GEO_AVX2)
+    if (useAvx2()) return haversineAvx2;
+#elif defined(FLATSQL_GEO_NEON)
+    return haversineNeon;
+#endif
+    return haversineScalar;
+}
+
+const char* geoKernelIsa() {
+#if defined(FLATSQL_GEO_NEON)
+    return "neon";
+#else
+    return useAvx2() ? "avx2" : "scalar";
+#endif
+}
+
+void geoHaversineBatch(double lat, double lon, const double* lats, const double* lons,
+                       size_t n, double* outKm) {
+    static const HaversineKernel kernel = haversineKernel();
+    double lat1 = lat * DEG_TO_RAD;
+    kernel(lat1, lon * DEG_TO_RAD, std::cos(lat1), lats, lons, n, outKm);
+}
+
+size_t geoWithinRadiusBatch(double lat, double lon, double radiusKm,
+                            const double* lats, const double* lons, size_t n,
+                            uint8_t* outMask, double* outKm) {
+    // Distances go to the caller's buffer when given, otherwise a stack chunk
+    constexpr size_t CHUNK = 256;
+    double scratch[CHUNK];
+
+    size_t count = 0;
+    for (size_t base = 0; base < n; base += CHUNK) {
+        size_t len = std::min(CHUNK, n - base);
+        double* dist = outKm ? outKm + base : scratch;
+        geoHaversineBatch(lat, lon, lats + base, lons + base, len, dist);
+
+        for (size_t i = 0; i < len; i++) {
+            double d = dist[i];
+            // Near the boundary (or the antipode) defer to the libm result
+            if (std::fabs(d - radiusKm) <= GEO_BATCH_MAX_ERROR_KM || d > ANTIPODAL_KM) {
+                d = geoHaversineKm(lat, lon, lats[base + i], lons[base + i]);
+                dist[i] = d;
+            }
+            uint8_t in = d <= radiusKm ? 1 : 0;
+            outMask[base + i] = in;
+            count += in;
+        }
+    }
+    return count;
+}
+
+size_t geoBboxContainsBatch(double minLat, double maxLat, double minLon, double maxLon,
+                            const double* lats, const double* lons, size_t n,
+                            uint8_t* outMask) {
+#ifdef FLATSQL_GEO_AVX2
+    if (useAvx2()) return bboxAvx2(minLat, maxLat, minLon, maxLon, lats, lons, n, outMask);
+#endif
+    size_t count = 0;
+    for (size_t i = 0; i < n; i++) {
+        uint8_t in = (lats[i] >= minLat && lats[i] <= maxLat &&
+                      lons[i] >= minLon && lons[i] <= maxLon) ? 1 : 0;
+        outMask[i] = in;
+        count += in;
+    }
+    return count;
+}
+
+}  // namespace flatsql
@@ -0,0 +1,233 @@
+#include "flatsql/geo_polygon.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+
+namespace flatsql {
+
+static constexpr uint32_t WKB_POLYGON = 3;
+static constexpr uint32_t WKB_MULTIPOLYGON = 6;
+
+// Upper bound on latitude bands; more only helps polygons with huge vertex counts
+static constexpr size_t MAX_BANDS = 1024;
+
+// Bounds-checked WKB reader honouring each geometry's byte order
+class WkbReader {
+public:
+    WkbReader(const uint8_t* data, size_t length) : p_(data), remaining_(length) {}
+
+    bool readByteOrder() {
+        if (remaining_ < 1) return false;
+        uint8_t order = *p_++;
+        remaining_--;
+        if (order > 1) return false;
+        bool hostLittle = isHostLittleEndian();
+        swap_ = (order == 1) != hostLittle;
+        return true;
+    }
+
+    bool readU32(uint32_t& out) {
+        if (remaining_ < 4) return false;
+        std::memcpy(&out, p_, 4);
+        if (swap_) out = __builtin_bswap32(out);
+        p_ += 4;
+        remaining_ -= 4;
+        return true;
+    }
+
+    bool readF64(double& out) {
+        if (remaining_ < 8) return false;
+        uint64_t bits;
+        std::memcpy(&bits, p_, 8);
+        if (swap_) bits = __builtin_bswap64(bits);
+        std::memcpy(&out, &bits, 8);
+        p_ += 8;
+        remaining_ -= 8;
+        return true;
+    }
+
+    size_t remaining() const { return remaining_; }
+
+    static bool isHostLittleEndian() {
+        const uint16_t probe = 1;
+        uint8_t first;
+        std::memcpy(&first, &probe, 1);
+        return first == 1;
+    }
+
+private:
+    const uint8_t* p_;
+    size_t remaining_;
+    bool swap_ = false;
+};
+
+// Read one WKB Polygon (header included) and hand each ring to onRing
+template <typename RingFn>
+static bool readWkbPolygon(WkbReader& reader, RingFn&& onRing) {
+    uint32_t type, numRings;
+    if (!reader.readByteOrder() || !reader.readU32(type) || type != WKB_POLYGON) return false;
+    if (!reader.readU32(numRings)) return false;
+
+    std::vector<double> lons, lats;
+    for (uint32_t r = 0; r < numRings; r++) {
+        uint32_t numPoints;
+        if (!reader.readU32(numPoints)) return false;
+        if (numPoints > reader.remaining() / 16) return false;  // Truncated; don't over-allocate
+        lons.resize(numPoints);
+        lats.resize(numPoints);
+        for (uint32_t i = 0; i < numPoints; i++) {
+            if (!reader.readF64(lons[i]) || !reader.readF64(lats[i])) return false;
+            if (!std::isfinite(lons[i]) || !std::isfinite(lats[i])) return false;
+        }
+        onRing(lons, lats);
+    }
+    return true;
+}
+
+std::unique_ptr<GeoPolygon> GeoPolygon::fromWkb(const uint8_t* data, size_t length) {
+    if (!data || length < 9) return nullptr;
+
+    std::unique_ptr<GeoPolygon> polygon(new GeoPolygon());
+    polygon->minLat_ = polygon->minLon_ = std::numeric_limits<double>::infinity();
+    polygon->maxLat_ = polygon->maxLon_ = -std::numeric_limits<double>::infinity();
+    auto onRing = [&](const std::vector<double>& lons, const std::vector<double>& lats) {
+        polygon->addRing(lons, lats);
+    };
+
+    // Peek at the outer geometry type
+    WkbReader header(data, length);
+    uint32_t type;
+    if (!header.readByteOrder() || !header.readU32(type)) return nullptr;
+
+    WkbReader reader(data, length);
+    if (type == WKB_POLYGON) {
+        if (!readWkbPolygon(reader, onRing)) return nullptr;
+    } else if (type == WKB_MULTIPOLYGON) {
+        uint32_t numPolygons;
+        if (!reader.readByteOrder() || !reader.readU32(type) || !reader.readU32(numPolygons)) return nullptr;
+        for (uint32_t i = 0; i < numPolygons; i++) {
+            if (!readWkbPolygon(reader, onRing)) return nullptr;
+        }
+    } else {
+        return nullptr;
+    }
+    if (reader.remaining() != 0) return nullptr;
+
+    polygon->buildBands();
+    return polygon;
+}
+
+std::unique_ptr<GeoPolygon> GeoPolygon::fromValue(sqlite3_value* value) {
+    if (sqlite3_value_type(value) != SQLITE_BLOB) return nullptr;
+    return fromWkb(static_cast<const uint8_t*>(sqlite3_value_blob(value)),
+                   static_cast<size_t>(sqlite3_value_bytes(value)));
+}
+
+std::vector<uint8_t> GeoPolygon::toWkb(const std::vector<double>& latLonPairs) {
+    size_t n = latLonPairs.size() / 2;
+    bool close = n > 0 && (latLonPairs[0] != latLonPairs[2 * n - 2] ||
+                           latLonPairs[1] != latLonPairs[2 * n - 1]);
+    uint32_t numPoints = static_cast<uint32_t>(n + (close ? 1 : 0));
+
+    std::vector<uint8_t> out;
+    out.reserve(13 + 16 * static_cast<size_t>(numPoints));
+    auto putU32 = [&](uint32_t v) {
+        for (int i = 0; i < 4; i++) out.push_back(static_cast<uint8_t>(v >> (8 * i)));
+    };
+    auto putF64 = [&](double v) {
+        uint64_t bits;
+        std::memcpy(&bits, &v, 8);
+        for (int i = 0; i < 8; i++) out.push_back(static_cast<uint8_t>(bits >> (8 * i)));
+    };
+
+    out.push_back(1);  // Little endian
+    putU32(WKB_POLYGON);
+    putU32(1);
+    putU32(numPoints);
+    for (size_t i = 0; i < numPoints; i++) {
+        size_t v = i % n;
+        putF64(latLonPairs[2 * v + 1]);  // x = lon
+        putF64(latLonPairs[2 * v]);      // y = lat
+    }
+    return out;
+}
+
+void GeoPolygon::addRing(const std::vector<double>& lons, const std::vector<double>& lats) {
+    size_t n = lons.size();
+    for (size_t i = 0; i < n; i++) {
+        minLat_ = std::min(minLat_, lats[i]);
+        maxLat_ = std::max(maxLat_, lats[i]);
+        minLon_ = std::min(minLon_, lons[i]);
+        maxLon_ = std::max(maxLon_, lons[i]);
+    }
+    if (n < 3) return;
+
+    // Rings are implicitly closed. Horizontal edges never cross a ray.
+    for (size_t i = 0; i < n; i++) {
+        size_t j = (i + 1) % n;
+        if (lats[i] == lats[j]) continue;
+        Edge e;
+        if (lats[i] < lats[j]) {
+            e.lat0 = lats[i];
+            e.lat1 = lats[j];
+            e.lon0 = lons[i];
+        } else {
+            e.lat0 = lats[j];
+            e.lat1 = lats[i];
+            e.lon0 = lons[j];
+        }
+        e.dLonPerLat = (lons[j] - lons[i]) / (lats[j] - lats[i]);
+        edges_.push_back(e);
+    }
+}
+
+size_t GeoPolygon::bandOf(double lat) const {
+    size_t bands = bandStart_.size() - 1;
+    double pos = (lat - minLat_) * bandScale_;
+    if (!(pos > 0.0)) return 0;
+    return std::min(bands - 1, static_cast<size_t>(pos));
+}
+
+void GeoPolygon::buildBands() {
+    size_t bands = std::max<size_t>(1, std::min(edges_.size(), MAX_BANDS));
+    double height = maxLat_ - minLat_;
+    bandScale_ = (bands > 1 && height > 0.0) ? static_cast<double>(bands) / height : 0.0;
+    if (bandScale_ == 0.0) bands = 1;
+    bandStart_.assign(bands + 1, 0);
+
+    // Two passes: count edges per band, then fill the flattened lists.
+    // An edge goes in every band its [lat0, lat1) span touches.
+    for (const auto& e : edges_) {
+        for (size_t b = bandOf(e.lat0), last = bandOf(e.lat1); b <= last; b++) {
+            bandStart_[b + 1]++;
+        }
+    }
+    for (size_t b = 0; b < bands; b++) {
+        bandStart_[b + 1] += bandStart_[b];
+    }
+    bandEdges_.resize(bandStart_[bands]);
+    std::vector<uint32_t> fill(bandStart_.begin(), bandStart_.end() - 1);
+    for (uint32_t i = 0; i < edges_.size(); i++) {
+        for (size_t b = bandOf(edges_[i].lat0), last = bandOf(edges_[i].lat1); b <= last; b++) {
+            bandEdges_[fill[b]++] = i;
+        }
+    }
+}
+
+bool GeoPolygon::contains(double lat, double lon) const {
+    if (!(lat >= minLat_ && lat <= maxLat_ && lon >= minLon_ && lon <= maxLon_)) return false;
+
+    // Even-odd ray cast towards +lon over the edges of this point's band
+    size_t b = bandOf(lat);
+    bool inside = false;
+    for (uint32_t k = bandStart_[b]; k < bandStart_[b + 1]; k++) {
+        const Edge& e = edges_[bandEdges_[k]];
+        if (lat >= e.lat0 && lat < e.lat1 && lon < e.lon0 + (lat - e.lat0) * e.dLonPerLat) {
+            inside = !inside;
+        }
+    }
+    return inside;
+}
+
+}  // namespace flatsql
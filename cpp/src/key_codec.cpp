@@ -0,0 +1,470 @@
+#include "flatsql/key_codec.h"
+#include <sqlite3.h>
+#include <cerrno>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+
+namespace flatsql {
+
+namespace {
+
+enum class KeyClass { Signed, Unsigned, Bool, Float, String, Bytes, None };
+
+KeyClass classify(ValueType type) {
+    switch (type) {
+        case ValueType::Int8:
+        case ValueType::Int16:
+        case ValueType::Int32:
+        case ValueType::Int64:   return KeyClass::Signed;
+        case ValueType::UInt8:
+        case ValueType::UInt16:
+        case ValueType::UInt32:
+        case ValueType::UInt64:  return KeyClass::Unsigned;
+        case ValueType::Bool:    return KeyClass::Bool;
+        case ValueType::Float32:
+        case ValueType::Float64: return KeyClass::Float;
+        case ValueType::String:  return KeyClass::String;
+        case ValueType::Bytes:   return KeyClass::Bytes;
+        default:                 return KeyClass::None;
+    }
+}
+
+void signedRange(ValueType type, int64_t& lo, int64_t& hi) {
+    switch (type) {
+        case ValueType::Int8:  lo = INT8_MIN;  hi = INT8_MAX;  break;
+        case ValueType::Int16: lo = INT16_MIN; hi = INT16_MAX; break;
+        case ValueType::Int32: lo = INT32_MIN; hi = INT32_MAX; break;
+        default:               lo = INT64_MIN; hi = INT64_MAX; break;
+    }
+}
+
+uint64_t unsignedMax(ValueType type) {
+    switch (type) {
+        case ValueType::Bool:   return 1;
+        case ValueType::UInt8:  return UINT8_MAX;
+        case ValueType::UInt16: return UINT16_MAX;
+        case ValueType::UInt32: return UINT32_MAX;
+        default:                return UINT64_MAX;
+    }
+}
+
+// A probe value read as a number. Integers keep full 64-bit precision.
+struct Number {
+    enum Kind { Int, UInt, Real } kind;
+    int64_t i = 0;   // Int
+    uint64_t u = 0;  // UInt (only used above INT64_MAX)
+    double d = 0.0;  // Real
+};
+
+// Parse text the way SQLite applies numeric affinity: the whole string,
+// optionally surrounded by spaces, must be a number
+bool parseNumericText(const std::string& text, Number& out) {
+    const char* start = text.c_str();
+    while (*start == ' ' || *start == '\t' || *start == '\n' || *start == '\r') start++;
+    if (*start == '\0') return false;
+
+    auto trailingSpaceOnly = [](const char* p) {
+        while (*p == ' ' || *p == '\t' || *p == '\n' || *p == '\r') p++;
+        return *p == '\0';
+    };
+
+    char* end = nullptr;
+    errno = 0;
+    long long i = std::strtoll(start, &end, 10);
+    if (end != start && errno == 0 && trailingSpaceOnly(end)) {
+        out.kind = Number::Int;
+        out.i = static_cast<int64_t>(i);
+        return true;
+    }
+    double d = std::strtod(start, &end);
+    if (end == start || !trailingSpaceOnly(end)) return false;
+    out.kind = Number::Real;
+    out.d = d;
+    return true;
+}
+
+bool toNumber(const Value& value, Number& out) {
+    switch (value.index()) {
+        case 1:  out.kind = Number::Int; out.i = std::get<bool>(value) ? 1 : 0; return true;
+        case 2:  out.kind = Number::Int; out.i = std::get<int8_t>(value); return true;
+        case 3:  out.kind = Number::Int; out.i = std::get<int16_t>(value); return true;
+        case 4:  out.kind = Number::Int; out.i = std::get<int32_t>(value); return true;
+        case 5:  out.kind = Number::Int; out.i = std::get<int64_t>(value); return true;
+        case 6:  out.kind = Number::Int; out.i = std::get<uint8_t>(value); return true;
+        case 7:  out.kind = Number::Int; out.i = std::get<uint16_t>(value); return true;
+        case 8:  out.kind = Number::Int; out.i = std::get<uint32_t>(value); return true;
+        case 9: {
+            uint64_t u = std::get<uint64_t>(value);
+            if (u <= static_cast<uint64_t>(INT64_MAX)) {
+                out.kind = Number::Int;
+                out.i = static_cast<int64_t>(u);
+            } else {
+                out.kind = Number::UInt;
+                out.u = u;
+            }
+            return true;
+        }
+        case 10: out.kind = Number::Real; out.d = std::get<float>(value); return true;
+        case 11: out.kind = Number::Real; out.d = std::get<double>(value); return true;
+        case 12: return parseNumericText(std::get<std::string>(value), out);
+        default: return false;
+    }
+}
+
+// Where an integer probe falls relative to the integers: below all of them,
+// above all of them, or at a value (negative in i, non-negative in u)
+struct IntegerProbe {
+    int order = 0;
+    bool negative = false;
+    int64_t i = 0;
+    uint64_t u = 0;
+};
+
+// Round a number onto the integers for the bound. Returns false if there is
+// no such integer (Exact on a fraction, or NaN).
+bool toIntegerProbe(const Number& n, KeyCodec::Bound bound, IntegerProbe& out) {
+    if (n.kind == Number::Int) {
+        out.negative = n.i < 0;
+        out.i = n.i;
+        out.u = static_cast<uint64_t>(n.i);
+        return true;
+    }
+    if (n.kind == Number::UInt) {
+        out.u = n.u;
+        return true;
+    }
+
+    double d = n.d;
+    if (std::isnan(d)) return false;
+    if (bound == KeyCodec::Bound::Exact && d != std::floor(d)) return false;
+    if (bound == KeyCodec::Bound::Lower) d = std::ceil(d);
+    if (bound == KeyCodec::Bound::Upper) d = std::floor(d);
+
+    if (d < -9223372036854775808.0) {
+        out.order = -1;
+    } else if (d >= 18446744073709551616.0) {
+        out.order = 1;
+    } else if (d < 0) {
+        out.negative = true;
+        out.i = static_cast<int64_t>(d);
+    } else {
+        out.u = static_cast<uint64_t>(d);
+    }
+    return true;
+}
+
+void appendBigEndian(uint64_t v, std::string& out) {
+    char buf[8];
+    for (int i = 7; i >= 0; i--) {
+        buf[i] = static_cast<char>(v & 0xFF);
+        v >>= 8;
+    }
+    out.append(buf, 8);
+}
+
+uint64_t readBigEndian(const uint8_t* p) {
+    uint64_t v = 0;
+    for (int i = 0; i < 8; i++) v = (v << 8) | p[i];
+    return v;
+}
+
+const uint64_t SIGN_BIT = 0x8000000000000000ull;
+
+bool appendInteger(ValueType keyType, KeyClass cls, const Number& n, KeyCodec::Bound bound,
+                   std::string& out) {
+    IntegerProbe p;
+    if (!toIntegerProbe(n, bound, p)) return false;
+
+    if (cls == KeyClass::Signed) {
+        int64_t lo, hi;
+        signedRange(keyType, lo, hi);
+        if (p.order == 0 && p.negative && p.i < lo) p.order = -1;
+        if (p.order == 0 && !p.negative && p.u > static_cast<uint64_t>(hi)) p.order = 1;
+
+        int64_t v;
+        if (p.order < 0) {
+            if (bound != KeyCodec::Bound::Lower) return false;
+            v = lo;
+        } else if (p.order > 0) {
+            if (bound != KeyCodec::Bound::Upper) return false;
+            v = hi;
+        } else {
+            v = p.negative ? p.i : static_cast<int64_t>(p.u);
+        }
+        KeyCodec::appendInt64(v, out);
+        return true;
+    }
+
+    uint64_t hi = unsignedMax(keyType);
+    if (p.order == 0 && p.negative) p.order = -1;
+    if (p.order == 0 && p.u > hi) p.order = 1;
+
+    uint64_t v;
+    if (p.order < 0) {
+        if (bound != KeyCodec::Bound::Lower) return false;
+        v = 0;
+    } else if (p.order > 0) {
+        if (bound != KeyCodec::Bound::Upper) return false;
+        v = hi;
+    } else {
+        v = p.u;
+    }
+    if (cls == KeyClass::Bool) {
+        KeyCodec::appendBool(v != 0, out);
+    } else {
+        KeyCodec::appendUInt64(v, out);
+    }
+    return true;
+}
+
+// Smallest and largest encoding of a key class, for probes that fall
+// entirely below or above it
+void appendClassMin(ValueType keyType, KeyClass cls, std::string& out) {
+    switch (cls) {
+        case KeyClass::Signed: {
+            int64_t lo, hi;
+            signedRange(keyType, lo, hi);
+            KeyCodec::appendInt64(lo, out);
+            break;
+        }
+        case KeyClass::Unsigned: KeyCodec::appendUInt64(0, out); break;
+        case KeyClass::Bool:     KeyCodec::appendBool(false, out); break;
+        case KeyClass::Float:    KeyCodec::appendDouble(-std::numeric_limits<double>::infinity(), out); break;
+        default:                 KeyCodec::appendBytes("", 0, out); break;
+    }
+}
+
+}  // namespace
+
+void KeyCodec::appendInt64(int64_t v, std::string& out) {
+    appendBigEndian(static_cast<uint64_t>(v) ^ SIGN_BIT, out);
+}
+
+void KeyCodec::appendUInt64(uint64_t v, std::string& out) {
+    appendBigEndian(v, out);
+}
+
+void KeyCodec::appendDouble(double v, std::string& out) {
+    uint64_t bits;
+    if (std::isnan(v)) {
+        bits = 0x7FF8000000000000ull;  // One NaN, above +inf
+    } else {
+        if (v == 0.0) v = 0.0;  // -0 == +0
+        std::memcpy(&bits, &v, 8);
+    }
+    bits = (bits & SIGN_BIT) ? ~bits : (bits | SIGN_BIT);
+    appendBigEndian(bits, out);
+}
+
+void KeyCodec::appendBool(bool v, std::string& out) {
+    out += static_cast<char>(v ? 1 : 0);
+}
+
+void KeyCodec::appendBytes(const char* data, size_t length, std::string& out, bool terminate) {
+    out.reserve(out.size() + length + 2);
+    for (size_t i = 0; i < length; i++) {
+        uint8_t c = static_cast<uint8_t>(data[i]);
+        if (c == 0x00) {
+            out += '\x00';
+            out += '\xFF';
+        } else if (c == 0xFF) {
+            out += '\xFF';
+            out += '\x00';
+        } else {
+            out += static_cast<char>(c);
+        }
+    }
+    if (terminate) {
+        out += '\x00';
+        out += '\x01';
+    }
+}
+
+void KeyCodec::appendMax(std::string& out) {
+    // Longer than any fixed-width key and above every escaped string byte
+    out.append(9, '\xFF');
+}
+
+bool KeyCodec::append(ValueType keyType, const Value& value, std::string& out, Bound bound) {
+    KeyClass cls = classify(keyType);
+    if (cls == KeyClass::None || value.index() == 0) return false;
+
+    switch (cls) {
+        case KeyClass::Signed:
+        case KeyClass::Unsigned:
+        case KeyClass::Bool:
+        case KeyClass::Float: {
+            Number n;
+            if (!toNumber(value, n)) {
+                // Text and blobs sort after every number
+                if (bound != Bound::Upper) return false;
+                if (cls == KeyClass::Float) {
+                    appendDouble(std::numeric_limits<double>::quiet_NaN(), out);
+                } else {
+                    Number top;
+                    top.kind = Number::Real;
+                    top.d = std::numeric_limits<double>::infinity();
+                    return appendInteger(keyType, cls, top, bound, out);
+                }
+                return true;
+            }
+            if (cls != KeyClass::Float) return appendInteger(keyType, cls, n, bound, out);
+
+            double d = n.kind == Number::Int ? static_cast<double>(n.i)
+                     : n.kind == Number::UInt ? static_cast<double>(n.u) : n.d;
+            appendDouble(d, out);
+            return true;
+        }
+
+        case KeyClass::String: {
+            char buf[32];
+            switch (value.index()) {
+                case 12: {
+                    const std::string& s = std::get<std::string>(value);
+                    appendBytes(s.data(), s.size(), out);
+                    return true;
+                }
+                case 13:
+                    // Blobs sort after every string
+                    if (bound != Bound::Upper) return false;
+                    appendMax(out);
+                    return true;
+                case 10:
+                case 11: {
+                    double d = value.index() == 10 ? std::get<float>(value) : std::get<double>(value);
+                    sqlite3_snprintf(sizeof(buf), buf, "%!.15g", d);
+                    appendBytes(buf, std::strlen(buf), out);
+                    return true;
+                }
+                default: {
+                    Number n;
+                    toNumber(value, n);
+                    std::string text = n.kind == Number::UInt ? std::to_string(n.u) : std::to_string(n.i);
+                    appendBytes(text.data(), text.size(), out);
+                    return true;
+                }
+            }
+        }
+
+        case KeyClass::Bytes: {
+            if (value.index() == 13) {
+                const auto& b = std::get<std::vector<uint8_t>>(value);
+                appendBytes(reinterpret_cast<const char*>(b.data()), b.size(), out);
+                return true;
+            }
+            // Numbers and text sort before every blob
+            if (bound != Bound::Lower) return false;
+            appendClassMin(keyType, cls, out);
+            return true;
+        }
+
+        default:
+            return false;
+    }
+}
+
+bool KeyCodec::prefixSuccessor(const std::string& prefix, std::string& out) {
+    out = prefix;
+    while (!out.empty() && static_cast<uint8_t>(out.back()) == 0xFF) {
+        out.pop_back();
+    }
+    if (out.empty()) return false;
+    out.back() = static_cast<char>(static_cast<uint8_t>(out.back()) + 1);
+    return true;
+}
+
+bool KeyCodec::appendComposite(const std::vector<ValueType>& keyTypes, const std::vector<Value>& values,
+                               std::string& out, Bound bound) {
+    if (keyTypes.size() != values.size()) return false;
+    for (size_t i = 0; i < values.size(); i++) {
+        if (!append(keyTypes[i], values[i], out, bound)) return false;
+    }
+    return true;
+}
+
+bool KeyCodec::decode(ValueType keyType, const uint8_t* data, size_t length, size_t& pos, Value& out) {
+    KeyClass cls = classify(keyType);
+    switch (cls) {
+        case KeyClass::Signed: {
+            if (pos + 8 > length) return false;
+            int64_t v = static_cast<int64_t>(readBigEndian(data + pos) ^ SIGN_BIT);
+            pos += 8;
+            switch (keyType) {
+                case ValueType::Int8:  out = static_cast<int8_t>(v); break;
+                case ValueType::Int16: out = static_cast<int16_t>(v); break;
+                case ValueType::Int32: out = static_cast<int32_t>(v); break;
+                default:               out = v; break;
+            }
+            return true;
+        }
+        case KeyClass::Unsigned: {
+            if (pos + 8 > length) return false;
+            uint64_t v = readBigEndian(data + pos);
+            pos += 8;
+            switch (keyType) {
+                case ValueType::UInt8:  out = static_cast<uint8_t>(v); break;
+                case ValueType::UInt16: out = static_cast<uint16_t>(v); break;
+                case ValueType::UInt32: out = static_cast<uint32_t>(v); break;
+                default:                out = v; break;
+            }
+            return true;
+        }
+        case KeyClass::Bool:
+            if (pos + 1 > length) return false;
+            out = data[pos++] != 0;
+            return true;
+        case KeyClass::Float: {
+            if (pos + 8 > length) return false;
+            uint64_t bits = readBigEndian(data + pos);
+            pos += 8;
+            bits = (bits & SIGN_BIT) ? (bits & ~SIGN_BIT) : ~bits;
+            double d;
+            std::memcpy(&d, &bits, 8);
+            if (keyType == ValueType::Float32) {
+                out = static_cast<float>(d);
+            } else {
+                out = d;
+            }
+            return true;
+        }
+        case KeyClass::String:
+        case KeyClass::Bytes: {
+            std::string bytes;
+            while (true) {
+                if (pos + 2 > length) return false;
+                uint8_t c = data[pos];
+                if (c == 0x00 || c == 0xFF) {
+                    uint8_t next = data[pos + 1];
+                    pos += 2;
+                    if (c == 0x00 && next == 0x01) break;  // Terminator
+                    if (c == 0x00 && next == 0xFF) bytes += '\x00';
+                    else if (c == 0xFF && next == 0x00) bytes += '\xFF';
+                    else return false;
+                } else {
+                    bytes += static_cast<char>(c);
+                    pos++;
+                }
+            }
+            if (cls == KeyClass::String) {
+                out = std::move(bytes);
+            } else {
+                out = std::vector<uint8_t>(bytes.begin(), bytes.end());
+            }
+            return true;
+        }
+        default:
+            return false;
+    }
+}
+
+uint64_t KeyCodec::prefix64(const uint8_t* data, size_t length) {
+    uint64_t v = 0;
+    for (size_t i = 0; i < 8; i++) {
+        v = (v << 8) | (i < length ? data[i] : 0);
+    }
+    return v;
+}
+
+}  // namespace flatsql
@@ -0,0 +1,424 @@
+#include "flatsql/learned_index.h"
+#include <algorithm>
+#include <stdexcept>
+
+namespace flatsql {
+
+static constexpr uint64_t SIGN_BIT = 0x8000000000000000ull;
+
+// The out-of-order buffer is merged once it holds more than entries /
+// PENDING_DIVISOR entries, clamped to [PENDING_MIN, PENDING_MAX]. The cap
+// bounds the cost of a sorted buffer insert when the stream jumps ahead
+// and most later keys arrive "late".
+static constexpr size_t PENDING_MIN = 256;
+static constexpr size_t PENDING_MAX = 4096;
+static constexpr size_t PENDING_DIVISOR = 64;
+
+// Ordinal distance b - a for a <= b, exact in uint64 even across the sign
+static inline double ordinalDistance(int64_t a, int64_t b) {
+    return static_cast<double>(static_cast<uint64_t>(b) - static_cast<uint64_t>(a));
+}
+
+static inline bool pendingLess(int64_t key, uint64_t sequence, int64_t otherKey, uint64_t otherSequence) {
+    return key < otherKey || (key == otherKey && sequence < otherSequence);
+}
+
+LearnedIndex::LearnedIndex(const std::string& columnName, ValueType keyType, size_t epsilon)
+    : columnName_(columnName), keyType_(keyType), epsilon_(epsilon) {
+    if (!supportsType(keyType)) {
+        throw std::runtime_error("Learned index on " + columnName + " requires a numeric column");
+    }
+    if (epsilon_ == 0) epsilon_ = 1;
+}
+
+bool LearnedIndex::supportsType(ValueType type) {
+    switch (type) {
+        case ValueType::Bool:
+        case ValueType::Int8:
+        case ValueType::Int16:
+        case ValueType::Int32:
+        case ValueType::Int64:
+        case ValueType::UInt8:
+        case ValueType::UInt16:
+        case ValueType::UInt32:
+        case ValueType::UInt64:
+        case ValueType::Float32:
+        case ValueType::Float64:
+            return true;
+        default:
+            return false;
+    }
+}
+
+// The KeyCodec encoding of a numeric key is at most 8 bytes and compares
+// as a big-endian unsigned integer; flipping the sign bit makes that a
+// signed ordinal, so integer keys map to themselves.
+bool LearnedIndex::toOrdinal(const Value& value, KeyCodec::Bound bound, int64_t& out) const {
+    std::string encoded;
+    if (!KeyCodec::append(keyType_, value, encoded, bound)) return false;
+    uint64_t prefix = KeyCodec::prefix64(reinterpret_cast<const uint8_t*>(encoded.data()), encoded.size());
+    out = static_cast<int64_t>(prefix ^ SIGN_BIT);
+    return true;
+}
+
+Value LearnedIndex::fromOrdinal(int64_t ordinal) const {
+    uint64_t prefix = static_cast<uint64_t>(ordinal) ^ SIGN_BIT;
+    uint8_t bytes[8];
+    for (int i = 7; i >= 0; i--) {
+        bytes[i] = static_cast<uint8_t>(prefix);
+        prefix >>= 8;
+    }
+    Value key;
+    size_t pos = 0;
+    KeyCodec::decode(keyType_, bytes, sizeof(bytes), pos, key);
+    return key;
+}
+
+void LearnedIndex::insert(const Value& key, uint64_t dataOffset, uint64_t sequence) {
+    int64_t ordinal;
+    if (!toOrdinal(key, KeyCodec::Bound::Exact, ordinal)) {
+        throw std::runtime_error("Learned index on " + columnName_ + ": key is null or not numeric");
+    }
+
+    // Append-optimized tail: in-order keys extend the arrays and the open segment
+    if (keys_.empty() || ordinal > keys_.back() ||
+        (ordinal == keys_.back() && sequence >= sequences_.back())) {
+        bool distinct = keys_.empty() || ordinal != keys_.back();
+        if (keys_.size() == keys_.capacity()) {
+            // Grow by 1/4 rather than doubling: the arrays are the index
+            size_t capacity = keys_.size() + keys_.size() / 4 + 64;
+            keys_.reserve(capacity);
+            offsets_.reserve(capacity);
+            sequences_.reserve(capacity);
+        }
+        keys_.push_back(ordinal);
+        offsets_.push_back(dataOffset);
+        sequences_.push_back(sequence);
+        if (distinct) fitPoint(ordinal, keys_.size() - 1);
+        return;
+    }
+
+    auto it = std::upper_bound(pending_.begin(), pending_.end(), Pending{ordinal, dataOffset, sequence},
+                               [](const Pending& a, const Pending& b) {
+                                   return pendingLess(a.key, a.sequence, b.key, b.sequence);
+                               });
+    pending_.insert(it, Pending{ordinal, dataOffset, sequence});
+
+    size_t limit = std::min(std::max(keys_.size() / PENDING_DIVISOR, PENDING_MIN), PENDING_MAX);
+    if (pending_.size() > limit) {
+        mergePending();
+    }
+}
+
+// Shrinking cone: the open segment is anchored at its first point and keeps
+// the interval of slopes that predict every later point within epsilon. A
+// point that leaves the interval empty starts a new segment.
+void LearnedIndex::fitPoint(int64_t key, size_t position) {
+    if (!segments_.empty()) {
+        Segment& seg = segments_.back();
+        double dx = ordinalDistance(seg.firstKey, key);
+        double dy = static_cast<double>(position - seg.start);
+        double eps = static_cast<double>(epsilon_);
+        double low = (dy - eps) / dx;
+        double high = (dy + eps) / dx;
+
+        if (!coneOpen_) {
+            coneLow_ = std::max(low, 0.0);
+            coneHigh_ = high;
+            coneOpen_ = true;
+            seg.slope = (coneLow_ + coneHigh_) / 2;
+            return;
+        }
+        if (low <= coneHigh_ && high >= coneLow_) {
+            coneLow_ = std::max(coneLow_, low);
+            coneHigh_ = std::min(coneHigh_, high);
+            seg.slope = (coneLow_ + coneHigh_) / 2;
+            return;
+        }
+    }
+    segments_.push_back(Segment{key, 0.0, position});
+    coneOpen_ = false;
+}
+
+void LearnedIndex::refit() {
+    segments_.clear();
+    coneOpen_ = false;
+    for (size_t i = 0; i < keys_.size(); i++) {
+        if (i == 0 || keys_[i] != keys_[i - 1]) fitPoint(keys_[i], i);
+    }
+}
+
+void LearnedIndex::mergePending() {
+    if (pending_.empty()) return;
+
+    size_t total = keys_.size() + pending_.size();
+    PageVector<int64_t> keys;
+    PageVector<uint64_t> offsets;
+    PageVector<uint64_t> sequences;
+    keys.reserve(total);
+    offsets.reserve(total);
+    sequences.reserve(total);
+
+    size_t i = 0, j = 0;
+    while (i < keys_.size() || j < pending_.size()) {
+        bool takeMain = j == pending_.size() ||
+            (i < keys_.size() && !pendingLess(pending_[j].key, pending_[j].sequence, keys_[i], sequences_[i]));
+        if (takeMain) {
+            keys.push_back(keys_[i]);
+            offsets.push_back(offsets_[i]);
+            sequences.push_back(sequences_[i]);
+            i++;
+        } else {
+            keys.push_back(pending_[j].key);
+            offsets.push_back(pending_[j].offset);
+            sequences.push_back(pending_[j].sequence);
+            j++;
+        }
+    }
+
+    keys_ = std::move(keys);
+    offsets_ = std::move(offsets);
+    sequences_ = std::move(sequences);
+    pending_.clear();
+    refit();
+}
+
+size_t LearnedIndex::lowerBound(int64_t ordinal) const {
+    if (keys_.empty() || ordinal <= keys_.front()) return 0;
+
+    // Last segment starting at or below the key
+    auto segIt = std::upper_bound(segments_.begin(), segments_.end(), ordinal,
+                                  [](int64_t k, const Segment& s) { return k < s.firstKey; });
+    const Segment& seg = *(segIt - 1);
+    size_t end = segIt == segments_.end() ? keys_.size() : segIt->start;
+
+    // Predicted position, then a binary search over its error window. The
+    // extra slot each side absorbs floating-point rounding.
+    double predicted = static_cast<double>(seg.start) + seg.slope * ordinalDistance(seg.firstKey, ordinal);
+    size_t pos = predicted >= static_cast<double>(end) ? end : static_cast<size_t>(predicted);
+    size_t lo = pos > seg.start + epsilon_ + 1 ? pos - epsilon_ - 1 : seg.start;
+    size_t hi = std::min(end, pos + epsilon_ + 2);
+
+    auto base = keys_.begin();
+    size_t found = std::lower_bound(base + lo, base + hi, ordinal) - base;
+
+    // The bound holds for keys in the index; an absent key past a long run
+    // of duplicates can predict outside its window, so widen to the segment
+    if (found == lo && lo > seg.start && keys_[lo - 1] >= ordinal) {
+        found = std::lower_bound(base + seg.start, base + lo, ordinal) - base;
+    } else if (found == hi && hi < end) {
+        found = std::lower_bound(base + hi, base + end, ordinal) - base;
+    }
+    return found;
+}
+
+void LearnedIndex::applyConstraint(OrdinalRange& range, Op op, const Value& value) const {
+    if (range.empty) return;
+    int64_t bound;
+    int64_t exact;
+    switch (op) {
+        case Op::Eq:
+            if (!toOrdinal(value, KeyCodec::Bound::Exact, bound)) {
+                range.empty = true;
+                return;
+            }
+            range.lo = std::max(range.lo, bound);
+            range.hi = std::min(range.hi, bound);
+            break;
+        case Op::Ge:
+        case Op::Gt:
+            if (!toOrdinal(value, KeyCodec::Bound::Lower, bound)) {
+                range.empty = true;
+                return;
+            }
+            // Strict only matters when the value is itself a key
+            if (op == Op::Gt && toOrdinal(value, KeyCodec::Bound::Exact, exact) && exact == bound) {
+                if (bound == INT64_MAX) {
+                    range.empty = true;
+                    return;
+                }
+                bound++;
+            }
+            range.lo = std::max(range.lo, bound);
+            break;
+        case Op::Le:
+        case Op::Lt:
+            if (!toOrdinal(value, KeyCodec::Bound::Upper, bound)) {
+                range.empty = true;
+                return;
+            }
+            if (op == Op::Lt && toOrdinal(value, KeyCodec::Bound::Exact, exact) && exact == bound) {
+                if (bound == INT64_MIN) {
+                    range.empty = true;
+                    return;
+                }
+                bound--;
+            }
+            range.hi = std::min(range.hi, bound);
+            break;
+    }
+    if (range.lo > range.hi) range.empty = true;
+}
+
+std::vector<IndexEntry> LearnedIndex::collect(const OrdinalRange& range) const {
+    std::vector<IndexEntry> results;
+    if (range.empty) return results;
+
+    size_t i = lowerBound(range.lo);
+    size_t iEnd = range.hi == INT64_MAX ? keys_.size() : lowerBound(range.hi + 1);
+
+    auto pendingLower = [this](int64_t k) {
+        return std::lower_bound(pending_.begin(), pending_.end(), k,
+                                [](const Pending& p, int64_t key) { return p.key < key; });
+    };
+    auto j = pendingLower(range.lo);
+    auto jEnd = range.hi == INT64_MAX ? pending_.end() : pendingLower(range.hi + 1);
+
+    results.reserve((iEnd - i) + static_cast<size_t>(jEnd - j));
+    while (i < iEnd || j != jEnd) {
+        if (j == jEnd || (i < iEnd && !pendingLess(j->key, j->sequence, keys_[i], sequences_[i]))) {
+            results.push_back(IndexEntry{fromOrdinal(keys_[i]), offsets_[i], 0, sequences_[i]});
+            i++;
+        } else {
+            results.push_back(IndexEntry{fromOrdinal(j->key), j->offset, 0, j->sequence});
+            ++j;
+        }
+    }
+    return results;
+}
+
+void LearnedIndex::openQuery(const std::vector<std::pair<Op, Value>>& constraints, IndexCursor& cursor) const {
+    OrdinalRange range;
+    for (const auto& [op, value] : constraints) {
+        applyConstraint(range, op, value);
+    }
+    cursor.open([this](IndexCursor& c) { fillCursor(c); });
+    if (range.empty) {
+        cursor.close();
+        return;
+    }
+    KeyCodec::appendUInt64(static_cast<uint64_t>(range.lo) ^ SIGN_BIT, cursor.from);
+    if (range.hi != INT64_MAX) {
+        KeyCodec::appendUInt64(static_cast<uint64_t>(range.hi) ^ SIGN_BIT, cursor.to);
+        cursor.hasTo = true;
+    }
+}
+
+void LearnedIndex::fillCursor(IndexCursor& cursor) const {
+    auto ordinalOf = [](const std::string& bytes) {
+        return static_cast<int64_t>(
+            KeyCodec::prefix64(reinterpret_cast<const uint8_t*>(bytes.data()), bytes.size()) ^ SIGN_BIT);
+    };
+    int64_t lo = ordinalOf(cursor.from);
+    int64_t hi = cursor.hasTo ? ordinalOf(cursor.to) : INT64_MAX;
+    bool resume = cursor.fromResume;
+    uint64_t after = cursor.fromSequence;
+
+    // First entries after the position, in both arrays
+    size_t i = lowerBound(lo);
+    size_t iEnd = hi == INT64_MAX ? keys_.size() : lowerBound(hi + 1);
+    if (resume) {
+        size_t run = lo == INT64_MAX ? keys_.size() : lowerBound(lo + 1);
+        i = static_cast<size_t>(std::upper_bound(sequences_.begin() + i, sequences_.begin() + run, after) -
+                                sequences_.begin());
+    }
+
+    auto pendingLower = [this](int64_t k) {
+        return std::lower_bound(pending_.begin(), pending_.end(), k,
+                                [](const Pending& p, int64_t key) { return p.key < key; });
+    };
+    auto j = resume
+        ? std::upper_bound(pending_.begin(), pending_.end(), Pending{lo, 0, after},
+                           [](const Pending& a, const Pending& b) {
+                               return pendingLess(a.key, a.sequence, b.key, b.sequence);
+                           })
+        : pendingLower(lo);
+    auto jEnd = hi == INT64_MAX ? pending_.end() : pendingLower(hi + 1);
+
+    char key[8];
+    auto push = [&](int64_t ordinal, uint64_t offset, uint64_t sequence) {
+        uint64_t prefix = static_cast<uint64_t>(ordinal) ^ SIGN_BIT;
+        for (int b = 7; b >= 0; b--) {
+            key[b] = static_cast<char>(prefix);
+            prefix >>= 8;
+        }
+        return cursor.push(key, sizeof(key), offset, sequence);
+    };
+    while (i < iEnd || j < jEnd) {
+        bool more;
+        if (j >= jEnd || (i < iEnd && !pendingLess(j->key, j->sequence, keys_[i], sequences_[i]))) {
+            more = push(keys_[i], offsets_[i], sequences_[i]);
+            i++;
+        } else {
+            more = push(j->key, j->offset, j->sequence);
+            ++j;
+        }
+        if (!more) return;
+    }
+}
+
+std::vector<IndexEntry> LearnedIndex::query(const std::vector<std::pair<Op, Value>>& constraints) const {
+    OrdinalRange range;
+    for (const auto& [op, value] : constraints) {
+        applyConstraint(range, op, value);
+    }
+    return collect(range);
+}
+
+std::vector<IndexEntry> LearnedIndex::search(const Value& key) const {
+    OrdinalRange range;
+    applyConstraint(range, Op::Eq, key);
+    return collect(range);
+}
+
+bool LearnedIndex::searchFirst(const Value& key, IndexEntry& result) const {
+    int64_t ordinal;
+    if (!toOrdinal(key, KeyCodec::Bound::Exact, ordinal)) return false;
+
+    size_t i = lowerBound(ordinal);
+    bool inMain = i < keys_.size() && keys_[i] == ordinal;
+
+    auto j = std::lower_bound(pending_.begin(), pending_.end(), ordinal,
+                              [](const Pending& p, int64_t k) { return p.key < k; });
+    bool inPending = j != pending_.end() && j->key == ordinal;
+
+    if (inPending && (!inMain || j->sequence < sequences_[i])) {
+        result = IndexEntry{fromOrdinal(ordinal), j->offset, 0, j->sequence};
+        return true;
+    }
+    if (inMain) {
+        result = IndexEntry{fromOrdinal(ordinal), offsets_[i], 0, sequences_[i]};
+        return true;
+    }
+    return false;
+}
+
+std::vector<IndexEntry> LearnedIndex::range(const Value& minKey, const Value& maxKey) const {
+    OrdinalRange range;
+    applyConstraint(range, Op::Ge, minKey);
+    applyConstraint(range, Op::Le, maxKey);
+    return collect(range);
+}
+
+std::vector<IndexEntry> LearnedIndex::all() const {
+    return collect(OrdinalRange{});
+}
+
+size_t LearnedIndex::getMemoryBytes() const {
+    return keys_.capacity() * sizeof(int64_t) +
+           offsets_.capacity() * sizeof(uint64_t) +
+           sequences_.capacity() * sizeof(uint64_t) +
+           segments_.capacity() * sizeof(Segment) +
+           pending_.capacity() * sizeof(Pending);
+}
+
+void LearnedIndex::clear() {
+    keys_.clear();
+    offsets_.clear();
+    sequences_.clear();
+    segments_.clear();
+    pending_.clear();
+    coneOpen_ = false;
+}
+
+}  // namespace flatsql
@@ -0,0 +1,784 @@
+#include "flatsql/radix_index.h"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+#if defined(__SSE2__)
+#define FLATSQL_RADIX_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace flatsql {
+
+namespace {
+
+enum NodeType : uint8_t { LEAF, NODE4, NODE16, NODE48, NODE256 };
+
+struct Posting {
+    uint64_t offset;
+    uint64_t sequence;
+};
+
+// Heap bytes behind a std::string past its small-string buffer (15 bytes
+// in libstdc++, 22 in libc++; the smaller one is assumed)
+inline size_t stringHeapBytes(const std::string& s) {
+    return s.capacity() > 15 ? s.capacity() + 1 : 0;
+}
+
+// Compare path[from, ...) with bound[from, ...), where the bytes before
+// from are equal. Returns the sign of the first difference; when no byte
+// differs, 1 if path runs past the end of bound (every key below it is
+// greater) and 0 if the bound still applies below. A path exactly equal to
+// bound may be a whole key, so it stays undecided.
+inline int comparePath(const std::string& path, size_t from, const std::string& bound) {
+    size_t n = std::min(path.size(), bound.size());
+    for (size_t i = from; i < n; i++) {
+        uint8_t a = static_cast<uint8_t>(path[i]);
+        uint8_t b = static_cast<uint8_t>(bound[i]);
+        if (a != b) return a < b ? -1 : 1;
+    }
+    return path.size() > bound.size() ? 1 : 0;
+}
+
+// memcmp order, shorter first on a tie
+inline int compareKeys(const std::string& a, const std::string& b) {
+    int c = std::memcmp(a.data(), b.data(), std::min(a.size(), b.size()));
+    if (c != 0) return c;
+    return a.size() < b.size() ? -1 : (a.size() > b.size() ? 1 : 0);
+}
+
+}  // namespace
+
+struct RadixIndex::Node {
+    explicit Node(uint8_t t) : type(t) {}
+    uint8_t type;
+};
+
+struct RadixIndex::Leaf : Node {
+    Leaf() : Node(LEAF) {}
+    std::string key;             // Full encoded key
+    Posting first;               // Lowest sequence
+    std::vector<Posting> more;   // Further postings of a non-unique key, by sequence
+};
+
+struct RadixIndex::Inner : Node {
+    explicit Inner(uint8_t t) : Node(t) {}
+    uint16_t count = 0;
+    uint32_t prefixLength = 0;                     // Compressed path length
+    uint8_t prefix[RadixIndex::PREFIX_INLINE];     // Its first PREFIX_INLINE bytes
+};
+
+struct RadixIndex::Node4 : Inner {
+    Node4() : Inner(NODE4) {}
+    uint8_t keys[4];
+    Node* children[4];
+};
+
+struct RadixIndex::Node16 : Inner {
+    Node16() : Inner(NODE16) {}
+    uint8_t keys[16];
+    Node* children[16];
+};
+
+struct RadixIndex::Node48 : Inner {
+    Node48() : Inner(NODE48) { std::memset(slot, 0, sizeof(slot)); }
+    uint8_t slot[256];  // Byte -> child slot + 1, 0 when absent
+    Node* children[48];
+};
+
+struct RadixIndex::Node256 : Inner {
+    Node256() : Inner(NODE256) { std::memset(children, 0, sizeof(children)); }
+    Node* children[256];
+};
+
+RadixIndex::RadixIndex(const std::string& columnName, ValueType keyType)
+    : columnName_(columnName), keyType_(keyType) {
+    if (!supportsType(keyType)) {
+        throw std::runtime_error("Radix index on " + columnName + " requires a string or blob column");
+    }
+}
+
+RadixIndex::~RadixIndex() {
+    freeNode(root_);
+}
+
+bool RadixIndex::supportsType(ValueType type) {
+    return type == ValueType::String || type == ValueType::Bytes;
+}
+
+void RadixIndex::freeNode(Node* node) {
+    if (!node) return;
+    switch (node->type) {
+        case LEAF:
+            delete static_cast<Leaf*>(node);
+            return;
+        case NODE4: {
+            auto* n = static_cast<Node4*>(node);
+            for (uint16_t i = 0; i < n->count; i++) freeNode(n->children[i]);
+            delete n;
+            return;
+        }
+        case NODE16: {
+            auto* n = static_cast<Node16*>(node);
+            for (uint16_t i = 0; i < n->count; i++) freeNode(n->children[i]);
+            delete n;
+            return;
+        }
+        case NODE48: {
+            auto* n = static_cast<Node48*>(node);
+            for (uint16_t i = 0; i < n->count; i++) freeNode(n->children[i]);
+            delete n;
+            return;
+        }
+        default: {
+            auto* n = static_cast<Node256*>(node);
+            for (Node* child : n->children) freeNode(child);
+            delete n;
+            return;
+        }
+    }
+}
+
+void RadixIndex::clear() {
+    freeNode(root_);
+    root_ = nullptr;
+    entryCount_ = 0;
+    keyCount_ = 0;
+    nodeCount_ = 0;
+    memoryBytes_ = 0;
+}
+
+// ==================== Node operations ====================
+
+RadixIndex::Node** RadixIndex::findChild(Inner* node, uint8_t byte) {
+    switch (node->type) {
+        case NODE4: {
+            auto* n = static_cast<Node4*>(node);
+            for (uint16_t i = 0; i < n->count; i++) {
+                if (n->keys[i] == byte) return &n->children[i];
+            }
+            return nullptr;
+        }
+        case NODE16: {
+            auto* n = static_cast<Node16*>(node);
+#ifdef FLATSQL_RADIX_SSE2
+            __m128i cmp = _mm_cmpeq_epi8(_mm_set1_epi8(static_cast<char>(byte)),
+                                         _mm_loadu_si128(reinterpret_cast<const __m128i*>(n->keys)));
+            unsigned mask = static_cast<unsigned>(_mm_movemask_epi8(cmp)) & ((1u << n->count) - 1);
+            return mask ? &n->children[__builtin_ctz(mask)] : nullptr;
+#else
+            for (uint16_t i = 0; i < n->count; i++) {
+                if (n->keys[i] == byte) return &n->children[i];
+            }
+            return nullptr;
+#endif
+        }
+        case NODE48: {
+            auto* n = static_cast<Node48*>(node);
+            return n->slot[byte] ? &n->children[n->slot[byte] - 1] : nullptr;
+        }
+        default: {
+            auto* n = static_cast<Node256*>(node);
+            return n->children[byte] ? &n->children[byte] : nullptr;
+        }
+    }
+}
+
+const RadixIndex::Leaf* RadixIndex::minimumLeaf(const Node* node) {
+    while (node && node->type != LEAF) {
+        switch (node->type) {
+            case NODE4:  node = static_cast<const Node4*>(node)->children[0]; break;
+            case NODE16: node = static_cast<const Node16*>(node)->children[0]; break;
+            case NODE48: {
+                auto* n = static_cast<const Node48*>(node);
+                int b = 0;
+                while (!n->slot[b]) b++;
+                node = n->children[n->slot[b] - 1];
+                break;
+            }
+            default: {
+                auto* n = static_cast<const Node256*>(node);
+                int b = 0;
+                while (!n->children[b]) b++;
+                node = n->children[b];
+                break;
+            }
+        }
+    }
+    return static_cast<const Leaf*>(node);
+}
+
+// Sorted insert into the key/child arrays of a Node4 or Node16 with room
+template <typename N>
+void RadixIndex::insertSorted(N* n, uint8_t byte, Node* child) {
+    uint16_t pos = 0;
+    while (pos < n->count && n->keys[pos] < byte) pos++;
+    std::memmove(n->keys + pos + 1, n->keys + pos, n->count - pos);
+    std::memmove(n->children + pos + 1, n->children + pos, (n->count - pos) * sizeof(Node*));
+    n->keys[pos] = byte;
+    n->children[pos] = child;
+    n->count++;
+}
+
+void RadixIndex::copyHeader(Inner* to, const Inner* from) {
+    to->count = from->count;
+    to->prefixLength = from->prefixLength;
+    std::memcpy(to->prefix, from->prefix, PREFIX_INLINE);
+}
+
+void RadixIndex::addChild(Node** ref, Inner* node, uint8_t byte, Node* child) {
+    switch (node->type) {
+        case NODE4: {
+            auto* n = static_cast<Node4*>(node);
+            if (n->count < 4) {
+                insertSorted(n, byte, child);
+                return;
+            }
+            auto* grown = new Node16();
+            copyHeader(grown, n);
+            std::memcpy(grown->keys, n->keys, 4);
+            std::memcpy(grown->children, n->children, 4 * sizeof(Node*));
+            memoryBytes_ += sizeof(Node16) - sizeof(Node4);
+            delete n;
+            *ref = grown;
+            insertSorted(grown, byte, child);
+            return;
+        }
+        case NODE16: {
+            auto* n = static_cast<Node16*>(node);
+            if (n->count < 16) {
+                insertSorted(n, byte, child);
+                return;
+            }
+            auto* grown = new Node48();
+            copyHeader(grown, n);
+            for (uint16_t i = 0; i < 16; i++) {
+                grown->slot[n->keys[i]] = static_cast<uint8_t>(i + 1);
+                grown->children[i] = n->children[i];
+            }
+            memoryBytes_ += sizeof(Node48) - sizeof(Node16);
+            delete n;
+            *ref = grown;
+            addChild(ref, grown, byte, child);
+            return;
+        }
+        case NODE48: {
+            auto* n = static_cast<Node48*>(node);
+            if (n->count < 48) {
+                // Nothing is ever removed, so slots fill in order
+                n->children[n->count] = child;
+                n->slot[byte] = static_cast<uint8_t>(n->count + 1);
+                n->count++;
+                return;
+            }
+            auto* grown = new Node256();
+            copyHeader(grown, n);
+            for (int b = 0; b < 256; b++) {
+                if (n->slot[b]) grown->children[b] = n->children[n->slot[b] - 1];
+            }
+            memoryBytes_ += sizeof(Node256) - sizeof(Node48);
+            delete n;
+            *ref = grown;
+            addChild(ref, grown, byte, child);
+            return;
+        }
+        default: {
+            auto* n = static_cast<Node256*>(node);
+            n->children[byte] = child;
+            n->count++;
+            return;
+        }
+    }
+}
+
+RadixIndex::Node4* RadixIndex::newNode4(const uint8_t* prefix, size_t prefixLength) {
+    auto* n = new Node4();
+    n->prefixLength = static_cast<uint32_t>(prefixLength);
+    std::memcpy(n->prefix, prefix, std::min(prefixLength, PREFIX_INLINE));
+    nodeCount_++;
+    memoryBytes_ += sizeof(Node4);
+    return n;
+}
+
+RadixIndex::Leaf* RadixIndex::newLeaf(const std::string& key, uint64_t offset, uint64_t sequence) {
+    auto* leaf = new Leaf();
+    leaf->key = key;
+    leaf->first = Posting{offset, sequence};
+    keyCount_++;
+    memoryBytes_ += sizeof(Leaf) + stringHeapBytes(leaf->key);
+    return leaf;
+}
+
+// Length of the match between the node's compressed path and key[depth...]
+size_t RadixIndex::prefixMismatch(const Inner* node, const std::string& key, size_t depth) {
+    const auto* k = reinterpret_cast<const uint8_t*>(key.data());
+    size_t limit = std::min<size_t>(node->prefixLength, key.size() - depth);
+    size_t inlineLimit = std::min(limit, PREFIX_INLINE);
+    size_t i = 0;
+    while (i < inlineLimit && node->prefix[i] == k[depth + i]) i++;
+    if (i < inlineLimit || limit <= PREFIX_INLINE) return i;
+
+    // The rest of the path is only held by the leaves
+    const auto* full = reinterpret_cast<const uint8_t*>(minimumLeaf(node)->key.data());
+    while (i < limit && full[depth + i] == k[depth + i]) i++;
+    return i;
+}
+
+// ==================== Insert ====================
+
+void RadixIndex::insert(const Value& key, uint64_t dataOffset, uint64_t sequence) {
+    std::string encoded;
+    if (!KeyCodec::append(keyType_, key, encoded)) {
+        throw std::runtime_error("Radix index on " + columnName_ + ": key is null or can't be stored");
+    }
+    insertEncoded(encoded, dataOffset, sequence);
+}
+
+void RadixIndex::insertEncoded(const std::string& key, uint64_t offset, uint64_t sequence) {
+    entryCount_++;
+    const auto* k = reinterpret_cast<const uint8_t*>(key.data());
+    Node** ref = &root_;
+    size_t depth = 0;
+
+    // Encoded keys are prefix-free, so a key never runs out of bytes before
+    // it reaches a leaf or an empty child slot
+    while (true) {
+        Node* node = *ref;
+        if (!node) {
+            *ref = newLeaf(key, offset, sequence);
+            return;
+        }
+
+        if (node->type == LEAF) {
+            auto* leaf = static_cast<Leaf*>(node);
+            if (leaf->key == key) {
+                // Postings stay in sequence order; ingest order is the common case
+                size_t before = leaf->more.capacity();
+                Posting posting{offset, sequence};
+                if (sequence < leaf->first.sequence) {
+                    std::swap(posting, leaf->first);
+                }
+                auto pos = std::upper_bound(leaf->more.begin(), leaf->more.end(), posting.sequence,
+                                            [](uint64_t s, const Posting& p) { return s < p.sequence; });
+                leaf->more.insert(pos, posting);
+                memoryBytes_ += (leaf->more.capacity() - before) * sizeof(Posting);
+                return;
+            }
+
+            // Split: a Node4 holding the shared bytes, with both leaves under it
+            const auto* other = reinterpret_cast<const uint8_t*>(leaf->key.data());
+            size_t end = depth;
+            while (other[end] == k[end]) end++;
+            Node4* split = newNode4(k + depth, end - depth);
+            insertSorted(split, other[end], leaf);
+            insertSorted(split, k[end], newLeaf(key, offset, sequence));
+            *ref = split;
+            return;
+        }
+
+        auto* inner = static_cast<Inner*>(node);
+        if (inner->prefixLength > 0) {
+            size_t match = prefixMismatch(inner, key, depth);
+            if (match < inner->prefixLength) {
+                // The key leaves the compressed path: split it at the mismatch
+                Node4* split = newNode4(k + depth, match);
+                uint8_t byte;
+                uint32_t rest = inner->prefixLength - static_cast<uint32_t>(match) - 1;
+                if (inner->prefixLength <= PREFIX_INLINE) {
+                    byte = inner->prefix[match];
+                    std::memmove(inner->prefix, inner->prefix + match + 1, rest);
+                } else {
+                    const auto* full = reinterpret_cast<const uint8_t*>(minimumLeaf(inner)->key.data());
+                    byte = full[depth + match];
+                    std::memcpy(inner->prefix, full + depth + match + 1, std::min<size_t>(rest, PREFIX_INLINE));
+                }
+                inner->prefixLength = rest;
+                insertSorted(split, byte, inner);
+                insertSorted(split, k[depth + match], newLeaf(key, offset, sequence));
+                *ref = split;
+                return;
+            }
+            depth += inner->prefixLength;
+        }
+
+        Node** child = findChild(inner, k[depth]);
+        if (!child) {
+            addChild(ref, inner, k[depth], newLeaf(key, offset, sequence));
+            return;
+        }
+        ref = child;
+        depth++;
+    }
+}
+
+// ==================== Lookup ====================
+
+const RadixIndex::Leaf* RadixIndex::findLeaf(const uint8_t* key, size_t length) const {
+    const Node* node = root_;
+    size_t depth = 0;
+    while (node) {
+        if (node->type == LEAF) {
+            const auto* leaf = static_cast<const Leaf*>(node);
+            if (leaf->key.size() == length && std::memcmp(leaf->key.data(), key, length) == 0) {
+                return leaf;
+            }
+            return nullptr;
+        }
+
+        // Only the inline part of a long prefix is checked on the way down;
+        // the leaf comparison catches a mismatch past it
+        const auto* inner = static_cast<const Inner*>(node);
+        if (inner->prefixLength > 0) {
+            if (depth + inner->prefixLength >= length) return nullptr;
+            size_t n = std::min<size_t>(inner->prefixLength, PREFIX_INLINE);
+            if (std::memcmp(inner->prefix, key + depth, n) != 0) return nullptr;
+            depth += inner->prefixLength;
+        }
+        if (depth >= length) return nullptr;
+
+        Node** child = findChild(const_cast<Inner*>(inner), key[depth]);
+        node = child ? *child : nullptr;
+        depth++;
+    }
+    return nullptr;
+}
+
+IndexEntry RadixIndex::makeEntry(const std::string& key, uint64_t offset, uint64_t sequence) const {
+    IndexEntry entry;
+    size_t pos = 0;
+    if (!KeyCodec::decode(keyType_, reinterpret_cast<const uint8_t*>(key.data()), key.size(), pos, entry.key)) {
+        entry.key = std::monostate{};
+    }
+    entry.dataOffset = offset;
+    entry.dataLength = 0;
+    entry.sequence = sequence;
+    return entry;
+}
+
+std::vector<IndexEntry> RadixIndex::search(const Value& key) const {
+    std::vector<IndexEntry> results;
+    std::string encoded;
+    if (!KeyCodec::append(keyType_, key, encoded)) return results;
+
+    const Leaf* leaf = findLeaf(reinterpret_cast<const uint8_t*>(encoded.data()), encoded.size());
+    if (!leaf) return results;
+    results.reserve(1 + leaf->more.size());
+    results.push_back(makeEntry(leaf->key, leaf->first.offset, leaf->first.sequence));
+    for (const auto& p : leaf->more) {
+        results.push_back(makeEntry(leaf->key, p.offset, p.sequence));
+    }
+    return results;
+}
+
+bool RadixIndex::searchFirst(const Value& key, IndexEntry& result) const {
+    std::string encoded;
+    if (!KeyCodec::append(keyType_, key, encoded)) return false;
+
+    const Leaf* leaf = findLeaf(reinterpret_cast<const uint8_t*>(encoded.data()), encoded.size());
+    if (!leaf) return false;
+    result = makeEntry(leaf->key, leaf->first.offset, leaf->first.sequence);
+    return true;
+}
+
+bool RadixIndex::searchFirstString(const std::string& key, uint64_t& outOffset, uint64_t& outSequence) const {
+    keyBuffer_.clear();
+    if (keyType_ == ValueType::String) {
+        KeyCodec::appendBytes(key.data(), key.size(), keyBuffer_);
+    } else if (!KeyCodec::append(keyType_, Value(key), keyBuffer_)) {
+        return false;
+    }
+
+    return searchFirstEncoded(keyBuffer_, outOffset, outSequence);
+}
+
+bool RadixIndex::searchFirstEncoded(const std::string& key, uint64_t& outOffset, uint64_t& outSequence) const {
+    const Leaf* leaf = findLeaf(reinterpret_cast<const uint8_t*>(key.data()), key.size());
+    if (!leaf) return false;
+    outOffset = leaf->first.offset;
+    outSequence = leaf->first.sequence;
+    return true;
+}
+
+// ==================== Ordered walks ====================
+
+bool RadixIndex::walk(const Node* node, std::string& path, const Bounds& bounds,
+                      bool lowOpen, bool highOpen, const Visitor& visit) const {
+    if (node->type == LEAF) {
+        const auto* leaf = static_cast<const Leaf*>(node);
+        if (!lowOpen) {
+            int c = compareKeys(leaf->key, bounds.low);
+            if (c < 0 || (c == 0 && !bounds.lowInclusive)) return true;
+        }
+        if (!highOpen) {
+            int c = compareKeys(leaf->key, bounds.high);
+            if (c > 0 || (c == 0 && !bounds.highInclusive)) return false;  // Past the end
+        }
+        if (!visit(leaf->key, leaf->first.offset, leaf->first.sequence)) return false;
+        for (const auto& p : leaf->more) {
+            if (!visit(leaf->key, p.offset, p.sequence)) return false;
+        }
+        return true;
+    }
+
+    const auto* inner = static_cast<const Inner*>(node);
+    size_t base = path.size();
+    if (inner->prefixLength > 0) {
+        if (inner->prefixLength <= PREFIX_INLINE) {
+            path.append(reinterpret_cast<const char*>(inner->prefix), inner->prefixLength);
+        } else {
+            path.append(minimumLeaf(inner)->key, base, inner->prefixLength);
+        }
+    }
+
+    // Below the bounds' common bytes a subtree is wholly inside, wholly
+    // outside, or still straddles a bound
+    auto check = [&](size_t from, bool& lo, bool& hi) {
+        if (!lo) {
+            int c = comparePath(path, from, bounds.low);
+            if (c < 0) return 1;   // Before low: skip
+            if (c > 0) lo = true;
+        }
+        if (!hi) {
+            int c = comparePath(path, from, bounds.high);
+            if (c > 0) return 2;   // Past high: stop
+            if (c < 0) hi = true;
+        }
+        return 0;
+    };
+
+    int outcome = check(base, lowOpen, highOpen);
+    if (outcome != 0) {
+        path.resize(base);
+        return outcome == 1;
+    }
+
+    auto visitChild = [&](uint8_t byte, const Node* child) {
+        path.push_back(static_cast<char>(byte));
+        bool lo = lowOpen, hi = highOpen;
+        int result = check(path.size() - 1, lo, hi);
+        bool more = result == 0 ? walk(child, path, bounds, lo, hi, visit) : result == 1;
+        path.pop_back();
+        return more;
+    };
+
+    bool more = true;
+    switch (inner->type) {
+        case NODE4: {
+            auto* n = static_cast<const Node4*>(inner);
+            for (uint16_t i = 0; i < n->count && more; i++) more = visitChild(n->keys[i], n->children[i]);
+            break;
+        }
+        case NODE16: {
+            auto* n = static_cast<const Node16*>(inner);
+            for (uint16_t i = 0; i < n->count && more; i++) more = visitChild(n->keys[i], n->children[i]);
+            break;
+        }
+        case NODE48: {
+            auto* n = static_cast<const Node48*>(inner);
+            for (int b = 0; b < 256 && more; b++) {
+                if (n->slot[b]) more = visitChild(static_cast<uint8_t>(b), n->children[n->slot[b] - 1]);
+            }
+            break;
+        }
+        default: {
+            auto* n = static_cast<const Node256*>(inner);
+            for (int b = 0; b < 256 && more; b++) {
+                if (n->children[b]) more = visitChild(static_cast<uint8_t>(b), n->children[b]);
+            }
+            break;
+        }
+    }
+    path.resize(base);
+    return more;
+}
+
+void RadixIndex::scan(const Bounds& bounds, const Visitor& visit) const {
+    if (!root_ || bounds.empty) return;
+    if (bounds.hasLow && bounds.hasHigh) {
+        int c = compareKeys(bounds.low, bounds.high);
+        if (c > 0 || (c == 0 && !(bounds.lowInclusive && bounds.highInclusive))) return;
+    }
+    std::string path;
+    walk(root_, path, bounds, !bounds.hasLow, !bounds.hasHigh, visit);
+}
+
+std::vector<IndexEntry> RadixIndex::collect(const Bounds& bounds) const {
+    std::vector<IndexEntry> results;
+    scan(bounds, [&](const std::string& key, uint64_t offset, uint64_t sequence) {
+        results.push_back(makeEntry(key, offset, sequence));
+        return true;
+    });
+    return results;
+}
+
+void RadixIndex::setLow(Bounds& bounds, const std::string& key, bool inclusive) {
+    int c = bounds.hasLow ? compareKeys(key, bounds.low) : 1;
+    if (c > 0) {
+        bounds.low = key;
+        bounds.lowInclusive = inclusive;
+        bounds.hasLow = true;
+    } else if (c == 0) {
+        bounds.lowInclusive = bounds.lowInclusive && inclusive;
+    }
+}
+
+void RadixIndex::setHigh(Bounds& bounds, const std::string& key, bool inclusive) {
+    int c = bounds.hasHigh ? compareKeys(key, bounds.high) : -1;
+    if (c < 0) {
+        bounds.high = key;
+        bounds.highInclusive = inclusive;
+        bounds.hasHigh = true;
+    } else if (c == 0) {
+        bounds.highInclusive = bounds.highInclusive && inclusive;
+    }
+}
+
+void RadixIndex::applyConstraint(Bounds& bounds, Op op, const Value& value) const {
+    if (bounds.empty) return;
+    std::string bound;
+    std::string exact;
+    switch (op) {
+        case Op::Eq:
+            if (!KeyCodec::append(keyType_, value, bound)) {
+                bounds.empty = true;
+                return;
+            }
+            setLow(bounds, bound, true);
+            setHigh(bounds, bound, true);
+            break;
+        case Op::Ge:
+        case Op::Gt: {
+            if (!KeyCodec::append(keyType_, value, bound, KeyCodec::Bound::Lower)) {
+                bounds.empty = true;
+                return;
+            }
+            // Strict only matters when the value is itself a key
+            bool strict = op == Op::Gt && KeyCodec::append(keyType_, value, exact) && exact == bound;
+            setLow(bounds, bound, !strict);
+            break;
+        }
+        case Op::Le:
+        case Op::Lt: {
+            if (!KeyCodec::append(keyType_, value, bound, KeyCodec::Bound::Upper)) {
+                bounds.empty = true;
+                return;
+            }
+            bool strict = op == Op::Lt && KeyCodec::append(keyType_, value, exact) && exact == bound;
+            setHigh(bounds, bound, !strict);
+            break;
+        }
+    }
+}
+
+std::vector<IndexEntry> RadixIndex::query(const std::vector<std::pair<Op, Value>>& constraints) const {
+    Bounds bounds;
+    for (const auto& [op, value] : constraints) {
+        applyConstraint(bounds, op, value);
+    }
+    return collect(bounds);
+}
+
+std::vector<IndexEntry> RadixIndex::range(const Value& minKey, const Value& maxKey) const {
+    Bounds bounds;
+    applyConstraint(bounds, Op::Ge, minKey);
+    applyConstraint(bounds, Op::Le, maxKey);
+    return collect(bounds);
+}
+
+std::vector<IndexEntry> RadixIndex::prefixRange(const std::string& lowKey, const std::string& highPrefix) const {
+    // Same bounds as SqliteIndex::prefixRange: an encoded string prefix is a
+    // byte prefix of every key starting with it
+    Bounds bounds;
+    std::string encodedPrefix;
+    KeyCodec::appendBytes(lowKey.data(), lowKey.size(), bounds.low);
+    bounds.hasLow = true;
+    KeyCodec::appendBytes(highPrefix.data(), highPrefix.size(), encodedPrefix, false);
+    if (KeyCodec::prefixSuccessor(encodedPrefix, bounds.high)) {
+        bounds.hasHigh = true;
+        bounds.highInclusive = false;
+    }
+    return collect(bounds);
+}
+
+void RadixIndex::openQuery(const std::vector<std::pair<Op, Value>>& constraints, IndexCursor& cursor) const {
+    Bounds bounds;
+    for (const auto& [op, value] : constraints) {
+        applyConstraint(bounds, op, value);
+    }
+    openBounds(bounds, cursor);
+}
+
+void RadixIndex::openPrefixRange(const std::string& lowKey, const std::string& highPrefix,
+                                 IndexCursor& cursor) const {
+    // Same bounds as prefixRange
+    Bounds bounds;
+    std::string encodedPrefix;
+    KeyCodec::appendBytes(lowKey.data(), lowKey.size(), bounds.low);
+    bounds.hasLow = true;
+    KeyCodec::appendBytes(highPrefix.data(), highPrefix.size(), encodedPrefix, false);
+    if (KeyCodec::prefixSuccessor(encodedPrefix, bounds.high)) {
+        bounds.hasHigh = true;
+        bounds.highInclusive = false;
+    }
+    openBounds(bounds, cursor);
+}
+
+void RadixIndex::openBounds(const Bounds& bounds, IndexCursor& cursor) const {
+    cursor.open([this](IndexCursor& c) { fillCursor(c); });
+    if (bounds.empty) {
+        cursor.close();
+        return;
+    }
+    // The empty key sorts before every encoding
+    if (bounds.hasLow) {
+        cursor.from = bounds.low;
+        if (!bounds.lowInclusive) cursor.excludeFrom();
+    }
+    cursor.to = bounds.high;
+    cursor.hasTo = bounds.hasHigh;
+    cursor.toInclusive = bounds.highInclusive;
+}
+
+void RadixIndex::fillCursor(IndexCursor& cursor) const {
+    // The position moves as entries are pushed, so take the bounds first
+    Bounds bounds;
+    bounds.low = cursor.from;
+    bounds.hasLow = true;
+    bounds.lowInclusive = !cursor.fromResume;
+    bounds.high = cursor.to;
+    bounds.hasHigh = cursor.hasTo;
+    bounds.highInclusive = cursor.toInclusive;
+
+    // The rest of the postings of the key the last batch stopped in
+    if (cursor.fromResume && cursor.fromSequence != UINT64_MAX) {
+        uint64_t after = cursor.fromSequence;
+        const Leaf* leaf = findLeaf(reinterpret_cast<const uint8_t*>(bounds.low.data()), bounds.low.size());
+        if (leaf) {
+            if (leaf->first.sequence > after &&
+                !cursor.push(leaf->key, leaf->first.offset, leaf->first.sequence)) {
+                return;
+            }
+            auto it = std::upper_bound(leaf->more.begin(), leaf->more.end(), after,
+                                       [](uint64_t s, const Posting& p) { return s < p.sequence; });
+            for (; it != leaf->more.end(); ++it) {
+                if (!cursor.push(leaf->key, it->offset, it->sequence)) return;
+            }
+        }
+    }
+
+    scan(bounds, [&](const std::string& key, uint64_t offset, uint64_t sequence) {
+        return cursor.push(key, offset, sequence);
+    });
+}
+
+std::vector<IndexEntry> RadixIndex::all() const {
+    std::vector<IndexEntry> results;
+    results.reserve(static_cast<size_t>(entryCount_));
+    scan(Bounds{}, [&](const std::string& key, uint64_t offset, uint64_t sequence) {
+        results.push_back(makeEntry(key, offset, sequence));
+        return true;
+    });
+    return results;
+}
+
+}  // namespace flatsql
@@ -0,0 +1,133 @@
+#include "flatsql/replication.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <unistd.h>
+
+namespace flatsql {
+
+static uint32_t readLE32(const uint8_t* p) {
+    return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+           (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+// ==================== Leader ====================
+
+size_t ReplicationLeader::addFollower(int fd, uint64_t since) {
+    followers_.push_back({fd, since, true});
+    return followers_.size() - 1;
+}
+
+void ReplicationLeader::removeFollower(size_t id) {
+    if (id < followers_.size()) {
+        followers_[id].active = false;
+    }
+}
+
+uint64_t ReplicationLeader::getLowestShippedSequence() const {
+    uint64_t lowest = db_.getLastSequence();
+    for (const auto& follower : followers_) {
+        if (follower.active) lowest = std::min(lowest, follower.shipped);
+    }
+    return lowest;
+}
+
+size_t ReplicationLeader::ship() {
+    size_t shipped = 0;
+    for (auto& follower : followers_) {
+        if (!follower.active) continue;
+        try {
+            // Announce the target first, so the follower's lag counts down
+            // as the records arrive
+            uint64_t target = std::max(follower.shipped, db_.getLastSequence());
+            uint8_t frame[20] = {};
+            uint32_t prefix = controlFramePrefix(8);
+            for (int i = 0; i < 4; i++) frame[i] = static_cast<uint8_t>(prefix >> (8 * i));
+            std::memcpy(frame + 8, WATERMARK_FILE_ID, 4);
+            for (int i = 0; i < 8; i++) frame[12 + i] = static_cast<uint8_t>(target >> (8 * i));
+            size_t written = 0;
+            while (written < sizeof(frame)) {
+                ssize_t n = ::write(follower.fd, frame + written, sizeof(frame) - written);
+                if (n < 0) {
+                    if (errno == EINTR) continue;
+                    throw std::runtime_error(std::string("Replication write failed: ") + std::strerror(errno));
+                }
+                written += static_cast<size_t>(n);
+            }
+
+            follower.shipped = db_.exportSince(follower.shipped, follower.fd);
+            shipped++;
+        } catch (const std::runtime_error&) {
+            follower.active = false;
+        }
+    }
+    return shipped;
+}
+
+// ==================== Follower ====================
+
+bool ReplicationFollower::poll(int fd) {
+    uint8_t chunk[64 * 1024];
+    ssize_t n;
+    do {
+        n = ::read(fd, chunk, sizeof(chunk));
+    } while (n < 0 && errno == EINTR);
+    if (n <= 0) {
+        return false;
+    }
+    receive(chunk, static_cast<size_t>(n));
+    return true;
+}
+
+size_t ReplicationFollower::receive(const uint8_t* data, size_t length) {
+    if (failed_) {
+        throw std::runtime_error("Replication stream failed to apply earlier");
+    }
+    pending_.insert(pending_.end(), data, data + length);
+
+    // Hand runs of complete feed frames to applyChanges, splitting at
+    // watermark frames, which only this class understands. The leader ends
+    // every shipment before the next watermark, so only the final run can
+    // be left partly unapplied (a block still waiting for its checksum).
+    size_t records = 0;
+    size_t runStart = 0;
+    size_t pos = 0;
+    auto applyRun = [&](size_t runEnd) {
+        size_t consumed = 0;
+        if (runEnd > runStart) {
+            size_t ingested = 0;
+            consumed = db_.applyChanges(pending_.data() + runStart, runEnd - runStart, &ingested);
+            records += ingested;
+        }
+        return runStart + consumed;
+    };
+    size_t applied = 0;
+    try {
+        while (pos + 4 <= pending_.size()) {
+            uint32_t size = readLE32(&pending_[pos]);
+            if (pos + frameLength(size) > pending_.size()) break;
+
+            const uint8_t* frame = &pending_[pos];
+            if (isControlFrame(frame, ReplicationLeader::WATERMARK_FILE_ID, 8)) {
+                applyRun(pos);
+                uint64_t sequence = 0;
+                for (int i = 0; i < 8; i++) sequence |= static_cast<uint64_t>(frame[12 + i]) << (8 * i);
+                leaderSequence_ = std::max(leaderSequence_, sequence);
+                runStart = pos + frameLength(size);
+            }
+            pos += frameLength(size);
+        }
+        applied = applyRun(pos);
+    } catch (...) {
+        // Earlier runs are applied and must not be applied again; the run
+        // that threw may be in part, so the stream can't go on
+        pending_.erase(pending_.begin(), pending_.begin() + static_cast<std::ptrdiff_t>(runStart));
+        failed_ = true;
+        throw;
+    }
+    pending_.erase(pending_.begin(), pending_.begin() + static_cast<std::ptrdiff_t>(applied));
+    return records;
+}
+
+}  // namespace flatsql
@@ -46,6 +46,19 @@ ValueType SchemaParser::idlTypeToValueType(const std::string& idlType) {
     return ValueType::String;
 }
 
+bool SchemaParser::idlVectorElementType(const std::string& idlType, ValueType& elementType) {
+    std::string vector = toLower(trim(idlType));
+    if (vector.size() < 3 || vector.front() != '[' || vector.back() != ']') return false;
+
+    // Byte vectors stay blobs; vectors of tables, structs or vectors aren't supported
+    std::string element = trim(vector.substr(1, vector.size() - 2));
+    if (element == "ubyte" || element == "uint8" || element == "byte") return false;
+    ValueType type = idlTypeToValueType(element);
+    if (type == ValueType::String && element != "string") return false;
+    elementType = type;
+    return true;
+}
+
 ValueType SchemaParser::jsonTypeToValueType(const std::string& jsonType, const std::string& format) {
     std::string type = toLower(trim(jsonType));
 
@@ -77,6 +90,7 @@ DatabaseSchema SchemaParser::parseIDL(const std::string& idl, const std::string&
     std::string remaining = idl;
     while (std::regex_search(remaining, tableMatch, tableRegex)) {
         TableDef tableDef;
+        std::vector<bool> knownTypes;  // Per column: a type this parser understands
         tableDef.name = tableMatch[1].str();
 
         std::string fieldsStr = tableMatch[2].str();
@@ -117,7 +131,9 @@ DatabaseSchema SchemaParser::parseIDL(const std::string& idl, const std::string&
             }
 
             col.type = idlTypeToValueType(typeStr);
+            col.isVector = idlVectorElementType(typeStr, col.elementType);
             tableDef.columns.push_back(col);
+            knownTypes.push_back(col.isVector || col.type != ValueType::String || toLower(typeStr) == "string");
 
             if (col.primaryKey) {
                 tableDef.primaryKeyColumns.push_back(col.name);
@@ -126,9 +142,14 @@ DatabaseSchema SchemaParser::parseIDL(const std::string& idl, const std::string&
             fieldsRemaining = fieldMatch.suffix().str();
         }
 
-        // Assign field IDs based on position (maps to FlatBuffer vtable indices)
+        // Assign field IDs based on position (maps to FlatBuffer vtable indices).
+        // A union takes two slots, and an unknown type name may be a union,
+        // so fields after one can't be read by slot.
+        bool positional = true;
         for (size_t i = 0; i < tableDef.columns.size(); i++) {
             tableDef.columns[i].fieldId = static_cast<uint16_t>(i);
+            tableDef.columns[i].slotKnown = positional;
+            positional = positional && knownTypes[i];
         }
 
         schema.tables.push_back(tableDef);
@@ -181,6 +202,7 @@ DatabaseSchema SchemaParser::parseJSONSchema(const std::string& json, const std:
             ColumnDef col;
             col.name = propMatch[1].str();
             col.type = jsonTypeToValueType(propMatch[2].str());
+            col.slotKnown = false;  // JSON Schema has no FlatBuffer layout
             tableDef.columns.push_back(col);
             propsRemaining = propMatch.suffix().str();
         }
@@ -0,0 +1,343 @@
+#include "flatsql/sgp4.h"
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+namespace flatsql {
+
+// WGS-72 constants, as used by the reference SGP4
+static constexpr double RADIUS_EARTH_KM = 6378.135;
+static constexpr double MU = 398600.8;  // km^3/s^2
+static constexpr double J2 = 0.001082616;
+static constexpr double J3 = -0.00000253881;
+static constexpr double J4 = -0.00000165597;
+static constexpr double J3OJ2 = J3 / J2;
+static constexpr double TWO_PI = 2.0 * M_PI;
+static constexpr double DEG_TO_RAD = M_PI / 180.0;
+static constexpr double X2O3 = 2.0 / 3.0;
+static constexpr double MINUTES_PER_DAY = 1440.0;
+
+static const double XKE = 60.0 / std::sqrt(RADIUS_EARTH_KM * RADIUS_EARTH_KM * RADIUS_EARTH_KM / MU);
+static const double VKM_PER_SEC = RADIUS_EARTH_KM * XKE / 60.0;
+
+size_t Sgp4Batch::add(const Sgp4Elements& el) {
+    size_t index = size();
+    auto push = [](std::vector<double>& v, double x) { v.push_back(x); };
+
+    double noKozai = el.meanMotion * TWO_PI / MINUTES_PER_DAY;  // rad/min
+    double ecco = el.eccentricity;
+    double inclo = el.inclination * DEG_TO_RAD;
+    double nodeo = el.raOfAscNode * DEG_TO_RAD;
+    double argpo = el.argOfPericenter * DEG_TO_RAD;
+    double mo = el.meanAnomaly * DEG_TO_RAD;
+    double bstar = el.bstar;
+
+    int32_t error = SGP4_OK;
+    if (!(noKozai > 0.0)) error = SGP4_BAD_MEAN_MOTION;
+    else if (!(ecco >= 0.0 && ecco < 1.0)) error = SGP4_BAD_ECCENTRICITY;
+
+    // ---- initl: recover the original (un-Kozai'd) mean motion ----
+    double eccsq = ecco * ecco;
+    double omeosq = 1.0 - eccsq;
+    double rteosq = std::sqrt(std::fabs(omeosq));
+    double cosio = std::cos(inclo);
+    double cosio2 = cosio * cosio;
+    double sinio = std::sin(inclo);
+
+    double noUnkozai = 0.0, ao = 1.0;
+    if (error == SGP4_OK) {
+        double ak = std::pow(XKE / noKozai, X2O3);
+        double d1 = 0.75 * J2 * (3.0 * cosio2 - 1.0) / (rteosq * omeosq);
+        double del = d1 / (ak * ak);
+        double adel = ak * (1.0 - del * del - del * (1.0 / 3.0 + 134.0 * del * del / 81.0));
+        del = d1 / (adel * adel);
+        noUnkozai = noKozai / (1.0 + del);
+        ao = std::pow(XKE / noUnkozai, X2O3);
+        if (TWO_PI / noUnkozai >= 225.0) error = SGP4_DEEP_SPACE;
+    }
+
+    double po = ao * omeosq;
+    double con42 = 1.0 - 5.0 * cosio2;
+    double con41 = -con42 - cosio2 - cosio2;
+    double posq = po * po;
+    double rp = ao * (1.0 - ecco);
+
+    // ---- sgp4init: secular and drag coefficients ----
+    double ss = 78.0 / RADIUS_EARTH_KM + 1.0;
+    double qzms2t = std::pow((120.0 - 78.0) / RADIUS_EARTH_KM, 4);
+    uint8_t isimp = (rp < 220.0 / RADIUS_EARTH_KM + 1.0) ? 1 : 0;
+
+    double sfour = ss;
+    double qzms24 = qzms2t;
+    double perige = (rp - 1.0) * RADIUS_EARTH_KM;
+    if (perige < 156.0) {
+        sfour = perige - 78.0;
+        if (perige < 98.0) sfour = 20.0;
+        qzms24 = std::pow((120.0 - sfour) / RADIUS_EARTH_KM, 4);
+        sfour = sfour / RADIUS_EARTH_KM + 1.0;
+    }
+    double pinvsq = 1.0 / posq;
+
+    double tsi = 1.0 / (ao - sfour);
+    double eta = ao * ecco * tsi;
+    double etasq = eta * eta;
+    double eeta = ecco * eta;
+    double psisq = std::fabs(1.0 - etasq);
+    double coef = qzms24 * std::pow(tsi, 4);
+    double coef1 = coef / std::pow(psisq, 3.5);
+    double cc2 = coef1 * noUnkozai * (ao * (1.0 + 1.5 * etasq + eeta * (4.0 + etasq)) +
+                 0.375 * J2 * tsi / psisq * con41 * (8.0 + 3.0 * etasq * (8.0 + etasq)));
+    double cc1 = bstar * cc2;
+    double cc3 = 0.0;
+    if (ecco > 1.0e-4) cc3 = -2.0 * coef * tsi * J3OJ2 * noUnkozai * sinio / ecco;
+    double x1mth2 = 1.0 - cosio2;
+    double cc4 = 2.0 * noUnkozai * coef1 * ao * omeosq *
+                 (eta * (2.0 + 0.5 * etasq) + ecco * (0.5 + 2.0 * etasq) -
+                  J2 * tsi / (ao * psisq) *
+                  (-3.0 * con41 * (1.0 - 2.0 * eeta + etasq * (1.5 - 0.5 * eeta)) +
+                   0.75 * x1mth2 * (2.0 * etasq - eeta * (1.0 + etasq)) * std::cos(2.0 * argpo)));
+    double cc5 = 2.0 * coef1 * ao * omeosq * (1.0 + 2.75 * (etasq + eeta) + eeta * etasq);
+
+    double cosio4 = cosio2 * cosio2;
+    double temp1 = 1.5 * J2 * pinvsq * noUnkozai;
+    double temp2 = 0.5 * temp1 * J2 * pinvsq;
+    double temp3 = -0.46875 * J4 * pinvsq * pinvsq * noUnkozai;
+    double mdot = noUnkozai + 0.5 * temp1 * rteosq * con41 +
+                  0.0625 * temp2 * rteosq * (13.0 - 78.0 * cosio2 + 137.0 * cosio4);
+    double argpdot = -0.5 * temp1 * con42 + 0.0625 * temp2 * (7.0 - 114.0 * cosio2 + 395.0 * cosio4) +
+                     temp3 * (3.0 - 36.0 * cosio2 + 49.0 * cosio4);
+    double xhdot1 = -temp1 * cosio;
+    double nodedot = xhdot1 + (0.5 * temp2 * (4.0 - 19.0 * cosio2) + 2.0 * temp3 * (3.0 - 7.0 * cosio2)) * cosio;
+    double omgcof = bstar * cc3 * std::cos(argpo);
+    double xmcof = 0.0;
+    if (ecco > 1.0e-4) xmcof = -X2O3 * coef * bstar / eeta;
+    double nodecf = 3.5 * omeosq * xhdot1 * cc1;
+    double t2cof = 1.5 * cc1;
+    // Avoid a divide by zero for inclination = 180 degrees
+    double cosio1 = std::fabs(cosio + 1.0) > 1.5e-12 ? 1.0 + cosio : 1.5e-12;
+    double xlcof = -0.25 * J3OJ2 * sinio * (3.0 + 5.0 * cosio) / cosio1;
+    double aycof = -0.5 * J3OJ2 * sinio;
+    double delmo = std::pow(1.0 + eta * std::cos(mo), 3);
+    double sinmao = std::sin(mo);
+    double x7thm1 = 7.0 * cosio2 - 1.0;
+
+    double d2 = 0.0, d3 = 0.0, d4 = 0.0, t3cof = 0.0, t4cof = 0.0, t5cof = 0.0;
+    if (!isimp) {
+        double cc1sq = cc1 * cc1;
+        d2 = 4.0 * ao * tsi * cc1sq;
+        double temp = d2 * tsi * cc1 / 3.0;
+        d3 = (17.0 * ao + sfour) * temp;
+        d4 = 0.5 * temp * ao * tsi * (221.0 * ao + 31.0 * sfour) * cc1;
+        t3cof = d2 + 2.0 * cc1sq;
+        t4cof = 0.25 * (3.0 * d3 + cc1 * (12.0 * d2 + 10.0 * cc1sq));
+        t5cof = 0.2 * (3.0 * d4 + 12.0 * cc1 * d3 + 6.0 * d2 * d2 + 15.0 * cc1sq * (2.0 * d2 + cc1sq));
+    }
+
+    initError_.push_back(error);
+    isimp_.push_back(isimp);
+    push(epoch_, el.epoch);
+    push(ecco_, ecco);
+    push(inclo_, inclo);
+    push(nodeo_, nodeo);
+    push(argpo_, argpo);
+    push(mo_, mo);
+    push(bstar_, bstar);
+    push(noUnkozai_, noUnkozai);
+    push(aycof_, aycof);
+    push(con41_, con41);
+    push(cc1_, cc1);
+    push(cc4_, cc4);
+    push(cc5_, cc5);
+    push(d2_, d2);
+    push(d3_, d3);
+    push(d4_, d4);
+    push(delmo_, delmo);
+    push(eta_, eta);
+    push(argpdot_, argpdot);
+    push(omgcof_, omgcof);
+    push(sinmao_, sinmao);
+    push(t2cof_, t2cof);
+    push(t3cof_, t3cof);
+    push(t4cof_, t4cof);
+    push(t5cof_, t5cof);
+    push(x1mth2_, x1mth2);
+    push(x7thm1_, x7thm1);
+    push(mdot_, mdot);
+    push(nodedot_, nodedot);
+    push(xlcof_, xlcof);
+    push(xmcof_, xmcof);
+    push(nodecf_, nodecf);
+    return index;
+}
+
+void Sgp4Batch::propagate(double unixTime, size_t begin, size_t end,
+                          Sgp4State* out, int32_t* errors) const {
+    for (size_t i = begin; i < end; i++) {
+        Sgp4State& s = out[i];
+        if (initError_[i] != SGP4_OK) {
+            errors[i] = initError_[i];
+            s = Sgp4State{};
+            continue;
+        }
+
+        double t = (unixTime - epoch_[i]) / 60.0;  // Minutes since epoch
+
+        // ---- Secular gravity and atmospheric drag ----
+        double xmdf = mo_[i] + mdot_[i] * t;
+        double argpdf = argpo_[i] + argpdot_[i] * t;
+        double nodedf = nodeo_[i] + nodedot_[i] * t;
+        double argpm = argpdf;
+        double mm = xmdf;
+        double t2 = t * t;
+        double nodem = nodedf + nodecf_[i] * t2;
+        double tempa = 1.0 - cc1_[i] * t;
+        double tempe = bstar_[i] * cc4_[i] * t;
+        double templ = t2cof_[i] * t2;
+
+        if (!isimp_[i]) {
+            double delomg = omgcof_[i] * t;
+            double delmtemp = 1.0 + eta_[i] * std::cos(xmdf);
+            double delm = xmcof_[i] * (delmtemp * delmtemp * delmtemp - delmo_[i]);
+            double temp = delomg + delm;
+            mm = xmdf + temp;
+            argpm = argpdf - temp;
+            double t3 = t2 * t;
+            double t4 = t3 * t;
+            tempa = tempa - d2_[i] * t2 - d3_[i] * t3 - d4_[i] * t4;
+            tempe = tempe + bstar_[i] * cc5_[i] * (std::sin(mm) - sinmao_[i]);
+            templ = templ + t3cof_[i] * t3 + t4 * (t4cof_[i] + t * t5cof_[i]);
+        }
+
+        double am = std::pow(XKE / noUnkozai_[i], X2O3) * tempa * tempa;
+        double nm = XKE / std::pow(am, 1.5);
+        double em = ecco_[i] - tempe;
+        if (em >= 1.0 || em < -0.001 || !(am > 0.0)) {
+            errors[i] = SGP4_BAD_ECCENTRICITY;
+            s = Sgp4State{};
+            continue;
+        }
+        if (em < 1.0e-6) em = 1.0e-6;
+        mm = mm + noUnkozai_[i] * templ;
+        double xlm = mm + argpm + nodem;
+        nodem = std::fmod(nodem, TWO_PI);
+        argpm = std::fmod(argpm, TWO_PI);
+        xlm = std::fmod(xlm, TWO_PI);
+        mm = std::fmod(xlm - argpm - nodem, TWO_PI);
+
+        double sinip = std::sin(inclo_[i]);
+        double cosip = std::cos(inclo_[i]);
+
+        // ---- Long-period periodics ----
+        double axnl = em * std::cos(argpm);
+        double temp = 1.0 / (am * (1.0 - em * em));
+        double aynl = em * std::sin(argpm) + temp * aycof_[i];
+        double xl = mm + argpm + nodem + temp * xlcof_[i] * axnl;
+
+        // ---- Kepler's equation ----
+        double u = std::fmod(xl - nodem, TWO_PI);
+        double eo1 = u;
+        double tem5 = 9999.9;
+        double sineo1 = 0.0, coseo1 = 0.0;
+        for (int ktr = 1; std::fabs(tem5) >= 1.0e-12 && ktr <= 10; ktr++) {
+            sineo1 = std::sin(eo1);
+            coseo1 = std::cos(eo1);
+            tem5 = 1.0 - coseo1 * axnl - sineo1 * aynl;
+            tem5 = (u - aynl * coseo1 + axnl * sineo1 - eo1) / tem5;
+            if (std::fabs(tem5) >= 0.95) tem5 = tem5 > 0.0 ? 0.95 : -0.95;
+            eo1 = eo1 + tem5;
+        }
+
+        // ---- Short-period periodics ----
+        double ecose = axnl * coseo1 + aynl * sineo1;
+        double esine = axnl * sineo1 - aynl * coseo1;
+        double el2 = axnl * axnl + aynl * aynl;
+        double pl = am * (1.0 - el2);
+        if (pl < 0.0) {
+            errors[i] = SGP4_BAD_SEMILATUS;
+            s = Sgp4State{};
+            continue;
+        }
+        double rl = am * (1.0 - ecose);
+        double rdotl = std::sqrt(am) * esine / rl;
+        double rvdotl = std::sqrt(pl) / rl;
+        double betal = std::sqrt(1.0 - el2);
+        temp = esine / (1.0 + betal);
+        double sinu = am / rl * (sineo1 - aynl - axnl * temp);
+        double cosu = am / rl * (coseo1 - axnl + aynl * temp);
+        double su = std::atan2(sinu, cosu);
+        double sin2u = (cosu + cosu) * sinu;
+        double cos2u = 1.0 - 2.0 * sinu * sinu;
+        temp = 1.0 / pl;
+        double temp1 = 0.5 * J2 * temp;
+        double temp2 = temp1 * temp;
+
+        double mrt = rl * (1.0 - 1.5 * temp2 * betal * con41_[i]) + 0.5 * temp1 * x1mth2_[i] * cos2u;
+        su = su - 0.25 * temp2 * x7thm1_[i] * sin2u;
+        double xnode = nodem + 1.5 * temp2 * cosip * sin2u;
+        double xinc = inclo_[i] + 1.5 * temp2 * cosip * sinip * cos2u;
+        double mvt = rdotl - nm * temp1 * x1mth2_[i] * sin2u / XKE;
+        double rvdot = rvdotl + nm * temp1 * (x1mth2_[i] * cos2u + 1.5 * con41_[i]) / XKE;
+
+        // ---- Orientation vectors ----
+        double sinsu = std::sin(su), cossu = std::cos(su);
+        double snod = std::sin(xnode), cnod = std::cos(xnode);
+        double sini = std::sin(xinc), cosi = std::cos(xinc);
+        double xmx = -snod * cosi;
+        double xmy = cnod * cosi;
+        double ux = xmx * sinsu + cnod * cossu;
+        double uy = xmy * sinsu + snod * cossu;
+        double uz = sini * sinsu;
+        double vx = xmx * cossu - cnod * sinsu;
+        double vy = xmy * cossu - snod * sinsu;
+        double vz = sini * cossu;
+
+        double r = mrt * RADIUS_EARTH_KM;
+        s.x = r * ux;
+        s.y = r * uy;
+        s.z = r * uz;
+        s.vx = (mvt * ux + rvdot * vx) * VKM_PER_SEC;
+        s.vy = (mvt * uy + rvdot * vy) * VKM_PER_SEC;
+        s.vz = (mvt * uz + rvdot * vz) * VKM_PER_SEC;
+        errors[i] = mrt < 1.0 ? SGP4_DECAYED : SGP4_OK;
+    }
+}
+
+void Sgp4Batch::propagateGrid(double t0, double step, size_t steps, unsigned threads,
+                              Sgp4State* out, int32_t* errors) const {
+    size_t n = size();
+    if (n == 0 || steps == 0) return;
+
+    auto work = [&](size_t begin, size_t end) {
+        for (size_t k = 0; k < steps; k++) {
+            propagate(t0 + static_cast<double>(k) * step, begin, end, out + k * n, errors + k * n);
+        }
+    };
+
+#if defined(__EMSCRIPTEN__) && !defined(__EMSCRIPTEN_PTHREADS__)
+    (void)threads;
+    work(0, n);
+#else
+    if (threads == 0) threads = std::max(1u, std::thread::hardware_concurrency());
+    // Not worth a thread for fewer than ~256 satellite-steps
+    size_t maxUseful = std::max<size_t>(1, n * steps / 256);
+    size_t workers = std::min<size_t>({threads, maxUseful, n});
+    if (workers <= 1) {
+        work(0, n);
+        return;
+    }
+
+    std::vector<std::thread> pool;
+    pool.reserve(workers - 1);
+    size_t chunk = (n + workers - 1) / workers;
+    for (size_t w = 1; w < workers; w++) {
+        size_t begin = w * chunk;
+        size_t end = std::min(n, begin + chunk);
+        if (begin >= end) break;
+        pool.emplace_back(work, begin, end);
+    }
+    work(0, std::min(n, chunk));
+    for (auto& thread : pool) thread.join();
+#endif
+}
+
+}  // namespace flatsql
@@ -0,0 +1,344 @@
+#include "flatsql/spatial_index.h"
+#include "flatsql/geo_functions.h"
+#include "flatsql/geo_kernels.h"
+#include <stdexcept>
+#include <cmath>
+#include <algorithm>
+#include <cstdio>
+
+namespace flatsql {
+
+static constexpr double DEG_TO_RAD = M_PI / 180.0;
+static constexpr double RAD_TO_DEG = 180.0 / M_PI;
+
+// rtree bounds are 32-bit floats rounded outward, which can understate a
+// point's distance by a few metres. kNN search keeps this much slack.
+static constexpr double KNN_SLACK_KM = 0.01;
+
+// Distance from a point to the nearest point of a meridian arc lonM, latA..latB
+static double distanceToMeridianKm(double lat, double lon, double lonM, double latA, double latB) {
+    double dLon = std::remainder(lonM - lon, 360.0);
+    if (std::fabs(dLon) <= 90.0) {
+        // Foot of the perpendicular from the point onto the meridian's great circle
+        double foot = std::atan(std::tan(lat * DEG_TO_RAD) / std::cos(dLon * DEG_TO_RAD)) * RAD_TO_DEG;
+        foot = std::min(std::max(foot, latA), latB);
+        return geoHaversineKm(lat, lon, foot, lonM);
+    }
+    // Distance along the far meridian is monotonic, so an endpoint is nearest
+    return std::min(geoHaversineKm(lat, lon, latA, lonM), geoHaversineKm(lat, lon, latB, lonM));
+}
+
+// Great-circle distance from a point to a lat/lon box (0 when inside)
+static double distanceToBoxKm(double lat, double lon, double minLat, double maxLat,
+                              double minLon, double maxLon) {
+    if (lon >= minLon && lon <= maxLon) {
+        if (lat < minLat) return (minLat - lat) * DEG_TO_RAD * GEO_EARTH_RADIUS_KM;
+        if (lat > maxLat) return (lat - maxLat) * DEG_TO_RAD * GEO_EARTH_RADIUS_KM;
+        return 0.0;
+    }
+    // Outside the longitude band the nearest point lies on a bounding meridian
+    return std::min(distanceToMeridianKm(lat, lon, minLon, minLat, maxLat),
+                    distanceToMeridianKm(lat, lon, maxLon, minLat, maxLat));
+}
+
+SpatialIndex::SpatialIndex(sqlite3* db, const std::string& tableName,
+                           const std::string& latColumn, const std::string& lonColumn)
+    : db_(db), latColumn_(latColumn), lonColumn_(lonColumn) {
+
+    // Create unique rtree table name: _sidx_{table}_{lat}_{lon}
+    indexTableName_ = "_sidx_" + tableName + "_" + latColumn + "_" + lonColumn;
+
+    // The rtree stores 32-bit float bounds, so the exact coordinates are kept
+    // in auxiliary columns and re-checked after each probe.
+    std::string createSql =
+        "CREATE VIRTUAL TABLE IF NOT EXISTS \"" + indexTableName_ + "\" USING rtree("
+        "id, min_lat, max_lat, min_lon, max_lon, "
+        "+lat, +lon, +data_offset, +data_length)";
+
+    char* errMsg = nullptr;
+    int rc = sqlite3_exec(db_, createSql.c_str(), nullptr, nullptr, &errMsg);
+    if (rc != SQLITE_OK) {
+        std::string err = errMsg ? errMsg : "Unknown error";
+        sqlite3_free(errMsg);
+        throw std::runtime_error("Failed to create spatial index table: " + err);
+    }
+
+    std::string insertSql = "INSERT OR REPLACE INTO \"" + indexTableName_ +
+        "\" (id, min_lat, max_lat, min_lon, max_lon, lat, lon, data_offset, data_length) "
+        "VALUES (?1, ?2, ?2, ?3, ?3, ?2, ?3, ?4, ?5)";
+    rc = sqlite3_prepare_v2(db_, insertSql.c_str(), -1, &insertStmt_, nullptr);
+    if (rc != SQLITE_OK) {
+        throw std::runtime_error("Failed to prepare spatial insert statement");
+    }
+
+    std::string existsSql = "SELECT 1 FROM \"" + indexTableName_ + "\" WHERE id = ?1";
+    rc = sqlite3_prepare_v2(db_, existsSql.c_str(), -1, &existsStmt_, nullptr);
+    if (rc != SQLITE_OK) {
+        throw std::runtime_error("Failed to prepare spatial exists statement");
+    }
+
+    std::string searchSql = "SELECT id, lat, lon, data_offset, data_length FROM \"" +
+        indexTableName_ + "\" WHERE min_lat <= ?2 AND max_lat >= ?1 "
+        "AND min_lon <= ?4 AND max_lon >= ?3";
+    rc = sqlite3_prepare_v2(db_, searchSql.c_str(), -1, &searchStmt_, nullptr);
+    if (rc != SQLITE_OK) {
+        throw std::runtime_error("Failed to prepare spatial search statement");
+    }
+
+    // Best-first traversal driven by a scoring callback. The callback reads
+    // this index's pruning bound, so each index registers its own function.
+    char fnName[48];
+    snprintf(fnName, sizeof(fnName), "flatsql_knn_%p", static_cast<void*>(this));
+    knnFunction_ = fnName;
+    rc = sqlite3_rtree_query_callback(db_, knnFunction_.c_str(), knnScore, this, nullptr);
+    if (rc != SQLITE_OK) {
+        throw std::runtime_error("Failed to register kNN callback");
+    }
+    std::string nearestSql = "SELECT id, lat, lon, data_offset, data_length FROM \"" +
+        indexTableName_ + "\" WHERE id MATCH " + knnFunction_ + "(?1, ?2)";
+    rc = sqlite3_prepare_v2(db_, nearestSql.c_str(), -1, &nearestStmt_, nullptr);
+    if (rc != SQLITE_OK) {
+        throw std::runtime_error("Failed to prepare spatial nearest statement");
+    }
+
+    std::string clearSql = "DELETE FROM \"" + indexTableName_ + "\"";
+    rc = sqlite3_prepare_v2(db_, clearSql.c_str(), -1, &clearStmt_, nullptr);
+    if (rc != SQLITE_OK) {
+        throw std::runtime_error("Failed to prepare spatial clear statement");
+    }
+}
+
+SpatialIndex::~SpatialIndex() {
+    if (insertStmt_) sqlite3_finalize(insertStmt_);
+    if (existsStmt_) sqlite3_finalize(existsStmt_);
+    if (searchStmt_) sqlite3_finalize(searchStmt_);
+    if (nearestStmt_) sqlite3_finalize(nearestStmt_);
+    if (clearStmt_) sqlite3_finalize(clearStmt_);
+}
+
+// Score = lower bound on distance, so the rtree's priority queue visits
+// nodes and emits points nearest first
+int SpatialIndex::knnScore(sqlite3_rtree_query_info* info) {
+    if (info->nParam < 2 || info->nCoord < 4) return SQLITE_ERROR;
+    const SpatialIndex* self = static_cast<const SpatialIndex*>(info->pContext);
+
+    double d = distanceToBoxKm(info->aParam[0], info->aParam[1], info->aCoord[0],
+                               info->aCoord[1], info->aCoord[2], info->aCoord[3]);
+    if (d > self->knnBoundKm_) {
+        info->eWithin = NOT_WITHIN;
+        return SQLITE_OK;
+    }
+    info->rScore = d;
+    info->eWithin = info->iLevel == 0 ? FULLY_WITHIN : PARTLY_WITHIN;
+    return SQLITE_OK;
+}
+
+bool SpatialIndex::toDouble(const Value& v, double& out) {
+    return std::visit([&out](const auto& val) -> bool {
+        using T = std::decay_t<decltype(val)>;
+        if constexpr (std::is_arithmetic_v<T> && !std::is_same_v<T, bool>) {
+            out = static_cast<double>(val);
+            return !std::isnan(out);
+        }
+        return false;
+    }, v);
+}
+
+void SpatialIndex::insert(double lat, double lon, uint64_t dataOffset,
+                          uint32_t dataLength, uint64_t sequence) {
+    // A re-inserted sequence replaces its entry and isn't counted again
+    sqlite3_reset(existsStmt_);
+    sqlite3_bind_int64(existsStmt_, 1, static_cast<int64_t>(sequence));
+    bool existed = sqlite3_step(existsStmt_) == SQLITE_ROW;
+    sqlite3_reset(existsStmt_);
+
+    sqlite3_reset(insertStmt_);
+    sqlite3_bind_int64(insertStmt_, 1, static_cast<int64_t>(sequence));
+    sqlite3_bind_double(insertStmt_, 2, lat);
+    sqlite3_bind_double(insertStmt_, 3, lon);
+    sqlite3_bind_int64(insertStmt_, 4, static_cast<int64_t>(dataOffset));
+    sqlite3_bind_int64(insertStmt_, 5, dataLength);
+
+    int rc = sqlite3_step(insertStmt_);
+    if (rc != SQLITE_DONE) {
+        throw std::runtime_error("Failed to insert into spatial index: " +
+            std::string(sqlite3_errmsg(db_)));
+    }
+
+    if (!existed) entryCount_++;
+}
+
+void SpatialIndex::probe(double minLat, double maxLat, double minLon, double maxLon,
+                         std::vector<IndexEntry>& results,
+                         std::vector<double>* lats, std::vector<double>* lons) const {
+    sqlite3_reset(searchStmt_);
+    sqlite3_bind_double(searchStmt_, 1, minLat);
+    sqlite3_bind_double(searchStmt_, 2, maxLat);
+    sqlite3_bind_double(searchStmt_, 3, minLon);
+    sqlite3_bind_double(searchStmt_, 4, maxLon);
+
+    while (sqlite3_step(searchStmt_) == SQLITE_ROW) {
+        double lat = sqlite3_column_double(searchStmt_, 1);
+        double lon = sqlite3_column_double(searchStmt_, 2);
+
+        // The rtree probe is conservative; apply the exact box test here
+        if (lat < minLat || lat > maxLat || lon < minLon || lon > maxLon) continue;
+
+        IndexEntry entry;
+        entry.sequence = static_cast<uint64_t>(sqlite3_column_int64(searchStmt_, 0));
+        entry.dataOffset = static_cast<uint64_t>(sqlite3_column_int64(searchStmt_, 3));
+        entry.dataLength = static_cast<uint32_t>(sqlite3_column_int64(searchStmt_, 4));
+        results.push_back(std::move(entry));
+        if (lats) lats->push_back(lat);
+        if (lons) lons->push_back(lon);
+    }
+    sqlite3_reset(searchStmt_);
+}
+
+std::vector<IndexEntry> SpatialIndex::searchBox(double minLat, double maxLat,
+                                                double minLon, double maxLon) const {
+    std::vector<IndexEntry> results;
+    if (!(minLat <= maxLat) || !(minLon <= maxLon)) return results;
+    probe(minLat, maxLat, minLon, maxLon, results, nullptr, nullptr);
+    return results;
+}
+
+std::vector<IndexEntry> SpatialIndex::searchRadius(double centerLat, double centerLon,
+                                                   double radiusKm) const {
+    std::vector<IndexEntry> candidates;
+    std::vector<IndexEntry> results;
+    if (!(radiusKm >= 0) || std::isnan(centerLat) || std::isnan(centerLon)) return results;
+
+    // Bounding box of the spherical cap (angular radius d).
+    // Near a pole the cap covers every longitude; across the antimeridian
+    // the longitude band is split into two probes.
+    double d = radiusKm / GEO_EARTH_RADIUS_KM;
+    double dLat = d * RAD_TO_DEG;
+    double minLat = centerLat - dLat;
+    double maxLat = centerLat + dLat;
+    std::vector<double> lats;
+    std::vector<double> lons;
+
+    if (d >= M_PI || minLat <= -90.0 || maxLat >= 90.0) {
+        probe(std::max(minLat, -90.0), std::min(maxLat, 90.0), -180.0, 180.0, candidates, &lats, &lons);
+    } else {
+        double dLon = std::asin(std::min(1.0, std::sin(d) / std::cos(centerLat * DEG_TO_RAD))) * RAD_TO_DEG;
+        double minLon = centerLon - dLon;
+        double maxLon = centerLon + dLon;
+        if (dLon >= 180.0) {
+            probe(minLat, maxLat, -180.0, 180.0, candidates, &lats, &lons);
+        } else if (minLon < -180.0) {
+            probe(minLat, maxLat, minLon + 360.0, 180.0, candidates, &lats, &lons);
+            probe(minLat, maxLat, -180.0, maxLon, candidates, &lats, &lons);
+        } else if (maxLon > 180.0) {
+            probe(minLat, maxLat, minLon, 180.0, candidates, &lats, &lons);
+            probe(minLat, maxLat, -180.0, maxLon - 360.0, candidates, &lats, &lons);
+        } else {
+            probe(minLat, maxLat, minLon, maxLon, candidates, &lats, &lons);
+        }
+    }
+
+    // Exact great-circle check over the candidate columns; keep the
+    // distance as the entry key
+    std::vector<uint8_t> mask(candidates.size());
+    std::vector<double> distances(candidates.size());
+    size_t matches = geoWithinRadiusBatch(centerLat, centerLon, radiusKm, lats.data(), lons.data(),
+                                          candidates.size(), mask.data(), distances.data());
+    results.reserve(matches);
+    for (size_t i = 0; i < candidates.size(); i++) {
+        if (mask[i]) {
+            candidates[i].key = distances[i];
+            results.push_back(std::move(candidates[i]));
+        }
+    }
+    return results;
+}
+
+std::vector<IndexEntry> SpatialIndex::searchPolygon(const GeoPolygon& polygon) const {
+    std::vector<IndexEntry> candidates;
+    std::vector<IndexEntry> results;
+    if (!(polygon.getMinLat() <= polygon.getMaxLat()) || !(polygon.getMinLon() <= polygon.getMaxLon())) {
+        return results;
+    }
+
+    std::vector<double> lats;
+    std::vector<double> lons;
+    probe(polygon.getMinLat(), polygon.getMaxLat(), polygon.getMinLon(), polygon.getMaxLon(),
+          candidates, &lats, &lons);
+
+    for (size_t i = 0; i < candidates.size(); i++) {
+        if (polygon.contains(lats[i], lons[i])) {
+            results.push_back(std::move(candidates[i]));
+        }
+    }
+    return results;
+}
+
+std::vector<IndexEntry> SpatialIndex::nearest(double lat, double lon, size_t k,
+                                              const std::unordered_set<uint64_t>* exclude) const {
+    std::vector<IndexEntry> heap;  // Max-heap on distance: front is the current k-th
+    if (k == 0 || std::isnan(lat) || std::isnan(lon)) return heap;
+    heap.reserve(std::min<size_t>(k, 1024));
+
+    auto farther = [](const IndexEntry& a, const IndexEntry& b) {
+        return std::get<double>(a.key) < std::get<double>(b.key);
+    };
+
+    knnBoundKm_ = HUGE_VAL;
+    sqlite3_reset(nearestStmt_);
+    sqlite3_bind_double(nearestStmt_, 1, lat);
+    sqlite3_bind_double(nearestStmt_, 2, lon);
+
+    int rc;
+    while ((rc = sqlite3_step(nearestStmt_)) == SQLITE_ROW) {
+        uint64_t sequence = static_cast<uint64_t>(sqlite3_column_int64(nearestStmt_, 0));
+        if (exclude && exclude->count(sequence)) continue;
+
+        double distance = geoHaversineKm(lat, lon, sqlite3_column_double(nearestStmt_, 1),
+                                         sqlite3_column_double(nearestStmt_, 2));
+
+        // Points arrive in lower-bound order; once one is clearly beyond the
+        // k-th candidate, so is everything still queued
+        if (heap.size() == k) {
+            double kth = std::get<double>(heap.front().key);
+            if (distance - KNN_SLACK_KM > kth) break;
+            if (distance >= kth) continue;
+            std::pop_heap(heap.begin(), heap.end(), farther);
+            heap.pop_back();
+        }
+
+        IndexEntry entry;
+        entry.key = distance;
+        entry.sequence = sequence;
+        entry.dataOffset = static_cast<uint64_t>(sqlite3_column_int64(nearestStmt_, 3));
+        entry.dataLength = static_cast<uint32_t>(sqlite3_column_int64(nearestStmt_, 4));
+        heap.push_back(std::move(entry));
+        std::push_heap(heap.begin(), heap.end(), farther);
+
+        if (heap.size() == k) {
+            knnBoundKm_ = std::get<double>(heap.front().key) + KNN_SLACK_KM;
+        }
+    }
+    sqlite3_reset(nearestStmt_);
+    if (rc != SQLITE_ROW && rc != SQLITE_DONE) {
+        throw std::runtime_error("Spatial nearest search failed: " +
+            std::string(sqlite3_errmsg(db_)));
+    }
+
+    std::sort_heap(heap.begin(), heap.end(), farther);
+    return heap;
+}
+
+void SpatialIndex::clear() {
+    sqlite3_reset(clearStmt_);
+
+    int rc = sqlite3_step(clearStmt_);
+    if (rc != SQLITE_DONE) {
+        throw std::runtime_error("Failed to clear spatial index: " +
+            std::string(sqlite3_errmsg(db_)));
+    }
+
+    entryCount_ = 0;
+}
+
+}  // namespace flatsql
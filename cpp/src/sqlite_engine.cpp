@@ -1,8 +1,14 @@
 #include "flatsql/sqlite_engine.h"
+#include "flatsql/array_functions.h"
 #include "flatsql/geo_functions.h"
+#include "flatsql/flatbuffer_access.h"
+#include "flatsql/sgp4.h"
 #include <sstream>
+#include <cstring>
 #include <stdexcept>
 #include <cctype>
+#include <cmath>
+#include <algorithm>
 
 // sqlean extension init functions (C linkage)
 extern "C" {
@@ -38,6 +44,863 @@ static std::string normalizeSQL(const std::string& sql) {
     return result;
 }
 
+// ==================== geo_knn table-valued function ====================
+//
+//   SELECT k._rowid, k.distance, p.*
+//   FROM geo_knn('place', 40.7, -74.0, 10) AS k
+//   JOIN place AS p ON p.rowid = k._rowid
+//
+// Returns the k rows nearest to (lat, lon), closest first, using the
+// table's spatial index.
+
+namespace {
+
+// Column layout; the hidden columns are the function arguments
+enum GeoKnnColumn {
+    KNN_ROWID = 0,
+    KNN_DISTANCE,
+    KNN_OFFSET,
+    KNN_DATA,
+    KNN_TABLE,
+    KNN_LAT,
+    KNN_LON,
+    KNN_K
+};
+
+struct GeoKnnVTab : public sqlite3_vtab {
+    SQLiteEngine* engine;
+};
+
+struct GeoKnnCursor : public sqlite3_vtab_cursor {
+    std::vector<IndexEntry> results;
+    size_t position = 0;
+    const SourceInfo* source = nullptr;
+};
+
+}  // namespace
+
+// Table names are case-insensitive in SQL
+static const SourceInfo* resolveSource(const SQLiteEngine* engine, const char* name) {
+    const SourceInfo* source = engine->getSource(name);
+    if (!source) {
+        for (const auto& candidate : engine->listSources()) {
+            if (sqlite3_stricmp(candidate.c_str(), name) == 0) {
+                return engine->getSource(candidate);
+            }
+        }
+    }
+    return source;
+}
+
+static int geoKnnConnect(sqlite3* db, void* pAux, int, const char* const*,
+                         sqlite3_vtab** ppVTab, char** pzErr) {
+    int rc = sqlite3_declare_vtab(db,
+        "CREATE TABLE x(_rowid INTEGER, distance REAL, _offset INTEGER, _data BLOB, "
+        "table_name TEXT HIDDEN, lat REAL HIDDEN, lon REAL HIDDEN, k INTEGER HIDDEN)");
+    if (rc != SQLITE_OK) {
+        if (pzErr) *pzErr = sqlite3_mprintf("Failed to declare geo_knn: %s", sqlite3_errmsg(db));
+        return rc;
+    }
+
+    GeoKnnVTab* vtab = new GeoKnnVTab();
+    memset(static_cast<sqlite3_vtab*>(vtab), 0, sizeof(sqlite3_vtab));
+    vtab->engine = static_cast<SQLiteEngine*>(pAux);
+    *ppVTab = vtab;
+    return SQLITE_OK;
+}
+
+static int geoKnnDisconnect(sqlite3_vtab* pVTab) {
+    delete static_cast<GeoKnnVTab*>(pVTab);
+    return SQLITE_OK;
+}
+
+static int geoKnnBestIndex(sqlite3_vtab*, sqlite3_index_info* pIdxInfo) {
+    // All four arguments are required; argv follows the argument order
+    int argvFor[4] = {-1, -1, -1, -1};
+    for (int i = 0; i < pIdxInfo->nConstraint; i++) {
+        const auto& constraint = pIdxInfo->aConstraint[i];
+        if (constraint.iColumn < KNN_TABLE || constraint.op != SQLITE_INDEX_CONSTRAINT_EQ) continue;
+        if (!constraint.usable) return SQLITE_CONSTRAINT;
+        argvFor[constraint.iColumn - KNN_TABLE] = i;
+    }
+    for (int arg = 0; arg < 4; arg++) {
+        if (argvFor[arg] < 0) return SQLITE_CONSTRAINT;
+        pIdxInfo->aConstraintUsage[argvFor[arg]].argvIndex = arg + 1;
+        pIdxInfo->aConstraintUsage[argvFor[arg]].omit = 1;
+    }
+
+    // Rows come out in distance order
+    if (pIdxInfo->nOrderBy == 1 && pIdxInfo->aOrderBy[0].iColumn == KNN_DISTANCE &&
+        !pIdxInfo->aOrderBy[0].desc) {
+        pIdxInfo->orderByConsumed = 1;
+    }
+    pIdxInfo->estimatedCost = 10.0;
+    pIdxInfo->estimatedRows = 10;
+    return SQLITE_OK;
+}
+
+static int geoKnnOpen(sqlite3_vtab*, sqlite3_vtab_cursor** ppCursor) {
+    GeoKnnCursor* cursor = new GeoKnnCursor();
+    memset(static_cast<sqlite3_vtab_cursor*>(cursor), 0, sizeof(sqlite3_vtab_cursor));
+    *ppCursor = cursor;
+    return SQLITE_OK;
+}
+
+static int geoKnnClose(sqlite3_vtab_cursor* pCursor) {
+    delete static_cast<GeoKnnCursor*>(pCursor);
+    return SQLITE_OK;
+}
+
+static int geoKnnFilter(sqlite3_vtab_cursor* pCursor, int, const char*,
+                        int argc, sqlite3_value** argv) {
+    GeoKnnCursor* cursor = static_cast<GeoKnnCursor*>(pCursor);
+    GeoKnnVTab* vtab = static_cast<GeoKnnVTab*>(pCursor->pVtab);
+    cursor->results.clear();
+    cursor->position = 0;
+    cursor->source = nullptr;
+
+    if (argc < 4) return SQLITE_OK;
+    for (int i = 0; i < 4; i++) {
+        if (sqlite3_value_type(argv[i]) == SQLITE_NULL) return SQLITE_OK;
+    }
+
+    const char* name = reinterpret_cast<const char*>(sqlite3_value_text(argv[0]));
+    const SourceInfo* source = resolveSource(vtab->engine, name);
+    if (!source || !source->spatialIndex) {
+        sqlite3_free(vtab->zErrMsg);
+        vtab->zErrMsg = sqlite3_mprintf("geo_knn: no spatial index on table '%s'", name);
+        return SQLITE_ERROR;
+    }
+
+    sqlite3_int64 k = sqlite3_value_int64(argv[3]);
+    if (k <= 0) return SQLITE_OK;
+
+    try {
+        cursor->results = source->spatialIndex->nearest(
+            sqlite3_value_double(argv[1]), sqlite3_value_double(argv[2]),
+            static_cast<size_t>(k), &source->tombstones);
+    } catch (const std::exception& e) {
+        sqlite3_free(vtab->zErrMsg);
+        vtab->zErrMsg = sqlite3_mprintf("geo_knn: %s", e.what());
+        return SQLITE_ERROR;
+    }
+    cursor->source = source;
+    return SQLITE_OK;
+}
+
+static int geoKnnNext(sqlite3_vtab_cursor* pCursor) {
+    static_cast<GeoKnnCursor*>(pCursor)->position++;
+    return SQLITE_OK;
+}
+
+static int geoKnnEof(sqlite3_vtab_cursor* pCursor) {
+    GeoKnnCursor* cursor = static_cast<GeoKnnCursor*>(pCursor);
+    return cursor->position >= cursor->results.size() ? 1 : 0;
+}
+
+static int geoKnnColumn(sqlite3_vtab_cursor* pCursor, sqlite3_context* ctx, int N) {
+    GeoKnnCursor* cursor = static_cast<GeoKnnCursor*>(pCursor);
+    const IndexEntry& entry = cursor->results[cursor->position];
+    switch (N) {
+        case KNN_ROWID:
+            sqlite3_result_int64(ctx, static_cast<sqlite3_int64>(entry.sequence));
+            break;
+        case KNN_DISTANCE:
+            sqlite3_result_double(ctx, std::get<double>(entry.key));
+            break;
+        case KNN_OFFSET:
+            sqlite3_result_int64(ctx, static_cast<sqlite3_int64>(entry.dataOffset));
+            break;
+        case KNN_DATA: {
+            uint32_t len = 0;
+            const uint8_t* data = cursor->source->store->getDataAtOffset(entry.dataOffset, &len);
+            if (data) {
+                sqlite3_result_blob(ctx, data, static_cast<int>(len), SQLITE_TRANSIENT);
+            } else {
+                sqlite3_result_null(ctx);
+            }
+            break;
+        }
+        default:
+            sqlite3_result_null(ctx);
+            break;
+    }
+    return SQLITE_OK;
+}
+
+static int geoKnnRowid(sqlite3_vtab_cursor* pCursor, sqlite3_int64* pRowid) {
+    *pRowid = static_cast<sqlite3_int64>(static_cast<GeoKnnCursor*>(pCursor)->position);
+    return SQLITE_OK;
+}
+
+// Eponymous-only module: usable as geo_knn(...) without CREATE VIRTUAL TABLE
+static sqlite3_module geoKnnModule = {
+    0,                          // iVersion
+    nullptr,                    // xCreate (eponymous-only)
+    geoKnnConnect,              // xConnect
+    geoKnnBestIndex,            // xBestIndex
+    geoKnnDisconnect,           // xDisconnect
+    geoKnnDisconnect,           // xDestroy
+    geoKnnOpen,                 // xOpen
+    geoKnnClose,                // xClose
+    geoKnnFilter,               // xFilter
+    geoKnnNext,                 // xNext
+    geoKnnEof,                  // xEof
+    geoKnnColumn,               // xColumn
+    geoKnnRowid,                // xRowid
+    nullptr,                    // xUpdate
+    nullptr,                    // xBegin
+    nullptr,                    // xSync
+    nullptr,                    // xCommit
+    nullptr,                    // xRollback
+    nullptr,                    // xFindFunction
+    nullptr,                    // xRename
+    nullptr,                    // xSavepoint
+    nullptr,                    // xRelease
+    nullptr,                    // xRollbackTo
+    nullptr,                    // xShadowName
+    nullptr                     // xIntegrity
+};
+
+// ==================== sgp4_propagate table-valued function ====================
+//
+//   SELECT _rowid, t, x, y, z, vx, vy, vz
+//   FROM sgp4_propagate('MPE', 1700000000, 1700086400, 60)
+//   WHERE error = 0
+//
+// Propagates every record of a mean-element table (CCSDS OMM / MPE column
+// names) to each time t0, t0 + step, ... <= t1 (UNIX seconds). Rows are
+// TEME position (km) and velocity (km/s), time-major. Elements are read once
+// per query straight from the FlatBuffers, and positions are computed a
+// block of time steps at a time across threads.
+
+namespace {
+
+enum Sgp4Column {
+    SGP4_COL_ROWID = 0,
+    SGP4_COL_T,
+    SGP4_COL_X,
+    SGP4_COL_Y,
+    SGP4_COL_Z,
+    SGP4_COL_VX,
+    SGP4_COL_VY,
+    SGP4_COL_VZ,
+    SGP4_COL_ERROR,
+    SGP4_COL_TABLE,
+    SGP4_COL_T0,
+    SGP4_COL_T1,
+    SGP4_COL_STEP
+};
+
+// Element columns in Sgp4Elements order
+const char* const SGP4_ELEMENT_COLUMNS[] = {
+    "EPOCH", "MEAN_MOTION", "ECCENTRICITY", "INCLINATION",
+    "RA_OF_ASC_NODE", "ARG_OF_PERICENTER", "MEAN_ANOMALY", "BSTAR"
+};
+constexpr int SGP4_ELEMENT_COUNT = 8;
+
+// Rows computed per block; bounds memory independently of the grid size
+constexpr size_t SGP4_BLOCK_ROWS = 65536;
+
+struct Sgp4VTab : public sqlite3_vtab {
+    SQLiteEngine* engine;
+};
+
+struct Sgp4Cursor : public sqlite3_vtab_cursor {
+    Sgp4Batch batch;
+    std::vector<uint64_t> sequences;
+    double t0 = 0.0;
+    double step = 0.0;
+    size_t totalSteps = 0;
+
+    // Current block of propagated states, step-major
+    std::vector<Sgp4State> states;
+    std::vector<int32_t> errors;
+    size_t blockFirstStep = 0;
+    size_t blockSteps = 0;
+
+    // Position: step within the block and satellite within the step
+    size_t stepInBlock = 0;
+    size_t satellite = 0;
+    sqlite3_int64 rowid = 0;
+
+    bool eof() const { return sequences.empty() || blockFirstStep + stepInBlock >= totalSteps; }
+
+    void loadBlock(size_t firstStep) {
+        size_t n = sequences.size();
+        blockFirstStep = firstStep;
+        blockSteps = std::min(totalSteps - firstStep, std::max<size_t>(1, SGP4_BLOCK_ROWS / n));
+        states.resize(blockSteps * n);
+        errors.resize(blockSteps * n);
+        batch.propagateGrid(t0 + static_cast<double>(firstStep) * step, step, blockSteps, 0,
+                            states.data(), errors.data());
+        stepInBlock = 0;
+        satellite = 0;
+    }
+};
+
+// How to read one element column: raw from the buffer, or via the extractor
+struct ElementReader {
+    const ColumnDef* column = nullptr;
+    bool raw = false;
+    double defaultValue = 0.0;
+};
+
+}  // namespace
+
+static int sgp4Connect(sqlite3* db, void* pAux, int, const char* const*,
+                       sqlite3_vtab** ppVTab, char** pzErr) {
+    int rc = sqlite3_declare_vtab(db,
+        "CREATE TABLE x(_rowid INTEGER, t REAL, x REAL, y REAL, z REAL, "
+        "vx REAL, vy REAL, vz REAL, error INTEGER, "
+        "table_name TEXT HIDDEN, t0 REAL HIDDEN, t1 REAL HIDDEN, step REAL HIDDEN)");
+    if (rc != SQLITE_OK) {
+        if (pzErr) *pzErr = sqlite3_mprintf("Failed to declare sgp4_propagate: %s", sqlite3_errmsg(db));
+        return rc;
+    }
+
+    Sgp4VTab* vtab = new Sgp4VTab();
+    memset(static_cast<sqlite3_vtab*>(vtab), 0, sizeof(sqlite3_vtab));
+    vtab->engine = static_cast<SQLiteEngine*>(pAux);
+    *ppVTab = vtab;
+    return SQLITE_OK;
+}
+
+static int sgp4Disconnect(sqlite3_vtab* pVTab) {
+    delete static_cast<Sgp4VTab*>(pVTab);
+    return SQLITE_OK;
+}
+
+static int sgp4BestIndex(sqlite3_vtab*, sqlite3_index_info* pIdxInfo) {
+    // All four arguments are required; argv follows the argument order
+    int argvFor[4] = {-1, -1, -1, -1};
+    for (int i = 0; i < pIdxInfo->nConstraint; i++) {
+        const auto& constraint = pIdxInfo->aConstraint[i];
+        if (constraint.iColumn < SGP4_COL_TABLE || constraint.op != SQLITE_INDEX_CONSTRAINT_EQ) continue;
+        if (!constraint.usable) return SQLITE_CONSTRAINT;
+        argvFor[constraint.iColumn - SGP4_COL_TABLE] = i;
+    }
+    for (int arg = 0; arg < 4; arg++) {
+        if (argvFor[arg] < 0) return SQLITE_CONSTRAINT;
+        pIdxInfo->aConstraintUsage[argvFor[arg]].argvIndex = arg + 1;
+        pIdxInfo->aConstraintUsage[argvFor[arg]].omit = 1;
+    }
+
+    // Rows come out in time order
+    if (pIdxInfo->nOrderBy == 1 && pIdxInfo->aOrderBy[0].iColumn == SGP4_COL_T &&
+        !pIdxInfo->aOrderBy[0].desc) {
+        pIdxInfo->orderByConsumed = 1;
+    }
+    pIdxInfo->estimatedCost = 1000000.0;
+    pIdxInfo->estimatedRows = 1000000;
+    return SQLITE_OK;
+}
+
+static int sgp4Open(sqlite3_vtab*, sqlite3_vtab_cursor** ppCursor) {
+    Sgp4Cursor* cursor = new Sgp4Cursor();
+    memset(static_cast<sqlite3_vtab_cursor*>(cursor), 0, sizeof(sqlite3_vtab_cursor));
+    *ppCursor = cursor;
+    return SQLITE_OK;
+}
+
+static int sgp4Close(sqlite3_vtab_cursor* pCursor) {
+    delete static_cast<Sgp4Cursor*>(pCursor);
+    return SQLITE_OK;
+}
+
+static int sgp4Error(Sgp4VTab* vtab, char* message) {
+    sqlite3_free(vtab->zErrMsg);
+    vtab->zErrMsg = message;
+    return SQLITE_ERROR;
+}
+
+static int sgp4Filter(sqlite3_vtab_cursor* pCursor, int, const char*,
+                      int argc, sqlite3_value** argv) {
+    Sgp4Cursor* cursor = static_cast<Sgp4Cursor*>(pCursor);
+    Sgp4VTab* vtab = static_cast<Sgp4VTab*>(pCursor->pVtab);
+    cursor->batch = Sgp4Batch();
+    cursor->sequences.clear();
+    cursor->totalSteps = 0;
+    cursor->blockFirstStep = 0;
+    cursor->stepInBlock = 0;
+    cursor->satellite = 0;
+    cursor->rowid = 0;
+
+    if (argc < 4) return SQLITE_OK;
+    for (int i = 0; i < 4; i++) {
+        if (sqlite3_value_type(argv[i]) == SQLITE_NULL) return SQLITE_OK;
+    }
+
+    const char* name = reinterpret_cast<const char*>(sqlite3_value_text(argv[0]));
+    const SourceInfo* source = resolveSource(vtab->engine, name);
+    if (!source || !source->store || !source->tableDef) {
+        return sgp4Error(vtab, sqlite3_mprintf("sgp4_propagate: no such table '%s'", name));
+    }
+
+    double t0 = sqlite3_value_double(argv[1]);
+    double t1 = sqlite3_value_double(argv[2]);
+    double step = sqlite3_value_double(argv[3]);
+    if (!(step > 0.0) || !std::isfinite(t0) || !std::isfinite(t1)) {
+        return sgp4Error(vtab, sqlite3_mprintf("sgp4_propagate: step must be positive and times finite"));
+    }
+    if (t1 < t0) return SQLITE_OK;
+    double steps = std::floor((t1 - t0) / step + 1e-9) + 1.0;
+    if (steps > 1e9) {
+        return sgp4Error(vtab, sqlite3_mprintf("sgp4_propagate: time grid too large"));
+    }
+
+    // Resolve element columns. Unencrypted doubles are read from the buffer
+    // directly; anything else goes through the table's field extractor.
+    const TableDef& tableDef = *source->tableDef;
+    auto findColumn = [&](const char* column) -> const ColumnDef* {
+        for (const auto& col : tableDef.columns) {
+            if (col.name == column) return &col;
+        }
+        return nullptr;
+    };
+    ElementReader readers[SGP4_ELEMENT_COUNT];
+    for (int e = 0; e < SGP4_ELEMENT_COUNT; e++) {
+        ElementReader& reader = readers[e];
+        reader.column = findColumn(SGP4_ELEMENT_COLUMNS[e]);
+        if (!reader.column) {
+            return sgp4Error(vtab, sqlite3_mprintf("sgp4_propagate: table '%s' has no %s column",
+                                                   name, SGP4_ELEMENT_COLUMNS[e]));
+        }
+        reader.raw = reader.column->type == ValueType::Float64 && !reader.column->encrypted &&
+                     reader.column->slotKnown;
+        if (reader.column->defaultValue) {
+            SpatialIndex::toDouble(*reader.column->defaultValue, reader.defaultValue);
+        }
+        if (!reader.raw && !source->extractor) {
+            return sgp4Error(vtab, sqlite3_mprintf("sgp4_propagate: %s needs a field extractor",
+                                                   SGP4_ELEMENT_COLUMNS[e]));
+        }
+    }
+    const ColumnDef* theory = findColumn("MEAN_ELEMENT_THEORY");
+
+    const auto* recordInfos = source->sourceRecordInfos
+        ? source->sourceRecordInfos
+        : source->store->getRecordInfoVector(source->fileId);
+    if (!recordInfos) return SQLITE_OK;
+
+    for (const auto& info : *recordInfos) {
+        if (!source->tombstones.empty() && source->tombstones.count(info.sequence)) continue;
+        uint32_t len = 0;
+        const uint8_t* data = source->store->getDataAtOffset(info.offset, &len);
+        if (!data) continue;
+
+        // Only SGP4 element sets (theory 0) can be propagated
+        if (theory && source->extractor) {
+            double kind;
+            if (SpatialIndex::toDouble(source->extractor(data, len, theory->name), kind) && kind != 0.0) {
+                continue;
+            }
+        }
+
+        double values[SGP4_ELEMENT_COUNT];
+        bool ok = true;
+        for (int e = 0; e < SGP4_ELEMENT_COUNT && ok; e++) {
+            const ElementReader& reader = readers[e];
+            if (reader.raw) {
+                ok = fbReadRootScalar<double>(data, len, reader.column->fieldId, reader.defaultValue, values[e]);
+            } else {
+                ok = SpatialIndex::toDouble(source->extractor(data, len, reader.column->name), values[e]);
+            }
+        }
+        if (!ok) continue;
+
+        cursor->batch.add(Sgp4Elements{values[0], values[1], values[2], values[3],
+                                       values[4], values[5], values[6], values[7]});
+        cursor->sequences.push_back(info.sequence);
+    }
+
+    cursor->t0 = t0;
+    cursor->step = step;
+    cursor->totalSteps = static_cast<size_t>(steps);
+    if (!cursor->sequences.empty()) cursor->loadBlock(0);
+    return SQLITE_OK;
+}
+
+static int sgp4Next(sqlite3_vtab_cursor* pCursor) {
+    Sgp4Cursor* cursor = static_cast<Sgp4Cursor*>(pCursor);
+    cursor->rowid++;
+    if (++cursor->satellite < cursor->sequences.size()) return SQLITE_OK;
+    cursor->satellite = 0;
+    if (++cursor->stepInBlock < cursor->blockSteps) return SQLITE_OK;
+
+    size_t nextStep = cursor->blockFirstStep + cursor->blockSteps;
+    if (nextStep < cursor->totalSteps) {
+        cursor->loadBlock(nextStep);
+    }
+    return SQLITE_OK;
+}
+
+static int sgp4Eof(sqlite3_vtab_cursor* pCursor) {
+    return static_cast<Sgp4Cursor*>(pCursor)->eof() ? 1 : 0;
+}
+
+static int sgp4Column(sqlite3_vtab_cursor* pCursor, sqlite3_context* ctx, int N) {
+    Sgp4Cursor* cursor = static_cast<Sgp4Cursor*>(pCursor);
+    size_t row = cursor->stepInBlock * cursor->sequences.size() + cursor->satellite;
+    const Sgp4State& state = cursor->states[row];
+    int32_t error = cursor->errors[row];
+
+    switch (N) {
+        case SGP4_COL_ROWID:
+            sqlite3_result_int64(ctx, static_cast<sqlite3_int64>(cursor->sequences[cursor->satellite]));
+            return SQLITE_OK;
+        case SGP4_COL_T:
+            sqlite3_result_double(ctx, cursor->t0 +
+                static_cast<double>(cursor->blockFirstStep + cursor->stepInBlock) * cursor->step);
+            return SQLITE_OK;
+        case SGP4_COL_ERROR:
+            sqlite3_result_int(ctx, error);
+            return SQLITE_OK;
+        default:
+            break;
+    }
+
+    // State columns are NULL when propagation failed
+    if (error != SGP4_OK || N < SGP4_COL_X || N > SGP4_COL_VZ) {
+        sqlite3_result_null(ctx);
+        return SQLITE_OK;
+    }
+    const double components[6] = {state.x, state.y, state.z, state.vx, state.vy, state.vz};
+    sqlite3_result_double(ctx, components[N - SGP4_COL_X]);
+    return SQLITE_OK;
+}
+
+static int sgp4Rowid(sqlite3_vtab_cursor* pCursor, sqlite3_int64* pRowid) {
+    *pRowid = static_cast<Sgp4Cursor*>(pCursor)->rowid;
+    return SQLITE_OK;
+}
+
+// Eponymous-only module: usable as sgp4_propagate(...) without CREATE VIRTUAL TABLE
+static sqlite3_module sgp4Module = {
+    0,                          // iVersion
+    nullptr,                    // xCreate (eponymous-only)
+    sgp4Connect,                // xConnect
+    sgp4BestIndex,              // xBestIndex
+    sgp4Disconnect,             // xDisconnect
+    sgp4Disconnect,             // xDestroy
+    sgp4Open,                   // xOpen
+    sgp4Close,                  // xClose
+    sgp4Filter,                 // xFilter
+    sgp4Next,                   // xNext
+    sgp4Eof,                    // xEof
+    sgp4Column,                 // xColumn
+    sgp4Rowid,                  // xRowid
+    nullptr,                    // xUpdate
+    nullptr,                    // xBegin
+    nullptr,                    // xSync
+    nullptr,                    // xCommit
+    nullptr,                    // xRollback
+    nullptr,                    // xFindFunction
+    nullptr,                    // xRename
+    nullptr,                    // xSavepoint
+    nullptr,                    // xRelease
+    nullptr,                    // xRollbackTo
+    nullptr,                    // xShadowName
+    nullptr                     // xIntegrity
+};
+
+// ==================== fb_each table-valued function ====================
+//
+//   SELECT p.name, e.value
+//   FROM post AS p, fb_each('post', 'tags') AS e
+//   WHERE e._rowid = p.rowid
+//
+// One row per element of a vector column ([string], [int], ...), read in
+// place from the FlatBuffers. Without a _rowid constraint every record of
+// the table is unnested, in storage order.
+
+namespace {
+
+enum FbEachColumn {
+    EACH_ROWID = 0,
+    EACH_IDX,
+    EACH_VALUE,
+    EACH_TABLE,
+    EACH_COLUMN
+};
+
+struct FbEachVTab : public sqlite3_vtab {
+    SQLiteEngine* engine;
+};
+
+struct FbEachCursor : public sqlite3_vtab_cursor {
+    const SourceInfo* source = nullptr;
+    const ColumnDef* column = nullptr;
+
+    // Records to visit: the whole table, or the single _rowid record
+    const std::vector<StreamingFlatBufferStore::FileRecordInfo>* records = nullptr;
+    StreamingFlatBufferStore::FileRecordInfo single{};
+    size_t recordCount = 0;
+    size_t record = 0;
+
+    FbVectorView vector;
+    bool opened = false;
+    uint32_t element = 0;
+    sqlite3_int64 rowid = 0;
+
+    const StreamingFlatBufferStore::FileRecordInfo& recordInfo(size_t i) const {
+        return records ? (*records)[i] : single;
+    }
+
+    bool eof() const { return record >= recordCount; }
+
+    // Move past exhausted, empty, deleted and malformed records to the next
+    // element, opening records as it goes
+    void settle() {
+        while (record < recordCount) {
+            if (!opened) {
+                opened = openRecord(recordInfo(record));
+                element = 0;
+            }
+            if (opened && element < vector.size()) return;
+            record++;
+            opened = false;
+        }
+    }
+
+    bool openRecord(const StreamingFlatBufferStore::FileRecordInfo& info) {
+        if (!source->tombstones.empty() && source->tombstones.count(info.sequence)) return false;
+        uint32_t len = 0;
+        const uint8_t* data = source->store->getDataAtOffset(info.offset, &len);
+        return data && vector.open(data, len, column->fieldId, column->elementType);
+    }
+};
+
+}  // namespace
+
+static int fbEachConnect(sqlite3* db, void* pAux, int, const char* const*,
+                         sqlite3_vtab** ppVTab, char** pzErr) {
+    int rc = sqlite3_declare_vtab(db,
+        "CREATE TABLE x(_rowid INTEGER, idx INTEGER, value, "
+        "table_name TEXT HIDDEN, column_name TEXT HIDDEN)");
+    if (rc != SQLITE_OK) {
+        if (pzErr) *pzErr = sqlite3_mprintf("Failed to declare fb_each: %s", sqlite3_errmsg(db));
+        return rc;
+    }
+
+    FbEachVTab* vtab = new FbEachVTab();
+    memset(static_cast<sqlite3_vtab*>(vtab), 0, sizeof(sqlite3_vtab));
+    vtab->engine = static_cast<SQLiteEngine*>(pAux);
+    *ppVTab = vtab;
+    return SQLITE_OK;
+}
+
+static int fbEachDisconnect(sqlite3_vtab* pVTab) {
+    delete static_cast<FbEachVTab*>(pVTab);
+    return SQLITE_OK;
+}
+
+static int fbEachBestIndex(sqlite3_vtab*, sqlite3_index_info* pIdxInfo) {
+    // Both arguments are required; _rowid = ? narrows to one record (idxNum 1)
+    int argvFor[2] = {-1, -1};
+    int rowidConstraint = -1;
+    for (int i = 0; i < pIdxInfo->nConstraint; i++) {
+        const auto& constraint = pIdxInfo->aConstraint[i];
+        if (constraint.op != SQLITE_INDEX_CONSTRAINT_EQ) continue;
+        if (constraint.iColumn == EACH_ROWID) {
+            if (constraint.usable) rowidConstraint = i;
+            continue;
+        }
+        if (constraint.iColumn < EACH_TABLE) continue;
+        if (!constraint.usable) return SQLITE_CONSTRAINT;
+        argvFor[constraint.iColumn - EACH_TABLE] = i;
+    }
+    for (int arg = 0; arg < 2; arg++) {
+        if (argvFor[arg] < 0) return SQLITE_CONSTRAINT;
+        pIdxInfo->aConstraintUsage[argvFor[arg]].argvIndex = arg + 1;
+        pIdxInfo->aConstraintUsage[argvFor[arg]].omit = 1;
+    }
+
+    if (rowidConstraint >= 0) {
+        pIdxInfo->aConstraintUsage[rowidConstraint].argvIndex = 3;
+        pIdxInfo->aConstraintUsage[rowidConstraint].omit = 1;
+        pIdxInfo->idxNum = 1;
+        pIdxInfo->estimatedCost = 10.0;
+        pIdxInfo->estimatedRows = 10;
+    } else {
+        pIdxInfo->idxNum = 0;
+        pIdxInfo->estimatedCost = 1000000.0;
+        pIdxInfo->estimatedRows = 1000000;
+    }
+    return SQLITE_OK;
+}
+
+static int fbEachOpen(sqlite3_vtab*, sqlite3_vtab_cursor** ppCursor) {
+    FbEachCursor* cursor = new FbEachCursor();
+    memset(static_cast<sqlite3_vtab_cursor*>(cursor), 0, sizeof(sqlite3_vtab_cursor));
+    *ppCursor = cursor;
+    return SQLITE_OK;
+}
+
+static int fbEachClose(sqlite3_vtab_cursor* pCursor) {
+    delete static_cast<FbEachCursor*>(pCursor);
+    return SQLITE_OK;
+}
+
+static int fbEachError(FbEachVTab* vtab, char* message) {
+    sqlite3_free(vtab->zErrMsg);
+    vtab->zErrMsg = message;
+    return SQLITE_ERROR;
+}
+
+static int fbEachFilter(sqlite3_vtab_cursor* pCursor, int idxNum, const char*,
+                        int argc, sqlite3_value** argv) {
+    FbEachCursor* cursor = static_cast<FbEachCursor*>(pCursor);
+    FbEachVTab* vtab = static_cast<FbEachVTab*>(pCursor->pVtab);
+    cursor->records = nullptr;
+    cursor->recordCount = 0;
+    cursor->record = 0;
+    cursor->opened = false;
+    cursor->element = 0;
+    cursor->rowid = 0;
+
+    if (argc < 2) return SQLITE_OK;
+    for (int i = 0; i < argc; i++) {
+        if (sqlite3_value_type(argv[i]) == SQLITE_NULL) return SQLITE_OK;
+    }
+
+    const char* name = reinterpret_cast<const char*>(sqlite3_value_text(argv[0]));
+    const char* columnName = reinterpret_cast<const char*>(sqlite3_value_text(argv[1]));
+    const SourceInfo* source = resolveSource(vtab->engine, name);
+    if (!source || !source->store || !source->tableDef) {
+        return fbEachError(vtab, sqlite3_mprintf("fb_each: no such table '%s'", name));
+    }
+    const ColumnDef* column = nullptr;
+    for (const auto& col : source->tableDef->columns) {
+        if (sqlite3_stricmp(col.name.c_str(), columnName) == 0) column = &col;
+    }
+    if (!column) {
+        return fbEachError(vtab, sqlite3_mprintf("fb_each: table '%s' has no column '%s'", name, columnName));
+    }
+    if (!column->isVector || column->encrypted) {
+        return fbEachError(vtab, sqlite3_mprintf("fb_each: column '%s' is not an unencrypted vector",
+                                                 columnName));
+    }
+    if (!column->slotKnown) {
+        return fbEachError(vtab, sqlite3_mprintf("fb_each: column '%s' follows a field the schema can't place",
+                                                 columnName));
+    }
+    cursor->source = source;
+    cursor->column = column;
+
+    if (idxNum == 1 && argc >= 3) {
+        // Single record; its file identifier must belong to this table
+        uint64_t sequence = static_cast<uint64_t>(sqlite3_value_int64(argv[2]));
+        auto offset = source->store->getOffsetForSequence(sequence);
+        if (!offset.has_value()) return SQLITE_OK;
+        uint32_t len = 0;
+        const uint8_t* data = source->store->getDataAtOffset(offset.value(), &len);
+        if (!data || (!source->fileId.empty() &&
+                      (len < FILE_IDENTIFIER_OFFSET + FILE_IDENTIFIER_LENGTH ||
+                       std::memcmp(data + FILE_IDENTIFIER_OFFSET, source->fileId.data(),
+                                   std::min(source->fileId.size(), FILE_IDENTIFIER_LENGTH)) != 0))) {
+            return SQLITE_OK;
+        }
+        cursor->single = {offset.value(), sequence};
+        cursor->recordCount = 1;
+    } else {
+        cursor->records = source->sourceRecordInfos
+            ? source->sourceRecordInfos
+            : source->store->getRecordInfoVector(source->fileId);
+        cursor->recordCount = cursor->records ? cursor->records->size() : 0;
+    }
+
+    cursor->settle();
+    return SQLITE_OK;
+}
+
+static int fbEachNext(sqlite3_vtab_cursor* pCursor) {
+    FbEachCursor* cursor = static_cast<FbEachCursor*>(pCursor);
+    cursor->element++;
+    cursor->rowid++;
+    cursor->settle();
+    return SQLITE_OK;
+}
+
+static int fbEachEof(sqlite3_vtab_cursor* pCursor) {
+    return static_cast<FbEachCursor*>(pCursor)->eof() ? 1 : 0;
+}
+
+static int fbEachColumn(sqlite3_vtab_cursor* pCursor, sqlite3_context* ctx, int N) {
+    FbEachCursor* cursor = static_cast<FbEachCursor*>(pCursor);
+    switch (N) {
+        case EACH_ROWID:
+            sqlite3_result_int64(ctx, static_cast<sqlite3_int64>(cursor->recordInfo(cursor->record).sequence));
+            return SQLITE_OK;
+        case EACH_IDX:
+            sqlite3_result_int64(ctx, cursor->element);
+            return SQLITE_OK;
+        case EACH_VALUE:
+            break;
+        default:
+            sqlite3_result_null(ctx);
+            return SQLITE_OK;
+    }
+
+    // Strings point straight into the store, like the fast extractors
+    const FbVectorView& vector = cursor->vector;
+    if (vector.getElementType() == ValueType::String) {
+        const char* str;
+        uint32_t len;
+        if (vector.stringAt(cursor->element, str, len)) {
+            sqlite3_result_text(ctx, str, static_cast<int>(len), SQLITE_STATIC);
+        } else {
+            sqlite3_result_null(ctx);
+        }
+        return SQLITE_OK;
+    }
+    std::visit([ctx](auto&& v) {
+        using T = std::decay_t<decltype(v)>;
+        if constexpr (std::is_same_v<T, float> || std::is_same_v<T, double>) {
+            sqlite3_result_double(ctx, static_cast<double>(v));
+        } else if constexpr (std::is_arithmetic_v<T>) {
+            sqlite3_result_int64(ctx, static_cast<sqlite3_int64>(v));
+        } else {
+            sqlite3_result_null(ctx);
+        }
+    }, vector.at(cursor->element));
+    return SQLITE_OK;
+}
+
+static int fbEachRowid(sqlite3_vtab_cursor* pCursor, sqlite3_int64* pRowid) {
+    *pRowid = static_cast<FbEachCursor*>(pCursor)->rowid;
+    return SQLITE_OK;
+}
+
+// Eponymous-only module: usable as fb_each(...) without CREATE VIRTUAL TABLE
+static sqlite3_module fbEachModule = {
+    0,                          // iVersion
+    nullptr,                    // xCreate (eponymous-only)
+    fbEachConnect,              // xConnect
+    fbEachBestIndex,            // xBestIndex
+    fbEachDisconnect,           // xDisconnect
+    fbEachDisconnect,           // xDestroy
+    fbEachOpen,                 // xOpen
+    fbEachClose,                // xClose
+    fbEachFilter,               // xFilter
+    fbEachNext,                 // xNext
+    fbEachEof,                  // xEof
+    fbEachColumn,               // xColumn
+    fbEachRowid,                // xRowid
+    nullptr,                    // xUpdate
+    nullptr,                    // xBegin
+    nullptr,                    // xSync
+    nullptr,                    // xCommit
+    nullptr,                    // xRollback
+    nullptr,                    // xFindFunction
+    nullptr,                    // xRename
+    nullptr,                    // xSavepoint
+    nullptr,                    // xRelease
+    nullptr,                    // xRollbackTo
+    nullptr,                    // xShadowName
+    nullptr                     // xIntegrity
+};
+
 SQLiteEngine::SQLiteEngine() : db_(nullptr) {
     int rc = sqlite3_open(":memory:", &db_);
     if (rc != SQLITE_OK) {
@@ -47,8 +910,12 @@ SQLiteEngine::SQLiteEngine() : db_(nullptr) {
         throw std::runtime_error("Failed to open SQLite database: " + error);
     }
 
-    // Register custom geo/spatial functions
+    // Register custom geo/spatial and array functions
     registerGeoFunctions(db_);
+    registerArrayFunctions(db_);
+    sqlite3_create_module_v2(db_, "geo_knn", &geoKnnModule, this, nullptr);
+    sqlite3_create_module_v2(db_, "sgp4_propagate", &sgp4Module, this, nullptr);
+    sqlite3_create_module_v2(db_, "fb_each", &fbEachModule, this, nullptr);
 
     // Register sqlean extensions
     math_init(db_);
@@ -106,6 +973,13 @@ sqlite3_stmt* SQLiteEngine::getOrPrepareStmt(const std::string& sql) const {
 SQLiteEngine::SQLiteEngine(SQLiteEngine&& other) noexcept
     : db_(other.db_), sources_(std::move(other.sources_)) {
     other.db_ = nullptr;
+    // geo_knn, sgp4_propagate and fb_each resolve tables through the engine; point
+    // them at the new owner
+    if (db_) {
+        sqlite3_create_module_v2(db_, "geo_knn", &geoKnnModule, this, nullptr);
+        sqlite3_create_module_v2(db_, "sgp4_propagate", &sgp4Module, this, nullptr);
+        sqlite3_create_module_v2(db_, "fb_each", &fbEachModule, this, nullptr);
+    }
 }
 
 SQLiteEngine& SQLiteEngine::operator=(SQLiteEngine&& other) noexcept {
@@ -116,6 +990,11 @@ SQLiteEngine& SQLiteEngine::operator=(SQLiteEngine&& other) noexcept {
         db_ = other.db_;
         sources_ = std::move(other.sources_);
         other.db_ = nullptr;
+        if (db_) {
+            sqlite3_create_module_v2(db_, "geo_knn", &geoKnnModule, this, nullptr);
+            sqlite3_create_module_v2(db_, "sgp4_propagate", &sgp4Module, this, nullptr);
+            sqlite3_create_module_v2(db_, "fb_each", &fbEachModule, this, nullptr);
+        }
     }
     return *this;
 }
@@ -129,7 +1008,11 @@ void SQLiteEngine::registerSource(
     const std::unordered_map<std::string, SqliteIndex*>& indexes,
     FastFieldExtractor fastExtractor,
     BatchExtractor batchExtractor,
-    const std::vector<StreamingFlatBufferStore::FileRecordInfo>* sourceRecordInfos
+    const std::vector<StreamingFlatBufferStore::FileRecordInfo>* sourceRecordInfos,
+    SpatialIndex* spatialIndex,
+    const std::unordered_map<std::string, LearnedIndex*>& learnedIndexes,
+    const std::unordered_map<std::string, RadixIndex*>& radixIndexes,
+    bool vectorsInPlace
 ) {
     if (sources_.count(sourceName)) {
         throw std::runtime_error("Source already registered: " + sourceName);
@@ -144,6 +1027,9 @@ void SQLiteEngine::registerSource(
     sourceInfo->extractor = extractor;
     sourceInfo->batchExtractor = batchExtractor;
     sourceInfo->indexes = indexes;
+    sourceInfo->spatialIndex = spatialIndex;
+    sourceInfo->learnedIndexes = learnedIndexes;
+    sourceInfo->radixIndexes = radixIndexes;
     sourceInfo->sourceRecordInfos = sourceRecordInfos;
 
     // Set up VTabCreateInfo (pointer will be stable after insert)
@@ -154,8 +1040,12 @@ void SQLiteEngine::registerSource(
     sourceInfo->vtabInfo.fileId = fileId;
     sourceInfo->vtabInfo.extractor = extractor;
     sourceInfo->vtabInfo.indexes = indexes;
+    sourceInfo->vtabInfo.spatialIndex = spatialIndex;
+    sourceInfo->vtabInfo.learnedIndexes = learnedIndexes;
+    sourceInfo->vtabInfo.radixIndexes = radixIndexes;
     sourceInfo->vtabInfo.tombstones = &sourceInfo->tombstones;
     sourceInfo->vtabInfo.sourceRecordInfos = sourceRecordInfos;
+    sourceInfo->vtabInfo.vectorsInPlace = vectorsInPlace;
 
     // Store before registering (so pointers are stable)
     SourceInfo* infoPtr = sourceInfo.get();
@@ -189,6 +1079,76 @@ void SQLiteEngine::registerSource(
     }
 }
 
+void SQLiteEngine::setIndexes(const std::string& sourceName,
+                              const std::unordered_map<std::string, SqliteIndex*>& indexes,
+                              bool vectorsInPlace) {
+    auto it = sources_.find(sourceName);
+    if (it == sources_.end()) {
+        throw std::runtime_error("Source not found: " + sourceName);
+    }
+
+    SourceInfo* info = it->second.get();
+    info->indexes = indexes;
+    info->vtabInfo.indexes = indexes;
+    info->vtabInfo.vectorsInPlace = vectorsInPlace;
+    reconnectVirtualTable(sourceName);
+}
+
+void SQLiteEngine::setSpatialIndex(const std::string& sourceName, SpatialIndex* spatialIndex) {
+    auto it = sources_.find(sourceName);
+    if (it == sources_.end()) {
+        throw std::runtime_error("Source not found: " + sourceName);
+    }
+
+    SourceInfo* info = it->second.get();
+    info->spatialIndex = spatialIndex;
+    info->vtabInfo.spatialIndex = spatialIndex;
+    reconnectVirtualTable(sourceName);
+}
+
+void SQLiteEngine::setLearnedIndex(const std::string& sourceName, const std::string& column,
+                                   LearnedIndex* learnedIndex) {
+    auto it = sources_.find(sourceName);
+    if (it == sources_.end()) {
+        throw std::runtime_error("Source not found: " + sourceName);
+    }
+
+    SourceInfo* info = it->second.get();
+    info->learnedIndexes[column] = learnedIndex;
+    info->vtabInfo.learnedIndexes[column] = learnedIndex;
+    reconnectVirtualTable(sourceName);
+}
+
+void SQLiteEngine::setRadixIndex(const std::string& sourceName, const std::string& column,
+                                 RadixIndex* radixIndex) {
+    auto it = sources_.find(sourceName);
+    if (it == sources_.end()) {
+        throw std::runtime_error("Source not found: " + sourceName);
+    }
+
+    SourceInfo* info = it->second.get();
+    info->radixIndexes[column] = radixIndex;
+    info->vtabInfo.radixIndexes[column] = radixIndex;
+    reconnectVirtualTable(sourceName);
+}
+
+void SQLiteEngine::reconnectVirtualTable(const std::string& sourceName) {
+    // Virtual tables copy their create info on connect, so reconnect.
+    // Cached statements still reference the old table and must go first.
+    clearStmtCache();
+
+    std::string sql = "DROP TABLE IF EXISTS \"" + sourceName + "\"; "
+        "CREATE VIRTUAL TABLE \"" + sourceName + "\" USING \"" + sourceName + "\"()";
+
+    char* errMsg = nullptr;
+    int rc = sqlite3_exec(db_, sql.c_str(), nullptr, nullptr, &errMsg);
+    if (rc != SQLITE_OK) {
+        std::string error = errMsg ? errMsg : "Unknown error";
+        sqlite3_free(errMsg);
+        throw std::runtime_error("Failed to recreate virtual table: " + error);
+    }
+}
+
 std::string SQLiteEngine::buildColumnList(const TableDef* tableDef) const {
     std::ostringstream ss;
     bool first = true;
@@ -293,6 +1253,47 @@ void SQLiteEngine::bindValue(sqlite3_stmt* stmt, int idx, const Value& value) co
     }, value);
 }
 
+// Copy the current result row of stmt into row (numCols values)
+static void readRow(sqlite3_stmt* stmt, int numCols, std::vector<Value>& row) {
+    row.resize(numCols);
+
+    for (int i = 0; i < numCols; i++) {
+        int colType = sqlite3_column_type(stmt, i);
+
+        switch (colType) {
+            case SQLITE_NULL:
+                row[i] = std::monostate{};
+                break;
+
+            case SQLITE_INTEGER:
+                row[i] = static_cast<int64_t>(sqlite3_column_int64(stmt, i));
+                break;
+
+            case SQLITE_FLOAT:
+                row[i] = sqlite3_column_double(stmt, i);
+                break;
+
+            case SQLITE_TEXT: {
+                const char* text = reinterpret_cast<const char*>(sqlite3_column_text(stmt, i));
+                int len = sqlite3_column_bytes(stmt, i);
+                row[i] = std::string(text ? text : "", len);
+                break;
+            }
+
+            case SQLITE_BLOB: {
+                const uint8_t* blob = static_cast<const uint8_t*>(sqlite3_column_blob(stmt, i));
+                int len = sqlite3_column_bytes(stmt, i);
+                row[i] = std::vector<uint8_t>(blob, blob + len);
+                break;
+            }
+
+            default:
+                row[i] = std::monostate{};
+                break;
+        }
+    }
+}
+
 QueryResult SQLiteEngine::execute(const std::string& sql) {
     return execute(sql, {});
 }
@@ -325,54 +1326,59 @@ QueryResult SQLiteEngine::execute(const std::string& sql, const std::vector<Valu
     int rc;
     while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
         result.rows.emplace_back();
-        std::vector<Value>& row = result.rows.back();
-        row.resize(numCols);
+        readRow(stmt, numCols, result.rows.back());
+    }
 
-        for (int i = 0; i < numCols; i++) {
-            int colType = sqlite3_column_type(stmt, i);
+    // Don't finalize - statement is cached
+    // sqlite3_reset is called by getOrPrepareStmt on next use
 
-            switch (colType) {
-                case SQLITE_NULL:
-                    row[i] = std::monostate{};
-                    break;
+    if (rc != SQLITE_DONE) {
+        throw std::runtime_error("SQL execution error: " + std::string(sqlite3_errmsg(db_)));
+    }
 
-                case SQLITE_INTEGER:
-                    row[i] = static_cast<int64_t>(sqlite3_column_int64(stmt, i));
-                    break;
+    return result;
+}
 
-                case SQLITE_FLOAT:
-                    row[i] = sqlite3_column_double(stmt, i);
-                    break;
+size_t SQLiteEngine::executeBatch(const std::string& sql, const std::vector<std::vector<Value>>& paramSets,
+                                  const BatchRowSink& sink) {
+    // One prepare (or cache hit) for the whole batch
+    sqlite3_stmt* stmt = getOrPrepareStmt(sql);
+    int numCols = sqlite3_column_count(stmt);
 
-                case SQLITE_TEXT: {
-                    const char* text = reinterpret_cast<const char*>(sqlite3_column_text(stmt, i));
-                    int len = sqlite3_column_bytes(stmt, i);
-                    row[i] = std::string(text ? text : "", len);
-                    break;
-                }
+    // However the batch ends (including a throwing sink), release the
+    // statement's read state and bindings; it stays cached
+    struct StmtReset {
+        sqlite3_stmt* stmt;
+        ~StmtReset() {
+            sqlite3_reset(stmt);
+            sqlite3_clear_bindings(stmt);
+        }
+    } release{stmt};
 
-                case SQLITE_BLOB: {
-                    const uint8_t* blob = static_cast<const uint8_t*>(sqlite3_column_blob(stmt, i));
-                    int len = sqlite3_column_bytes(stmt, i);
-                    row[i] = std::vector<uint8_t>(blob, blob + len);
-                    break;
-                }
+    size_t rowCount = 0;
+    std::vector<Value> row;
+    for (size_t batchIndex = 0; batchIndex < paramSets.size(); batchIndex++) {
+        const auto& params = paramSets[batchIndex];
+        sqlite3_reset(stmt);
+        sqlite3_clear_bindings(stmt);
+        for (size_t i = 0; i < params.size(); i++) {
+            bindValue(stmt, static_cast<int>(i + 1), params[i]);
+        }
 
-                default:
-                    row[i] = std::monostate{};
-                    break;
+        int rc;
+        while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+            readRow(stmt, numCols, row);
+            rowCount++;
+            if (!sink(batchIndex, row)) {
+                return rowCount;
             }
         }
+        if (rc != SQLITE_DONE) {
+            throw std::runtime_error("SQL execution error: " + std::string(sqlite3_errmsg(db_)));
+        }
     }
 
-    // Don't finalize - statement is cached
-    // sqlite3_reset is called by getOrPrepareStmt on next use
-
-    if (rc != SQLITE_DONE) {
-        throw std::runtime_error("SQL execution error: " + std::string(sqlite3_errmsg(db_)));
-    }
-
-    return result;
+    return rowCount;
 }
 
 size_t SQLiteEngine::executeAndCount(const std::string& sql, const std::vector<Value>& params) {
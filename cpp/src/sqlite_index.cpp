@@ -2,117 +2,284 @@
 #include <stdexcept>
 #include <cstring>
 #include <algorithm>
+#include <utility>
 
 namespace flatsql {
 
-// Helper to convert Value to int64 for comparison (optimized with get_if)
-// Order by frequency: int32_t most common in FlatBuffers, then int64_t
-static bool tryGetInt64(const Value& v, int64_t& out) {
-    // Fast path for common types using get_if (faster than visit)
-    if (auto* p = std::get_if<int32_t>(&v)) { out = *p; return true; }  // Most common
-    if (auto* p = std::get_if<int64_t>(&v)) { out = *p; return true; }
-    if (auto* p = std::get_if<uint32_t>(&v)) { out = *p; return true; }
-    if (auto* p = std::get_if<uint64_t>(&v)) { out = static_cast<int64_t>(*p); return true; }
-    if (auto* p = std::get_if<int16_t>(&v)) { out = *p; return true; }
-    if (auto* p = std::get_if<uint16_t>(&v)) { out = *p; return true; }
-    if (auto* p = std::get_if<int8_t>(&v)) { out = *p; return true; }
-    if (auto* p = std::get_if<uint8_t>(&v)) { out = *p; return true; }
-    return false;
+// Numeric class of a Value for comparison: 0 = not a number,
+// 1 = signed integer in i, 2 = uint64 in u, 3 = floating point in d
+static int numericClass(const Value& v, int64_t& i, uint64_t& u, double& d) {
+    switch (v.index()) {
+        case 2:  i = std::get<int8_t>(v); return 1;
+        case 3:  i = std::get<int16_t>(v); return 1;
+        case 4:  i = std::get<int32_t>(v); return 1;
+        case 5:  i = std::get<int64_t>(v); return 1;
+        case 6:  i = std::get<uint8_t>(v); return 1;
+        case 7:  i = std::get<uint16_t>(v); return 1;
+        case 8:  i = std::get<uint32_t>(v); return 1;
+        case 9:  u = std::get<uint64_t>(v); return 2;
+        case 10: d = std::get<float>(v); return 3;
+        case 11: d = std::get<double>(v); return 3;
+        default: return 0;
+    }
 }
 
-// Helper to convert Value to double for comparison
-static bool tryGetDouble(const Value& v, double& out) {
-    return std::visit([&out](const auto& val) -> bool {
-        using T = std::decay_t<decltype(val)>;
-        if constexpr (std::is_same_v<T, float> || std::is_same_v<T, double>) {
-            out = static_cast<double>(val);
-            return true;
-        } else if constexpr (std::is_same_v<T, int8_t> || std::is_same_v<T, int16_t> ||
-                            std::is_same_v<T, int32_t> || std::is_same_v<T, int64_t> ||
-                            std::is_same_v<T, uint8_t> || std::is_same_v<T, uint16_t> ||
-                            std::is_same_v<T, uint32_t> || std::is_same_v<T, uint64_t>) {
-            out = static_cast<double>(val);
-            return true;
-        }
-        return false;
-    }, v);
+static double numericAsDouble(int cls, int64_t i, uint64_t u, double d) {
+    return cls == 1 ? static_cast<double>(i) : cls == 2 ? static_cast<double>(u) : d;
 }
 
 // Compare two Values with numeric type coercion
 int compareValues(const Value& a, const Value& b) {
+    size_t ai = a.index();
+    size_t bi = b.index();
+
     // Handle null comparisons
-    if (std::holds_alternative<std::monostate>(a)) {
-        return std::holds_alternative<std::monostate>(b) ? 0 : -1;
+    if (ai == 0 || bi == 0) {
+        return ai == bi ? 0 : (ai == 0 ? -1 : 1);
     }
-    if (std::holds_alternative<std::monostate>(b)) {
-        return 1;
+
+    int64_t aInt = 0, bInt = 0;
+    uint64_t aUInt = 0, bUInt = 0;
+    double aDouble = 0, bDouble = 0;
+    int aCls = numericClass(a, aInt, aUInt, aDouble);
+    int bCls = numericClass(b, bInt, bUInt, bDouble);
+    if (aCls != 0 && bCls != 0) {
+        // Integers compare exactly, including uint64 above INT64_MAX
+        if (aCls != 3 && bCls != 3) {
+            if (aCls == 1 && bCls == 1) return aInt < bInt ? -1 : (aInt > bInt ? 1 : 0);
+            if (aCls == 1 && aInt < 0) return -1;
+            if (bCls == 1 && bInt < 0) return 1;
+            uint64_t x = aCls == 1 ? static_cast<uint64_t>(aInt) : aUInt;
+            uint64_t y = bCls == 1 ? static_cast<uint64_t>(bInt) : bUInt;
+            return x < y ? -1 : (x > y ? 1 : 0);
+        }
+        double x = numericAsDouble(aCls, aInt, aUInt, aDouble);
+        double y = numericAsDouble(bCls, bInt, bUInt, bDouble);
+        return x < y ? -1 : (x > y ? 1 : 0);
     }
 
-    // Try integer comparison first (handles int32 vs int64 etc.)
-    int64_t aInt, bInt;
-    if (tryGetInt64(a, aInt) && tryGetInt64(b, bInt)) {
-        if (aInt < bInt) return -1;
-        if (aInt > bInt) return 1;
-        return 0;
+    if (ai != bi) {
+        // Different incompatible types - compare by type index
+        return ai < bi ? -1 : 1;
     }
 
-    // Try floating point comparison
-    double aDouble, bDouble;
-    if (tryGetDouble(a, aDouble) && tryGetDouble(b, bDouble)) {
-        if (aDouble < bDouble) return -1;
-        if (aDouble > bDouble) return 1;
-        return 0;
+    switch (ai) {
+        case 1: {
+            bool x = std::get<bool>(a);
+            bool y = std::get<bool>(b);
+            return x == y ? 0 : (x ? 1 : -1);
+        }
+        case 12:
+            return std::get<std::string>(a).compare(std::get<std::string>(b));
+        case 13: {
+            const auto& x = std::get<std::vector<uint8_t>>(a);
+            const auto& y = std::get<std::vector<uint8_t>>(b);
+            size_t n = std::min(x.size(), y.size());
+            int c = n ? std::memcmp(x.data(), y.data(), n) : 0;
+            if (c != 0) return c < 0 ? -1 : 1;
+            return x.size() < y.size() ? -1 : (x.size() > y.size() ? 1 : 0);
+        }
+        default:
+            return 0;
     }
+}
 
-    // String comparison
-    if (std::holds_alternative<std::string>(a) && std::holds_alternative<std::string>(b)) {
-        return std::get<std::string>(a).compare(std::get<std::string>(b));
+
+// ==================== Compact block encoding ====================
+//
+// block := varint(count) entry*
+// entry := varint(shared) varint(suffixLength) suffix
+//          varint(zigzag(sequence - prevSequence)) varint(zigzag(offset - prevOffset))
+//
+// shared is the number of leading bytes the entry's encoded key has in common
+// with the previous entry's. The first entry of a block is coded against an
+// empty key and zero sequence/offset, so every block decodes on its own.
+
+static void putVarint(std::string& out, uint64_t v) {
+    while (v >= 0x80) {
+        out += static_cast<char>((v & 0x7F) | 0x80);
+        v >>= 7;
+    }
+    out += static_cast<char>(v);
+}
+
+static bool getVarint(const uint8_t*& p, const uint8_t* end, uint64_t& v) {
+    v = 0;
+    for (int shift = 0; shift < 64 && p < end; shift += 7) {
+        uint8_t b = *p++;
+        v |= static_cast<uint64_t>(b & 0x7F) << shift;
+        if (!(b & 0x80)) return true;
     }
+    return false;
+}
+
+// Deltas wrap mod 2^64; zigzag keeps small negative deltas short
+static uint64_t zigzag(uint64_t delta) {
+    return (delta << 1) ^ static_cast<uint64_t>(static_cast<int64_t>(delta) >> 63);
+}
+
+static uint64_t unzigzag(uint64_t v) {
+    return (v >> 1) ^ (~(v & 1) + 1);
+}
+
+static void putEntry(std::string& out, const std::string& prevKey, uint64_t prevSeq, uint64_t prevOffset,
+                     const std::string& key, uint64_t sequence, uint64_t offset) {
+    size_t limit = std::min(prevKey.size(), key.size());
+    size_t shared = 0;
+    while (shared < limit && prevKey[shared] == key[shared]) shared++;
+    putVarint(out, shared);
+    putVarint(out, key.size() - shared);
+    out.append(key, shared, std::string::npos);
+    putVarint(out, zigzag(sequence - prevSeq));
+    putVarint(out, zigzag(offset - prevOffset));
+}
 
-    // Blob comparison
-    if (std::holds_alternative<std::vector<uint8_t>>(a) && std::holds_alternative<std::vector<uint8_t>>(b)) {
-        const auto& aVec = std::get<std::vector<uint8_t>>(a);
-        const auto& bVec = std::get<std::vector<uint8_t>>(b);
-        size_t minLen = std::min(aVec.size(), bVec.size());
-        for (size_t i = 0; i < minLen; i++) {
-            if (aVec[i] < bVec[i]) return -1;
-            if (aVec[i] > bVec[i]) return 1;
+// Encoded key order of (key, sequence) pairs
+static int compareEntry(const std::string& aKey, uint64_t aSeq, const std::string& bKey, uint64_t bSeq) {
+    int c = aKey.compare(bKey);
+    if (c != 0) return c;
+    return aSeq < bSeq ? -1 : (aSeq > bSeq ? 1 : 0);
+}
+
+namespace {
+
+// Forward decoder over one block
+struct BlockReader {
+    const uint8_t* p = nullptr;
+    const uint8_t* end = nullptr;
+    uint64_t count = 0;
+    uint64_t remaining = 0;
+    std::string key;
+    uint64_t sequence = 0;
+    uint64_t offset = 0;
+
+    bool open(const void* data, size_t size) {
+        p = static_cast<const uint8_t*>(data);
+        end = p + size;
+        key.clear();
+        sequence = 0;
+        offset = 0;
+        if (!p || !getVarint(p, end, count)) return false;
+        remaining = count;
+        return true;
+    }
+
+    // Decode the next entry; false at the end of the block or if malformed
+    bool next() {
+        if (remaining == 0) return false;
+        uint64_t shared, suffix, seqDelta, offDelta;
+        if (!getVarint(p, end, shared) || !getVarint(p, end, suffix)) return fail();
+        if (shared > key.size() || suffix > static_cast<uint64_t>(end - p)) return fail();
+        key.resize(shared);
+        key.append(reinterpret_cast<const char*>(p), suffix);
+        p += suffix;
+        if (!getVarint(p, end, seqDelta) || !getVarint(p, end, offDelta)) return fail();
+        sequence += unzigzag(seqDelta);
+        offset += unzigzag(offDelta);
+        remaining--;
+        return true;
+    }
+
+    bool fail() {
+        remaining = 0;
+        return false;
+    }
+};
+
+struct BlockEntry {
+    std::string key;
+    uint64_t sequence;
+    uint64_t offset;
+};
+
+std::string encodeBlock(const std::vector<BlockEntry>& entries, size_t begin, size_t end) {
+    std::string out;
+    putVarint(out, end - begin);
+    for (size_t i = begin; i < end; i++) {
+        const BlockEntry& e = entries[i];
+        if (i == begin) {
+            putEntry(out, std::string(), 0, 0, e.key, e.sequence, e.offset);
+        } else {
+            const BlockEntry& prev = entries[i - 1];
+            putEntry(out, prev.key, prev.sequence, prev.offset, e.key, e.sequence, e.offset);
         }
-        if (aVec.size() < bVec.size()) return -1;
-        if (aVec.size() > bVec.size()) return 1;
-        return 0;
     }
+    return out;
+}
 
-    // Bool comparison
-    if (std::holds_alternative<bool>(a) && std::holds_alternative<bool>(b)) {
-        bool aVal = std::get<bool>(a);
-        bool bVal = std::get<bool>(b);
-        return aVal == bVal ? 0 : (aVal < bVal ? -1 : 1);
+// SQLite record payload sizes, for the getStorageBytes() count
+size_t sqliteVarintLength(uint64_t v) {
+    size_t n = 1;
+    while (v >= 0x80 && n < 9) {
+        v >>= 7;
+        n++;
     }
+    return n;
+}
 
-    // Different incompatible types - compare by type index
-    return a.index() < b.index() ? -1 : 1;
+size_t sqliteIntegerLength(int64_t v) {
+    if (v == 0 || v == 1) return 0;
+    if (v >= -128 && v <= 127) return 1;
+    if (v >= -32768 && v <= 32767) return 2;
+    if (v >= -8388608 && v <= 8388607) return 3;
+    if (v >= -2147483648LL && v <= 2147483647LL) return 4;
+    if (v >= -140737488355328LL && v <= 140737488355327LL) return 6;
+    return 8;
 }
 
+size_t sqliteBlobLength(uint64_t size) {
+    return sqliteVarintLength(size * 2 + 12) + size;  // Serial type + bytes
+}
+
+// Payload of an index row: a header (its size, then one serial type per
+// column) followed by the column values
+uint64_t rowRecordBytes(size_t keyLength, uint64_t offset, uint64_t sequence) {
+    return 1 + sqliteBlobLength(keyLength) + 1 + sqliteIntegerLength(static_cast<int64_t>(offset)) +
+           1 + sqliteIntegerLength(static_cast<int64_t>(sequence));
+}
+
+uint64_t blockRecordBytes(size_t firstKeyLength, int64_t firstSeq, size_t blockLength) {
+    return 1 + sqliteBlobLength(firstKeyLength) + 1 + sqliteIntegerLength(firstSeq) +
+           sqliteBlobLength(blockLength);
+}
+
+}  // namespace
+
+// ==================== SqliteIndex ====================
+
+
 SqliteIndex::SqliteIndex(sqlite3* db, const std::string& tableName,
-                         const std::string& columnName, ValueType keyType)
-    : db_(db), keyType_(keyType) {
-
-    // Create unique index table name: _idx_{table}_{column}
-    indexTableName_ = "_idx_" + tableName + "_" + columnName;
-
-    // Create the index table with appropriate type
-    // Use (key, sequence) as composite primary key to support non-unique indexes
-    // This allows multiple records with the same key (e.g., posts by same user_id)
-    std::string sqlType = getSqliteType();
-    std::string createSql =
-        "CREATE TABLE IF NOT EXISTS \"" + indexTableName_ + "\" ("
-        "key " + sqlType + " NOT NULL, "
-        "data_offset INTEGER NOT NULL, "
-        "data_length INTEGER NOT NULL, "
-        "sequence INTEGER NOT NULL, "
-        "PRIMARY KEY (key, sequence)"
-        ") WITHOUT ROWID";
+                         const std::string& columnName, ValueType keyType, IndexLayout layout)
+    : db_(db), keyType_(keyType), layout_(layout) {
+
+    // Unique index table name: _idx_{table}_{column}, or _cidx_ for the
+    // compact layout so a column can switch layouts without a DROP TABLE
+    indexTableName_ = (layout_ == IndexLayout::Compact ? "_cidx_" : "_idx_") + tableName + "_" + columnName;
+    const std::string t = "\"" + indexTableName_ + "\"";
+
+    // Keys are KeyCodec-encoded BLOBs, which SQLite compares with memcmp.
+    // Record lengths come from the size prefix in storage, so only the offset is kept.
+    std::string createSql;
+    if (layout_ == IndexLayout::Rows) {
+        // Use (key, sequence) as composite primary key to support non-unique indexes
+        // This allows multiple records with the same key (e.g., posts by same user_id)
+        createSql =
+            "CREATE TABLE IF NOT EXISTS " + t + " ("
+            "key BLOB NOT NULL, "
+            "data_offset INTEGER NOT NULL, "
+            "sequence INTEGER NOT NULL, "
+            "PRIMARY KEY (key, sequence)"
+            ") WITHOUT ROWID";
+    } else {
+        // One row per block, keyed by the block's first (key, sequence)
+        createSql =
+            "CREATE TABLE IF NOT EXISTS " + t + " ("
+            "first_key BLOB NOT NULL, "
+            "first_seq INTEGER NOT NULL, "
+            "block BLOB NOT NULL, "
+            "PRIMARY KEY (first_key, first_seq)"
+            ") WITHOUT ROWID";
+    }
 
     char* errMsg = nullptr;
     int rc = sqlite3_exec(db_, createSql.c_str(), nullptr, nullptr, &errMsg);
@@ -122,241 +289,183 @@ SqliteIndex::SqliteIndex(sqlite3* db, const std::string& tableName,
         throw std::runtime_error("Failed to create index table: " + err);
     }
 
-    // Prepare statements
-    std::string insertSql = "INSERT INTO \"" + indexTableName_ +
-        "\" (key, data_offset, data_length, sequence) VALUES (?, ?, ?, ?)";
-    rc = sqlite3_prepare_v2(db_, insertSql.c_str(), -1, &insertStmt_, nullptr);
-    if (rc != SQLITE_OK) {
-        throw std::runtime_error("Failed to prepare insert statement");
-    }
-
-    std::string searchSql = "SELECT key, data_offset, data_length, sequence FROM \"" +
-        indexTableName_ + "\" WHERE key = ?";
-    rc = sqlite3_prepare_v2(db_, searchSql.c_str(), -1, &searchStmt_, nullptr);
-    if (rc != SQLITE_OK) {
-        throw std::runtime_error("Failed to prepare search statement");
+    prepare("SELECT COUNT(*) FROM " + t, &countStmt_, "count");
+    prepare("DELETE FROM " + t, &clearStmt_, "clear");
+
+    if (layout_ == IndexLayout::Compact) {
+        prepare("INSERT INTO " + t + " (first_key, first_seq, block) VALUES (?, ?, ?)",
+                &insertStmt_, "insert");
+        prepare("SELECT first_key, first_seq, block FROM " + t + " ORDER BY first_key, first_seq",
+                &allStmt_, "all");
+        // Row-value bounds let SQLite seek the primary key directly
+        prepare("SELECT first_key, first_seq, block FROM " + t +
+                " WHERE (first_key, first_seq) <= (?, ?) ORDER BY first_key DESC, first_seq DESC LIMIT 1",
+                &blockFloorStmt_, "block floor");
+        prepare("SELECT first_key, first_seq, block FROM " + t + " ORDER BY first_key, first_seq LIMIT 1",
+                &blockHeadStmt_, "block head");
+        prepare("SELECT block FROM " + t +
+                " WHERE first_key < ? ORDER BY first_key DESC, first_seq DESC LIMIT 1",
+                &blockBeforeStmt_, "block before");
+        prepare("SELECT block FROM " + t +
+                " WHERE first_key >= ? AND first_key <= ? ORDER BY first_key, first_seq",
+                &blockRangeStmt_, "block range");
+        prepare("SELECT block FROM " + t +
+                " WHERE (first_key, first_seq) > (?, ?) ORDER BY first_key, first_seq",
+                &blockAfterStmt_, "block after");
+        prepare("UPDATE " + t + " SET block = ? WHERE first_key = ? AND first_seq = ?",
+                &blockUpdateStmt_, "block update");
+        prepare("DELETE FROM " + t + " WHERE first_key = ? AND first_seq = ?",
+                &blockDeleteStmt_, "block delete");
+        return;
     }
 
+    prepare("INSERT INTO " + t + " (key, data_offset, sequence) VALUES (?, ?, ?)",
+            &insertStmt_, "insert");
+    prepare("SELECT key, data_offset, sequence FROM " + t + " WHERE key = ?",
+            &searchStmt_, "search");
     // searchFirst returns just the first match (with LIMIT 1 for efficiency)
-    std::string searchFirstSql = "SELECT key, data_offset, data_length, sequence FROM \"" +
-        indexTableName_ + "\" WHERE key = ? LIMIT 1";
-    rc = sqlite3_prepare_v2(db_, searchFirstSql.c_str(), -1, &searchFirstStmt_, nullptr);
-    if (rc != SQLITE_OK) {
-        throw std::runtime_error("Failed to prepare searchFirst statement");
-    }
-
-    std::string rangeSql = "SELECT key, data_offset, data_length, sequence FROM \"" +
-        indexTableName_ + "\" WHERE key >= ? AND key <= ? ORDER BY key";
-    rc = sqlite3_prepare_v2(db_, rangeSql.c_str(), -1, &rangeStmt_, nullptr);
-    if (rc != SQLITE_OK) {
-        throw std::runtime_error("Failed to prepare range statement");
-    }
-
-    std::string allSql = "SELECT key, data_offset, data_length, sequence FROM \"" +
-        indexTableName_ + "\" ORDER BY key";
-    rc = sqlite3_prepare_v2(db_, allSql.c_str(), -1, &allStmt_, nullptr);
-    if (rc != SQLITE_OK) {
-        throw std::runtime_error("Failed to prepare all statement");
-    }
+    prepare("SELECT key, data_offset, sequence FROM " + t + " WHERE key = ? LIMIT 1",
+            &searchFirstStmt_, "searchFirst");
+    prepare("SELECT key, data_offset, sequence FROM " + t + " WHERE key >= ? AND key <= ? ORDER BY key",
+            &rangeStmt_, "range");
+    // Half-open range used for prefix probes (upper bound is the prefix successor)
+    prepare("SELECT key, data_offset, sequence FROM " + t + " WHERE key >= ? AND key < ? ORDER BY key",
+            &prefixStmt_, "prefix");
+    prepare("SELECT key, data_offset, sequence FROM " + t + " ORDER BY key",
+            &allStmt_, "all");
+    // Cursor refill: resumes after the last (key, sequence) handed out
+    prepare("SELECT key, data_offset, sequence FROM " + t +
+            " WHERE (key, sequence) > (?, ?) ORDER BY key, sequence",
+            &afterStmt_, "after");
+}
 
-    std::string countSql = "SELECT COUNT(*) FROM \"" + indexTableName_ + "\"";
-    rc = sqlite3_prepare_v2(db_, countSql.c_str(), -1, &countStmt_, nullptr);
+void SqliteIndex::prepare(const std::string& sql, sqlite3_stmt** stmt, const char* what) {
+    int rc = sqlite3_prepare_v2(db_, sql.c_str(), -1, stmt, nullptr);
     if (rc != SQLITE_OK) {
-        throw std::runtime_error("Failed to prepare count statement");
+        std::string err = sqlite3_errmsg(db_);
+        finalizeAll();
+        throw std::runtime_error(std::string("Failed to prepare ") + what + " statement: " + err);
     }
+}
 
-    std::string clearSql = "DELETE FROM \"" + indexTableName_ + "\"";
-    rc = sqlite3_prepare_v2(db_, clearSql.c_str(), -1, &clearStmt_, nullptr);
-    if (rc != SQLITE_OK) {
-        throw std::runtime_error("Failed to prepare clear statement");
+void SqliteIndex::finalizeAll() {
+    for (sqlite3_stmt** stmt : {&insertStmt_, &searchStmt_, &searchFirstStmt_, &rangeStmt_,
+                                &prefixStmt_, &allStmt_, &afterStmt_, &countStmt_, &clearStmt_,
+                                &blockFloorStmt_, &blockHeadStmt_, &blockBeforeStmt_,
+                                &blockRangeStmt_, &blockAfterStmt_, &blockUpdateStmt_,
+                                &blockDeleteStmt_}) {
+        if (*stmt) sqlite3_finalize(*stmt);
+        *stmt = nullptr;
     }
 }
 
 SqliteIndex::~SqliteIndex() {
-    if (insertStmt_) sqlite3_finalize(insertStmt_);
-    if (searchStmt_) sqlite3_finalize(searchStmt_);
-    if (searchFirstStmt_) sqlite3_finalize(searchFirstStmt_);
-    if (rangeStmt_) sqlite3_finalize(rangeStmt_);
-    if (allStmt_) sqlite3_finalize(allStmt_);
-    if (countStmt_) sqlite3_finalize(countStmt_);
-    if (clearStmt_) sqlite3_finalize(clearStmt_);
+    finalizeAll();
 }
 
 SqliteIndex::SqliteIndex(SqliteIndex&& other) noexcept
-    : db_(other.db_)
-    , indexTableName_(std::move(other.indexTableName_))
-    , keyType_(other.keyType_)
-    , entryCount_(other.entryCount_)
-    , insertStmt_(other.insertStmt_)
-    , searchStmt_(other.searchStmt_)
-    , searchFirstStmt_(other.searchFirstStmt_)
-    , rangeStmt_(other.rangeStmt_)
-    , allStmt_(other.allStmt_)
-    , countStmt_(other.countStmt_)
-    , clearStmt_(other.clearStmt_)
-{
-    other.db_ = nullptr;
-    other.insertStmt_ = nullptr;
-    other.searchStmt_ = nullptr;
-    other.searchFirstStmt_ = nullptr;
-    other.rangeStmt_ = nullptr;
-    other.allStmt_ = nullptr;
-    other.countStmt_ = nullptr;
-    other.clearStmt_ = nullptr;
+    : db_(nullptr), keyType_(ValueType::Null), layout_(IndexLayout::Rows) {
+    *this = std::move(other);
 }
 
 SqliteIndex& SqliteIndex::operator=(SqliteIndex&& other) noexcept {
     if (this != &other) {
         // Clean up existing statements
-        if (insertStmt_) sqlite3_finalize(insertStmt_);
-        if (searchStmt_) sqlite3_finalize(searchStmt_);
-        if (searchFirstStmt_) sqlite3_finalize(searchFirstStmt_);
-        if (rangeStmt_) sqlite3_finalize(rangeStmt_);
-        if (allStmt_) sqlite3_finalize(allStmt_);
-        if (countStmt_) sqlite3_finalize(countStmt_);
-        if (clearStmt_) sqlite3_finalize(clearStmt_);
+        finalizeAll();
 
         // Move from other
-        db_ = other.db_;
+        db_ = std::exchange(other.db_, nullptr);
         indexTableName_ = std::move(other.indexTableName_);
         keyType_ = other.keyType_;
+        layout_ = other.layout_;
         entryCount_ = other.entryCount_;
-        insertStmt_ = other.insertStmt_;
-        searchStmt_ = other.searchStmt_;
-        searchFirstStmt_ = other.searchFirstStmt_;
-        rangeStmt_ = other.rangeStmt_;
-        allStmt_ = other.allStmt_;
-        countStmt_ = other.countStmt_;
-        clearStmt_ = other.clearStmt_;
-
-        other.db_ = nullptr;
-        other.insertStmt_ = nullptr;
-        other.searchStmt_ = nullptr;
-        other.searchFirstStmt_ = nullptr;
-        other.rangeStmt_ = nullptr;
-        other.allStmt_ = nullptr;
-        other.countStmt_ = nullptr;
-        other.clearStmt_ = nullptr;
+        storageBytes_ = other.storageBytes_;
+        insertStmt_ = std::exchange(other.insertStmt_, nullptr);
+        searchStmt_ = std::exchange(other.searchStmt_, nullptr);
+        searchFirstStmt_ = std::exchange(other.searchFirstStmt_, nullptr);
+        rangeStmt_ = std::exchange(other.rangeStmt_, nullptr);
+        prefixStmt_ = std::exchange(other.prefixStmt_, nullptr);
+        allStmt_ = std::exchange(other.allStmt_, nullptr);
+        afterStmt_ = std::exchange(other.afterStmt_, nullptr);
+        countStmt_ = std::exchange(other.countStmt_, nullptr);
+        clearStmt_ = std::exchange(other.clearStmt_, nullptr);
+        blockFloorStmt_ = std::exchange(other.blockFloorStmt_, nullptr);
+        blockHeadStmt_ = std::exchange(other.blockHeadStmt_, nullptr);
+        blockBeforeStmt_ = std::exchange(other.blockBeforeStmt_, nullptr);
+        blockRangeStmt_ = std::exchange(other.blockRangeStmt_, nullptr);
+        blockAfterStmt_ = std::exchange(other.blockAfterStmt_, nullptr);
+        blockUpdateStmt_ = std::exchange(other.blockUpdateStmt_, nullptr);
+        blockDeleteStmt_ = std::exchange(other.blockDeleteStmt_, nullptr);
+        keyBuffer_ = std::move(other.keyBuffer_);
+        keyBuffer2_ = std::move(other.keyBuffer2_);
     }
     return *this;
 }
 
-std::string SqliteIndex::getSqliteType() const {
-    switch (keyType_) {
-        case ValueType::Int8:
-        case ValueType::Int16:
-        case ValueType::Int32:
-        case ValueType::Int64:
-        case ValueType::UInt8:
-        case ValueType::UInt16:
-        case ValueType::UInt32:
-        case ValueType::UInt64:
-            return "INTEGER";
-        case ValueType::Float32:
-        case ValueType::Float64:
-            return "REAL";
-        case ValueType::String:
-            return "TEXT";
-        case ValueType::Bool:
-            return "INTEGER";
-        case ValueType::Bytes:
-            return "BLOB";
-        default:
-            return "BLOB";
-    }
-}
-
-void SqliteIndex::bindKey(sqlite3_stmt* stmt, int index, const Value& key) const {
-    std::visit([stmt, index](auto&& arg) {
-        using T = std::decay_t<decltype(arg)>;
-        if constexpr (std::is_same_v<T, std::monostate>) {
-            sqlite3_bind_null(stmt, index);
-        } else if constexpr (std::is_same_v<T, bool>) {
-            sqlite3_bind_int(stmt, index, arg ? 1 : 0);
-        } else if constexpr (std::is_same_v<T, int8_t> || std::is_same_v<T, int16_t> ||
-                           std::is_same_v<T, int32_t>) {
-            sqlite3_bind_int(stmt, index, static_cast<int>(arg));
-        } else if constexpr (std::is_same_v<T, int64_t>) {
-            sqlite3_bind_int64(stmt, index, arg);
-        } else if constexpr (std::is_same_v<T, uint8_t> || std::is_same_v<T, uint16_t> ||
-                           std::is_same_v<T, uint32_t>) {
-            sqlite3_bind_int(stmt, index, static_cast<int>(arg));
-        } else if constexpr (std::is_same_v<T, uint64_t>) {
-            sqlite3_bind_int64(stmt, index, static_cast<int64_t>(arg));
-        } else if constexpr (std::is_same_v<T, float>) {
-            sqlite3_bind_double(stmt, index, static_cast<double>(arg));
-        } else if constexpr (std::is_same_v<T, double>) {
-            sqlite3_bind_double(stmt, index, arg);
-        } else if constexpr (std::is_same_v<T, std::string>) {
-            sqlite3_bind_text(stmt, index, arg.c_str(), static_cast<int>(arg.size()), SQLITE_TRANSIENT);
-        } else if constexpr (std::is_same_v<T, std::vector<uint8_t>>) {
-            sqlite3_bind_blob(stmt, index, arg.data(), static_cast<int>(arg.size()), SQLITE_TRANSIENT);
-        }
-    }, key);
+bool SqliteIndex::bindKey(sqlite3_stmt* stmt, int index, const Value& key, std::string& buffer,
+                          KeyCodec::Bound bound) const {
+    buffer.clear();
+    if (!KeyCodec::append(keyType_, key, buffer, bound)) {
+        return false;
+    }
+    sqlite3_bind_blob(stmt, index, buffer.data(), static_cast<int>(buffer.size()), SQLITE_STATIC);
+    return true;
 }
 
 Value SqliteIndex::extractKey(sqlite3_stmt* stmt, int column) const {
-    int type = sqlite3_column_type(stmt, column);
-
-    switch (keyType_) {
-        case ValueType::Int8:
-            return static_cast<int8_t>(sqlite3_column_int(stmt, column));
-        case ValueType::Int16:
-            return static_cast<int16_t>(sqlite3_column_int(stmt, column));
-        case ValueType::Int32:
-            return static_cast<int32_t>(sqlite3_column_int(stmt, column));
-        case ValueType::Int64:
-            return sqlite3_column_int64(stmt, column);
-        case ValueType::UInt8:
-            return static_cast<uint8_t>(sqlite3_column_int(stmt, column));
-        case ValueType::UInt16:
-            return static_cast<uint16_t>(sqlite3_column_int(stmt, column));
-        case ValueType::UInt32:
-            return static_cast<uint32_t>(sqlite3_column_int(stmt, column));
-        case ValueType::UInt64:
-            return static_cast<uint64_t>(sqlite3_column_int64(stmt, column));
-        case ValueType::Float32:
-            return static_cast<float>(sqlite3_column_double(stmt, column));
-        case ValueType::Float64:
-            return sqlite3_column_double(stmt, column);
-        case ValueType::String: {
-            const char* text = reinterpret_cast<const char*>(sqlite3_column_text(stmt, column));
-            return text ? std::string(text) : std::string();
-        }
-        case ValueType::Bool:
-            return sqlite3_column_int(stmt, column) != 0;
-        case ValueType::Bytes: {
-            const void* blob = sqlite3_column_blob(stmt, column);
-            int size = sqlite3_column_bytes(stmt, column);
-            if (blob && size > 0) {
-                const uint8_t* data = static_cast<const uint8_t*>(blob);
-                return std::vector<uint8_t>(data, data + size);
-            }
-            return std::vector<uint8_t>();
-        }
-        case ValueType::Null:
-        default:
-            return std::monostate{};
+    const uint8_t* data = static_cast<const uint8_t*>(sqlite3_column_blob(stmt, column));
+    size_t size = static_cast<size_t>(sqlite3_column_bytes(stmt, column));
+    size_t pos = 0;
+    Value key;
+    if (!data || !KeyCodec::decode(keyType_, data, size, pos, key)) {
+        return std::monostate{};
     }
+    return key;
 }
 
 IndexEntry SqliteIndex::extractEntry(sqlite3_stmt* stmt) const {
     IndexEntry entry;
     entry.key = extractKey(stmt, 0);
     entry.dataOffset = static_cast<uint64_t>(sqlite3_column_int64(stmt, 1));
-    entry.dataLength = static_cast<uint32_t>(sqlite3_column_int(stmt, 2));
-    entry.sequence = static_cast<uint64_t>(sqlite3_column_int64(stmt, 3));
+    entry.dataLength = 0;
+    entry.sequence = static_cast<uint64_t>(sqlite3_column_int64(stmt, 2));
+    return entry;
+}
+
+IndexEntry SqliteIndex::makeEntry(const std::string& key, uint64_t offset, uint64_t sequence) const {
+    IndexEntry entry;
+    size_t pos = 0;
+    if (!KeyCodec::decode(keyType_, reinterpret_cast<const uint8_t*>(key.data()), key.size(), pos, entry.key)) {
+        entry.key = std::monostate{};
+    }
+    entry.dataOffset = offset;
+    entry.dataLength = 0;
+    entry.sequence = sequence;
     return entry;
 }
 
-void SqliteIndex::insert(const Value& key, uint64_t dataOffset, uint32_t dataLength, uint64_t sequence) {
+void SqliteIndex::insert(const Value& key, uint64_t dataOffset, uint32_t /*dataLength*/, uint64_t sequence) {
+    if (layout_ == IndexLayout::Compact) {
+        keyBuffer_.clear();
+        if (!KeyCodec::append(keyType_, key, keyBuffer_)) {
+            throw std::runtime_error("Failed to insert index entry: key can't be stored in " +
+                indexTableName_);
+        }
+        std::string encoded = keyBuffer_;
+        compactInsert(encoded, dataOffset, sequence);
+        entryCount_++;
+        return;
+    }
+
     sqlite3_reset(insertStmt_);
     sqlite3_clear_bindings(insertStmt_);
 
-    bindKey(insertStmt_, 1, key);
+    if (!bindKey(insertStmt_, 1, key, keyBuffer_)) {
+        throw std::runtime_error("Failed to insert index entry: key can't be stored in " +
+            indexTableName_);
+    }
     sqlite3_bind_int64(insertStmt_, 2, static_cast<int64_t>(dataOffset));
-    sqlite3_bind_int(insertStmt_, 3, static_cast<int>(dataLength));
-    sqlite3_bind_int64(insertStmt_, 4, static_cast<int64_t>(sequence));
+    sqlite3_bind_int64(insertStmt_, 3, static_cast<int64_t>(sequence));
 
     int rc = sqlite3_step(insertStmt_);
     if (rc != SQLITE_DONE) {
@@ -365,14 +474,27 @@ void SqliteIndex::insert(const Value& key, uint64_t dataOffset, uint32_t dataLen
     }
 
     entryCount_++;
+    storageBytes_ += rowRecordBytes(keyBuffer_.size(), dataOffset, sequence);
 }
 
 std::vector<IndexEntry> SqliteIndex::search(const Value& key) const {
     std::vector<IndexEntry> results;
 
+    if (layout_ == IndexLayout::Compact) {
+        std::string encoded;
+        if (!KeyCodec::append(keyType_, key, encoded)) return results;
+        compactScan(encoded, encoded, true, [&](const std::string& k, uint64_t offset, uint64_t sequence) {
+            results.push_back(makeEntry(k, offset, sequence));
+            return true;
+        });
+        return results;
+    }
+
     sqlite3_reset(searchStmt_);
     sqlite3_clear_bindings(searchStmt_);
-    bindKey(searchStmt_, 1, key);
+    if (!bindKey(searchStmt_, 1, key, keyBuffer_)) {
+        return results;
+    }
 
     while (sqlite3_step(searchStmt_) == SQLITE_ROW) {
         results.push_back(extractEntry(searchStmt_));
@@ -382,9 +504,23 @@ std::vector<IndexEntry> SqliteIndex::search(const Value& key) const {
 }
 
 bool SqliteIndex::searchFirst(const Value& key, IndexEntry& result) const {
+    if (layout_ == IndexLayout::Compact) {
+        std::string encoded;
+        if (!KeyCodec::append(keyType_, key, encoded)) return false;
+        bool found = false;
+        compactScan(encoded, encoded, true, [&](const std::string& k, uint64_t offset, uint64_t sequence) {
+            result = makeEntry(k, offset, sequence);
+            found = true;
+            return false;
+        });
+        return found;
+    }
+
     sqlite3_reset(searchFirstStmt_);
     sqlite3_clear_bindings(searchFirstStmt_);
-    bindKey(searchFirstStmt_, 1, key);
+    if (!bindKey(searchFirstStmt_, 1, key, keyBuffer_)) {
+        return false;
+    }
 
     if (sqlite3_step(searchFirstStmt_) == SQLITE_ROW) {
         result = extractEntry(searchFirstStmt_);
@@ -394,45 +530,80 @@ bool SqliteIndex::searchFirst(const Value& key, IndexEntry& result) const {
     return false;
 }
 
-bool SqliteIndex::searchFirstString(const std::string& key, uint64_t& outOffset, uint32_t& outLength, uint64_t& outSequence) const {
+// Look up an encoded key
+bool SqliteIndex::stepFirst(const std::string& key, uint64_t& outOffset, uint64_t& outSequence) const {
+    if (layout_ == IndexLayout::Compact) {
+        bool found = false;
+        compactScan(key, key, true, [&](const std::string&, uint64_t offset, uint64_t sequence) {
+            outOffset = offset;
+            outSequence = sequence;
+            found = true;
+            return false;
+        });
+        return found;
+    }
+
     sqlite3_reset(searchFirstStmt_);
-    // Bind string directly - no variant dispatch
-    sqlite3_bind_text(searchFirstStmt_, 1, key.c_str(), static_cast<int>(key.size()), SQLITE_STATIC);
+    sqlite3_bind_blob(searchFirstStmt_, 1, key.data(), static_cast<int>(key.size()), SQLITE_STATIC);
 
     if (sqlite3_step(searchFirstStmt_) == SQLITE_ROW) {
         // Extract only what we need - skip key extraction entirely
         outOffset = static_cast<uint64_t>(sqlite3_column_int64(searchFirstStmt_, 1));
-        outLength = static_cast<uint32_t>(sqlite3_column_int(searchFirstStmt_, 2));
-        outSequence = static_cast<uint64_t>(sqlite3_column_int64(searchFirstStmt_, 3));
+        outSequence = static_cast<uint64_t>(sqlite3_column_int64(searchFirstStmt_, 2));
         return true;
     }
 
     return false;
 }
 
-bool SqliteIndex::searchFirstInt64(int64_t key, uint64_t& outOffset, uint32_t& outLength, uint64_t& outSequence) const {
-    sqlite3_reset(searchFirstStmt_);
-    // Bind int64 directly - no variant dispatch
-    sqlite3_bind_int64(searchFirstStmt_, 1, key);
+bool SqliteIndex::searchFirstString(const std::string& key, uint64_t& outOffset, uint64_t& outSequence) const {
+    keyBuffer_.clear();
+    if (keyType_ == ValueType::String) {
+        // Encode the string directly - no variant dispatch
+        KeyCodec::appendBytes(key.data(), key.size(), keyBuffer_);
+    } else if (!KeyCodec::append(keyType_, Value(key), keyBuffer_)) {
+        return false;
+    }
+    return stepFirst(keyBuffer_, outOffset, outSequence);
+}
 
-    if (sqlite3_step(searchFirstStmt_) == SQLITE_ROW) {
-        // Extract only what we need - skip key extraction entirely
-        outOffset = static_cast<uint64_t>(sqlite3_column_int64(searchFirstStmt_, 1));
-        outLength = static_cast<uint32_t>(sqlite3_column_int(searchFirstStmt_, 2));
-        outSequence = static_cast<uint64_t>(sqlite3_column_int64(searchFirstStmt_, 3));
-        return true;
+bool SqliteIndex::searchFirstInt64(int64_t key, uint64_t& outOffset, uint64_t& outSequence) const {
+    keyBuffer_.clear();
+    if (keyType_ == ValueType::Int64) {
+        // Encode the integer directly - no variant dispatch
+        KeyCodec::appendInt64(key, keyBuffer_);
+    } else if (!KeyCodec::append(keyType_, Value(key), keyBuffer_)) {
+        return false;
     }
+    return stepFirst(keyBuffer_, outOffset, outSequence);
+}
 
-    return false;
+bool SqliteIndex::searchFirstEncoded(const std::string& key, uint64_t& outOffset, uint64_t& outSequence) const {
+    return stepFirst(key, outOffset, outSequence);
 }
 
 std::vector<IndexEntry> SqliteIndex::range(const Value& minKey, const Value& maxKey) const {
     std::vector<IndexEntry> results;
 
+    if (layout_ == IndexLayout::Compact) {
+        std::string low, high;
+        if (!KeyCodec::append(keyType_, minKey, low, KeyCodec::Bound::Lower) ||
+            !KeyCodec::append(keyType_, maxKey, high, KeyCodec::Bound::Upper)) {
+            return results;
+        }
+        compactScan(low, high, true, [&](const std::string& k, uint64_t offset, uint64_t sequence) {
+            results.push_back(makeEntry(k, offset, sequence));
+            return true;
+        });
+        return results;
+    }
+
     sqlite3_reset(rangeStmt_);
     sqlite3_clear_bindings(rangeStmt_);
-    bindKey(rangeStmt_, 1, minKey);
-    bindKey(rangeStmt_, 2, maxKey);
+    if (!bindKey(rangeStmt_, 1, minKey, keyBuffer_, KeyCodec::Bound::Lower) ||
+        !bindKey(rangeStmt_, 2, maxKey, keyBuffer2_, KeyCodec::Bound::Upper)) {
+        return results;
+    }
 
     while (sqlite3_step(rangeStmt_) == SQLITE_ROW) {
         results.push_back(extractEntry(rangeStmt_));
@@ -441,9 +612,51 @@ std::vector<IndexEntry> SqliteIndex::range(const Value& minKey, const Value& max
     return results;
 }
 
+std::vector<IndexEntry> SqliteIndex::prefixRange(const std::string& lowKey, const std::string& highPrefix) const {
+    std::vector<IndexEntry> results;
+
+    // An encoded string prefix is a byte prefix of the encoding of every
+    // string that starts with it, so its byte successor bounds them all
+    std::string low, high, encodedPrefix;
+    KeyCodec::appendBytes(lowKey.data(), lowKey.size(), low);
+    KeyCodec::appendBytes(highPrefix.data(), highPrefix.size(), encodedPrefix, false);
+    if (!KeyCodec::prefixSuccessor(encodedPrefix, high)) {
+        high.clear();
+        KeyCodec::appendMax(high);
+    }
+
+    if (layout_ == IndexLayout::Compact) {
+        compactScan(low, high, false, [&](const std::string& k, uint64_t offset, uint64_t sequence) {
+            results.push_back(makeEntry(k, offset, sequence));
+            return true;
+        });
+        return results;
+    }
+
+    sqlite3_reset(prefixStmt_);
+    sqlite3_clear_bindings(prefixStmt_);
+    sqlite3_bind_blob(prefixStmt_, 1, low.data(), static_cast<int>(low.size()), SQLITE_STATIC);
+    sqlite3_bind_blob(prefixStmt_, 2, high.data(), static_cast<int>(high.size()), SQLITE_STATIC);
+
+    while (sqlite3_step(prefixStmt_) == SQLITE_ROW) {
+        results.push_back(extractEntry(prefixStmt_));
+    }
+
+    return results;
+}
+
 std::vector<IndexEntry> SqliteIndex::all() const {
     std::vector<IndexEntry> results;
 
+    if (layout_ == IndexLayout::Compact) {
+        results.reserve(static_cast<size_t>(entryCount_));
+        compactScanAll([&](const std::string& k, uint64_t offset, uint64_t sequence) {
+            results.push_back(makeEntry(k, offset, sequence));
+            return true;
+        });
+        return results;
+    }
+
     sqlite3_reset(allStmt_);
 
     while (sqlite3_step(allStmt_) == SQLITE_ROW) {
@@ -453,6 +666,81 @@ std::vector<IndexEntry> SqliteIndex::all() const {
     return results;
 }
 
+// ==================== Cursors ====================
+
+// Sequence to bind with the cursor position: before every sequence when
+// the whole from key is included. Sequences are stored as signed integers.
+static int64_t resumeSequence(const IndexCursor& cursor) {
+    if (!cursor.fromResume) return INT64_MIN;
+    return cursor.fromSequence > static_cast<uint64_t>(INT64_MAX)
+        ? INT64_MAX : static_cast<int64_t>(cursor.fromSequence);
+}
+
+void SqliteIndex::openSearch(const Value& key, IndexCursor& cursor) const {
+    cursor.open([this](IndexCursor& c) { fillCursor(c); });
+    if (!KeyCodec::append(keyType_, key, cursor.from)) {
+        cursor.close();
+        return;
+    }
+    cursor.to = cursor.from;
+    cursor.hasTo = true;
+}
+
+void SqliteIndex::openRange(const Value& minKey, const Value& maxKey, IndexCursor& cursor) const {
+    cursor.open([this](IndexCursor& c) { fillCursor(c); });
+    if (!KeyCodec::append(keyType_, minKey, cursor.from, KeyCodec::Bound::Lower) ||
+        !KeyCodec::append(keyType_, maxKey, cursor.to, KeyCodec::Bound::Upper)) {
+        cursor.close();
+        return;
+    }
+    cursor.hasTo = true;
+}
+
+void SqliteIndex::openPrefixRange(const std::string& lowKey, const std::string& highPrefix,
+                                  IndexCursor& cursor) const {
+    // Same bounds as prefixRange
+    cursor.open([this](IndexCursor& c) { fillCursor(c); });
+    std::string encodedPrefix;
+    KeyCodec::appendBytes(lowKey.data(), lowKey.size(), cursor.from);
+    KeyCodec::appendBytes(highPrefix.data(), highPrefix.size(), encodedPrefix, false);
+    if (!KeyCodec::prefixSuccessor(encodedPrefix, cursor.to)) {
+        cursor.to.clear();
+        KeyCodec::appendMax(cursor.to);
+    }
+    cursor.hasTo = true;
+    cursor.toInclusive = false;
+}
+
+void SqliteIndex::openAll(IndexCursor& cursor) const {
+    // The empty key sorts before every encoding
+    cursor.open([this](IndexCursor& c) { fillCursor(c); });
+}
+
+void SqliteIndex::fillCursor(IndexCursor& cursor) const {
+    if (layout_ == IndexLayout::Compact) {
+        compactFillCursor(cursor);
+        return;
+    }
+
+    // The row value seeks the (key, sequence) primary key directly. Bind a
+    // copy of the position: cursor.from moves as entries are pushed.
+    keyBuffer_ = cursor.from;
+    sqlite3_reset(afterStmt_);
+    sqlite3_bind_blob(afterStmt_, 1, keyBuffer_.data(), static_cast<int>(keyBuffer_.size()), SQLITE_STATIC);
+    sqlite3_bind_int64(afterStmt_, 2, resumeSequence(cursor));
+    while (sqlite3_step(afterStmt_) == SQLITE_ROW) {
+        const char* key = static_cast<const char*>(sqlite3_column_blob(afterStmt_, 0));
+        size_t length = static_cast<size_t>(sqlite3_column_bytes(afterStmt_, 0));
+        if (cursor.pastEnd(key, length)) break;
+        if (!cursor.push(key ? key : "", length,
+                         static_cast<uint64_t>(sqlite3_column_int64(afterStmt_, 1)),
+                         static_cast<uint64_t>(sqlite3_column_int64(afterStmt_, 2)))) {
+            break;
+        }
+    }
+    sqlite3_reset(afterStmt_);
+}
+
 void SqliteIndex::clear() {
     sqlite3_reset(clearStmt_);
 
@@ -463,6 +751,263 @@ void SqliteIndex::clear() {
     }
 
     entryCount_ = 0;
+    storageBytes_ = 0;
+}
+
+// ==================== Compact layout ====================
+
+void SqliteIndex::compactInsert(const std::string& key, uint64_t offset, uint64_t sequence) {
+    // Find the block the entry belongs in: the last one starting at or
+    // before it, or the first block if the entry sorts before every block
+    std::string firstKey;
+    int64_t firstSeq = 0;
+    std::string block;
+    bool haveBlock = false;
+    bool newHead = false;
+
+    sqlite3_reset(blockFloorStmt_);
+    sqlite3_bind_blob(blockFloorStmt_, 1, key.data(), static_cast<int>(key.size()), SQLITE_STATIC);
+    sqlite3_bind_int64(blockFloorStmt_, 2, static_cast<int64_t>(sequence));
+    sqlite3_stmt* found = nullptr;
+    if (sqlite3_step(blockFloorStmt_) == SQLITE_ROW) {
+        found = blockFloorStmt_;
+    } else {
+        sqlite3_reset(blockHeadStmt_);
+        if (sqlite3_step(blockHeadStmt_) == SQLITE_ROW) {
+            found = blockHeadStmt_;
+            newHead = true;
+        }
+    }
+    if (found) {
+        haveBlock = true;
+        firstKey.assign(static_cast<const char*>(sqlite3_column_blob(found, 0)),
+                        static_cast<size_t>(sqlite3_column_bytes(found, 0)));
+        firstSeq = sqlite3_column_int64(found, 1);
+        block.assign(static_cast<const char*>(sqlite3_column_blob(found, 2)),
+                     static_cast<size_t>(sqlite3_column_bytes(found, 2)));
+    }
+    sqlite3_reset(blockFloorStmt_);
+    sqlite3_reset(blockHeadStmt_);
+
+    if (!haveBlock) {
+        std::string fresh;
+        putVarint(fresh, 1);
+        putEntry(fresh, std::string(), 0, 0, key, sequence, offset);
+        compactPut(fresh);
+        return;
+    }
+
+    // Splice the entry in: only it and its successor are (re)coded, the
+    // rest of the block is copied as is
+    BlockReader reader;
+    if (!reader.open(block.data(), block.size())) {
+        throw std::runtime_error("Corrupt index block in " + indexTableName_);
+    }
+    const uint8_t* base = reinterpret_cast<const uint8_t*>(block.data());
+    const uint8_t* bodyStart = reader.p;
+    std::string prevKey;
+    uint64_t prevSeq = 0, prevOffset = 0;
+    std::string body;
+    bool placed = false;
+    while (true) {
+        const uint8_t* entryStart = reader.p;
+        if (!reader.next()) break;
+        int c = compareEntry(reader.key, reader.sequence, key, sequence);
+        if (c == 0) {
+            throw std::runtime_error("Failed to insert index entry: duplicate key and sequence in " +
+                indexTableName_);
+        }
+        if (c > 0) {
+            body.assign(reinterpret_cast<const char*>(bodyStart), entryStart - bodyStart);
+            putEntry(body, prevKey, prevSeq, prevOffset, key, sequence, offset);
+            putEntry(body, key, sequence, offset, reader.key, reader.sequence, reader.offset);
+            body.append(reinterpret_cast<const char*>(reader.p), base + block.size() - reader.p);
+            placed = true;
+            break;
+        }
+        prevKey = reader.key;
+        prevSeq = reader.sequence;
+        prevOffset = reader.offset;
+    }
+    if (!placed) {
+        if (reader.remaining != 0 || reader.p != base + block.size()) {
+            throw std::runtime_error("Corrupt index block in " + indexTableName_);
+        }
+        body.assign(reinterpret_cast<const char*>(bodyStart), base + block.size() - bodyStart);
+        putEntry(body, prevKey, prevSeq, prevOffset, key, sequence, offset);
+    }
+    uint64_t count = reader.count + 1;
+
+    if (count > COMPACT_BLOCK_ENTRIES || (count > 1 && body.size() > COMPACT_BLOCK_BYTES)) {
+        // Split a full block into two halves
+        std::string merged;
+        putVarint(merged, count);
+        merged += body;
+        std::vector<BlockEntry> entries;
+        entries.reserve(static_cast<size_t>(count));
+        BlockReader all;
+        all.open(merged.data(), merged.size());
+        while (all.next()) entries.push_back({all.key, all.sequence, all.offset});
+
+        size_t half = entries.size() / 2;
+        compactDelete(firstKey, firstSeq, block.size());
+        compactPut(encodeBlock(entries, 0, half));
+        compactPut(encodeBlock(entries, half, entries.size()));
+        return;
+    }
+
+    std::string updated;
+    putVarint(updated, count);
+    updated += body;
+    if (newHead) {
+        // The block's first entry changed, and with it the row key
+        compactDelete(firstKey, firstSeq, block.size());
+        compactPut(updated);
+    } else {
+        compactUpdate(firstKey, firstSeq, block.size(), updated);
+    }
+}
+
+void SqliteIndex::compactPut(const std::string& block) {
+    BlockReader reader;
+    if (!reader.open(block.data(), block.size()) || !reader.next()) {
+        throw std::runtime_error("Failed to insert index block: empty block");
+    }
+    sqlite3_reset(insertStmt_);
+    sqlite3_bind_blob(insertStmt_, 1, reader.key.data(), static_cast<int>(reader.key.size()), SQLITE_STATIC);
+    sqlite3_bind_int64(insertStmt_, 2, static_cast<int64_t>(reader.sequence));
+    sqlite3_bind_blob(insertStmt_, 3, block.data(), static_cast<int>(block.size()), SQLITE_STATIC);
+    int rc = sqlite3_step(insertStmt_);
+    sqlite3_reset(insertStmt_);
+    if (rc != SQLITE_DONE) {
+        throw std::runtime_error("Failed to insert index block: " + std::string(sqlite3_errmsg(db_)));
+    }
+    storageBytes_ += blockRecordBytes(reader.key.size(), static_cast<int64_t>(reader.sequence), block.size());
+}
+
+void SqliteIndex::compactUpdate(const std::string& firstKey, int64_t firstSeq, size_t oldSize,
+                                const std::string& block) {
+    sqlite3_reset(blockUpdateStmt_);
+    sqlite3_bind_blob(blockUpdateStmt_, 1, block.data(), static_cast<int>(block.size()), SQLITE_STATIC);
+    sqlite3_bind_blob(blockUpdateStmt_, 2, firstKey.data(), static_cast<int>(firstKey.size()), SQLITE_STATIC);
+    sqlite3_bind_int64(blockUpdateStmt_, 3, firstSeq);
+    int rc = sqlite3_step(blockUpdateStmt_);
+    sqlite3_reset(blockUpdateStmt_);
+    if (rc != SQLITE_DONE) {
+        throw std::runtime_error("Failed to update index block: " + std::string(sqlite3_errmsg(db_)));
+    }
+    storageBytes_ += sqliteBlobLength(block.size());
+    storageBytes_ -= sqliteBlobLength(oldSize);
+}
+
+void SqliteIndex::compactDelete(const std::string& firstKey, int64_t firstSeq, size_t size) {
+    sqlite3_reset(blockDeleteStmt_);
+    sqlite3_bind_blob(blockDeleteStmt_, 1, firstKey.data(), static_cast<int>(firstKey.size()), SQLITE_STATIC);
+    sqlite3_bind_int64(blockDeleteStmt_, 2, firstSeq);
+    int rc = sqlite3_step(blockDeleteStmt_);
+    sqlite3_reset(blockDeleteStmt_);
+    if (rc != SQLITE_DONE) {
+        throw std::runtime_error("Failed to delete index block: " + std::string(sqlite3_errmsg(db_)));
+    }
+    storageBytes_ -= blockRecordBytes(firstKey.size(), firstSeq, size);
+}
+
+void SqliteIndex::compactScan(const std::string& low, const std::string& high, bool highInclusive,
+                              const BlockVisitor& visit) const {
+    // Visit the entries of one block in [low, high]; false once past high or stopped
+    auto visitBlock = [&](sqlite3_stmt* stmt, int column) {
+        BlockReader reader;
+        if (!reader.open(sqlite3_column_blob(stmt, column),
+                         static_cast<size_t>(sqlite3_column_bytes(stmt, column)))) {
+            return true;
+        }
+        while (reader.next()) {
+            if (reader.key < low) continue;
+            int c = reader.key.compare(high);
+            if (c > 0 || (c == 0 && !highInclusive)) return false;
+            if (!visit(reader.key, reader.offset, reader.sequence)) return false;
+        }
+        return true;
+    };
+
+    // Entries equal to low may start in the last block before it
+    bool more = true;
+    sqlite3_reset(blockBeforeStmt_);
+    sqlite3_bind_blob(blockBeforeStmt_, 1, low.data(), static_cast<int>(low.size()), SQLITE_STATIC);
+    if (sqlite3_step(blockBeforeStmt_) == SQLITE_ROW) {
+        more = visitBlock(blockBeforeStmt_, 0);
+    }
+    sqlite3_reset(blockBeforeStmt_);
+    if (!more) return;
+
+    sqlite3_reset(blockRangeStmt_);
+    sqlite3_bind_blob(blockRangeStmt_, 1, low.data(), static_cast<int>(low.size()), SQLITE_STATIC);
+    sqlite3_bind_blob(blockRangeStmt_, 2, high.data(), static_cast<int>(high.size()), SQLITE_STATIC);
+    while (more && sqlite3_step(blockRangeStmt_) == SQLITE_ROW) {
+        more = visitBlock(blockRangeStmt_, 0);
+    }
+    sqlite3_reset(blockRangeStmt_);
+}
+
+void SqliteIndex::compactFillCursor(IndexCursor& cursor) const {
+    // The position moves as entries are pushed, so keep the starting one
+    std::string from = cursor.from;
+    bool resume = cursor.fromResume;
+    uint64_t fromSequence = cursor.fromSequence;
+    int64_t bindSequence = resumeSequence(cursor);
+
+    // Visit the entries of one block after the position; false once past
+    // the end or the batch is full
+    auto visitBlock = [&](sqlite3_stmt* stmt, int column) {
+        BlockReader reader;
+        if (!reader.open(sqlite3_column_blob(stmt, column),
+                         static_cast<size_t>(sqlite3_column_bytes(stmt, column)))) {
+            return true;
+        }
+        while (reader.next()) {
+            int c = reader.key.compare(from);
+            if (c < 0 || (c == 0 && resume && reader.sequence <= fromSequence)) continue;
+            if (cursor.pastEnd(reader.key.data(), reader.key.size())) return false;
+            if (!cursor.push(reader.key, reader.offset, reader.sequence)) return false;
+        }
+        return true;
+    };
+
+    // The entry after the position is in the last block starting at or
+    // before it, or in a later block
+    bool more = true;
+    sqlite3_reset(blockFloorStmt_);
+    sqlite3_bind_blob(blockFloorStmt_, 1, from.data(), static_cast<int>(from.size()), SQLITE_STATIC);
+    sqlite3_bind_int64(blockFloorStmt_, 2, bindSequence);
+    if (sqlite3_step(blockFloorStmt_) == SQLITE_ROW) {
+        more = visitBlock(blockFloorStmt_, 2);
+    }
+    sqlite3_reset(blockFloorStmt_);
+    if (!more) return;
+
+    sqlite3_reset(blockAfterStmt_);
+    sqlite3_bind_blob(blockAfterStmt_, 1, from.data(), static_cast<int>(from.size()), SQLITE_STATIC);
+    sqlite3_bind_int64(blockAfterStmt_, 2, bindSequence);
+    while (more && sqlite3_step(blockAfterStmt_) == SQLITE_ROW) {
+        more = visitBlock(blockAfterStmt_, 0);
+    }
+    sqlite3_reset(blockAfterStmt_);
+}
+
+void SqliteIndex::compactScanAll(const BlockVisitor& visit) const {
+    sqlite3_reset(allStmt_);
+    bool more = true;
+    while (more && sqlite3_step(allStmt_) == SQLITE_ROW) {
+        BlockReader reader;
+        if (!reader.open(sqlite3_column_blob(allStmt_, 2),
+                         static_cast<size_t>(sqlite3_column_bytes(allStmt_, 2)))) {
+            continue;
+        }
+        while (more && reader.next()) {
+            more = visit(reader.key, reader.offset, reader.sequence);
+        }
+    }
+    sqlite3_reset(allStmt_);
 }
 
 }  // namespace flatsql
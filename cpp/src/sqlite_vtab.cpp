@@ -1,5 +1,10 @@
 #include "flatsql/sqlite_vtab.h"
+#include "flatsql/array_functions.h"
+#include "flatsql/flatbuffer_access.h"
+#include "flatsql/geo_functions.h"
 #include "flatbuffers/encryption.h"
+#include <algorithm>
+#include <cmath>
 #include <cstring>
 #include <sstream>
 
@@ -56,6 +61,21 @@ static void decryptColumnValue(Value& value,
     }
 }
 
+// Literal prefix of a LIKE or GLOB pattern (everything before the first wildcard).
+// An empty result means the pattern is not anchored and the index can't help.
+static std::string literalPatternPrefix(const char* pattern, bool isGlob) {
+    std::string prefix;
+    if (!pattern) return prefix;
+    for (const char* p = pattern; *p; p++) {
+        char c = *p;
+        if (isGlob ? (c == '*' || c == '?' || c == '[') : (c == '%' || c == '_')) {
+            break;
+        }
+        prefix.push_back(c);
+    }
+    return prefix;
+}
+
 // Static module instance
 sqlite3_module FlatBufferVTabModule::module_ = {
     0,                          // iVersion
@@ -76,7 +96,7 @@ sqlite3_module FlatBufferVTabModule::module_ = {
     nullptr,                    // xSync
     nullptr,                    // xCommit
     nullptr,                    // xRollback
-    nullptr,                    // xFindFunction
+    xFindFunction,              // xFindFunction
     nullptr,                    // xRename
     nullptr,                    // xSavepoint
     nullptr,                    // xRelease
@@ -110,7 +130,9 @@ std::string FlatBufferVTabModule::valueTypeToSQLite(ValueType type) {
 }
 
 std::string FlatBufferVTabModule::buildColumnDecl(const ColumnDef& col) {
-    std::string decl = "\"" + col.name + "\" " + valueTypeToSQLite(col.type);
+    // Vector columns read as JSON array text
+    ValueType type = col.isVector ? ValueType::String : col.type;
+    std::string decl = "\"" + col.name + "\" " + valueTypeToSQLite(type);
     if (!col.nullable) {
         decl += " NOT NULL";
     }
@@ -156,6 +178,10 @@ int FlatBufferVTabModule::xConnect(sqlite3* db, void* pAux, int argc, const char
     sql << ", \"_offset\" INTEGER";
     sql << ", \"_data\" BLOB";
 
+    // Hidden point column for spatial predicates, e.g.
+    // WHERE geo_within_radius(_geo, geo_circle(lat, lon, km))
+    sql << ", \"_geo\" BLOB HIDDEN";
+
     sql << ")";
 
     int rc = sqlite3_declare_vtab(db, sql.str().c_str());
@@ -177,10 +203,42 @@ int FlatBufferVTabModule::xConnect(sqlite3* db, void* pAux, int argc, const char
     vtab->extractor = info->extractor;
     vtab->fastExtractor = info->fastExtractor;
     vtab->indexes = info->indexes;
+    vtab->learnedIndexes = info->learnedIndexes;
+    vtab->radixIndexes = info->radixIndexes;
     vtab->tombstones = info->tombstones;
     vtab->sourceRecordInfos = info->sourceRecordInfos;
     vtab->encryptionCtx = info->encryptionCtx;
     vtab->sourceColumnIndex = static_cast<int>(tableDef.columns.size());  // _source is first virtual column
+    vtab->geoColumnIndex = static_cast<int>(tableDef.columns.size()) + 4;
+    vtab->spatialIndex = nullptr;
+    vtab->geoLatColumn = -1;
+    vtab->geoLonColumn = -1;
+
+    // Vectors are decoded in place when the column's slot is known and there
+    // is no extractor (which knows the real layout), or the table opted in.
+    // Matches TableStore::readsVectorInPlace.
+    bool inPlace = info->vectorsInPlace || !info->extractor;
+    for (size_t i = 0; i < tableDef.columns.size(); i++) {
+        const ColumnDef& col = tableDef.columns[i];
+        if (col.isVector && !col.encrypted && col.slotKnown && inPlace) {
+            vtab->vectorColumns.resize(tableDef.columns.size(), 0);
+            vtab->vectorColumns[i] = 1;
+        }
+    }
+
+    if (info->spatialIndex) {
+        for (size_t i = 0; i < tableDef.columns.size(); i++) {
+            if (tableDef.columns[i].name == info->spatialIndex->getLatColumn()) {
+                vtab->geoLatColumn = static_cast<int>(i);
+            }
+            if (tableDef.columns[i].name == info->spatialIndex->getLonColumn()) {
+                vtab->geoLonColumn = static_cast<int>(i);
+            }
+        }
+        if (vtab->geoLatColumn >= 0 && vtab->geoLonColumn >= 0) {
+            vtab->spatialIndex = info->spatialIndex;
+        }
+    }
 
     *ppVTab = vtab;
     return SQLITE_OK;
@@ -205,12 +263,46 @@ int FlatBufferVTabModule::xBestIndex(sqlite3_vtab* pVTab, sqlite3_index_info* pI
     //   1 = rowid equality
     //   2 + (colIdx << 8) = index equality on column colIdx
     //   3 + (colIdx << 8) = index range on column colIdx
+    //   4 + (colIdx << 8) = index prefix probe for anchored LIKE on column colIdx
+    //   5 + (colIdx << 8) = index prefix probe for anchored GLOB on column colIdx
+    //   6 = spatial index radius search (geo_within_radius on _geo)
+    //   7 = spatial index box search (geo_bbox_contains on _geo)
+    //   8 = spatial index polygon search (geo_contains on _geo)
+    //   9 + (colIdx << 8) = element index lookup (array_contains on vector column colIdx)
+    //  10 + (colIdx << 8) = in-memory (learned or radix) index lookup on column colIdx;
+    //                       idxStr holds one op per argument: '=' EQ, '>' GT, 'g' GE,
+    //                       '<' LT, 'l' LE
+    //  11 = scan of the records between rowid (_rowid) and/or _offset bounds; idxStr
+    //       holds two chars per argument: 'r' rowid or 'o' _offset, then the op as above
 
     int idxNum = 0;
     double estimatedCost = 1000000.0;  // Full scan cost
     int argvIndex = 1;
     int usableConstraints = 0;
 
+    // Best LIKE/GLOB candidate, only used when nothing better is found
+    int prefixConstraint = -1;
+    int prefixColIdx = -1;
+    bool prefixIsGlob = false;
+
+    // Spatial predicate on the _geo column, preferred over any scan
+    int geoConstraint = -1;
+    int geoStrategy = 0;
+
+    // array_contains on a vector column with an element index
+    int arrayConstraint = -1;
+    int arrayColIdx = -1;
+
+    // Comparisons on one learned- or radix-index column, preferring a column with EQ
+    std::vector<int> memoryConstraints;
+    int memoryColIdx = -1;
+    bool memoryHasEq = false;
+
+    // Comparisons on rowid, _rowid or _offset, which both ascend in ingest order
+    std::vector<int> recordConstraints;
+    int rowidColumnIndex = vtab->sourceColumnIndex + 1;
+    int offsetColumnIndex = vtab->sourceColumnIndex + 2;
+
     for (int i = 0; i < pIdxInfo->nConstraint; i++) {
         const auto& constraint = pIdxInfo->aConstraint[i];
         if (!constraint.usable) continue;
@@ -227,8 +319,29 @@ int FlatBufferVTabModule::xBestIndex(sqlite3_vtab* pVTab, sqlite3_index_info* pI
             continue;
         }
 
+        if ((colIdx == -1 || colIdx == rowidColumnIndex || colIdx == offsetColumnIndex) &&
+            (constraint.op == SQLITE_INDEX_CONSTRAINT_EQ || constraint.op == SQLITE_INDEX_CONSTRAINT_GT ||
+             constraint.op == SQLITE_INDEX_CONSTRAINT_GE || constraint.op == SQLITE_INDEX_CONSTRAINT_LT ||
+             constraint.op == SQLITE_INDEX_CONSTRAINT_LE)) {
+            recordConstraints.push_back(i);
+            continue;
+        }
+
         // Skip virtual columns for index optimization
         if (colIdx >= static_cast<int>(vtab->tableDef->columns.size())) {
+            // geo_within_radius / geo_bbox_contains overloaded by xFindFunction
+            if (colIdx == vtab->geoColumnIndex && vtab->spatialIndex && geoConstraint < 0) {
+                if (constraint.op == SQLITE_INDEX_CONSTRAINT_FUNCTION) {
+                    geoConstraint = i;
+                    geoStrategy = 6;
+                } else if (constraint.op == SQLITE_INDEX_CONSTRAINT_FUNCTION + 1) {
+                    geoConstraint = i;
+                    geoStrategy = 7;
+                } else if (constraint.op == SQLITE_INDEX_CONSTRAINT_FUNCTION + 2) {
+                    geoConstraint = i;
+                    geoStrategy = 8;
+                }
+            }
             // Check if filtering by _source
             if (colIdx == vtab->sourceColumnIndex && constraint.op == SQLITE_INDEX_CONSTRAINT_EQ) {
                 // _source filter - we can use this to skip the table entirely
@@ -243,20 +356,48 @@ int FlatBufferVTabModule::xBestIndex(sqlite3_vtab* pVTab, sqlite3_index_info* pI
         // Get column name
         const std::string& colName = vtab->tableDef->columns[colIdx].name;
 
+        // array_contains overloaded by xFindFunction
+        if (constraint.op == SQLITE_INDEX_CONSTRAINT_FUNCTION + 3) {
+            auto elementIt = vtab->indexes.find(colName + "[]");
+            if (arrayConstraint < 0 && elementIt != vtab->indexes.end() && elementIt->second) {
+                arrayConstraint = i;
+                arrayColIdx = colIdx;
+            }
+            continue;
+        }
+
+        // Comparisons on an in-memory index column, decided after the loop
+        bool comparison = constraint.op == SQLITE_INDEX_CONSTRAINT_EQ ||
+                          constraint.op == SQLITE_INDEX_CONSTRAINT_GT ||
+                          constraint.op == SQLITE_INDEX_CONSTRAINT_GE ||
+                          constraint.op == SQLITE_INDEX_CONSTRAINT_LT ||
+                          constraint.op == SQLITE_INDEX_CONSTRAINT_LE;
+        bool hasRadix = vtab->radixIndexes.count(colName) > 0;
+        if (comparison && (hasRadix || vtab->learnedIndexes.count(colName))) {
+            bool isEq = constraint.op == SQLITE_INDEX_CONSTRAINT_EQ;
+            if (memoryColIdx != colIdx && (memoryColIdx < 0 || (isEq && !memoryHasEq))) {
+                memoryConstraints.clear();
+                memoryColIdx = colIdx;
+                memoryHasEq = false;
+            }
+            if (memoryColIdx == colIdx) {
+                memoryConstraints.push_back(i);
+                memoryHasEq = memoryHasEq || isEq;
+            }
+        }
+
         // Check if we have an index for this column
         auto indexIt = vtab->indexes.find(colName);
-        if (indexIt != vtab->indexes.end() && indexIt->second != nullptr) {
-            if (constraint.op == SQLITE_INDEX_CONSTRAINT_EQ) {
+        bool hasIndex = indexIt != vtab->indexes.end() && indexIt->second != nullptr;
+        if (hasIndex || hasRadix) {
+            if (hasIndex && constraint.op == SQLITE_INDEX_CONSTRAINT_EQ) {
                 // Encode column index in idxNum (strategy 2 + column << 8)
                 idxNum = 2 + (colIdx << 8);
                 pIdxInfo->aConstraintUsage[i].argvIndex = argvIndex++;
                 pIdxInfo->aConstraintUsage[i].omit = 1;
                 estimatedCost = 10.0;  // Index lookup cost
                 usableConstraints++;
-            } else if (constraint.op == SQLITE_INDEX_CONSTRAINT_GE ||
-                       constraint.op == SQLITE_INDEX_CONSTRAINT_GT ||
-                       constraint.op == SQLITE_INDEX_CONSTRAINT_LE ||
-                       constraint.op == SQLITE_INDEX_CONSTRAINT_LT) {
+            } else if (hasIndex && comparison) {
                 // Range query - encode column index in idxNum (strategy 3 + column << 8)
                 if ((idxNum & 0xFF) < 2) {  // Don't override equality
                     idxNum = 3 + (colIdx << 8);
@@ -265,8 +406,118 @@ int FlatBufferVTabModule::xBestIndex(sqlite3_vtab* pVTab, sqlite3_index_info* pI
                 pIdxInfo->aConstraintUsage[i].omit = 0;  // Don't omit - SQLite will double-check
                 estimatedCost = 100.0;  // Range scan cost
                 usableConstraints++;
+            } else if ((constraint.op == SQLITE_INDEX_CONSTRAINT_LIKE ||
+                        constraint.op == SQLITE_INDEX_CONSTRAINT_GLOB) &&
+                       vtab->tableDef->columns[colIdx].type == ValueType::String &&
+                       prefixConstraint < 0) {
+                // Only anchored patterns map to a key range. When the pattern is a
+                // literal we can check that now; bound parameters are checked in xFilter.
+                bool isGlob = constraint.op == SQLITE_INDEX_CONSTRAINT_GLOB;
+                sqlite3_value* rhs = nullptr;
+                if (sqlite3_vtab_rhs_value(pIdxInfo, i, &rhs) == SQLITE_OK && rhs) {
+                    const char* pattern = reinterpret_cast<const char*>(sqlite3_value_text(rhs));
+                    if (literalPatternPrefix(pattern, isGlob).empty()) continue;
+                }
+                prefixConstraint = i;
+                prefixColIdx = colIdx;
+                prefixIsGlob = isGlob;
+            }
+        }
+    }
+
+    // Use a prefix probe if we'd otherwise scan everything. The range strategy
+    // doesn't read its arguments, so it's safe to replace. The pattern is never
+    // omitted: the probe returns a superset and SQLite re-checks each row.
+    if (prefixConstraint >= 0 && ((idxNum & 0xFF) == 0 || (idxNum & 0xFF) == 3)) {
+        for (int i = 0; i < pIdxInfo->nConstraint; i++) {
+            pIdxInfo->aConstraintUsage[i].argvIndex = 0;
+            pIdxInfo->aConstraintUsage[i].omit = 0;
+        }
+        pIdxInfo->aConstraintUsage[prefixConstraint].argvIndex = 1;
+        idxNum = (prefixIsGlob ? 5 : 4) + (prefixColIdx << 8);
+        estimatedCost = 50.0;  // Bounded range scan cost
+    }
+
+    // Element lookup beats any scan, like an equality lookup. The index holds
+    // every distinct element, so the predicate needs no re-check.
+    int current = idxNum & 0xFF;
+    if (arrayConstraint >= 0 && (current == 0 || current >= 3)) {
+        for (int i = 0; i < pIdxInfo->nConstraint; i++) {
+            pIdxInfo->aConstraintUsage[i].argvIndex = 0;
+            pIdxInfo->aConstraintUsage[i].omit = 0;
+        }
+        pIdxInfo->aConstraintUsage[arrayConstraint].argvIndex = 1;
+        pIdxInfo->aConstraintUsage[arrayConstraint].omit = 1;
+        idxNum = 9 + (arrayColIdx << 8);
+        estimatedCost = 10.0;  // Index lookup cost
+        current = 9;
+    }
+
+    // Spatial search beats any scan. The index applies the exact predicate,
+    // so SQLite doesn't need to evaluate the function again.
+    if (geoConstraint >= 0 && (current == 0 || (current >= 3 && current < 9))) {
+        for (int i = 0; i < pIdxInfo->nConstraint; i++) {
+            pIdxInfo->aConstraintUsage[i].argvIndex = 0;
+            pIdxInfo->aConstraintUsage[i].omit = 0;
+        }
+        pIdxInfo->aConstraintUsage[geoConstraint].argvIndex = 1;
+        pIdxInfo->aConstraintUsage[geoConstraint].omit = 1;
+        idxNum = geoStrategy;
+        estimatedCost = 20.0;  // R*Tree probe cost
+        current = geoStrategy;
+    }
+
+    // In-memory index lookup replaces scans, unbounded ranges and prefix
+    // probes, and an equality lookup on the same column. Equality is exact;
+    // ranges are re-checked by SQLite like the B-tree range strategy.
+    if (memoryColIdx >= 0) {
+        bool sameColumnEq = current == 2 && (idxNum >> 8) == memoryColIdx;
+        bool replace = current == 0 || current == 3 ||
+                       (memoryHasEq && (sameColumnEq || current == 4 || current == 5));
+        if (replace) {
+            for (int i = 0; i < pIdxInfo->nConstraint; i++) {
+                pIdxInfo->aConstraintUsage[i].argvIndex = 0;
+                pIdxInfo->aConstraintUsage[i].omit = 0;
             }
+            std::string ops;
+            for (int i : memoryConstraints) {
+                unsigned char op = pIdxInfo->aConstraint[i].op;
+                pIdxInfo->aConstraintUsage[i].argvIndex = static_cast<int>(ops.size()) + 1;
+                pIdxInfo->aConstraintUsage[i].omit = op == SQLITE_INDEX_CONSTRAINT_EQ ? 1 : 0;
+                ops += op == SQLITE_INDEX_CONSTRAINT_EQ ? '=' :
+                       op == SQLITE_INDEX_CONSTRAINT_GT ? '>' :
+                       op == SQLITE_INDEX_CONSTRAINT_GE ? 'g' :
+                       op == SQLITE_INDEX_CONSTRAINT_LT ? '<' : 'l';
+            }
+            pIdxInfo->idxStr = sqlite3_mprintf("%s", ops.c_str());
+            pIdxInfo->needToFreeIdxStr = 1;
+            idxNum = 10 + (memoryColIdx << 8);
+            estimatedCost = memoryHasEq ? 5.0 : 40.0;  // In-memory probe, cheaper than the B-tree
+        }
+    }
+
+    // Rowid/_offset bounds cut a scan down to a slice of the record list,
+    // found by binary search. The slice may be wider than the constraints
+    // (fractional or non-numeric arguments), so SQLite re-checks them.
+    if (!recordConstraints.empty() && (idxNum & 0xFF) == 0) {
+        for (int i = 0; i < pIdxInfo->nConstraint; i++) {
+            pIdxInfo->aConstraintUsage[i].argvIndex = 0;
+            pIdxInfo->aConstraintUsage[i].omit = 0;
         }
+        std::string ops;
+        for (int i : recordConstraints) {
+            unsigned char op = pIdxInfo->aConstraint[i].op;
+            pIdxInfo->aConstraintUsage[i].argvIndex = static_cast<int>(ops.size() / 2) + 1;
+            ops += pIdxInfo->aConstraint[i].iColumn == offsetColumnIndex ? 'o' : 'r';
+            ops += op == SQLITE_INDEX_CONSTRAINT_EQ ? '=' :
+                   op == SQLITE_INDEX_CONSTRAINT_GT ? '>' :
+                   op == SQLITE_INDEX_CONSTRAINT_GE ? 'g' :
+                   op == SQLITE_INDEX_CONSTRAINT_LT ? '<' : 'l';
+        }
+        pIdxInfo->idxStr = sqlite3_mprintf("%s", ops.c_str());
+        pIdxInfo->needToFreeIdxStr = 1;
+        idxNum = 11;
+        estimatedCost = 30.0;  // Two binary searches, then only the slice
     }
 
     pIdxInfo->idxNum = idxNum;
@@ -279,8 +530,10 @@ int FlatBufferVTabModule::xBestIndex(sqlite3_vtab* pVTab, sqlite3_index_info* pI
             pIdxInfo->estimatedRows = vtab->store->getRecordCount();
         } else if (strategy == 1) {
             pIdxInfo->estimatedRows = 1;
-        } else if (strategy == 2) {
+        } else if (strategy == 2 || strategy == 9 || (strategy == 10 && memoryHasEq)) {
             pIdxInfo->estimatedRows = 10;  // Estimate for equality lookup
+        } else if (strategy >= 4) {
+            pIdxInfo->estimatedRows = vtab->store->getRecordCount() / 100;  // Estimate for prefix/spatial/in-memory range
         } else {
             pIdxInfo->estimatedRows = vtab->store->getRecordCount() / 10;  // Estimate for range
         }
@@ -304,6 +557,10 @@ int FlatBufferVTabModule::xOpen(sqlite3_vtab* pVTab, sqlite3_vtab_cursor** ppCur
     cursor->scanType = ScanType::FullScan;
     cursor->indexPosition = 0;
     cursor->scanPosition = 0;
+    cursor->scanBatchPos = 0;
+    cursor->scanBatchCount = 0;
+    cursor->scanLowSequence = 0;
+    cursor->scanHighSequence = UINT64_MAX;
     cursor->cacheValid = false;
     cursor->numRealColumns = static_cast<int>(vtab->tableDef->columns.size());
 
@@ -312,6 +569,7 @@ int FlatBufferVTabModule::xOpen(sqlite3_vtab* pVTab, sqlite3_vtab_cursor** ppCur
 
     // Cache the fast extractor to avoid vtab pointer chase in hot path
     cursor->cachedFastExtractor = vtab->fastExtractor;
+    cursor->vectorColumns = vtab->vectorColumns.empty() ? nullptr : vtab->vectorColumns.data();
 
     *ppCursor = cursor;
     return SQLITE_OK;
@@ -344,9 +602,195 @@ Value FlatBufferVTabModule::valueFromSqlite(sqlite3_value* val) {
     }
 }
 
+// Narrow an inclusive [low, high] key range by one rowid/_offset comparison
+// (op as in idxStr). Fractional arguments widen to the enclosing integers;
+// NULL matches nothing; other non-numeric arguments leave the range as is.
+static void applyRecordBound(char op, sqlite3_value* value, uint64_t& low, uint64_t& high) {
+    int type = sqlite3_value_numeric_type(value);
+    if (type == SQLITE_NULL) {
+        low = UINT64_MAX;
+        high = 0;
+        return;
+    }
+    if (type != SQLITE_INTEGER && type != SQLITE_FLOAT) return;
+
+    int64_t v;
+    if (type == SQLITE_INTEGER) {
+        v = sqlite3_value_int64(value);
+    } else {
+        double d = sqlite3_value_double(value);
+        if (d != d) {
+            low = UINT64_MAX;
+            high = 0;
+            return;
+        }
+        d = (op == '>' || op == 'g' || op == '=') ? std::floor(d) : std::ceil(d);
+        v = d >= 9.2e18 ? INT64_MAX : (d <= -9.2e18 ? INT64_MIN : static_cast<int64_t>(d));
+    }
+
+    bool hasLow = op == '=' || op == '>' || op == 'g';
+    bool hasHigh = op == '=' || op == '<' || op == 'l';
+    int64_t lowValue = v;
+    int64_t highValue = v;
+    if (op == '>') {
+        if (v == INT64_MAX) { low = UINT64_MAX; high = 0; return; }
+        lowValue = v + 1;
+    } else if (op == '<') {
+        if (v == INT64_MIN) { low = UINT64_MAX; high = 0; return; }
+        highValue = v - 1;
+    }
+    if (hasLow && lowValue > 0) {
+        low = std::max(low, static_cast<uint64_t>(lowValue));
+    }
+    if (hasHigh) {
+        if (highValue < 0) { low = UINT64_MAX; high = 0; return; }
+        high = std::min(high, static_cast<uint64_t>(highValue));
+    }
+}
+
+// Restrict a full scan to the records within the rowid/_offset bounds of
+// strategy 11. Offsets ascend through a record list, and so do sequences
+// unless reorganizeStorage() clustered the table by a key; each bound is
+// a binary search, or a rowid bound is checked per record.
+static void narrowRecordScan(FlatBufferCursor* cursor, const char* idxStr, int argc, sqlite3_value** argv) {
+    uint64_t lowSequence = 0, highSequence = UINT64_MAX;
+    uint64_t lowOffset = 0, highOffset = UINT64_MAX;
+    for (int i = 0; i < argc && idxStr && idxStr[2 * i] && idxStr[2 * i + 1]; i++) {
+        if (idxStr[2 * i] == 'o') {
+            applyRecordBound(idxStr[2 * i + 1], argv[i], lowOffset, highOffset);
+        } else {
+            applyRecordBound(idxStr[2 * i + 1], argv[i], lowSequence, highSequence);
+        }
+    }
+
+    using Info = StreamingFlatBufferStore::FileRecordInfo;
+    auto begin = cursor->scanRecordInfos->begin();
+    auto end = begin + static_cast<std::ptrdiff_t>(cursor->scanFileCount);
+    auto first = std::lower_bound(begin, end, lowOffset, [](const Info& r, uint64_t v) { return r.offset < v; });
+    auto last = std::upper_bound(begin, end, highOffset, [](uint64_t v, const Info& r) { return v < r.offset; });
+    if (cursor->vtab->store->isRecordListSequenceOrdered()) {
+        first = std::max(first,
+            std::lower_bound(begin, end, lowSequence, [](const Info& r, uint64_t v) { return r.sequence < v; }));
+        last = std::min(last,
+            std::upper_bound(begin, end, highSequence, [](uint64_t v, const Info& r) { return v < r.sequence; }));
+    } else {
+        cursor->scanLowSequence = lowSequence;
+        cursor->scanHighSequence = highSequence;
+    }
+    cursor->scanFileIndex = static_cast<size_t>(first - begin);
+    cursor->scanFileCount = static_cast<size_t>(std::max(first, last) - begin);
+}
+
+// Prefetch the vtable of a record whose header and root table were
+// prefetched earlier. Only reads within the record's bounds.
+static inline void prefetchVTable(const uint8_t* sizePrefixed) {
+    uint32_t length, root;
+    std::memcpy(&length, sizePrefixed, 4);
+    if (length < 8) return;
+    std::memcpy(&root, sizePrefixed + 4, 4);
+    if (root > length - 4) return;
+    int32_t vtableOffset;
+    std::memcpy(&vtableOffset, sizePrefixed + 4 + root, 4);
+    int64_t vtable = static_cast<int64_t>(root) - vtableOffset;
+    if (vtable >= 0 && vtable < static_cast<int64_t>(length)) {
+        __builtin_prefetch(sizePrefixed + 4 + vtable);
+    }
+}
+
+// Prefetch the root table of a record whose header was prefetched earlier
+static inline void prefetchRootTable(const uint8_t* sizePrefixed) {
+    uint32_t length, root;
+    std::memcpy(&length, sizePrefixed, 4);
+    if (length < 8) return;
+    std::memcpy(&root, sizePrefixed + 4, 4);
+    if (root < length) {
+        __builtin_prefetch(sizePrefixed + 4 + root);
+    }
+}
+
+// Resolve the next batch of live full scan rows into the cursor. Each of
+// the three dependent loads behind a field read (size prefix and root
+// offset, root table, vtable) is prefetched one batch before the load that
+// needs it, so records interleaved with other tables' records arrive in
+// cache by the time they are decoded.
+static void fillScanBatch(FlatBufferCursor* cursor) {
+    constexpr size_t batch = FlatBufferCursor::SCAN_BATCH;
+    cursor->scanBatchPos = 0;
+    cursor->scanBatchCount = 0;
+    if (cursor->scanFileIndex >= cursor->scanFileCount) return;
+    const auto& infos = *cursor->scanRecordInfos;
+    const uint8_t* base = cursor->scanDataBuffer;
+    size_t next = cursor->scanFileIndex;
+    size_t count = cursor->scanFileCount;
+
+    for (size_t i = next + batch, end = std::min(count, next + 2 * batch); i < end; i++) {
+        prefetchVTable(base + infos[i].offset);
+    }
+    for (size_t i = next + 2 * batch, end = std::min(count, next + 3 * batch); i < end; i++) {
+        prefetchRootTable(base + infos[i].offset);
+    }
+    for (size_t i = next + 3 * batch, end = std::min(count, next + 4 * batch); i < end; i++) {
+        __builtin_prefetch(base + infos[i].offset);
+    }
+
+    const auto* tombstones = cursor->hasTombstones ? cursor->vtab->tombstones : nullptr;
+    size_t filled = 0;
+    while (filled < batch && next < count) {
+        const auto& info = infos[next++];
+        if (info.sequence < cursor->scanLowSequence || info.sequence > cursor->scanHighSequence) continue;
+        if (tombstones && tombstones->count(info.sequence)) continue;
+        const uint8_t* ptr = base + info.offset;
+        RecordRef& row = cursor->scanBatch[filled++];
+        row.offset = info.offset;
+        row.sequence = info.sequence;
+        row.data = ptr + 4;  // Skip size prefix
+        row.length = static_cast<uint32_t>(ptr[0]) |
+                     (static_cast<uint32_t>(ptr[1]) << 8) |
+                     (static_cast<uint32_t>(ptr[2]) << 16) |
+                     (static_cast<uint32_t>(ptr[3]) << 24);
+    }
+    cursor->scanFileIndex = next;
+    cursor->scanBatchCount = filled;
+}
+
+// Move a full scan to its next live row, or to EOF
+static inline void stepFullScan(FlatBufferCursor* cursor) {
+    if (cursor->scanBatchPos == cursor->scanBatchCount) {
+        fillScanBatch(cursor);
+        if (cursor->scanBatchCount == 0) {
+            cursor->atEof = true;
+            return;
+        }
+    }
+    const RecordRef& row = cursor->scanBatch[cursor->scanBatchPos++];
+    cursor->currentOffset = row.offset;
+    cursor->currentSequence = row.sequence;
+    cursor->currentData = row.data;
+    cursor->currentLength = row.length;
+}
+
+// Move to the next live entry of an index cursor scan, or to EOF
+static void stepIndexCursor(FlatBufferCursor* cursor) {
+    FlatBufferVTab* vtab = cursor->vtab;
+    uint64_t offset = 0;
+    uint64_t sequence = 0;
+    while (cursor->indexCursor.next(offset, sequence)) {
+        if (cursor->hasTombstones && vtab->tombstones->count(sequence)) continue;
+        uint32_t len = 0;
+        const uint8_t* data = vtab->store->getDataAtOffset(offset, &len);
+        if (!data) break;
+        cursor->currentOffset = offset;
+        cursor->currentSequence = sequence;
+        cursor->currentData = data;
+        cursor->currentLength = len;
+        return;
+    }
+    cursor->atEof = true;
+}
+
 int FlatBufferVTabModule::xFilter(sqlite3_vtab_cursor* pCursor, int idxNum, const char* idxStr,
                                    int argc, sqlite3_value** argv) {
-    (void)idxStr;  // No longer used - column index encoded in idxNum
+    // Column index is encoded in idxNum; idxStr only carries in-memory index ops
     FlatBufferCursor* cursor = static_cast<FlatBufferCursor*>(pCursor);
     FlatBufferVTab* vtab = cursor->vtab;
 
@@ -354,6 +798,7 @@ int FlatBufferVTabModule::xFilter(sqlite3_vtab_cursor* pCursor, int idxNum, cons
     cursor->atEof = false;
     cursor->indexResults.clear();
     cursor->indexPosition = 0;
+    cursor->indexCursor.close();
     cursor->scanRefs.clear();
     cursor->scanPosition = 0;
     cursor->currentData = nullptr;
@@ -365,6 +810,7 @@ int FlatBufferVTabModule::xFilter(sqlite3_vtab_cursor* pCursor, int idxNum, cons
         return SQLITE_OK;
     }
 
+    cursor->hasTombstones = vtab->tombstones && !vtab->tombstones->empty();
     int argIdx = 0;
 
     // Decode idxNum: low byte = strategy, high bytes = column index
@@ -372,8 +818,10 @@ int FlatBufferVTabModule::xFilter(sqlite3_vtab_cursor* pCursor, int idxNum, cons
     int colIdx = idxNum >> 8;
 
     switch (strategy) {
-        case 0: {
-            // Full scan - use indexed iteration with cached vector and buffer pointers
+        case 0:
+        case 11: {
+            // Full scan - use indexed iteration with cached vector and buffer pointers.
+            // A rowid/_offset range scans only its slice of the records.
             cursor->scanType = ScanType::FullScan;
             cursor->useLazyScan = false;
             cursor->scanFileIndex = 0;
@@ -385,31 +833,16 @@ int FlatBufferVTabModule::xFilter(sqlite3_vtab_cursor* pCursor, int idxNum, cons
             }
             cursor->scanFileCount = cursor->scanRecordInfos ? cursor->scanRecordInfos->size() : 0;
             cursor->scanDataBuffer = vtab->store->getDataBuffer();
-            cursor->hasTombstones = vtab->tombstones && !vtab->tombstones->empty();
-
-            // Find first non-tombstoned record
-            while (cursor->scanFileIndex < cursor->scanFileCount) {
-                const auto& info = (*cursor->scanRecordInfos)[cursor->scanFileIndex];
-                // Check tombstone
-                if (!vtab->tombstones || !vtab->tombstones->count(info.sequence)) {
-                    // Inline data access - read size prefix and compute pointer
-                    const uint8_t* ptr = cursor->scanDataBuffer + info.offset;
-                    uint32_t len = static_cast<uint32_t>(ptr[0]) |
-                                   (static_cast<uint32_t>(ptr[1]) << 8) |
-                                   (static_cast<uint32_t>(ptr[2]) << 16) |
-                                   (static_cast<uint32_t>(ptr[3]) << 24);
-                    cursor->currentOffset = info.offset;
-                    cursor->currentSequence = info.sequence;
-                    cursor->currentData = ptr + 4;  // Skip size prefix
-                    cursor->currentLength = len;
-                    break;
-                }
-                cursor->scanFileIndex++;
+            cursor->scanLowSequence = 0;
+            cursor->scanHighSequence = UINT64_MAX;
+            if (strategy == 11 && cursor->scanRecordInfos) {
+                narrowRecordScan(cursor, idxStr, argc, argv);
             }
 
-            if (cursor->scanFileIndex >= cursor->scanFileCount) {
-                cursor->atEof = true;
-            }
+            // Find first non-tombstoned record
+            cursor->scanBatchPos = 0;
+            cursor->scanBatchCount = 0;
+            stepFullScan(cursor);
             break;
         }
 
@@ -492,44 +925,16 @@ int FlatBufferVTabModule::xFilter(sqlite3_vtab_cursor* pCursor, int idxNum, cons
                     cursor->atEof = true;
                 }
             } else {
-                // Non-unique index OR primary key with tombstone: search for all matches
-                cursor->scanType = ScanType::IndexEquality;
-                cursor->indexResults = indexIt->second->search(searchValue);
-
-                // Filter out tombstoned entries if needed
-                if (vtab->tombstones && !vtab->tombstones->empty()) {
-                    std::vector<IndexEntry> filtered;
-                    for (const auto& entry : cursor->indexResults) {
-                        if (!vtab->tombstones->count(entry.sequence)) {
-                            filtered.push_back(entry);
-                        }
-                    }
-                    cursor->indexResults = std::move(filtered);
-                }
-
-                cursor->indexPosition = 0;
-                if (cursor->indexResults.empty()) {
-                    cursor->atEof = true;
-                } else {
-                    const IndexEntry& entry = cursor->indexResults[0];
-                    uint32_t len = 0;
-                    const uint8_t* data = vtab->store->getDataAtOffset(entry.dataOffset, &len);
-                    if (data) {
-                        cursor->currentOffset = entry.dataOffset;
-                        cursor->currentSequence = entry.sequence;
-                        cursor->currentData = data;
-                        cursor->currentLength = len;
-                    } else {
-                        cursor->atEof = true;
-                    }
-                }
+                // Non-unique index OR primary key with tombstone: walk all matches
+                cursor->scanType = ScanType::IndexStream;
+                indexIt->second->openSearch(searchValue, cursor->indexCursor);
+                stepIndexCursor(cursor);
             }
             break;
         }
 
         case 3: {
-            // Index range query
-            cursor->scanType = ScanType::IndexRange;
+            // Index range query: walks the whole index, SQLite re-checks the bounds
             if (colIdx < 0 || colIdx >= static_cast<int>(vtab->tableDef->columns.size())) {
                 cursor->atEof = true;
                 return SQLITE_OK;
@@ -544,10 +949,111 @@ int FlatBufferVTabModule::xFilter(sqlite3_vtab_cursor* pCursor, int idxNum, cons
                 return SQLITE_OK;
             }
 
-            cursor->indexResults = indexIt->second->all();
+            cursor->scanType = ScanType::IndexStream;
+            indexIt->second->openAll(cursor->indexCursor);
+            stepIndexCursor(cursor);
+            break;
+        }
+
+        case 4:
+        case 5: {
+            // Anchored LIKE (4) / GLOB (5) - probe the key range sharing the literal
+            // prefix. SQLite still evaluates the pattern on every row we return.
+            if (argc < 1 || colIdx < 0 || colIdx >= static_cast<int>(vtab->tableDef->columns.size())) {
+                cursor->atEof = true;
+                return SQLITE_OK;
+            }
+
+            // A radix index on the column answers the probe ahead of the B-tree
+            const std::string& colName = vtab->tableDef->columns[colIdx].name;
+            auto indexIt = vtab->indexes.find(colName);
+            auto radixIt = vtab->radixIndexes.find(colName);
+            RadixIndex* radix = radixIt != vtab->radixIndexes.end() ? radixIt->second : nullptr;
+            SqliteIndex* index = indexIt != vtab->indexes.end() ? indexIt->second : nullptr;
+            if (!radix && !index) {
+                cursor->atEof = true;
+                return SQLITE_OK;
+            }
+            auto probe = [&](const std::string& low, const std::string& highPrefix) {
+                if (radix) {
+                    radix->openPrefixRange(low, highPrefix, cursor->indexCursor);
+                } else {
+                    index->openPrefixRange(low, highPrefix, cursor->indexCursor);
+                }
+            };
+
+            // x LIKE NULL is never true
+            if (sqlite3_value_type(argv[argIdx]) == SQLITE_NULL) {
+                cursor->atEof = true;
+                return SQLITE_OK;
+            }
+
+            const char* pattern = reinterpret_cast<const char*>(sqlite3_value_text(argv[argIdx]));
+            std::string prefix = literalPatternPrefix(pattern, strategy == 5);
+            if (prefix.empty()) {
+                // Bound pattern turned out to start with a wildcard
+                return xFilter(pCursor, 0, idxStr, 0, nullptr);
+            }
+
+            cursor->scanType = ScanType::IndexStream;
+            cursor->constraintColumn = colName;
+
+            if (strategy == 5) {
+                probe(prefix, prefix);
+            } else {
+                // LIKE folds ASCII case: every variant of the prefix sorts between
+                // its all-upper and all-lower spellings
+                std::string upper = prefix;
+                std::string lower = prefix;
+                for (size_t i = 0; i < prefix.size(); i++) {
+                    char c = prefix[i];
+                    if (c >= 'a' && c <= 'z') upper[i] = static_cast<char>(c - 'a' + 'A');
+                    if (c >= 'A' && c <= 'Z') lower[i] = static_cast<char>(c - 'A' + 'a');
+                }
+                probe(upper, lower);
+            }
+            stepIndexCursor(cursor);
+            break;
+        }
+
+        case 6:
+        case 7:
+        case 8: {
+            // Spatial radius (6) / box (7) / polygon (8) search on the R*Tree
+            if (argc < 1 || !vtab->spatialIndex) {
+                cursor->atEof = true;
+                return SQLITE_OK;
+            }
+
+            // Malformed or NULL shapes make the predicate NULL, i.e. no rows
+            if (strategy == 6) {
+                GeoCircle circle;
+                if (!geoCircleFromValue(argv[argIdx], circle)) {
+                    cursor->atEof = true;
+                    return SQLITE_OK;
+                }
+                cursor->indexResults = vtab->spatialIndex->searchRadius(circle.lat, circle.lon,
+                                                                         circle.radiusKm);
+            } else if (strategy == 7) {
+                GeoBox box;
+                if (!geoBoxFromValue(argv[argIdx], box)) {
+                    cursor->atEof = true;
+                    return SQLITE_OK;
+                }
+                cursor->indexResults = vtab->spatialIndex->searchBox(box.minLat, box.maxLat,
+                                                                      box.minLon, box.maxLon);
+            } else {
+                std::unique_ptr<GeoPolygon> polygon = GeoPolygon::fromValue(argv[argIdx]);
+                if (!polygon) {
+                    cursor->atEof = true;
+                    return SQLITE_OK;
+                }
+                cursor->indexResults = vtab->spatialIndex->searchPolygon(*polygon);
+            }
+            cursor->scanType = ScanType::IndexRange;
 
             // Filter out tombstoned entries
-            if (vtab->tombstones) {
+            if (vtab->tombstones && !vtab->tombstones->empty()) {
                 std::vector<IndexEntry> filtered;
                 filtered.reserve(cursor->indexResults.size());
                 for (const auto& entry : cursor->indexResults) {
@@ -577,6 +1083,77 @@ int FlatBufferVTabModule::xFilter(sqlite3_vtab_cursor* pCursor, int idxNum, cons
             break;
         }
 
+        case 9: {
+            // Records whose vector column contains the value
+            if (argc < 1 || colIdx < 0 || colIdx >= static_cast<int>(vtab->tableDef->columns.size())) {
+                cursor->atEof = true;
+                return SQLITE_OK;
+            }
+            const ColumnDef& col = vtab->tableDef->columns[colIdx];
+            auto indexIt = vtab->indexes.find(col.name + "[]");
+            if (indexIt == vtab->indexes.end() || !indexIt->second) {
+                cursor->atEof = true;
+                return SQLITE_OK;
+            }
+
+            // Same matching as array_contains: strings only equal strings and
+            // numbers only numbers (the index would coerce '5' to 5)
+            int needleType = sqlite3_value_type(argv[argIdx]);
+            bool stringElements = col.elementType == ValueType::String;
+            if (needleType == SQLITE_NULL || needleType == SQLITE_BLOB ||
+                (needleType == SQLITE_TEXT) != stringElements) {
+                cursor->atEof = true;
+                return SQLITE_OK;
+            }
+
+            cursor->scanType = ScanType::IndexStream;
+            indexIt->second->openSearch(valueFromSqlite(argv[argIdx]), cursor->indexCursor);
+            stepIndexCursor(cursor);
+            break;
+        }
+
+        case 10: {
+            // In-memory index lookup: every argument narrows the key range
+            if (colIdx < 0 || colIdx >= static_cast<int>(vtab->tableDef->columns.size()) || !idxStr ||
+                static_cast<int>(strlen(idxStr)) != argc) {
+                cursor->atEof = true;
+                return SQLITE_OK;
+            }
+            const std::string& colName = vtab->tableDef->columns[colIdx].name;
+            auto learnedIt = vtab->learnedIndexes.find(colName);
+            auto radixIt = vtab->radixIndexes.find(colName);
+            LearnedIndex* learned = learnedIt != vtab->learnedIndexes.end() ? learnedIt->second : nullptr;
+            RadixIndex* radix = radixIt != vtab->radixIndexes.end() ? radixIt->second : nullptr;
+            if (!learned && !radix) {
+                cursor->atEof = true;
+                return SQLITE_OK;
+            }
+
+            std::vector<std::pair<KeyOp, Value>> constraints;
+            constraints.reserve(argc);
+            for (int i = 0; i < argc; i++) {
+                KeyOp op;
+                switch (idxStr[i]) {
+                    case '=': op = KeyOp::Eq; break;
+                    case '>': op = KeyOp::Gt; break;
+                    case 'g': op = KeyOp::Ge; break;
+                    case '<': op = KeyOp::Lt; break;
+                    default:  op = KeyOp::Le; break;
+                }
+                constraints.emplace_back(op, valueFromSqlite(argv[i]));
+            }
+
+            cursor->scanType = ScanType::IndexStream;
+            cursor->constraintColumn = colName;
+            if (learned) {
+                learned->openQuery(constraints, cursor->indexCursor);
+            } else {
+                radix->openQuery(constraints, cursor->indexCursor);
+            }
+            stepIndexCursor(cursor);
+            break;
+        }
+
         default:
             cursor->atEof = true;
             break;
@@ -592,50 +1169,11 @@ int FlatBufferVTabModule::xNext(sqlite3_vtab_cursor* pCursor) {
     cursor->cacheValid = false;
 
     switch (cursor->scanType) {
-        case ScanType::FullScan: {
-            // Use indexed iteration with inlined buffer access
-            cursor->scanFileIndex++;
-
-            // Fast path: no tombstones (common case, cached check)
-            if (__builtin_expect(!cursor->hasTombstones, 1)) {
-                if (__builtin_expect(cursor->scanFileIndex < cursor->scanFileCount, 1)) {
-                    const auto& info = (*cursor->scanRecordInfos)[cursor->scanFileIndex];
-                    const uint8_t* ptr = cursor->scanDataBuffer + info.offset;
-                    uint32_t len = static_cast<uint32_t>(ptr[0]) |
-                                   (static_cast<uint32_t>(ptr[1]) << 8) |
-                                   (static_cast<uint32_t>(ptr[2]) << 16) |
-                                   (static_cast<uint32_t>(ptr[3]) << 24);
-                    cursor->currentOffset = info.offset;
-                    cursor->currentSequence = info.sequence;
-                    cursor->currentData = ptr + 4;
-                    cursor->currentLength = len;
-                    return SQLITE_OK;
-                }
-                cursor->atEof = true;
-                return SQLITE_OK;
-            }
-
-            // Slow path: has tombstones, need to check each record
-            while (cursor->scanFileIndex < cursor->scanFileCount) {
-                const auto& info = (*cursor->scanRecordInfos)[cursor->scanFileIndex];
-                if (!cursor->vtab->tombstones->count(info.sequence)) {
-                    const uint8_t* ptr = cursor->scanDataBuffer + info.offset;
-                    uint32_t len = static_cast<uint32_t>(ptr[0]) |
-                                   (static_cast<uint32_t>(ptr[1]) << 8) |
-                                   (static_cast<uint32_t>(ptr[2]) << 16) |
-                                   (static_cast<uint32_t>(ptr[3]) << 24);
-                    cursor->currentOffset = info.offset;
-                    cursor->currentSequence = info.sequence;
-                    cursor->currentData = ptr + 4;
-                    cursor->currentLength = len;
-                    return SQLITE_OK;
-                }
-                cursor->scanFileIndex++;
-            }
-
-            cursor->atEof = true;
+        case ScanType::FullScan:
+            // Rows come from the cursor's batch, refilled every SCAN_BATCH rows
+            stepFullScan(cursor);
             break;
-        }
+
 
         case ScanType::RowidLookup:
         case ScanType::IndexSingleLookup:
@@ -643,7 +1181,10 @@ int FlatBufferVTabModule::xNext(sqlite3_vtab_cursor* pCursor) {
             cursor->atEof = true;
             break;
 
-        case ScanType::IndexEquality:
+        case ScanType::IndexStream:
+            stepIndexCursor(cursor);
+            break;
+
         case ScanType::IndexRange: {
             cursor->indexPosition++;
             if (cursor->indexPosition >= cursor->indexResults.size()) {
@@ -732,6 +1273,20 @@ void FlatBufferVTabModule::setResultFromValue(sqlite3_context* ctx, const Value&
 int FlatBufferVTabModule::xColumn(sqlite3_vtab_cursor* pCursor, sqlite3_context* ctx, int N) {
     FlatBufferCursor* cursor = static_cast<FlatBufferCursor*>(pCursor);
 
+    // Vector columns are decoded from the buffer in place
+    if (__builtin_expect(cursor->vectorColumns != nullptr, 0) && N >= 0 &&
+        N < cursor->numRealColumns && cursor->vectorColumns[N] && cursor->currentData) {
+        const ColumnDef& col = cursor->vtab->tableDef->columns[N];
+        FbVectorView vector;
+        if (vector.open(cursor->currentData, cursor->currentLength, col.fieldId, col.elementType)) {
+            std::string json = vector.toJson();
+            sqlite3_result_text(ctx, json.data(), static_cast<int>(json.size()), SQLITE_TRANSIENT);
+        } else {
+            sqlite3_result_null(ctx);
+        }
+        return SQLITE_OK;
+    }
+
     // Fast path: regular column with fast extractor (most common case)
     // Skip fast path when encryption is active - must go through cache for decryption
     if (N >= 0 && N < cursor->numRealColumns && cursor->currentData
@@ -766,6 +1321,21 @@ int FlatBufferVTabModule::xColumn(sqlite3_vtab_cursor* pCursor, sqlite3_context*
         }
         return SQLITE_OK;
     }
+    if (N == vtab->geoColumnIndex) {
+        // Point blob built from the spatial index's lat/lon columns
+        double lat, lon;
+        if (vtab->spatialIndex && vtab->extractor && cursor->currentData) {
+            fillColumnCache(cursor);
+            if (SpatialIndex::toDouble(cursor->columnCache[vtab->geoLatColumn], lat) &&
+                SpatialIndex::toDouble(cursor->columnCache[vtab->geoLonColumn], lon)) {
+                GeoPoint point{lat, lon};
+                sqlite3_result_blob(ctx, &point, sizeof(point), SQLITE_TRANSIENT);
+                return SQLITE_OK;
+            }
+        }
+        sqlite3_result_null(ctx);
+        return SQLITE_OK;
+    }
 
     if (N < 0 || N >= numRealColumns || !cursor->currentData) {
         sqlite3_result_null(ctx);
@@ -778,28 +1348,33 @@ int FlatBufferVTabModule::xColumn(sqlite3_vtab_cursor* pCursor, sqlite3_context*
         return SQLITE_OK;
     }
 
-    if (!cursor->cacheValid) {
-        for (int i = 0; i < numRealColumns; i++) {
-            cursor->columnCache[i] = vtab->extractor(cursor->currentData, cursor->currentLength,
-                                                      vtab->tableDef->columns[i].name);
-        }
+    fillColumnCache(cursor);
+    setResultFromValue(ctx, cursor->columnCache[N]);
+    return SQLITE_OK;
+}
 
-        // Decrypt encrypted columns if encryption context is present
-        if (vtab->encryptionCtx) {
-            for (int i = 0; i < numRealColumns; i++) {
-                if (vtab->tableDef->columns[i].encrypted) {
-                    decryptColumnValue(cursor->columnCache[i],
-                                       *vtab->encryptionCtx,
-                                       vtab->tableDef->columns[i].fieldId);
-                }
+void FlatBufferVTabModule::fillColumnCache(FlatBufferCursor* cursor) {
+    if (cursor->cacheValid) return;
+
+    FlatBufferVTab* vtab = cursor->vtab;
+    int numRealColumns = cursor->numRealColumns;
+    for (int i = 0; i < numRealColumns; i++) {
+        cursor->columnCache[i] = vtab->extractor(cursor->currentData, cursor->currentLength,
+                                                  vtab->tableDef->columns[i].name);
+    }
+
+    // Decrypt encrypted columns if encryption context is present
+    if (vtab->encryptionCtx) {
+        for (int i = 0; i < numRealColumns; i++) {
+            if (vtab->tableDef->columns[i].encrypted) {
+                decryptColumnValue(cursor->columnCache[i],
+                                   *vtab->encryptionCtx,
+                                   vtab->tableDef->columns[i].fieldId);
             }
         }
-
-        cursor->cacheValid = true;
     }
 
-    setResultFromValue(ctx, cursor->columnCache[N]);
-    return SQLITE_OK;
+    cursor->cacheValid = true;
 }
 
 int FlatBufferVTabModule::xRowid(sqlite3_vtab_cursor* pCursor, sqlite3_int64* pRowid) {
@@ -808,4 +1383,37 @@ int FlatBufferVTabModule::xRowid(sqlite3_vtab_cursor* pCursor, sqlite3_int64* pR
     return SQLITE_OK;
 }
 
+int FlatBufferVTabModule::xFindFunction(sqlite3_vtab* pVTab, int nArg, const char* zName,
+                                        void (**pxFunc)(sqlite3_context*, int, sqlite3_value**),
+                                        void** ppArg) {
+    FlatBufferVTab* vtab = static_cast<FlatBufferVTab*>(pVTab);
+    if (nArg != 2 || !zName) return 0;
+
+    // Returning a constraint op lets xBestIndex see the call as a constraint
+    // on its first argument (a vector column, or the _geo column)
+    if (sqlite3_stricmp(zName, "array_contains") == 0) {
+        *pxFunc = arrayContainsFunc;
+        *ppArg = nullptr;
+        return SQLITE_INDEX_CONSTRAINT_FUNCTION + 3;
+    }
+    if (!vtab->spatialIndex) return 0;
+
+    if (sqlite3_stricmp(zName, "geo_within_radius") == 0) {
+        *pxFunc = geoWithinRadiusPointFunc;
+        *ppArg = nullptr;
+        return SQLITE_INDEX_CONSTRAINT_FUNCTION;
+    }
+    if (sqlite3_stricmp(zName, "geo_bbox_contains") == 0) {
+        *pxFunc = geoBboxContainsPointFunc;
+        *ppArg = nullptr;
+        return SQLITE_INDEX_CONSTRAINT_FUNCTION + 1;
+    }
+    if (sqlite3_stricmp(zName, "geo_contains") == 0) {
+        *pxFunc = geoContainsPointFunc;
+        *ppArg = nullptr;
+        return SQLITE_INDEX_CONSTRAINT_FUNCTION + 2;
+    }
+    return 0;
+}
+
 }  // namespace flatsql
@@ -1,10 +1,25 @@
 #include "flatsql/storage.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <cstring>
+#include <new>
 #include <stdexcept>
+#include <unordered_set>
+
+#if defined(__linux__) && !defined(__EMSCRIPTEN__)
+#define FLATSQL_HAVE_MMAP 1
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#if defined(__aarch64__) && defined(__ARM_FEATURE_CRC32)
+#include <arm_acle.h>
+#endif
 
 namespace flatsql {
 
-// CRC32 implementation (IEEE polynomial) - kept for potential future use
+// CRC32 implementation (IEEE polynomial)
 static uint32_t computeCRC32(const uint8_t* data, size_t length) {
     uint32_t crc = 0xFFFFFFFF;
     for (size_t i = 0; i < length; i++) {
@@ -39,12 +54,278 @@ static inline uint32_t readLE32(const uint8_t* src) {
            (static_cast<uint32_t>(src[3]) << 24);
 }
 
+// CRC32C (Castagnoli polynomial, reflected). Uses the SSE4.2 or ARMv8 CRC
+// instructions when available, slicing-by-8 tables otherwise.
+static const std::array<std::array<uint32_t, 256>, 8>& crc32cTables() {
+    static const auto tables = [] {
+        std::array<std::array<uint32_t, 256>, 8> t{};
+        for (uint32_t i = 0; i < 256; i++) {
+            uint32_t crc = i;
+            for (int j = 0; j < 8; j++) {
+                crc = (crc >> 1) ^ (0x82F63B78 & -(crc & 1));
+            }
+            t[0][i] = crc;
+        }
+        // t[k][i]: CRC of byte i followed by k zero bytes
+        for (uint32_t i = 0; i < 256; i++) {
+            for (int k = 1; k < 8; k++) {
+                t[k][i] = (t[k - 1][i] >> 8) ^ t[0][t[k - 1][i] & 0xFF];
+            }
+        }
+        return t;
+    }();
+    return tables;
+}
+
+static uint32_t crc32cSoftware(const uint8_t* data, size_t length, uint32_t crc) {
+    const auto& t = crc32cTables();
+    while (length >= 8) {
+        uint32_t lo = crc ^ readLE32(data);
+        uint32_t hi = readLE32(data + 4);
+        crc = t[7][lo & 0xFF] ^ t[6][(lo >> 8) & 0xFF] ^ t[5][(lo >> 16) & 0xFF] ^ t[4][lo >> 24] ^
+              t[3][hi & 0xFF] ^ t[2][(hi >> 8) & 0xFF] ^ t[1][(hi >> 16) & 0xFF] ^ t[0][hi >> 24];
+        data += 8;
+        length -= 8;
+    }
+    while (length--) {
+        crc = t[0][(crc ^ *data++) & 0xFF] ^ (crc >> 8);
+    }
+    return crc;
+}
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+__attribute__((target("sse4.2")))
+static uint32_t crc32cHardware(const uint8_t* data, size_t length, uint32_t crc) {
+    uint64_t c = crc;
+    while (length >= 8) {
+        uint64_t word;
+        std::memcpy(&word, data, 8);
+        c = __builtin_ia32_crc32di(c, word);
+        data += 8;
+        length -= 8;
+    }
+    uint32_t c32 = static_cast<uint32_t>(c);
+    while (length--) {
+        c32 = __builtin_ia32_crc32qi(c32, *data++);
+    }
+    return c32;
+}
+
+static bool hasHardwareCrc32c() {
+    static const bool supported = __builtin_cpu_supports("sse4.2");
+    return supported;
+}
+#elif defined(__aarch64__) && defined(__ARM_FEATURE_CRC32)
+static uint32_t crc32cHardware(const uint8_t* data, size_t length, uint32_t crc) {
+    while (length >= 8) {
+        uint64_t word;
+        std::memcpy(&word, data, 8);
+        crc = __crc32cd(crc, word);
+        data += 8;
+        length -= 8;
+    }
+    while (length--) {
+        crc = __crc32cb(crc, *data++);
+    }
+    return crc;
+}
+
+static bool hasHardwareCrc32c() { return true; }
+#else
+static uint32_t crc32cHardware(const uint8_t* data, size_t length, uint32_t crc) {
+    return crc32cSoftware(data, length, crc);
+}
+
+static bool hasHardwareCrc32c() { return false; }
+#endif
+
+uint32_t crc32c(const uint8_t* data, size_t length, uint32_t crc) {
+    crc = ~crc;
+    crc = hasHardwareCrc32c() ? crc32cHardware(data, length, crc) : crc32cSoftware(data, length, crc);
+    return ~crc;
+}
+
+// ==================== Page Memory ====================
+
+static std::atomic<HugePages> hugePages{HugePages::Transparent};
+
+void setHugePages(HugePages mode) {
+    hugePages.store(mode, std::memory_order_relaxed);
+}
+
+HugePages getHugePages() {
+    return hugePages.load(std::memory_order_relaxed);
+}
+
+#ifdef FLATSQL_HAVE_MMAP
+static size_t roundToHugePages(size_t bytes) {
+    return (bytes + HUGE_PAGE_SIZE - 1) & ~(HUGE_PAGE_SIZE - 1);
+}
+
+static void* mapHugePages(size_t length, HugePages mode) {
+#ifdef MAP_HUGETLB
+    if (mode == HugePages::Explicit) {
+        int flags = MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB;
+#ifdef MAP_HUGE_SHIFT
+        flags |= 21 << MAP_HUGE_SHIFT;  // 2 MiB pages
+#endif
+        void* p = ::mmap(nullptr, length, PROT_READ | PROT_WRITE, flags, -1, 0);
+        if (p != MAP_FAILED) return p;
+    }
+#endif
+
+    // Map a huge page more and trim, so the buffer starts on a boundary
+    // the kernel can back with huge pages
+    void* raw = ::mmap(nullptr, length + HUGE_PAGE_SIZE, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (raw == MAP_FAILED) return nullptr;
+    uintptr_t start = reinterpret_cast<uintptr_t>(raw);
+    uintptr_t aligned = (start + HUGE_PAGE_SIZE - 1) & ~static_cast<uintptr_t>(HUGE_PAGE_SIZE - 1);
+    if (aligned > start) ::munmap(raw, aligned - start);
+    size_t tail = static_cast<size_t>(start + HUGE_PAGE_SIZE - aligned);
+    if (tail > 0) ::munmap(reinterpret_cast<void*>(aligned + length), tail);
+#ifdef MADV_HUGEPAGE
+    if (mode != HugePages::Off) {
+        ::madvise(reinterpret_cast<void*>(aligned), length, MADV_HUGEPAGE);  // Fails harmlessly without THP
+    }
+#endif
+    return reinterpret_cast<void*>(aligned);
+}
+#endif
+
+void* allocatePages(size_t bytes) {
+#ifdef FLATSQL_HAVE_MMAP
+    if (bytes >= HUGE_PAGE_SIZE) {
+        void* p = mapHugePages(roundToHugePages(bytes), getHugePages());
+        if (!p) throw std::bad_alloc();
+        return p;
+    }
+#endif
+    return ::operator new(bytes);
+}
+
+void freePages(void* pointer, size_t bytes) {
+#ifdef FLATSQL_HAVE_MMAP
+    if (bytes >= HUGE_PAGE_SIZE) {
+        ::munmap(pointer, roundToHugePages(bytes));
+        return;
+    }
+#endif
+    ::operator delete(pointer);
+}
+
+void advisePages(const void* data, size_t length, PageAccess access) {
+#ifdef FLATSQL_HAVE_MMAP
+    // Small ranges aren't worth a system call (or splitting the heap's mapping)
+    if (length < HUGE_PAGE_SIZE) return;
+    static const uintptr_t pageSize = static_cast<uintptr_t>(::sysconf(_SC_PAGESIZE));
+    uintptr_t start = reinterpret_cast<uintptr_t>(data) & ~(pageSize - 1);
+    uintptr_t end = reinterpret_cast<uintptr_t>(data) + length;
+    int advice = access == PageAccess::Sequential ? MADV_SEQUENTIAL
+               : access == PageAccess::WillNeed   ? MADV_WILLNEED
+                                                  : MADV_NORMAL;
+    ::madvise(reinterpret_cast<void*>(start), static_cast<size_t>(end - start), advice);
+#else
+    (void)data;
+    (void)length;
+    (void)access;
+#endif
+}
+
+// Marks a range of data_ for one front-to-back read, then back to normal.
+// Advice covers whole pages, so caller buffers (which may share pages with
+// other memory) are never advised.
+namespace {
+class SequentialRead {
+public:
+    SequentialRead(const void* data, size_t length) : data_(data), length_(length) {
+        advisePages(data_, length_, PageAccess::WillNeed);
+        advisePages(data_, length_, PageAccess::Sequential);
+    }
+    ~SequentialRead() { advisePages(data_, length_, PageAccess::Normal); }
+
+private:
+    const void* data_;
+    size_t length_;
+};
+}  // namespace
+
 // ==================== StreamingFlatBufferStore ====================
 
 StreamingFlatBufferStore::StreamingFlatBufferStore(size_t initialCapacity)
     : data_(initialCapacity) {
 }
 
+void StreamingFlatBufferStore::setRecordAlignment(size_t alignment) {
+    if (writeOffset_ > 0) {
+        throw std::runtime_error("Record alignment must be set before storing records");
+    }
+    if (alignment == 0 || (alignment & (alignment - 1)) != 0 || alignment > MAX_RECORD_ALIGNMENT) {
+        throw std::runtime_error("Unsupported record alignment: " + std::to_string(alignment));
+    }
+    alignment_ = alignment;
+}
+
+void StreamingFlatBufferStore::setClustered(const std::string& fileId, size_t segmentBytes) {
+    if (segmentBytes < SIZE_PREFIX_LENGTH || segmentBytes > PADDING_FRAME_FLAG) {
+        throw std::runtime_error("Unsupported segment size: " + std::to_string(segmentBytes));
+    }
+    clusters_[fileId].bytes = segmentBytes;
+    sequential_ = false;
+}
+
+size_t StreamingFlatBufferStore::paddingBefore(uint64_t offset) const {
+    if (alignment_ <= 1) return 0;
+    // The FlatBuffer follows the size prefix, and a padding frame needs a
+    // prefix of its own
+    size_t gap = (alignment_ - (offset + SIZE_PREFIX_LENGTH) % alignment_) % alignment_;
+    while (gap > 0 && gap < SIZE_PREFIX_LENGTH) {
+        gap += alignment_;
+    }
+    return gap;
+}
+
+void StreamingFlatBufferStore::writePadding(uint64_t offset, size_t bytes) {
+    if (bytes == 0) return;
+    writeLE32(&data_[offset], PADDING_FRAME_FLAG | static_cast<uint32_t>(bytes - SIZE_PREFIX_LENGTH));
+    std::memset(&data_[offset + SIZE_PREFIX_LENGTH], 0, bytes - SIZE_PREFIX_LENGTH);
+}
+
+uint64_t StreamingFlatBufferStore::placeRecord(const std::string& fileId, size_t frameBytes) {
+    auto cluster = clusters_.find(fileId);
+    if (cluster == clusters_.end()) {
+        size_t gap = paddingBefore(writeOffset_);
+        ensureCapacity(gap + frameBytes);
+        writePadding(writeOffset_, gap);
+        uint64_t offset = writeOffset_ + gap;
+        writeOffset_ = offset + frameBytes;
+        return offset;
+    }
+
+    // A segment's tail must stay empty or hold a padding frame
+    Segment& segment = cluster->second;
+    auto fits = [&](uint64_t next, uint64_t end, size_t need) {
+        return next + need <= end && (end - next - need == 0 || end - next - need >= SIZE_PREFIX_LENGTH);
+    };
+    size_t gap = paddingBefore(segment.next);
+    if (!fits(segment.next, segment.end, gap + frameBytes)) {
+        gap = paddingBefore(writeOffset_);
+        size_t bytes = std::max(segment.bytes, gap + frameBytes);
+        if (!fits(writeOffset_, writeOffset_ + bytes, gap + frameBytes)) {
+            bytes = gap + frameBytes;
+        }
+        ensureCapacity(bytes);
+        segment.next = writeOffset_;
+        segment.end = writeOffset_ + bytes;
+        writeOffset_ = segment.end;
+    }
+    writePadding(segment.next, gap);
+    uint64_t offset = segment.next + gap;
+    segment.next = offset + frameBytes;
+    writePadding(segment.next, static_cast<size_t>(segment.end - segment.next));
+    return offset;
+}
+
 void StreamingFlatBufferStore::ensureCapacity(size_t needed) {
     size_t totalNeeded = static_cast<size_t>(writeOffset_) + needed;
     if (totalNeeded <= data_.size()) return;
@@ -73,27 +354,32 @@ size_t StreamingFlatBufferStore::ingest(const uint8_t* data, size_t length, Inge
         // Read size prefix
         uint32_t fbSize = readLE32(data + offset);
 
+        // Padding from an aligned stream; this store places its own
+        if (fbSize & PADDING_FRAME_FLAG) {
+            if (offset + frameLength(fbSize) > length) {
+                break;
+            }
+            offset += frameLength(fbSize);
+            continue;
+        }
+
         // Check if we have the complete FlatBuffer
         if (offset + SIZE_PREFIX_LENGTH + fbSize > length) {
             break;  // Incomplete, wait for more data
         }
 
         const uint8_t* fbData = data + offset + SIZE_PREFIX_LENGTH;
+        std::string fileId = extractFileId(fbData, fbSize);
 
         // Store with size prefix
-        uint64_t storeOffset = writeOffset_;
-        ensureCapacity(SIZE_PREFIX_LENGTH + fbSize);
-        std::memcpy(&data_[writeOffset_], data + offset, SIZE_PREFIX_LENGTH + fbSize);
-        writeOffset_ += SIZE_PREFIX_LENGTH + fbSize;
+        uint64_t storeOffset = placeRecord(fileId, SIZE_PREFIX_LENGTH + fbSize);
+        std::memcpy(&data_[storeOffset], data + offset, SIZE_PREFIX_LENGTH + fbSize);
 
         // Assign sequence and index
         uint64_t seq = nextSequence_++;
         sequenceToOffset_[seq] = storeOffset;
         offsetToSequence_[storeOffset] = seq;
         recordCount_++;
-
-        // Extract file identifier and build file ID index
-        std::string fileId = extractFileId(fbData, fbSize);
         indexRecord(fileId, storeOffset);
 
         if (callback) {
@@ -122,12 +408,11 @@ uint64_t StreamingFlatBufferStore::ingestOne(const uint8_t* sizePrefixedData, si
     }
 
     const uint8_t* fbData = sizePrefixedData + SIZE_PREFIX_LENGTH;
+    std::string fileId = extractFileId(fbData, fbSize);
 
     // Store
-    uint64_t storeOffset = writeOffset_;
-    ensureCapacity(SIZE_PREFIX_LENGTH + fbSize);
-    std::memcpy(&data_[writeOffset_], sizePrefixedData, SIZE_PREFIX_LENGTH + fbSize);
-    writeOffset_ += SIZE_PREFIX_LENGTH + fbSize;
+    uint64_t storeOffset = placeRecord(fileId, SIZE_PREFIX_LENGTH + fbSize);
+    std::memcpy(&data_[storeOffset], sizePrefixedData, SIZE_PREFIX_LENGTH + fbSize);
 
     // Assign sequence
     uint64_t seq = nextSequence_++;
@@ -136,7 +421,6 @@ uint64_t StreamingFlatBufferStore::ingestOne(const uint8_t* sizePrefixedData, si
     recordCount_++;
 
     // Build file ID index
-    std::string fileId = extractFileId(fbData, fbSize);
     indexRecord(fileId, storeOffset);
 
     if (callback) {
@@ -149,14 +433,10 @@ uint64_t StreamingFlatBufferStore::ingestOne(const uint8_t* sizePrefixedData, si
 uint64_t StreamingFlatBufferStore::ingestFlatBuffer(const uint8_t* data, size_t length,
                                                      IngestCallback callback) {
     // Store with size prefix
-    uint64_t storeOffset = writeOffset_;
-    ensureCapacity(SIZE_PREFIX_LENGTH + length);
-
-    writeLE32(&data_[writeOffset_], static_cast<uint32_t>(length));
-    writeOffset_ += SIZE_PREFIX_LENGTH;
-
-    std::memcpy(&data_[writeOffset_], data, length);
-    writeOffset_ += length;
+    std::string fileId = extractFileId(data, length);
+    uint64_t storeOffset = placeRecord(fileId, SIZE_PREFIX_LENGTH + length);
+    writeLE32(&data_[storeOffset], static_cast<uint32_t>(length));
+    std::memcpy(&data_[storeOffset + SIZE_PREFIX_LENGTH], data, length);
 
     // Assign sequence
     uint64_t seq = nextSequence_++;
@@ -165,7 +445,6 @@ uint64_t StreamingFlatBufferStore::ingestFlatBuffer(const uint8_t* data, size_t
     recordCount_++;
 
     // Build file ID index
-    std::string fileId = extractFileId(data, length);
     indexRecord(fileId, storeOffset);
 
     if (callback) {
@@ -177,6 +456,23 @@ uint64_t StreamingFlatBufferStore::ingestFlatBuffer(const uint8_t* data, size_t
 
 void StreamingFlatBufferStore::loadAndRebuild(const uint8_t* data, size_t length,
                                                IngestCallback callback) {
+    // Records of clustered file IDs, and records that don't already start
+    // on this store's boundaries, are placed one at a time
+    if (!clusters_.empty()) {
+        ingest(data, length, callback);
+        return;
+    }
+    if (alignment_ > 1) {
+        for (size_t offset = 0; offset + SIZE_PREFIX_LENGTH <= length;) {
+            uint32_t fbSize = readLE32(data + offset);
+            if (!(fbSize & PADDING_FRAME_FLAG) && (offset + SIZE_PREFIX_LENGTH) % alignment_ != 0) {
+                ingest(data, length, callback);
+                return;
+            }
+            offset += frameLength(fbSize);
+        }
+    }
+
     // Copy all data
     ensureCapacity(length);
     std::memcpy(data_.data(), data, length);
@@ -186,9 +482,13 @@ void StreamingFlatBufferStore::loadAndRebuild(const uint8_t* data, size_t length
     while (offset + SIZE_PREFIX_LENGTH <= length) {
         uint32_t fbSize = readLE32(data + offset);
 
-        if (offset + SIZE_PREFIX_LENGTH + fbSize > length) {
+        if (offset + frameLength(fbSize) > length) {
             break;  // Truncated
         }
+        if (fbSize & PADDING_FRAME_FLAG) {
+            offset += frameLength(fbSize);
+            continue;
+        }
 
         const uint8_t* fbData = data + offset + SIZE_PREFIX_LENGTH;
 
@@ -278,9 +578,14 @@ std::optional<uint64_t> StreamingFlatBufferStore::getOffsetForSequence(uint64_t
 }
 
 void StreamingFlatBufferStore::iterateRecords(std::function<bool(const StoredRecord&)> callback) const {
+    SequentialRead read(data_.data(), static_cast<size_t>(writeOffset_));
     size_t offset = 0;
     while (offset + SIZE_PREFIX_LENGTH <= writeOffset_) {
         uint32_t fbSize = readLE32(&data_[offset]);
+        if (fbSize & PADDING_FRAME_FLAG) {
+            offset += frameLength(fbSize);
+            continue;
+        }
         if (offset + SIZE_PREFIX_LENGTH + fbSize > writeOffset_) {
             break;
         }
@@ -309,6 +614,10 @@ void StreamingFlatBufferStore::iterateRefsByFileId(std::string_view fileId,
     size_t offset = 0;
     while (offset + SIZE_PREFIX_LENGTH <= writeOffset_) {
         uint32_t fbSize = readLE32(&data_[offset]);
+        if (fbSize & PADDING_FRAME_FLAG) {
+            offset += frameLength(fbSize);
+            continue;
+        }
         if (offset + SIZE_PREFIX_LENGTH + fbSize > writeOffset_) {
             break;
         }
@@ -346,6 +655,10 @@ bool StreamingFlatBufferStore::getFirstRecord(std::string_view fileId,
     size_t offset = 0;
     while (offset + SIZE_PREFIX_LENGTH <= writeOffset_) {
         uint32_t fbSize = readLE32(&data_[offset]);
+        if (fbSize & PADDING_FRAME_FLAG) {
+            offset += frameLength(fbSize);
+            continue;
+        }
         if (offset + SIZE_PREFIX_LENGTH + fbSize > writeOffset_) {
             break;
         }
@@ -386,6 +699,10 @@ bool StreamingFlatBufferStore::getNextRecord(uint64_t afterOffset, std::string_v
     // Find next record with matching file ID
     while (offset + SIZE_PREFIX_LENGTH <= writeOffset_) {
         uint32_t fbSize = readLE32(&data_[offset]);
+        if (fbSize & PADDING_FRAME_FLAG) {
+            offset += frameLength(fbSize);
+            continue;
+        }
         if (offset + SIZE_PREFIX_LENGTH + fbSize > writeOffset_) {
             break;
         }
@@ -462,4 +779,98 @@ StreamingFlatBufferStore::getRecordInfoVector(std::string_view fileId) const {
     return &it->second;
 }
 
+std::vector<uint8_t> StreamingFlatBufferStore::exportData() const {
+    if (sequential_) {
+        return std::vector<uint8_t>(data_.begin(), data_.begin() + writeOffset_);
+    }
+    std::vector<uint8_t> out;
+    out.reserve(static_cast<size_t>(writeOffset_));
+    visitRecords(0, getLastSequence(), [&](const uint8_t* bytes, size_t length) {
+        out.insert(out.end(), bytes, bytes + length);
+    });
+    return out;
+}
+
+void StreamingFlatBufferStore::visitRecords(uint64_t after, uint64_t upTo,
+                                            const std::function<void(const uint8_t*, size_t)>& visit) const {
+    upTo = std::min(upTo, getLastSequence());
+    if (after >= upTo) return;
+
+    if (sequential_) {
+        // Sequences are dense until a relocate()
+        uint64_t begin = sequenceToOffset_.at(after + 1);
+        uint64_t end = upTo < getLastSequence() ? sequenceToOffset_.at(upTo + 1) : writeOffset_;
+        SequentialRead read(&data_[begin], static_cast<size_t>(end - begin));
+        visit(&data_[begin], static_cast<size_t>(end - begin));
+        return;
+    }
+
+    // Records adjacent in storage share a run
+    uint64_t runStart = 0;
+    uint64_t runEnd = 0;
+    for (uint64_t seq = after + 1; seq <= upTo; seq++) {
+        auto it = sequenceToOffset_.find(seq);
+        if (it == sequenceToOffset_.end()) continue;
+        uint64_t offset = it->second;
+        if (offset != runEnd) {
+            if (runEnd > runStart) visit(&data_[runStart], static_cast<size_t>(runEnd - runStart));
+            runStart = offset;
+        }
+        runEnd = offset + frameLength(readLE32(&data_[offset]));
+    }
+    if (runEnd > runStart) visit(&data_[runStart], static_cast<size_t>(runEnd - runStart));
+}
+
+void StreamingFlatBufferStore::relocate(const std::vector<uint64_t>& sequences) {
+    // Check every sequence before anything is moved
+    std::unordered_set<uint64_t> seen;
+    seen.reserve(sequences.size());
+    for (uint64_t seq : sequences) {
+        if (sequenceToOffset_.find(seq) == sequenceToOffset_.end()) {
+            throw std::runtime_error("Record not found for sequence: " + std::to_string(seq));
+        }
+        if (!seen.insert(seq).second) {
+            throw std::runtime_error("Sequence listed twice: " + std::to_string(seq));
+        }
+    }
+
+    PageVector<uint8_t> old(std::max<size_t>(static_cast<size_t>(writeOffset_), 1));
+    old.swap(data_);  // data_ is now an empty buffer of the same size
+    std::unordered_map<uint64_t, uint64_t> oldOffsets;
+    oldOffsets.swap(sequenceToOffset_);
+    offsetToSequence_.clear();
+    for (auto& [fileId, records] : fileIdToRecords_) {
+        records.clear();  // Keeps the vectors getRecordInfoVector() handed out
+    }
+    for (auto& [fileId, segment] : clusters_) {
+        segment.next = segment.end = 0;
+    }
+    writeOffset_ = 0;
+    recordCount_ = 0;
+
+    // Placed back to back whether clustered or not
+    auto clusters = std::move(clusters_);
+    clusters_.clear();
+    std::unordered_map<std::string, uint64_t> lastSequence;
+    listsSequenceOrdered_ = true;
+    for (uint64_t seq : sequences) {
+        const uint8_t* frame = &old[oldOffsets.at(seq)];
+        uint32_t fbSize = readLE32(frame);
+        std::string fileId = extractFileId(frame + SIZE_PREFIX_LENGTH, fbSize);
+
+        uint64_t offset = placeRecord(fileId, SIZE_PREFIX_LENGTH + fbSize);
+        std::memcpy(&data_[offset], frame, SIZE_PREFIX_LENGTH + fbSize);
+        sequenceToOffset_[seq] = offset;
+        offsetToSequence_[offset] = seq;
+        recordCount_++;
+        indexRecord(fileId, offset);
+
+        uint64_t& last = lastSequence[fileId];
+        if (seq < last) listsSequenceOrdered_ = false;
+        last = seq;
+    }
+    clusters_ = std::move(clusters);
+    sequential_ = false;
+}
+
 }  // namespace flatsql
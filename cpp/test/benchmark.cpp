@@ -9,7 +9,17 @@
 #include <vector>
 #include <random>
 #include <iomanip>
+#include <cstdio>
 #include <cstring>
+#include <sstream>
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
 
 using namespace flatsql;
 using namespace std::chrono;
@@ -30,6 +40,55 @@ private:
     high_resolution_clock::time_point start_, end_;
 };
 
+#ifdef __linux__
+// Page faults taken by the process so far (minor + major)
+long pageFaults() {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_minflt + usage.ru_majflt;
+}
+
+// Data TLB load misses of this thread between start() and stop(); -1 where
+// perf events aren't permitted (see /proc/sys/kernel/perf_event_paranoid)
+class TlbMissCounter {
+public:
+    TlbMissCounter() {
+        struct perf_event_attr attr;
+        std::memset(&attr, 0, sizeof(attr));
+        attr.type = PERF_TYPE_HW_CACHE;
+        attr.size = sizeof(attr);
+        attr.config = PERF_COUNT_HW_CACHE_DTLB | (PERF_COUNT_HW_CACHE_OP_READ << 8) |
+                      (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+        attr.disabled = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        fd_ = static_cast<int>(syscall(__NR_perf_event_open, &attr, 0, -1, -1, 0));
+    }
+    ~TlbMissCounter() { if (fd_ >= 0) close(fd_); }
+    void start() {
+        if (fd_ < 0) return;
+        ioctl(fd_, PERF_EVENT_IOC_RESET, 0);
+        ioctl(fd_, PERF_EVENT_IOC_ENABLE, 0);
+    }
+    long long stop() {
+        if (fd_ < 0) return -1;
+        ioctl(fd_, PERF_EVENT_IOC_DISABLE, 0);
+        long long count = 0;
+        return read(fd_, &count, sizeof(count)) == sizeof(count) ? count : -1;
+    }
+private:
+    int fd_;
+};
+#else
+long pageFaults() { return -1; }
+
+class TlbMissCounter {
+public:
+    void start() {}
+    long long stop() { return -1; }
+};
+#endif
+
 // Create FlatBuffer User
 std::vector<uint8_t> createUserFlatBuffer(int32_t id, const std::string& name,
                                            const std::string& email, int32_t age) {
@@ -285,6 +344,30 @@ int main() {
     std::cout << "  FlatSQL: " << std::fixed << std::setprecision(0) << flatsqlRecordsPerSec << " records/sec\n";
     std::cout << "  SQLite:  " << sqliteRecordsPerSec << " records/sec\n";
 
+    // Same ingest with a group-commit append log (fdatasync on a background thread)
+    {
+        const char* walPath = "/tmp/flatsql_benchmark.wal";
+        std::remove(walPath);
+        auto durableDb = FlatSQLDatabase::fromSchema(schema, "benchmark_wal");
+        durableDb.registerFileId("USER", "User");
+        durableDb.setFieldExtractor("User", extractUserField);
+        durableDb.setFastFieldExtractor("User", fastExtractUserField);
+        durableDb.setBatchExtractor("User", batchExtractUser);
+        durableDb.openAppendLog(walPath);
+
+        timer.start();
+        for (const auto& fb : flatBuffers) {
+            durableDb.ingestOne(fb.data(), fb.size());
+        }
+        timer.stop();
+        double durableIngestMs = timer.ms();
+        std::cout << "  FlatSQL + group commit: " << RECORD_COUNT / (durableIngestMs / 1000.0)
+                  << " records/sec (" << std::setprecision(1)
+                  << (durableIngestMs / flatsqlIngestMs - 1.0) * 100.0 << "% overhead)\n";
+        durableDb.closeAppendLog();
+        std::remove(walPath);
+    }
+
     // ==================== QUERY BENCHMARK ====================
     printHeader("QUERY BENCHMARK");
     std::cout << std::left << std::setw(25) << "Operation"
@@ -410,6 +493,21 @@ int main() {
     double flatsqlZeroCopyMs = timer.ms();
     printResult("Zero-copy lookup", flatsqlZeroCopyMs, sqlitePointQueryMs);
 
+    // Batched zero-copy lookup (table and index resolved once per batch)
+    rng.seed(123);
+    constexpr size_t LOOKUP_BATCH = 1000;
+    std::vector<Value> batchKeys(LOOKUP_BATCH);
+    std::vector<StreamingFlatBufferStore::RecordRef> batchRefs(LOOKUP_BATCH);
+    timer.start();
+    for (int i = 0; i < QUERY_ITERATIONS; i += static_cast<int>(LOOKUP_BATCH)) {
+        for (auto& key : batchKeys) {
+            key = static_cast<int32_t>(idDist(rng));
+        }
+        flatsqlDb.findRawByIndexBatch("User", "id", batchKeys.data(), batchKeys.size(), batchRefs.data());
+    }
+    timer.stop();
+    printResult("Batched zero-copy lookup", timer.ms(), sqlitePointQueryMs);
+
     // Point query by email (indexed) - using parameterized query
     timer.start();
     for (int i = 0; i < QUERY_ITERATIONS; i++) {
@@ -579,6 +677,68 @@ int main() {
     std::cout << "\nNote: FlatSQL uses full-fat FlatBuffers (no compression) for zero-copy access.\n";
     std::cout << "      Larger storage enables faster reads - this is an intentional trade-off.\n";
 
+    // ==================== PAGE FAULTS AND TLB ====================
+    printHeader("PAGE FAULTS AND TLB (random point lookups)");
+
+    // A store well past the data TLB's reach with 4 KB pages
+    constexpr int STORE_COPIES = 50;
+    constexpr int LOOKUPS = 1000000;
+    std::cout << std::left << std::setw(14) << "Pages"
+              << std::right << std::setw(10) << "Load"
+              << std::setw(10) << "Faults"
+              << std::setw(12) << "Lookup"
+              << std::setw(14) << "dTLB miss/op" << "\n";
+    std::cout << std::string(60, '-') << "\n";
+    HugePages savedHugePages = getHugePages();
+    for (HugePages mode : {HugePages::Off, HugePages::Transparent, HugePages::Explicit}) {
+        setHugePages(mode);
+        long faultsBefore = pageFaults();
+        timer.start();
+        StreamingFlatBufferStore store;
+        for (int copy = 0; copy < STORE_COPIES; copy++) {
+            for (const auto& fb : flatBuffers) {
+                store.ingestFlatBuffer(fb.data(), fb.size(), nullptr);
+            }
+        }
+        timer.stop();
+        double loadMs = timer.ms();
+        long faults = pageFaults() - faultsBefore;
+
+        const auto* records = store.getRecordInfoVector("USER");
+        std::mt19937_64 rng(7);
+        std::vector<uint64_t> probes(LOOKUPS);
+        for (auto& p : probes) p = (*records)[rng() % records->size()].offset;
+
+        TlbMissCounter tlbMisses;
+        uint64_t checksum = 0;
+        timer.start();
+        tlbMisses.start();
+        for (uint64_t offset : probes) {
+            uint32_t length = 0;
+            const uint8_t* data = store.getDataAtOffset(offset, &length);
+            checksum += data[length / 2];
+        }
+        long long misses = tlbMisses.stop();
+        timer.stop();
+
+        const char* label = mode == HugePages::Off ? "4 KB" : mode == HugePages::Transparent ? "THP" : "hugetlbfs";
+        std::ostringstream missesPerOp;
+        if (misses >= 0) {
+            missesPerOp << std::fixed << std::setprecision(3) << static_cast<double>(misses) / LOOKUPS;
+        } else {
+            missesPerOp << "n/a";
+        }
+        std::cout << std::left << std::setw(14) << label
+                  << std::right << std::setw(7) << std::fixed << std::setprecision(1) << loadMs << " ms"
+                  << std::setw(10) << faults
+                  << std::setw(9) << std::setprecision(1) << timer.us() * 1000.0 / LOOKUPS << " ns"
+                  << std::setw(14) << missesPerOp.str() << "\n";
+        if (checksum == 0) std::cout << "";  // Keep the reads
+    }
+    setHugePages(savedHugePages);
+    std::cout << "\nStore: " << STORE_COPIES * RECORD_COUNT << " records. hugetlbfs falls back to THP\n";
+    std::cout << "unless pages are reserved (vm.nr_hugepages).\n";
+
     // ==================== SUMMARY ====================
     printHeader("SUMMARY");
 
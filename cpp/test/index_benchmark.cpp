@@ -0,0 +1,298 @@
+// Index Benchmark: in-memory indexes vs SqliteIndex
+//
+// This benchmark does NOT run as part of CI.
+// 1. Time-ordered keys: a nearly sorted stream of EPOCH values (Julian
+//    dates, a few percent arriving late), piecewise-linear learned index vs
+//    the SQLite B-tree index.
+// 2. String keys: short entity ids and emails with long shared prefixes,
+//    adaptive radix tree vs the compact B-tree layout.
+// Both compare build time, memory, point lookups and short range or prefix
+// scans.
+//
+// Usage:
+//   ./flatsql_index_benchmark [entry_count]
+//
+//   Default: 1,000,000 entries
+
+#include "flatsql/learned_index.h"
+#include "flatsql/radix_index.h"
+#include "flatsql/sqlite_index.h"
+#include <sqlite3.h>
+#include <iostream>
+#include <chrono>
+#include <vector>
+#include <random>
+#include <iomanip>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+#include <string>
+
+using namespace flatsql;
+using namespace std::chrono;
+
+static size_t ENTRY_COUNT = 1'000'000;
+static constexpr int QUERY_ITERATIONS = 100'000;
+static constexpr int RANGE_ITERATIONS = 10'000;
+static constexpr size_t RANGE_WIDTH = 100;   // Entries per range scan
+static constexpr double LATE_FRACTION = 0.02;
+
+class Timer {
+public:
+    void start() { start_ = high_resolution_clock::now(); }
+    void stop() { end_ = high_resolution_clock::now(); }
+    double ms() const { return duration_cast<microseconds>(end_ - start_).count() / 1000.0; }
+    double ns() const { return static_cast<double>(duration_cast<nanoseconds>(end_ - start_).count()); }
+private:
+    high_resolution_clock::time_point start_, end_;
+};
+
+static void printRow(const std::string& name, const std::string& sqliteValue, const std::string& memoryValue) {
+    std::cout << "  " << std::left << std::setw(26) << name
+              << std::right << std::setw(16) << sqliteValue
+              << std::setw(16) << memoryValue << std::endl;
+}
+
+static std::string fixed(double v, int precision, const std::string& unit) {
+    std::ostringstream ss;
+    ss << std::fixed << std::setprecision(precision) << v << unit;
+    return ss.str();
+}
+
+// Bytes of pages in an in-memory database
+static double databaseBytes(sqlite3* db) {
+    sqlite3_stmt* stmt = nullptr;
+    sqlite3_prepare_v2(db, "SELECT page_count * page_size FROM pragma_page_count(), pragma_page_size()",
+                       -1, &stmt, nullptr);
+    double bytes = sqlite3_step(stmt) == SQLITE_ROW ? sqlite3_column_double(stmt, 0) : 0.0;
+    sqlite3_finalize(stmt);
+    return bytes;
+}
+
+static int benchEpochKeys() {
+    std::cout << "Index benchmark: " << ENTRY_COUNT << " EPOCH keys, "
+              << (LATE_FRACTION * 100) << "% late" << std::endl;
+
+    // One observation every ~0.5 s with jitter, in arrival order. Late
+    // observations arrive up to a minute after their epoch.
+    std::mt19937_64 rng(42);
+    std::uniform_real_distribution<double> jitter(0.0, 0.4 / 86400.0);
+    std::uniform_real_distribution<double> delay(0.0, 60.0 / 86400.0);
+    std::uniform_real_distribution<double> coin(0.0, 1.0);
+    std::vector<std::pair<double, double>> arrivals(ENTRY_COUNT);  // (arrival, epoch)
+    double epoch = 2460000.5;
+    for (size_t i = 0; i < ENTRY_COUNT; i++) {
+        epoch += 0.5 / 86400.0;
+        double observed = epoch + jitter(rng);
+        double arrival = observed + (coin(rng) < LATE_FRACTION ? delay(rng) : 0.0);
+        arrivals[i] = {arrival, observed};
+    }
+    std::sort(arrivals.begin(), arrivals.end());
+    std::vector<double> epochs(ENTRY_COUNT);
+    for (size_t i = 0; i < ENTRY_COUNT; i++) epochs[i] = arrivals[i].second;
+
+    sqlite3* db = nullptr;
+    sqlite3_open(":memory:", &db);
+    sqlite3_exec(db, "PRAGMA journal_mode = OFF; PRAGMA synchronous = OFF;", nullptr, nullptr, nullptr);
+    SqliteIndex btree(db, "bench", "EPOCH", ValueType::Float64);
+    LearnedIndex learned("EPOCH", ValueType::Float64);
+
+    Timer timer;
+    timer.start();
+    sqlite3_exec(db, "BEGIN", nullptr, nullptr, nullptr);
+    for (size_t i = 0; i < ENTRY_COUNT; i++) btree.insert(epochs[i], i * 256, 0, i + 1);
+    sqlite3_exec(db, "COMMIT", nullptr, nullptr, nullptr);
+    timer.stop();
+    double btreeBuildMs = timer.ms();
+
+    timer.start();
+    for (size_t i = 0; i < ENTRY_COUNT; i++) learned.insert(epochs[i], i * 256, i + 1);
+    timer.stop();
+    double learnedBuildMs = timer.ms();
+
+    // B-tree memory is the pages of the in-memory database
+    double btreeBytes = databaseBytes(db);
+    double learnedBytes = static_cast<double>(learned.getMemoryBytes());
+
+    // Point lookups of existing keys
+    std::vector<double> probes(QUERY_ITERATIONS);
+    for (auto& p : probes) p = epochs[rng() % ENTRY_COUNT];
+
+    size_t found = 0;
+    IndexEntry entry;
+    timer.start();
+    for (double p : probes) found += btree.searchFirst(p, entry) ? 1 : 0;
+    timer.stop();
+    double btreePointNs = timer.ns() / QUERY_ITERATIONS;
+
+    size_t learnedFound = 0;
+    timer.start();
+    for (double p : probes) learnedFound += learned.searchFirst(p, entry) ? 1 : 0;
+    timer.stop();
+    double learnedPointNs = timer.ns() / QUERY_ITERATIONS;
+
+    // Range scans covering ~RANGE_WIDTH entries
+    std::vector<double> sorted = epochs;
+    std::sort(sorted.begin(), sorted.end());
+    std::vector<std::pair<double, double>> ranges(RANGE_ITERATIONS);
+    for (auto& r : ranges) {
+        size_t start = rng() % (ENTRY_COUNT - RANGE_WIDTH);
+        r = {sorted[start], sorted[start + RANGE_WIDTH - 1]};
+    }
+
+    size_t btreeRows = 0;
+    timer.start();
+    for (const auto& r : ranges) btreeRows += btree.range(r.first, r.second).size();
+    timer.stop();
+    double btreeRangeUs = timer.ns() / RANGE_ITERATIONS / 1000.0;
+
+    size_t learnedRows = 0;
+    timer.start();
+    for (const auto& r : ranges) learnedRows += learned.range(r.first, r.second).size();
+    timer.stop();
+    double learnedRangeUs = timer.ns() / RANGE_ITERATIONS / 1000.0;
+
+    if (found != learnedFound || btreeRows != learnedRows) {
+        std::cerr << "Result mismatch: " << found << "/" << learnedFound << " point hits, "
+                  << btreeRows << "/" << learnedRows << " range rows" << std::endl;
+        sqlite3_close(db);
+        return 1;
+    }
+
+    std::cout << std::endl;
+    printRow("", "SqliteIndex", "LearnedIndex");
+    printRow("Build", fixed(btreeBuildMs, 1, " ms"), fixed(learnedBuildMs, 1, " ms"));
+    printRow("Memory", fixed(btreeBytes / 1048576.0, 2, " MB"), fixed(learnedBytes / 1048576.0, 2, " MB"));
+    printRow("Bytes/entry", fixed(btreeBytes / ENTRY_COUNT, 1, ""), fixed(learnedBytes / ENTRY_COUNT, 1, ""));
+    printRow("Model (segments)", "-", fixed(static_cast<double>(learned.getModelBytes()), 0, " B"));
+    printRow("Point lookup", fixed(btreePointNs, 0, " ns"), fixed(learnedPointNs, 0, " ns"));
+    printRow("Range (" + std::to_string(RANGE_WIDTH) + " rows)", fixed(btreeRangeUs, 2, " us"),
+             fixed(learnedRangeUs, 2, " us"));
+    std::cout << std::endl << "  Learned segments: " << learned.getSegmentCount()
+              << " (epsilon " << learned.getEpsilon() << "), "
+              << learned.getPendingCount() << " late entries buffered" << std::endl;
+
+    sqlite3_close(db);
+    return 0;
+}
+
+// One string key set: build, memory, point lookups and prefix scans
+static int benchStringKeys(const std::string& label, const std::vector<std::string>& keys,
+                           const std::vector<std::string>& prefixes) {
+    std::cout << std::endl << "String keys: " << keys.size() << " " << label << std::endl;
+
+    sqlite3* db = nullptr;
+    sqlite3_open(":memory:", &db);
+    sqlite3_exec(db, "PRAGMA journal_mode = OFF; PRAGMA synchronous = OFF;", nullptr, nullptr, nullptr);
+    SqliteIndex btree(db, "bench", "ID", ValueType::String, IndexLayout::Compact);
+    RadixIndex radix("ID", ValueType::String);
+
+    Timer timer;
+    timer.start();
+    sqlite3_exec(db, "BEGIN", nullptr, nullptr, nullptr);
+    for (size_t i = 0; i < keys.size(); i++) btree.insert(keys[i], i * 256, 0, i + 1);
+    sqlite3_exec(db, "COMMIT", nullptr, nullptr, nullptr);
+    timer.stop();
+    double btreeBuildMs = timer.ms();
+
+    timer.start();
+    for (size_t i = 0; i < keys.size(); i++) radix.insert(keys[i], i * 256, i + 1);
+    timer.stop();
+    double radixBuildMs = timer.ms();
+
+    double btreeBytes = databaseBytes(db);
+    double radixBytes = static_cast<double>(radix.getMemoryBytes());
+
+    std::mt19937_64 rng(7);
+    std::vector<std::string> probes(QUERY_ITERATIONS);
+    for (auto& p : probes) p = keys[rng() % keys.size()];
+
+    size_t found = 0;
+    uint64_t offset = 0, sequence = 0;
+    timer.start();
+    for (const auto& p : probes) found += btree.searchFirstString(p, offset, sequence) ? 1 : 0;
+    timer.stop();
+    double btreePointNs = timer.ns() / QUERY_ITERATIONS;
+
+    size_t radixFound = 0;
+    timer.start();
+    for (const auto& p : probes) radixFound += radix.searchFirstString(p, offset, sequence) ? 1 : 0;
+    timer.stop();
+    double radixPointNs = timer.ns() / QUERY_ITERATIONS;
+
+    size_t btreeRows = 0;
+    timer.start();
+    for (int i = 0; i < RANGE_ITERATIONS; i++) {
+        const std::string& prefix = prefixes[i % prefixes.size()];
+        btreeRows += btree.prefixRange(prefix, prefix).size();
+    }
+    timer.stop();
+    double btreePrefixUs = timer.ns() / RANGE_ITERATIONS / 1000.0;
+
+    size_t radixRows = 0;
+    timer.start();
+    for (int i = 0; i < RANGE_ITERATIONS; i++) {
+        const std::string& prefix = prefixes[i % prefixes.size()];
+        radixRows += radix.prefixRange(prefix, prefix).size();
+    }
+    timer.stop();
+    double radixPrefixUs = timer.ns() / RANGE_ITERATIONS / 1000.0;
+
+    if (found != radixFound || btreeRows != radixRows) {
+        std::cerr << "Result mismatch: " << found << "/" << radixFound << " point hits, "
+                  << btreeRows << "/" << radixRows << " prefix rows" << std::endl;
+        sqlite3_close(db);
+        return 1;
+    }
+
+    std::cout << std::endl;
+    printRow("", "SqliteIndex", "RadixIndex");
+    printRow("Build", fixed(btreeBuildMs, 1, " ms"), fixed(radixBuildMs, 1, " ms"));
+    printRow("Memory", fixed(btreeBytes / 1048576.0, 2, " MB"), fixed(radixBytes / 1048576.0, 2, " MB"));
+    printRow("Bytes/entry", fixed(btreeBytes / keys.size(), 1, ""), fixed(radixBytes / keys.size(), 1, ""));
+    printRow("Point lookup", fixed(btreePointNs, 0, " ns"), fixed(radixPointNs, 0, " ns"));
+    printRow("Prefix (~" + std::to_string(btreeRows / RANGE_ITERATIONS) + " rows)",
+             fixed(btreePrefixUs, 2, " us"), fixed(radixPrefixUs, 2, " us"));
+    std::cout << std::endl << "  Radix nodes: " << radix.getNodeCount() << " inner, "
+              << radix.getKeyCount() << " leaves" << std::endl;
+
+    sqlite3_close(db);
+    return 0;
+}
+
+int main(int argc, char* argv[]) {
+    if (argc > 1) ENTRY_COUNT = std::strtoull(argv[1], nullptr, 10);
+
+    if (benchEpochKeys() != 0) return 1;
+
+    // International designators in random launch order: short keys that
+    // differ early ("2019-074BX")
+    std::mt19937_64 rng(11);
+    std::vector<std::string> designators(ENTRY_COUNT);
+    std::vector<std::string> launches;
+    for (auto& key : designators) {
+        char buf[16];
+        std::snprintf(buf, sizeof(buf), "%04d-%03d", 1990 + static_cast<int>(rng() % 35),
+                      1 + static_cast<int>(rng() % 300));
+        int piece = static_cast<int>(rng() % (26 * 27));
+        key = buf;
+        key += static_cast<char>('A' + piece % 26);
+        if (piece / 26) key += static_cast<char>('A' + piece / 26 - 1);
+        if (launches.size() < 1000) launches.push_back(key.substr(0, 8));  // One launch
+    }
+    if (benchStringKeys("entity ids", designators, launches) != 0) return 1;
+
+    // Emails on a few long domains: keys share most of their bytes
+    static const char* domains[] = {"@operations.spacecraft-catalog.example.org",
+                                    "@tracking.ground-segment.example.net",
+                                    "@conjunction-assessment.example.com"};
+    std::vector<std::string> emails(ENTRY_COUNT);
+    std::vector<std::string> users;
+    for (auto& key : emails) {
+        std::string user = "analyst." + std::to_string(rng() % (ENTRY_COUNT / 4 + 1));
+        key = user + domains[rng() % 3];
+        if (users.size() < 1000) users.push_back(user + "@");  // One user's addresses
+    }
+    return benchStringKeys("emails", emails, users);
+}
@@ -575,6 +575,25 @@ int main(int argc, char* argv[]) {
     std::cout << "  FlatSQL: " << flatsqlRangeMs << " ms (count: " << flatsqlCount << ")\n";
     std::cout << "  SQLite:  " << sqliteRangeMs << " ms (count: " << sqliteCount << ")\n";
 
+    // ==================== CATALOG PROPAGATION ====================
+    printHeader("CATALOG PROPAGATION (sgp4_propagate)");
+
+    // Whole catalog to a 6-step grid, 10 minutes apart
+    double gridStart = epochThreshold;
+    std::vector<Value> gridParams = {gridStart, gridStart + 3000.0, 600.0};
+    timer.start();
+    auto propagated = flatsqlDb.query(
+        "SELECT COUNT(*), SUM(error = 0) FROM sgp4_propagate('MPE', ?, ?, ?)", gridParams);
+    timer.stop();
+    double propagateMs = timer.ms();
+    int64_t stateRows = std::get<int64_t>(propagated.rows[0][0]);
+    int64_t okRows = std::get<int64_t>(propagated.rows[0][1]);
+
+    std::cout << "Query: SELECT COUNT(*) FROM sgp4_propagate('MPE', t0, t0 + 3000, 600)\n";
+    std::cout << "  States:     " << stateRows << " (" << okRows << " propagated)\n";
+    std::cout << "  Time:       " << std::fixed << std::setprecision(2) << propagateMs << " ms\n";
+    std::cout << "  Throughput: " << static_cast<size_t>(stateRows / (propagateMs / 1000.0)) << " states/sec\n";
+
     // ==================== STORAGE SIZE ====================
     printHeader("STORAGE SIZE");
 
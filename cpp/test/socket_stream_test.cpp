@@ -2,6 +2,7 @@
 // Demonstrates streaming raw FlatBuffers over a Unix domain socket
 
 #include "flatsql/database.h"
+#include "flatsql/replication.h"
 #include "../schemas/test_schema_generated.h"
 #include <iostream>
 #include <cassert>
@@ -508,6 +509,195 @@ void testMixedTableStreaming() {
     std::cout << "Mixed table streaming test passed!" << std::endl;
 }
 
+// Leader and follower databases for the replication tests
+static const char* REPLICATION_SCHEMA = R"(
+    table User {
+        id: int (id);
+        name: string;
+        email: string (key);
+        age: int;
+    }
+    table Post {
+        id: int (id);
+        user_id: int (key);
+        title: string;
+        content: string;
+    }
+)";
+
+static FlatSQLDatabase openReplica(const char* name) {
+    FlatSQLDatabase db = FlatSQLDatabase::fromSchema(REPLICATION_SCHEMA, name);
+    db.registerFileId("USER", "User");
+    db.registerFileId("POST", "Post");
+    db.setFieldExtractor("User", extractUserField);
+    db.setFieldExtractor("Post", extractPostField);
+    return db;
+}
+
+static void ingestUsers(FlatSQLDatabase& db, int from, int to) {
+    std::vector<std::vector<uint8_t>> buffers;
+    for (int i = from; i < to; i++) {
+        std::string name = "User" + std::to_string(i);
+        std::string email = "user" + std::to_string(i) + "@test.com";
+        buffers.push_back(createUser(i, name.c_str(), email.c_str(), 20 + i % 50));
+        if (i % 4 == 0) {
+            std::string title = "Post by " + name;
+            buffers.push_back(createPost(i, i, title.c_str(), "content"));
+        }
+    }
+    std::vector<uint8_t> stream = buildStream(buffers);
+    db.ingest(stream.data(), stream.size());
+}
+
+static uint64_t rowidOf(FlatSQLDatabase& db, const char* sql) {
+    QueryResult result = db.query(sql);
+    assert(result.rowCount() == 1);
+    return static_cast<uint64_t>(std::get<int64_t>(result.rows[0][0]));
+}
+
+static bool sameContents(FlatSQLDatabase& a, FlatSQLDatabase& b) {
+    for (const char* sql : {"SELECT _rowid, id, email FROM User", "SELECT _rowid, id, user_id FROM Post",
+                            "SELECT * FROM User WHERE email = 'user42@test.com'"}) {
+        if (a.query(sql).rows != b.query(sql).rows) return false;
+    }
+    return true;
+}
+
+void testReplicationOverPipe() {
+    std::cout << "Testing log-shipping replication over a pipe..." << std::endl;
+
+    FlatSQLDatabase leaderDb = openReplica("leader");
+    FlatSQLDatabase followerDb = openReplica("follower");
+    int fds[2];
+    assert(pipe(fds) == 0);
+
+    ReplicationLeader leader(leaderDb);
+    ReplicationFollower follower(followerDb);
+    size_t id = leader.addFollower(fds[1]);
+
+    ingestUsers(leaderDb, 1, 101);
+    assert(leader.ship() == 1 && leader.getShippedSequence(id) == leaderDb.getLastSequence());
+
+    // The watermark arrives first: the follower's lag counts down as it applies
+    uint8_t chunk[1024];
+    ssize_t n = read(fds[0], chunk, sizeof(chunk));
+    assert(n > 0);
+    follower.receive(chunk, static_cast<size_t>(n));
+    assert(follower.getLeaderSequence() == leaderDb.getLastSequence());
+    assert(follower.getLag() > 0 && follower.getAppliedSequence() > 0);
+    while (follower.getLag() > 0) {
+        assert(follower.poll(fds[0]));
+    }
+    assert(sameContents(leaderDb, followerDb));
+
+    // Deletes and new rows follow in order
+    leaderDb.markDeleted("User", rowidOf(leaderDb, "SELECT _rowid FROM User WHERE id = 1"));
+    ingestUsers(leaderDb, 101, 121);
+    leaderDb.markDeleted("Post", rowidOf(leaderDb, "SELECT _rowid FROM Post WHERE id = 104"));
+    leader.ship();
+    do {
+        assert(follower.poll(fds[0]));
+    } while (follower.getLag() > 0 || followerDb.getDeletedCount("Post") == 0);
+    assert(followerDb.getDeletedCount("User") == 1 && followerDb.getDeletedCount("Post") == 1);
+    assert(sameContents(leaderDb, followerDb));
+
+    // A follower the feed doesn't continue from fails, and stays failed
+    FlatSQLDatabase strayDb = openReplica("stray");
+    ingestUsers(strayDb, 1, 3);
+    ReplicationFollower stray(strayDb);
+    int strayFds[2];
+    assert(pipe(strayFds) == 0);
+    ReplicationLeader strayLeader(leaderDb);
+    strayLeader.addFollower(strayFds[1], leaderDb.getLastSequence() - 1);
+    assert(strayLeader.ship() == 1);
+    n = read(strayFds[0], chunk, sizeof(chunk));
+    assert(n > 0);
+    for (int attempt = 0; attempt < 2; attempt++) {
+        bool threw = false;
+        try {
+            stray.receive(chunk, attempt == 0 ? static_cast<size_t>(n) : 0);
+        } catch (const std::runtime_error&) {
+            threw = true;
+        }
+        assert(threw && strayDb.getLastSequence() == 2);
+    }
+    close(strayFds[1]);
+    close(strayFds[0]);
+
+    // Closing the stream ends polling
+    close(fds[1]);
+    assert(!follower.poll(fds[0]));
+    close(fds[0]);
+
+    std::cout << "Replication over pipe test passed!" << std::endl;
+}
+
+void testReplicationOverSocket() {
+    std::cout << "Testing log-shipping replication over a Unix socket..." << std::endl;
+
+    // Follower: listens like SocketServer and applies until the leader hangs up
+    std::atomic<bool> listening{false};
+    std::atomic<uint64_t> followerApplied{0};
+    std::atomic<size_t> followerUsers{0};
+    std::atomic<size_t> followerDeleted{0};
+    std::thread followerThread([&]() {
+        unlink(SOCKET_PATH);
+        int serverFd = socket(AF_UNIX, SOCK_STREAM, 0);
+        struct sockaddr_un addr;
+        memset(&addr, 0, sizeof(addr));
+        addr.sun_family = AF_UNIX;
+        strncpy(addr.sun_path, SOCKET_PATH, sizeof(addr.sun_path) - 1);
+        assert(serverFd >= 0 && bind(serverFd, (struct sockaddr*)&addr, sizeof(addr)) == 0);
+        assert(listen(serverFd, 1) == 0);
+        listening = true;
+        int leaderFd = accept(serverFd, nullptr, nullptr);
+        assert(leaderFd >= 0);
+
+        FlatSQLDatabase followerDb = openReplica("socket_follower");
+        ReplicationFollower follower(followerDb);
+        while (follower.poll(leaderFd)) {
+        }
+        assert(follower.getLag() == 0);
+        followerApplied = follower.getAppliedSequence();
+        followerUsers = followerDb.query("SELECT * FROM User").rowCount();
+        followerDeleted = followerDb.getDeletedCount("User");
+
+        close(leaderFd);
+        close(serverFd);
+        unlink(SOCKET_PATH);
+    });
+    while (!listening) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+
+    // Leader: connects like SocketClient and ships three rounds of changes
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+    struct sockaddr_un addr;
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strncpy(addr.sun_path, SOCKET_PATH, sizeof(addr.sun_path) - 1);
+    assert(fd >= 0 && connect(fd, (struct sockaddr*)&addr, sizeof(addr)) == 0);
+
+    FlatSQLDatabase leaderDb = openReplica("socket_leader");
+    ReplicationLeader leader(leaderDb);
+    leader.addFollower(fd);
+    for (int round = 0; round < 3; round++) {
+        ingestUsers(leaderDb, round * 500 + 1, round * 500 + 501);
+        std::string sql = "SELECT _rowid FROM User WHERE id = " + std::to_string(round * 500 + 7);
+        leaderDb.markDeleted("User", rowidOf(leaderDb, sql.c_str()));
+        assert(leader.ship() == 1);
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    close(fd);
+    followerThread.join();
+
+    assert(followerApplied == leaderDb.getLastSequence());
+    assert(followerUsers == leaderDb.query("SELECT * FROM User").rowCount());
+    assert(followerDeleted == 3);
+
+    std::cout << "Replication over Unix socket test passed!" << std::endl;
+}
+
 int main() {
     std::cout << "=== FlatSQL Socket Streaming Tests ===" << std::endl;
     std::cout << "Testing raw FlatBuffer streaming over Unix sockets" << std::endl;
@@ -523,6 +713,10 @@ int main() {
         testBasicSocketStreaming();
         testLargeStreamingBatch();
 
+        // Log-shipping replication
+        testReplicationOverPipe();
+        testReplicationOverSocket();
+
         std::cout << std::endl;
         std::cout << "=== All socket streaming tests passed! ===" << std::endl;
         return 0;
@@ -1,10 +1,26 @@
 #include "flatsql/database.h"
 #include "flatsql/junction.h"
 #include "flatsql/sqlite_index.h"
+#include "flatsql/key_codec.h"
+#include "flatsql/learned_index.h"
+#include "flatsql/radix_index.h"
+#include "flatsql/geo_functions.h"
+#include "flatsql/geo_kernels.h"
+#include "flatsql/geo_polygon.h"
+#include "flatsql/sgp4.h"
+#include "flatsql/flatbuffer_access.h"
 #include "flatbuffers/encryption.h"
 #include <sqlite3.h>
 #include <iostream>
 #include <cassert>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <cmath>
+#include <chrono>
+#include <map>
+#include <random>
+#include <thread>
 
 using namespace flatsql;
 
@@ -105,15 +121,13 @@ void testSqliteIndex() {
 
         // searchFirstInt64 (fast path API)
         uint64_t offset, seq;
-        uint32_t len;
-        found = index.searchFirstInt64(50, offset, len, seq);
+        found = index.searchFirstInt64(50, offset, seq);
         assert(found);
         assert(offset == 5000);
-        assert(len == 50);
         assert(seq == 50);
 
         // Test not found case
-        found = index.searchFirstInt64(999, offset, len, seq);
+        found = index.searchFirstInt64(999, offset, seq);
         assert(!found);
 
         // Range search
@@ -150,21 +164,30 @@ void testSqliteIndex() {
 
         // searchFirstString (fast path API)
         uint64_t offset, seq;
-        uint32_t len;
-        found = stringIndex.searchFirstString("12345", offset, len, seq);
+        found = stringIndex.searchFirstString("12345", offset, seq);
         assert(found);
         assert(offset == 3000);
-        assert(len == 100);
         assert(seq == 4);
 
         // Test not found case
-        found = stringIndex.searchFirstString("NOTFOUND", offset, len, seq);
+        found = stringIndex.searchFirstString("NOTFOUND", offset, seq);
         assert(!found);
 
         // Range search on strings
         auto rangeResults = stringIndex.range(std::string("00001"), std::string("00003"));
         assert(rangeResults.size() == 3);
 
+        // Prefix range (half-open, upper bound is the prefix successor)
+        auto prefixResults = stringIndex.prefixRange("0000", "0000");
+        assert(prefixResults.size() == 3);
+        prefixResults = stringIndex.prefixRange("123", "123");
+        assert(prefixResults.size() == 1);
+        assert(prefixResults[0].dataOffset == 3000);
+        prefixResults = stringIndex.prefixRange("2", "2");
+        assert(prefixResults.empty());
+        prefixResults = stringIndex.prefixRange("", "");  // Unbounded
+        assert(prefixResults.size() == 5);
+
         stringIndex.clear();
     }
 
@@ -225,17 +248,16 @@ void testSqliteIndex() {
 
         // Verify lookups work for boundary values
         uint64_t offset, seq;
-        uint32_t len;
 
-        bool found = edgeIndex.searchFirstInt64(INT64_MAX, offset, len, seq);
+        bool found = edgeIndex.searchFirstInt64(INT64_MAX, offset, seq);
         assert(found);
         assert(offset == 20);
 
-        found = edgeIndex.searchFirstInt64(INT64_MIN, offset, len, seq);
+        found = edgeIndex.searchFirstInt64(INT64_MIN, offset, seq);
         assert(found);
         assert(offset == 30);
 
-        found = edgeIndex.searchFirstInt64(0, offset, len, seq);
+        found = edgeIndex.searchFirstInt64(0, offset, seq);
         assert(found);
         assert(offset == 0);
 
@@ -257,8 +279,7 @@ void testSqliteIndex() {
         assert(!found);
 
         uint64_t offset, seq;
-        uint32_t len;
-        found = emptyIndex.searchFirstInt64(42, offset, len, seq);
+        found = emptyIndex.searchFirstInt64(42, offset, seq);
         assert(!found);
 
         auto all = emptyIndex.all();
@@ -268,11 +289,2414 @@ void testSqliteIndex() {
         assert(range.empty());
     }
 
+    // ==================== Compact Layout Tests ====================
+    std::cout << "  Testing compact layout..." << std::endl;
+    {
+        SqliteIndex rows(db, "compact_table", "rows_id", ValueType::String);
+        SqliteIndex compact(db, "compact_table", "compact_id", ValueType::String, IndexLayout::Compact);
+        assert(compact.getLayout() == IndexLayout::Compact);
+
+        // Shuffled, non-unique entity ids - enough to split blocks many times
+        const int N = 2000;
+        for (int i = 0; i < N; i++) {
+            int id = (i * 7919) % (N / 2);
+            char key[32];
+            std::snprintf(key, sizeof(key), "ENTITY-%06d", id);
+            uint64_t seq = static_cast<uint64_t>(i + 1);
+            rows.insert(std::string(key), seq * 64, 64, seq);
+            compact.insert(std::string(key), seq * 64, 64, seq);
+        }
+        assert(compact.getEntryCount() == static_cast<uint64_t>(N));
+
+        auto sameEntries = [](const std::vector<IndexEntry>& a, const std::vector<IndexEntry>& b) {
+            if (a.size() != b.size()) return false;
+            for (size_t i = 0; i < a.size(); i++) {
+                if (compareValues(a[i].key, b[i].key) != 0 || a[i].sequence != b[i].sequence ||
+                    a[i].dataOffset != b[i].dataOffset) return false;
+            }
+            return true;
+        };
+
+        // Same entries in the same (key, sequence) order as the row layout
+        auto all = compact.all();
+        assert(all.size() == static_cast<size_t>(N));
+        assert(sameEntries(all, rows.all()));
+
+        auto dup = compact.search(std::string("ENTITY-000123"));
+        assert(dup.size() == 2 && dup[0].sequence < dup[1].sequence);
+        assert(sameEntries(dup, rows.search(std::string("ENTITY-000123"))));
+        assert(compact.search(std::string("ENTITY-999999")).empty());
+        assert(compact.search(std::string("A")).empty());
+
+        assert(sameEntries(compact.range(std::string("ENTITY-000100"), std::string("ENTITY-000199")),
+                           rows.range(std::string("ENTITY-000100"), std::string("ENTITY-000199"))));
+        assert(compact.range(std::string("ENTITY-000100"), std::string("ENTITY-000199")).size() == 200);
+        assert(sameEntries(compact.prefixRange("ENTITY-0009", "ENTITY-0009"),
+                           rows.prefixRange("ENTITY-0009", "ENTITY-0009")));
+        assert(compact.prefixRange("", "").size() == static_cast<size_t>(N));
+
+        uint64_t offset, seq;
+        assert(compact.searchFirstString("ENTITY-000000", offset, seq));
+        assert(seq == 1 && offset == 64);
+        IndexEntry entry;
+        assert(compact.searchFirst(std::string("ENTITY-000499"), entry));
+        assert(std::get<std::string>(entry.key) == "ENTITY-000499" && entry.dataLength == 0);
+
+        // (key, sequence) pairs are unique, as in the row layout
+        bool threw = false;
+        try {
+            compact.insert(std::string("ENTITY-000123"), 0, 0, dup[0].sequence);
+        } catch (const std::runtime_error&) {
+            threw = true;
+        }
+        assert(threw);
+
+        // Front coding and delta-coded postings take less room than rows
+        assert(compact.getStorageBytes() * 2 < rows.getStorageBytes());
+
+        compact.clear();
+        assert(compact.all().empty() && compact.getStorageBytes() == 0);
+    }
+
     sqlite3_close(db);
 
     std::cout << "SQLite-backed index tests passed!" << std::endl;
 }
 
+static std::string encodeKey(ValueType type, const Value& v,
+                             KeyCodec::Bound bound = KeyCodec::Bound::Exact) {
+    std::string out;
+    bool ok = KeyCodec::append(type, v, out, bound);
+    assert(ok);
+    return out;
+}
+
+void testKeyCodec() {
+    std::cout << "Testing key codec..." << std::endl;
+
+    // Encodings sort like the values under memcmp (std::string compare)
+    std::vector<int64_t> ints = {INT64_MIN, -1000000, -1, 0, 1, 255, 256, 1000000, INT64_MAX};
+    for (size_t i = 1; i < ints.size(); i++) {
+        assert(encodeKey(ValueType::Int64, ints[i - 1]) < encodeKey(ValueType::Int64, ints[i]));
+    }
+    std::vector<uint64_t> uints = {0, 1, 0x7FFFFFFFFFFFFFFFull, 0x8000000000000000ull, UINT64_MAX};
+    for (size_t i = 1; i < uints.size(); i++) {
+        assert(encodeKey(ValueType::UInt64, uints[i - 1]) < encodeKey(ValueType::UInt64, uints[i]));
+    }
+    std::vector<double> doubles = {-INFINITY, -1e300, -2.5, -1.0, -1e-300, 0.0, 1e-300, 1.0, 2.5, 1e300, INFINITY, NAN};
+    for (size_t i = 1; i < doubles.size(); i++) {
+        assert(encodeKey(ValueType::Float64, doubles[i - 1]) < encodeKey(ValueType::Float64, doubles[i]));
+    }
+    assert(encodeKey(ValueType::Float64, -0.0) == encodeKey(ValueType::Float64, 0.0));
+
+    // Strings with embedded 0x00 / 0xFF keep byte order, and shorter sorts first
+    std::vector<std::string> strs = {"", std::string(1, '\0'), std::string("\0\xFF", 2), "\x01", "a",
+                                     std::string("a\0", 2), "a\x01", "ab", "b", "\xFF", "\xFF\xFF"};
+    for (size_t i = 1; i < strs.size(); i++) {
+        assert(encodeKey(ValueType::String, strs[i - 1]) < encodeKey(ValueType::String, strs[i]));
+    }
+
+    // An encoded prefix is a byte prefix of every longer key's encoding
+    std::string prefix;
+    KeyCodec::appendBytes("ab", 2, prefix, false);
+    assert(encodeKey(ValueType::String, std::string("abc")).compare(0, prefix.size(), prefix) == 0);
+    assert(encodeKey(ValueType::String, std::string("ab")).compare(0, prefix.size(), prefix) == 0);
+
+    // Composite keys order column by column
+    std::vector<ValueType> types = {ValueType::String, ValueType::Int32};
+    std::string c1, c2, c3;
+    assert(KeyCodec::appendComposite(types, {std::string("a"), int32_t(5)}, c1));
+    assert(KeyCodec::appendComposite(types, {std::string("a"), int32_t(10)}, c2));
+    assert(KeyCodec::appendComposite(types, {std::string("ab"), int32_t(-1)}, c3));
+    assert(c1 < c2 && c2 < c3);
+
+    // Round trip, including composites
+    {
+        const uint8_t* p = reinterpret_cast<const uint8_t*>(c3.data());
+        size_t pos = 0;
+        Value a, b;
+        assert(KeyCodec::decode(ValueType::String, p, c3.size(), pos, a));
+        assert(KeyCodec::decode(ValueType::Int32, p, c3.size(), pos, b));
+        assert(pos == c3.size());
+        assert(std::get<std::string>(a) == "ab" && std::get<int32_t>(b) == -1);
+
+        std::string weird("x\0\xFFy", 4);
+        std::string enc = encodeKey(ValueType::String, weird);
+        pos = 0;
+        assert(KeyCodec::decode(ValueType::String, reinterpret_cast<const uint8_t*>(enc.data()), enc.size(), pos, a));
+        assert(std::get<std::string>(a) == weird);
+
+        enc = encodeKey(ValueType::Float64, -2.5);
+        pos = 0;
+        assert(KeyCodec::decode(ValueType::Float64, reinterpret_cast<const uint8_t*>(enc.data()), enc.size(), pos, a));
+        assert(std::get<double>(a) == -2.5);
+    }
+
+    // Probe conversion follows SQLite affinity
+    assert(encodeKey(ValueType::Int32, std::string("42")) == encodeKey(ValueType::Int32, int32_t(42)));
+    assert(encodeKey(ValueType::Int32, 2.5, KeyCodec::Bound::Lower) == encodeKey(ValueType::Int32, int32_t(3)));
+    assert(encodeKey(ValueType::Int32, 2.5, KeyCodec::Bound::Upper) == encodeKey(ValueType::Int32, int32_t(2)));
+    assert(encodeKey(ValueType::String, int64_t(42)) == encodeKey(ValueType::String, std::string("42")));
+    {
+        std::string out;
+        assert(!KeyCodec::append(ValueType::Int32, 2.5, out));
+        assert(!KeyCodec::append(ValueType::Int8, int64_t(1000), out));
+        assert(!KeyCodec::append(ValueType::Int32, std::string("abc"), out));
+        assert(!KeyCodec::append(ValueType::String, std::monostate{}, out));
+    }
+    // Integer prefix agrees with memcmp on the first 8 bytes
+    {
+        std::string a = encodeKey(ValueType::Int64, int64_t(-5));
+        std::string b = encodeKey(ValueType::Int64, int64_t(7));
+        assert(KeyCodec::prefix64(reinterpret_cast<const uint8_t*>(a.data()), a.size()) <
+               KeyCodec::prefix64(reinterpret_cast<const uint8_t*>(b.data()), b.size()));
+    }
+
+    // uint64 keys above INT64_MAX sort after the small ones in an index
+    sqlite3* db;
+    int rc = sqlite3_open(":memory:", &db);
+    assert(rc == SQLITE_OK);
+    {
+        SqliteIndex index(db, "codec", "u", ValueType::UInt64);
+        index.insert(UINT64_MAX, 300, 10, 3);
+        index.insert(uint64_t(1), 100, 10, 1);
+        index.insert(uint64_t(0x8000000000000000ull), 200, 10, 2);
+
+        auto all = index.all();
+        assert(all.size() == 3);
+        assert(all[0].dataOffset == 100 && all[1].dataOffset == 200 && all[2].dataOffset == 300);
+        assert(std::get<uint64_t>(all[2].key) == UINT64_MAX);
+
+        auto upper = index.range(uint64_t(2), UINT64_MAX);
+        assert(upper.size() == 2);
+        assert(index.search(int64_t(-1)).empty());
+    }
+    {
+        SqliteIndex index(db, "codec", "d", ValueType::Float64);
+        index.insert(-3.5, 1, 1, 1);
+        index.insert(-0.0, 2, 1, 2);
+        index.insert(2.0, 3, 1, 3);
+        assert(index.search(0.0).size() == 1);
+        assert(index.search(int32_t(2)).size() == 1);
+        auto neg = index.range(-10.0, -1.0);
+        assert(neg.size() == 1 && std::get<double>(neg[0].key) == -3.5);
+    }
+    sqlite3_close(db);
+
+    std::cout << "Key codec tests passed!" << std::endl;
+}
+
+// Fake record for SQL tests: [root offset][file_id "CATS"][name bytes...]
+static std::vector<uint8_t> makeNamedRecord(const std::string& name) {
+    std::vector<uint8_t> data = {0x08, 0x00, 0x00, 0x00, 'C', 'A', 'T', 'S'};
+    data.insert(data.end(), name.begin(), name.end());
+    return data;
+}
+
+static Value extractNamedRecord(const uint8_t* data, size_t length, const std::string& fieldName) {
+    if (fieldName != "name" || length < 8) return std::monostate{};
+    return std::string(reinterpret_cast<const char*>(data + 8), length - 8);
+}
+
+// Returns the EXPLAIN QUERY PLAN detail for a single-table query
+static std::string queryPlan(FlatSQLDatabase& db, const std::string& sql) {
+    QueryResult plan = db.query("EXPLAIN QUERY PLAN " + sql);
+    std::string detail;
+    for (const auto& row : plan.rows) {
+        if (auto* s = std::get_if<std::string>(&row.back())) detail += *s;
+    }
+    return detail;
+}
+
+void testPatternPushdown() {
+    std::cout << "Testing LIKE/GLOB prefix pushdown..." << std::endl;
+
+    std::string schema = R"(
+        table catalog {
+            name: string (key);
+        }
+    )";
+
+    FlatSQLDatabase db = FlatSQLDatabase::fromSchema(schema, "pattern_test");
+    db.registerFileId("CATS", "catalog");
+    db.setFieldExtractor("catalog", extractNamedRecord);
+
+    std::vector<std::string> names = {
+        "2024-001A", "2024-002B", "2023-117C", "ISS (ZARYA)", "iss deorbit", "Isspace",
+        "STARLINK-1007", "STARLINK-2001", "starlink-x", "OBJECT_A", "OBJECTXA"
+    };
+    for (const auto& name : names) {
+        auto rec = makeNamedRecord(name);
+        db.ingestOne(rec.data(), rec.size());
+    }
+
+    // Anchored patterns use the prefix strategy (4 = LIKE, 5 = GLOB on column 0)
+    assert(queryPlan(db, "SELECT * FROM catalog WHERE name LIKE '2024-%'").find("INDEX 4:") != std::string::npos);
+    assert(queryPlan(db, "SELECT * FROM catalog WHERE name GLOB 'ISS*'").find("INDEX 5:") != std::string::npos);
+    // Leading wildcards can't use the index
+    assert(queryPlan(db, "SELECT * FROM catalog WHERE name LIKE '%LINK%'").find("INDEX 0:") != std::string::npos);
+
+    // LIKE is case-insensitive for ASCII; the residual check is done by SQLite
+    assert(db.query("SELECT * FROM catalog WHERE name LIKE '2024-%'").rowCount() == 2);
+    assert(db.query("SELECT * FROM catalog WHERE name LIKE 'iss%'").rowCount() == 3);
+    assert(db.query("SELECT * FROM catalog WHERE name LIKE 'Starlink-_0%'").rowCount() == 2);
+    assert(db.query("SELECT * FROM catalog WHERE name LIKE 'OBJECT_A'").rowCount() == 2);
+
+    // GLOB is case-sensitive
+    assert(db.query("SELECT * FROM catalog WHERE name GLOB 'ISS*'").rowCount() == 1);
+    assert(db.query("SELECT * FROM catalog WHERE name GLOB 'STARLINK-[12]*'").rowCount() == 2);
+
+    // Bound patterns, including one that turns out not to be anchored
+    assert(db.query("SELECT * FROM catalog WHERE name LIKE ?", {Value(std::string("2023%"))}).rowCount() == 1);
+    assert(db.query("SELECT * FROM catalog WHERE name LIKE ?", {Value(std::string("%a%"))}).rowCount() == 8);
+    assert(db.query("SELECT * FROM catalog WHERE name LIKE ?", {Value()}).rowCount() == 0);
+
+    // Tombstoned records are skipped
+    QueryResult iss = db.query("SELECT _rowid FROM catalog WHERE name GLOB 'ISS*'");
+    assert(iss.rowCount() == 1);
+    db.markDeleted("catalog", static_cast<uint64_t>(std::get<int64_t>(iss.rows[0][0])));
+    assert(db.query("SELECT * FROM catalog WHERE name LIKE 'iss%'").rowCount() == 2);
+
+    std::cout << "LIKE/GLOB prefix pushdown tests passed!" << std::endl;
+}
+
+// Fake record for learned index tests: [root offset][file_id "TICK"][epoch double]
+static std::vector<uint8_t> makeTickRecord(double epoch) {
+    std::vector<uint8_t> data = {0x08, 0x00, 0x00, 0x00, 'T', 'I', 'C', 'K'};
+    data.resize(8 + sizeof(double));
+    std::memcpy(data.data() + 8, &epoch, sizeof(double));
+    return data;
+}
+
+static Value extractTickRecord(const uint8_t* data, size_t length, const std::string& fieldName) {
+    if (fieldName != "epoch" || length < 8 + sizeof(double)) return std::monostate{};
+    double epoch;
+    std::memcpy(&epoch, data + 8, sizeof(double));
+    return epoch;
+}
+
+void testLearnedIndex() {
+    std::cout << "Testing learned index..." << std::endl;
+
+    // Nearly sorted keys with duplicates and late arrivals, checked against
+    // a brute-force multimap for every lookup
+    {
+        LearnedIndex index("ts", ValueType::Int64, 8);
+        std::multimap<int64_t, uint64_t> expected;
+        std::mt19937 rng(7);
+        int64_t key = -5000;
+        for (uint64_t seq = 1; seq <= 20000; seq++) {
+            key += rng() % 4;  // Steps of 0-3, so runs of duplicates
+            int64_t k = (rng() % 50 == 0) ? key - static_cast<int64_t>(rng() % 500) : key;
+            index.insert(k, seq * 10, seq);
+            expected.emplace(k, seq);
+        }
+        assert(index.getEntryCount() == 20000);
+        assert(index.getSegmentCount() < 200);
+
+        for (int i = 0; i < 2000; i++) {
+            int64_t probe = -5100 + static_cast<int64_t>(rng() % 31000);
+            auto hits = index.search(probe);
+            assert(hits.size() == expected.count(probe));
+            for (size_t j = 1; j < hits.size(); j++) assert(hits[j - 1].sequence < hits[j].sequence);
+            IndexEntry first;
+            assert(index.searchFirst(probe, first) == !hits.empty());
+            if (!hits.empty()) assert(first.sequence == hits[0].sequence && first.dataOffset == first.sequence * 10);
+
+            int64_t hi = probe + static_cast<int64_t>(rng() % 300);
+            auto range = index.range(probe, hi);
+            size_t count = std::distance(expected.lower_bound(probe), expected.upper_bound(hi));
+            assert(range.size() == count);
+            for (size_t j = 1; j < range.size(); j++) {
+                assert(std::get<int64_t>(range[j - 1].key) <= std::get<int64_t>(range[j].key));
+            }
+        }
+        assert(index.all().size() == 20000);
+    }
+
+    // A straight line needs one segment; exclusive bounds and probe conversion
+    {
+        LearnedIndex index("seq", ValueType::Int64);
+        for (int64_t k = 0; k < 10000; k++) index.insert(k * 5, static_cast<uint64_t>(k), static_cast<uint64_t>(k));
+        assert(index.getSegmentCount() == 1);
+        using Op = LearnedIndex::Op;
+        assert(index.query({{Op::Gt, int64_t(10)}, {Op::Lt, int64_t(30)}}).size() == 3);   // 15, 20, 25
+        assert(index.query({{Op::Ge, int64_t(10)}, {Op::Le, int64_t(30)}}).size() == 5);
+        assert(index.query({{Op::Gt, 9.5}, {Op::Lt, 30.5}}).size() == 5);                  // 10..30
+        assert(index.query({{Op::Ge, std::string("49990")}}).size() == 2);                 // Numeric text
+        assert(index.query({{Op::Gt, std::string("abc")}}).empty());                       // Text sorts after numbers
+        assert(index.query({{Op::Eq, Value()}}).empty());
+        assert(index.query({{Op::Gt, int64_t(100)}, {Op::Lt, int64_t(50)}}).empty());
+        assert(index.search(12.5).empty());
+        assert(index.search(15.0).size() == 1);
+        assert(index.getModelBytes() < index.getMemoryBytes());
+    }
+
+    // Float keys keep their order across the sign, -0 is +0
+    {
+        LearnedIndex index("epoch", ValueType::Float64);
+        index.insert(-2.5, 1, 1);
+        index.insert(-0.0, 2, 2);
+        index.insert(1.25, 3, 3);
+        index.insert(-7.0, 4, 4);  // Late
+        auto all = index.all();
+        assert(all.size() == 4);
+        assert(std::get<double>(all[0].key) == -7.0 && std::get<double>(all[3].key) == 1.25);
+        assert(index.search(0.0).size() == 1);
+        assert(index.range(-3.0, 0.0).size() == 2);
+        assert(index.query({{LearnedIndex::Op::Gt, 0.0}}).size() == 1);
+    }
+
+    bool threw = false;
+    try {
+        LearnedIndex index("name", ValueType::String);
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    assert(threw);
+
+    // SQL pushdown: strategy 10 serves equality and ranges on the column
+    std::string schema = R"(
+        table ticks {
+            epoch: double;
+        }
+    )";
+    FlatSQLDatabase db = FlatSQLDatabase::fromSchema(schema, "learned_test");
+    db.registerFileId("TICK", "ticks");
+    db.setFieldExtractor("ticks", extractTickRecord);
+
+    for (int i = 0; i < 500; i++) {
+        double epoch = 2460000.5 + i / 1440.0;
+        if (i % 37 == 36) epoch -= 0.01;  // A late observation
+        auto rec = makeTickRecord(epoch);
+        db.ingestOne(rec.data(), rec.size());
+    }
+    size_t before = db.query("SELECT * FROM ticks WHERE epoch >= 2460000.6 AND epoch < 2460000.7").rowCount();
+    assert(queryPlan(db, "SELECT * FROM ticks WHERE epoch > 2460000.6").find("INDEX 0:") != std::string::npos);
+
+    db.createLearnedIndex("ticks", "epoch");
+    assert(queryPlan(db, "SELECT * FROM ticks WHERE epoch > 2460000.6").find("INDEX 10:>") != std::string::npos);
+    assert(queryPlan(db, "SELECT * FROM ticks WHERE epoch = ?").find("INDEX 10:=") != std::string::npos);
+    assert(db.query("SELECT * FROM ticks WHERE epoch >= 2460000.6 AND epoch < 2460000.7").rowCount() == before);
+
+    double target = 2460000.5 + 100 / 1440.0;
+    QueryResult hit = db.query("SELECT _rowid FROM ticks WHERE epoch = ?", {Value(target)});
+    assert(hit.rowCount() == 1);
+    assert(db.findByIndex("ticks", "epoch", target).size() == 1);
+
+    // Rows ingested after creation are indexed; tombstones are skipped
+    auto rec = makeTickRecord(target);
+    db.ingestOne(rec.data(), rec.size());
+    assert(db.query("SELECT * FROM ticks WHERE epoch = ?", {Value(target)}).rowCount() == 2);
+    db.markDeleted("ticks", static_cast<uint64_t>(std::get<int64_t>(hit.rows[0][0])));
+    assert(db.query("SELECT * FROM ticks WHERE epoch = ?", {Value(target)}).rowCount() == 1);
+
+    auto stats = db.getStats();
+    assert(stats.size() == 1 && stats[0].indexStats.size() == 1);
+    assert(stats[0].indexStats[0].learned && stats[0].indexStats[0].entryCount == 501);
+
+    std::cout << "Learned index tests passed!" << std::endl;
+}
+
+void testRadixIndex() {
+    std::cout << "Testing radix index..." << std::endl;
+
+    // Random keys over a tiny alphabet (long shared prefixes, embedded 0x00 and
+    // 0xFF) and over all 256 bytes (nodes grow to 256 children), checked
+    // against a brute-force multimap for every lookup
+    for (int alphabet : {3, 256}) {
+        RadixIndex index("id", ValueType::String);
+        std::multimap<std::string, uint64_t> expected;
+        std::mt19937 rng(alphabet);
+        auto randomKey = [&]() {
+            std::string key(rng() % 24, '\0');
+            for (auto& c : key) c = static_cast<char>(alphabet == 3 ? "\0a\xFF"[rng() % 3] : rng() % 256);
+            return key;
+        };
+        for (uint64_t seq = 1; seq <= 5000; seq++) {
+            std::string key = randomKey();
+            index.insert(key, seq * 10, seq);
+            expected.emplace(key, seq);
+        }
+        assert(index.getEntryCount() == 5000);
+
+        for (int i = 0; i < 500; i++) {
+            std::string probe = randomKey();
+            auto existing = expected.lower_bound(probe);
+            if (i % 2 && existing != expected.end()) probe = existing->first;
+            auto hits = index.search(probe);
+            assert(hits.size() == expected.count(probe));
+            for (size_t j = 1; j < hits.size(); j++) assert(hits[j - 1].sequence < hits[j].sequence);
+            uint64_t offset = 0, sequence = 0;
+            assert(index.searchFirstString(probe, offset, sequence) == !hits.empty());
+            if (!hits.empty()) assert(sequence == hits[0].sequence && offset == sequence * 10);
+
+            std::string hi = randomKey();
+            if (hi < probe) std::swap(hi, probe);
+            auto range = index.range(probe, hi);
+            assert(range.size() == static_cast<size_t>(std::distance(expected.lower_bound(probe), expected.upper_bound(hi))));
+            for (size_t j = 1; j < range.size(); j++) {
+                assert(std::get<std::string>(range[j - 1].key) <= std::get<std::string>(range[j].key));
+            }
+            auto open = index.query({{RadixIndex::Op::Gt, probe}, {RadixIndex::Op::Lt, hi}});
+            size_t count = probe < hi ? std::distance(expected.upper_bound(probe), expected.lower_bound(hi)) : 0;
+            assert(open.size() == count);
+
+            std::string prefix = probe.substr(0, probe.size() / 2);
+            size_t withPrefix = 0;
+            for (auto it = expected.lower_bound(prefix); it != expected.end() && it->first.compare(0, prefix.size(), prefix) == 0; ++it) {
+                withPrefix++;
+            }
+            assert(index.prefixRange(prefix, prefix).size() == withPrefix);
+        }
+        auto all = index.all();
+        assert(all.size() == 5000 && std::get<std::string>(all.front().key) == expected.begin()->first);
+    }
+
+    // Shared prefixes longer than a node holds inline, split at every depth
+    {
+        RadixIndex index("email", ValueType::String);
+        std::string domain = "@operations.spacecraft-catalog.example.org";
+        for (int i = 0; i < 1000; i++) {
+            index.insert("user" + std::to_string(i) + domain, static_cast<uint64_t>(i), static_cast<uint64_t>(i));
+        }
+        index.insert(std::string("user1") + domain, 9999, 1000);  // Duplicate
+        assert(index.getKeyCount() == 1000 && index.getEntryCount() == 1001);
+        assert(index.search(std::string("user1") + domain).size() == 2);
+        assert(index.search(std::string("user1")).empty());
+        assert(index.prefixRange("user1", "user1").size() == 112);  // user1, user10-19, user100-199, + dup
+        assert(index.query({{RadixIndex::Op::Ge, std::string("user998")}}).size() == 4);  // user998, user999, user99@, user9@
+        assert(index.query({{RadixIndex::Op::Eq, Value()}}).empty());
+        assert(index.getNodeCount() < index.getKeyCount());
+        index.clear();
+        assert(index.getEntryCount() == 0 && index.all().empty() && index.getMemoryBytes() == 0);
+    }
+
+    bool threw = false;
+    try {
+        RadixIndex index("epoch", ValueType::Float64);
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    assert(threw);
+
+    // SQL pushdown: strategy 10 serves comparisons and 4/5 serve LIKE/GLOB
+    // on a column with no B-tree index
+    std::string schema = R"(
+        table catalog {
+            name: string;
+        }
+    )";
+    FlatSQLDatabase db = FlatSQLDatabase::fromSchema(schema, "radix_test");
+    db.registerFileId("CATS", "catalog");
+    db.setFieldExtractor("catalog", extractNamedRecord);
+
+    std::vector<std::string> names = {
+        "STARLINK-1007", "STARLINK-2001", "starlink-x", "ISS (ZARYA)", "iss deorbit", "2024-001A"
+    };
+    for (const auto& name : names) {
+        auto rec = makeNamedRecord(name);
+        db.ingestOne(rec.data(), rec.size());
+    }
+    assert(queryPlan(db, "SELECT * FROM catalog WHERE name = 'ISS (ZARYA)'").find("INDEX 0:") != std::string::npos);
+
+    db.createRadixIndex("catalog", "name");
+    assert(queryPlan(db, "SELECT * FROM catalog WHERE name = ?").find("INDEX 10:=") != std::string::npos);
+    assert(queryPlan(db, "SELECT * FROM catalog WHERE name > 'S'").find("INDEX 10:>") != std::string::npos);
+    assert(queryPlan(db, "SELECT * FROM catalog WHERE name LIKE 'star%'").find("INDEX 4:") != std::string::npos);
+    assert(queryPlan(db, "SELECT * FROM catalog WHERE name GLOB 'STAR*'").find("INDEX 5:") != std::string::npos);
+
+    assert(db.query("SELECT * FROM catalog WHERE name = 'ISS (ZARYA)'").rowCount() == 1);
+    assert(db.query("SELECT * FROM catalog WHERE name >= 'STARLINK' AND name < 'a'").rowCount() == 2);
+    assert(db.query("SELECT * FROM catalog WHERE name LIKE 'star%'").rowCount() == 3);
+    assert(db.query("SELECT * FROM catalog WHERE name GLOB 'STAR*'").rowCount() == 2);
+
+    // Rows ingested after creation are indexed; the raw lookup uses the tree
+    auto rec = makeNamedRecord("2024-001A");
+    db.ingestOne(rec.data(), rec.size());
+    assert(db.findByIndex("catalog", "name", std::string("2024-001A")).size() == 2);
+    uint32_t length = 0;
+    const uint8_t* raw = db.findRawByIndex("catalog", "name", std::string("iss deorbit"), &length);
+    assert(raw && length == 8 + 11 && std::memcmp(raw + 8, "iss deorbit", 11) == 0);
+    assert(!db.findRawByIndex("catalog", "name", std::string("iss"), &length));
+
+    auto stats = db.getStats();
+    assert(stats.size() == 1 && stats[0].indexStats.size() == 1);
+    assert(stats[0].indexStats[0].radix && stats[0].indexStats[0].entryCount == 7);
+
+    std::cout << "Radix index tests passed!" << std::endl;
+}
+
+void testRecordRefs() {
+    std::cout << "Testing zero-copy record visitors..." << std::endl;
+
+    // Same rows in three tables: scanned, B-tree indexed and radix indexed
+    std::string schema = R"(
+        table plain {
+            name: string;
+        }
+        table keyed {
+            name: string (key);
+        }
+    )";
+    FlatSQLDatabase db = FlatSQLDatabase::fromSchema(schema, "refs_test");
+    db.registerFileId("CATS", "plain");
+    db.setFieldExtractor("plain", extractNamedRecord);
+    FlatSQLDatabase keyed = FlatSQLDatabase::fromSchema(schema, "refs_test");
+    keyed.registerFileId("CATS", "keyed");
+    keyed.setFieldExtractor("keyed", extractNamedRecord);
+    FlatSQLDatabase radix = FlatSQLDatabase::fromSchema(schema, "refs_test");
+    radix.registerFileId("CATS", "plain");
+    radix.setFieldExtractor("plain", extractNamedRecord);
+    radix.createRadixIndex("plain", "name");
+
+    for (int i = 0; i < 300; i++) {
+        auto rec = makeNamedRecord("SAT-" + std::to_string(100 + i % 150));
+        db.ingestOne(rec.data(), rec.size());
+        keyed.ingestOne(rec.data(), rec.size());
+        radix.ingestOne(rec.data(), rec.size());
+    }
+
+    struct Probe { FlatSQLDatabase* db; const char* table; };
+    for (Probe probe : {Probe{&db, "plain"}, Probe{&keyed, "keyed"}, Probe{&radix, "plain"}}) {
+        std::vector<uint64_t> sequences;
+        size_t n = probe.db->forEachByIndex(probe.table, "name", std::string("SAT-120"),
+            [&](const StreamingFlatBufferStore::RecordRef& ref) {
+                assert(ref.length == 8 + 7 && std::memcmp(ref.data + 8, "SAT-120", 7) == 0);
+                sequences.push_back(ref.sequence);
+                return true;
+            });
+        assert(n == 2 && sequences.size() == 2 && sequences[0] + 150 == sequences[1]);
+
+        // Ranges visit in key order and match the copying API
+        std::string last;
+        n = probe.db->forEachByRange(probe.table, "name", std::string("SAT-200"), std::string("SAT-209"),
+            [&](const StreamingFlatBufferStore::RecordRef& ref) {
+                std::string name(reinterpret_cast<const char*>(ref.data + 8), ref.length - 8);
+                assert(name >= "SAT-200" && name <= "SAT-209");
+                if (std::strcmp(probe.table, "keyed") == 0 || probe.db == &radix) assert(name >= last);
+                last = name;
+                return true;
+            });
+        assert(n == 20);
+
+        // Returning false stops the walk
+        n = probe.db->scanRefs(probe.table, [](const StreamingFlatBufferStore::RecordRef&) { return false; });
+        assert(n == 1);
+        n = probe.db->scanRefs(probe.table, [](const StreamingFlatBufferStore::RecordRef&) { return true; });
+        assert(n == 300);
+        assert(probe.db->forEachByIndex("missing", "name", std::string("SAT-120"),
+            [](const StreamingFlatBufferStore::RecordRef&) { return true; }) == 0);
+    }
+
+    // The copying API on an unindexed column copies only the matches
+    auto copies = db.findByIndex("plain", "name", std::string("SAT-120"));
+    assert(copies.size() == 2);
+    for (const auto& record : copies) {
+        assert(record.header.fileId == "CATS" && record.header.dataLength == record.data.size());
+    }
+
+    // Index hits without a data copy still report the stored length
+    auto hits = keyed.findByIndex("keyed", "name", std::string("SAT-120"));
+    assert(hits.size() == 1 && hits[0].data.empty() && hits[0].header.dataLength == 8 + 7);
+    StoredRecord one;
+    assert(keyed.findOneByIndex("keyed", "name", std::string("SAT-120"), one));
+    assert(one.offset == hits[0].offset && one.header.dataLength == 8 + 7);
+
+    std::cout << "Zero-copy record visitor tests passed!" << std::endl;
+}
+
+void testBatchedLookup() {
+    std::cout << "Testing batched point lookups..." << std::endl;
+
+    std::string schema = R"(
+        table plain {
+            name: string;
+        }
+        table keyed {
+            name: string (key);
+        }
+    )";
+    FlatSQLDatabase keyed = FlatSQLDatabase::fromSchema(schema, "batch_test");
+    keyed.registerFileId("CATS", "keyed");
+    keyed.setFieldExtractor("keyed", extractNamedRecord);
+    FlatSQLDatabase radix = FlatSQLDatabase::fromSchema(schema, "batch_test");
+    radix.registerFileId("CATS", "plain");
+    radix.setFieldExtractor("plain", extractNamedRecord);
+    radix.createRadixIndex("plain", "name");
+
+    for (int i = 0; i < 500; i++) {
+        auto rec = makeNamedRecord("OBJ-" + std::to_string(i));
+        keyed.ingestOne(rec.data(), rec.size());
+        radix.ingestOne(rec.data(), rec.size());
+    }
+
+    // Unsorted keys with repeats, misses and a key of the wrong type
+    std::vector<Value> keys;
+    for (int i = 0; i < 100; i++) {
+        keys.push_back(std::string("OBJ-" + std::to_string((i * 337) % 600)));
+    }
+    keys.push_back(std::string("OBJ-42"));
+    keys.push_back(std::monostate{});
+
+    struct Probe { FlatSQLDatabase* db; const char* table; };
+    for (Probe probe : {Probe{&keyed, "keyed"}, Probe{&radix, "plain"}}) {
+        std::vector<StreamingFlatBufferStore::RecordRef> refs(keys.size());
+        size_t found = probe.db->findRawByIndexBatch(probe.table, "name", keys.data(), keys.size(), refs.data());
+
+        size_t expected = 0;
+        for (size_t i = 0; i < keys.size(); i++) {
+            uint32_t length = 0;
+            uint64_t sequence = 0;
+            const uint8_t* raw = probe.db->findRawByIndex(probe.table, "name", keys[i], &length, &sequence);
+            assert(refs[i].data == raw);
+            if (raw) {
+                expected++;
+                assert(refs[i].length == length && refs[i].sequence == sequence);
+                const auto& name = std::get<std::string>(keys[i]);
+                assert(std::memcmp(refs[i].data + 8, name.data(), name.size()) == 0);
+            }
+        }
+        assert(found == expected && found > 0 && found < keys.size());
+        assert(refs.back().data == nullptr);
+
+        assert(probe.db->findRawByIndexBatch("missing", "name", keys.data(), keys.size(), refs.data()) == 0);
+        assert(refs[0].data == nullptr);
+    }
+
+    std::cout << "Batched point lookup tests passed!" << std::endl;
+}
+
+void testExecuteBatch() {
+    std::cout << "Testing batched SQL execution..." << std::endl;
+
+    std::string schema = R"(
+        table keyed {
+            name: string (key);
+        }
+    )";
+    FlatSQLDatabase db = FlatSQLDatabase::fromSchema(schema, "exec_batch_test");
+    db.registerFileId("CATS", "keyed");
+    db.setFieldExtractor("keyed", extractNamedRecord);
+    for (int i = 0; i < 200; i++) {
+        auto rec = makeNamedRecord("OBJ-" + std::to_string(i % 100));
+        db.ingestOne(rec.data(), rec.size());
+    }
+
+    // Each set's rows match a separate query and arrive tagged in set order
+    std::vector<std::vector<Value>> paramSets;
+    for (int i = 0; i < 50; i++) {
+        paramSets.push_back({std::string("OBJ-" + std::to_string((i * 7) % 120))});
+    }
+    std::vector<size_t> perSet(paramSets.size(), 0);
+    size_t lastIndex = 0;
+    size_t rows = db.executeBatch("SELECT name, _rowid FROM keyed WHERE name = ?", paramSets,
+        [&](size_t batchIndex, const std::vector<Value>& row) {
+            assert(batchIndex >= lastIndex && row.size() == 2);
+            assert(std::get<std::string>(row[0]) == std::get<std::string>(paramSets[batchIndex][0]));
+            lastIndex = batchIndex;
+            perSet[batchIndex]++;
+            return true;
+        });
+    size_t expected = 0;
+    for (size_t i = 0; i < paramSets.size(); i++) {
+        size_t n = db.query("SELECT name, _rowid FROM keyed WHERE name = ?", paramSets[i]).rowCount();
+        assert(perSet[i] == n);
+        expected += n;
+    }
+    assert(rows == expected && rows > 0);
+
+    // The sink can stop the batch; the cached statement stays usable
+    rows = db.executeBatch("SELECT name FROM keyed WHERE name = ?", paramSets,
+        [](size_t, const std::vector<Value>&) { return false; });
+    assert(rows == 1);
+    assert(db.query("SELECT name FROM keyed WHERE name = ?", paramSets[0]).rowCount() == 2);
+
+    bool threw = false;
+    try {
+        db.executeBatch("SELECT nope FROM keyed WHERE name = ?", paramSets,
+            [](size_t, const std::vector<Value>&) { return true; });
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    assert(threw);
+
+    // A throwing sink leaves the statement reset, its bindings cleared
+    threw = false;
+    try {
+        db.executeBatch("SELECT name FROM keyed WHERE name = ?", paramSets,
+            [](size_t, const std::vector<Value>&) -> bool { throw std::runtime_error("sink"); });
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    assert(threw);
+    assert(db.query("SELECT name FROM keyed WHERE name = ?").rowCount() == 0);
+    assert(db.query("SELECT name FROM keyed WHERE name = ?", paramSets[0]).rowCount() == 2);
+
+    std::cout << "Batched SQL execution tests passed!" << std::endl;
+}
+
+void testRecordRangeScan() {
+    std::cout << "Testing rowid/_offset range scans..." << std::endl;
+
+    // Two tables interleaved in one store: each range covers only its table
+    std::string schema = R"(
+        table catalog {
+            name: string;
+        }
+        table ticks {
+            epoch: double;
+        }
+    )";
+    FlatSQLDatabase db = FlatSQLDatabase::fromSchema(schema, "record_range_test");
+    db.registerFileId("CATS", "catalog");
+    db.registerFileId("TICK", "ticks");
+    db.setFieldExtractor("catalog", extractNamedRecord);
+    db.setFieldExtractor("ticks", extractTickRecord);
+    for (int i = 0; i < 300; i++) {
+        auto rec = makeNamedRecord("OBJ-" + std::to_string(i));
+        db.ingestOne(rec.data(), rec.size());
+        auto tick = makeTickRecord(2460000.5 + i);
+        db.ingestOne(tick.data(), tick.size());
+    }
+
+    assert(queryPlan(db, "SELECT * FROM catalog WHERE _rowid > ?").find("INDEX 11:r>") != std::string::npos);
+    assert(queryPlan(db, "SELECT * FROM catalog WHERE rowid >= 5 AND rowid < 9").find("INDEX 11:rgr<") != std::string::npos);
+    assert(queryPlan(db, "SELECT * FROM catalog WHERE _offset BETWEEN 10 AND 99").find("INDEX 11:o") != std::string::npos);
+    assert(queryPlan(db, "SELECT * FROM catalog WHERE rowid = 5").find("INDEX 1:") != std::string::npos);
+
+    // Each pushed-down query returns what the unindexed (+column) form does
+    QueryResult rows = db.query("SELECT _rowid, _offset FROM catalog");
+    assert(rows.rowCount() == 300);
+    int64_t watermark = std::get<int64_t>(rows.rows[250][0]);
+    int64_t offset = std::get<int64_t>(rows.rows[100][1]);
+    std::vector<std::pair<std::string, std::vector<Value>>> cases = {
+        {"_rowid > ?", {watermark}},
+        {"_rowid >= ? AND _rowid <= ?", {watermark - 20, watermark}},
+        {"_rowid < ?", {int64_t(0)}},
+        {"_rowid > ?", {static_cast<double>(watermark) + 0.5}},
+        {"_rowid <= ?", {static_cast<double>(watermark) - 0.5}},
+        {"_rowid = ?", {watermark}},
+        {"_rowid > ?", {std::monostate{}}},
+        {"_offset >= ? AND _rowid < ?", {offset, watermark}},
+        {"_offset < ?", {offset}},
+        {"_offset = ?", {offset}},
+    };
+    for (const auto& [where, params] : cases) {
+        QueryResult pushed = db.query("SELECT _rowid FROM catalog WHERE " + where, params);
+        std::string unindexed = where;
+        for (const char* column : {"_rowid", "_offset"}) {
+            for (size_t at = 0; (at = unindexed.find(column, at)) != std::string::npos; at += 2) {
+                unindexed.insert(at, "+");
+            }
+        }
+        QueryResult scanned = db.query("SELECT _rowid FROM catalog WHERE " + unindexed, params);
+        assert(pushed.rows == scanned.rows);
+    }
+    assert(db.query("SELECT * FROM catalog WHERE _rowid > ?", {watermark}).rowCount() == 49);
+    assert(db.query("SELECT * FROM catalog WHERE _offset = ?", {offset}).rowCount() == 1);
+
+    // Text arguments don't narrow the slice; SQLite compares with column affinity
+    assert(db.query("SELECT * FROM catalog WHERE _rowid > ?", {std::string("10")}).rowCount() ==
+           db.query("SELECT * FROM catalog WHERE _rowid > 10").rowCount());
+
+    // Tombstones inside the slice are skipped
+    db.markDeleted("catalog", static_cast<uint64_t>(watermark) + 2);
+    assert(db.query("SELECT * FROM catalog WHERE _rowid > ?", {watermark}).rowCount() == 48);
+
+    // Full scans resolve rows a batch at a time: a run of tombstones longer
+    // than a batch is skipped, and two cursors over one table keep their own
+    for (uint64_t sequence = 101; sequence <= 181; sequence += 2) {
+        db.markDeleted("catalog", sequence);  // Catalog records have odd sequences
+    }
+    QueryResult live = db.query("SELECT _rowid, name FROM catalog");
+    assert(live.rowCount() == 258);
+    assert(std::get<int64_t>(live.rows[49][0]) == 99 && std::get<int64_t>(live.rows[50][0]) == 183);
+    assert(std::get<std::string>(live.rows[50][1]) == "OBJ-91");
+    assert(db.query("SELECT a._rowid FROM catalog a JOIN catalog b ON +a._rowid = +b._rowid").rowCount() == 258);
+
+    std::cout << "Rowid/_offset range scan tests passed!" << std::endl;
+}
+
+// Run exportSince into a temporary file and read the feed back
+static std::vector<uint8_t> exportFeed(const FlatSQLDatabase& db, uint64_t since, uint64_t& watermark) {
+    FILE* file = std::tmpfile();
+    assert(file);
+    watermark = db.exportSince(since, fileno(file));
+    std::vector<uint8_t> feed(static_cast<size_t>(std::ftell(file)));
+    std::rewind(file);
+    assert(std::fread(feed.data(), 1, feed.size(), file) == feed.size());
+    std::fclose(file);
+    return feed;
+}
+
+void testChangeFeed() {
+    std::cout << "Testing change feed..." << std::endl;
+
+    std::string schema = R"(
+        table catalog {
+            name: string (key);
+        }
+        table ticks {
+            epoch: double;
+        }
+    )";
+    auto open = [&](const char* name) {
+        FlatSQLDatabase db = FlatSQLDatabase::fromSchema(schema, name);
+        db.registerFileId("CATS", "catalog");
+        db.registerFileId("TICK", "ticks");
+        db.setFieldExtractor("catalog", extractNamedRecord);
+        db.setFieldExtractor("ticks", extractTickRecord);
+        return db;
+    };
+    FlatSQLDatabase leader = open("leader");
+    FlatSQLDatabase follower = open("follower");
+    auto ingestBoth = [&](int from, int to) {
+        for (int i = from; i < to; i++) {
+            auto rec = makeNamedRecord("OBJ-" + std::to_string(i));
+            leader.ingestOne(rec.data(), rec.size());
+            auto tick = makeTickRecord(2460000.5 + i);
+            leader.ingestOne(tick.data(), tick.size());
+        }
+    };
+    auto sameRows = [&](const char* sql) {
+        return leader.query(sql).rows == follower.query(sql).rows;
+    };
+
+    // Initial sync from 0 carries every record; the feed is a sequence
+    // frame and the raw stream
+    ingestBoth(0, 50);
+    uint64_t watermark = 0;
+    std::vector<uint8_t> feed = exportFeed(leader, 0, watermark);
+    std::vector<uint8_t> stream = leader.exportData();
+    assert(watermark == 100 && feed.size() == 20 + stream.size());
+    assert(std::memcmp(feed.data() + 12, "\0\0\0\0\0\0\0\0", 8) == 0);
+    assert(std::equal(stream.begin(), stream.end(), feed.begin() + 20));
+    size_t records = 0;
+    assert(follower.applyChanges(feed.data(), feed.size(), &records) == feed.size() && records == 100);
+    assert(sameRows("SELECT _rowid, name FROM catalog") && sameRows("SELECT _rowid, epoch FROM ticks"));
+
+    // Interleaved deletes and inserts arrive in order
+    leader.markDeleted("catalog", 3);
+    ingestBoth(50, 60);
+    leader.markDeleted("ticks", 110);
+    leader.markDeleted("catalog", 101);
+    ingestBoth(60, 65);
+    uint64_t next = 0;
+    feed = exportFeed(leader, watermark, next);
+    assert(next == 130);
+    std::vector<uint8_t> buffered;
+    assert(leader.exportSince(watermark, buffered) == next && buffered == feed);
+
+    // A partial frame is left for the next call
+    size_t consumed = follower.applyChanges(feed.data(), feed.size() - 3, &records);
+    assert(consumed < feed.size() - 3 && records == 29);
+    consumed += follower.applyChanges(feed.data() + consumed, feed.size() - consumed, &records);
+    assert(consumed == feed.size() && records == 1);
+    assert(sameRows("SELECT _rowid, name FROM catalog") && sameRows("SELECT _rowid, epoch FROM ticks"));
+    assert(follower.getDeletedCount("catalog") == 2 && follower.getDeletedCount("ticks") == 1);
+    assert(follower.query("SELECT * FROM catalog WHERE name = 'OBJ-1'").rowCount() == 0);
+
+    // Nothing new: empty feed; a delete after the watermark resends only the
+    // deletes stamped with it
+    feed = exportFeed(leader, next, watermark);
+    assert(feed.empty() && watermark == next);
+    leader.markDeleted("catalog", 5);
+    feed = exportFeed(leader, next, watermark);
+    assert(watermark == next && follower.applyChanges(feed.data(), feed.size()) == feed.size());
+    assert(follower.getDeletedCount("catalog") == 3 && sameRows("SELECT _rowid, name FROM catalog"));
+
+    // Trimming keeps what feeds from the watermark on need
+    leader.trimChangeFeed(next);
+    feed = exportFeed(leader, next, watermark);
+    assert(!feed.empty() && watermark == next);
+    bool threw = false;
+    try {
+        exportFeed(leader, 100, watermark);
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    assert(threw);
+
+    // A record whose file identifier is a control frame kind is still a record
+    auto lookalike = makeNamedRecord("catalog");
+    std::memcpy(lookalike.data() + 4, FlatSQLDatabase::TOMBSTONE_FILE_ID, 4);
+    leader.ingestOne(lookalike.data(), lookalike.size());
+    feed = exportFeed(leader, next, watermark);
+    assert(follower.applyChanges(feed.data(), feed.size(), &records) == feed.size() && records == 1);
+    assert(follower.getLastSequence() == leader.getLastSequence());
+    assert(follower.getDeletedCount("catalog") == 3);
+
+    // A replica that isn't at the sequence a feed continues from refuses it
+    FlatSQLDatabase stale = open("stale");
+    threw = false;
+    try {
+        stale.applyChanges(feed.data(), feed.size());
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    assert(threw && stale.getLastSequence() == 0);
+
+    std::cout << "Change feed tests passed!" << std::endl;
+}
+
+// Read a whole file (empty if missing)
+static std::vector<uint8_t> readFile(const char* path) {
+    std::vector<uint8_t> bytes;
+    FILE* file = std::fopen(path, "rb");
+    if (!file) return bytes;
+    std::fseek(file, 0, SEEK_END);
+    bytes.resize(static_cast<size_t>(std::ftell(file)));
+    std::rewind(file);
+    assert(std::fread(bytes.data(), 1, bytes.size(), file) == bytes.size());
+    std::fclose(file);
+    return bytes;
+}
+
+static void writeFile(const char* path, const std::vector<uint8_t>& bytes) {
+    FILE* file = std::fopen(path, "wb");
+    assert(file && std::fwrite(bytes.data(), 1, bytes.size(), file) == bytes.size());
+    std::fclose(file);
+}
+
+void testAppendLog() {
+    std::cout << "Testing append log..." << std::endl;
+
+    const char* path = "/tmp/flatsql_append_log_test.wal";
+    std::string schema = R"(
+        table catalog {
+            name: string (key);
+        }
+        table ticks {
+            epoch: double;
+        }
+    )";
+    auto open = [&](const AppendLogOptions& options) {
+        FlatSQLDatabase db = FlatSQLDatabase::fromSchema(schema, "durable");
+        db.registerFileId("CATS", "catalog");
+        db.registerFileId("TICK", "ticks");
+        db.setFieldExtractor("catalog", extractNamedRecord);
+        db.setFieldExtractor("ticks", extractTickRecord);
+        db.openAppendLog(path, options);
+        return db;
+    };
+    auto ingest = [](FlatSQLDatabase& db, int from, int to) {
+        for (int i = from; i < to; i++) {
+            auto rec = makeNamedRecord("OBJ-" + std::to_string(i));
+            db.ingestOne(rec.data(), rec.size());
+            auto tick = makeTickRecord(2460000.5 + i);
+            std::vector<uint8_t> framed(4 + tick.size());
+            uint32_t size = static_cast<uint32_t>(tick.size());
+            std::memcpy(framed.data(), &size, 4);
+            std::memcpy(framed.data() + 4, tick.data(), tick.size());
+            db.ingest(framed.data(), framed.size());
+        }
+    };
+
+    // Every durability mode recovers the same records and deletes
+    for (Durability durability : {Durability::None, Durability::SyncPerBatch, Durability::GroupCommit}) {
+        std::remove(path);
+        AppendLogOptions options;
+        options.durability = durability;
+        std::vector<std::vector<Value>> names;
+        {
+            FlatSQLDatabase db = open(options);
+            assert(db.query("SELECT * FROM catalog").rowCount() == 0);
+            ingest(db, 0, 40);
+            db.markDeleted("catalog", 3);
+            db.markDeleted("ticks", 40);
+            ingest(db, 40, 50);
+            names = db.query("SELECT _rowid, name FROM catalog").rows;
+
+            const AppendLog* log = db.getAppendLog();
+            if (durability == Durability::SyncPerBatch) {
+                assert(log->getSyncCount() == 102);  // 100 ingest calls, 2 deletes
+            } else if (durability == Durability::None) {
+                assert(log->getSyncCount() == 0 && log->getWrittenBytes() > 0);
+            }
+        }  // Destruction writes and syncs the rest
+
+        FlatSQLDatabase reopened = open(options);
+        assert(reopened.getLastSequence() == 100);
+        assert(reopened.query("SELECT _rowid, name FROM catalog").rows == names);
+        assert(reopened.query("SELECT * FROM ticks").rowCount() == 49);
+        assert(reopened.getDeletedCount("catalog") == 1 && reopened.getDeletedCount("ticks") == 1);
+        assert(reopened.query("SELECT * FROM catalog WHERE name = 'OBJ-1'").rowCount() == 0);
+    }
+
+    // Group commit syncs in the background without an explicit sync
+    {
+        std::remove(path);
+        AppendLogOptions options;
+        options.groupCommitMs = 5;
+        FlatSQLDatabase db = open(options);
+        ingest(db, 0, 10);
+        for (int i = 0; i < 400 && db.getAppendLog()->getSyncCount() == 0; i++) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        }
+        assert(db.getAppendLog()->getSyncCount() > 0);
+        assert(readFile(path).size() == db.getAppendLog()->getWrittenBytes());
+    }
+
+    // A torn or corrupt tail is cut off; appends continue after the last intact frame
+    {
+        std::remove(path);
+        AppendLogOptions options;
+        options.durability = Durability::SyncPerBatch;
+        {
+            FlatSQLDatabase db = open(options);
+            ingest(db, 0, 5);
+        }
+        std::vector<uint8_t> intact = readFile(path);
+
+        std::vector<uint8_t> torn = intact;
+        torn.resize(torn.size() - 3);
+        writeFile(path, torn);
+        uint64_t dropped = 0;
+        std::vector<uint8_t> payloads = AppendLog::recover(path, &dropped);
+        assert(dropped > 0 && dropped < intact.size());
+        assert(readFile(path).size() == intact.size() - 3 - dropped);
+
+        std::vector<uint8_t> corrupt = intact;
+        corrupt[corrupt.size() - 1] ^= 0x5A;
+        writeFile(path, corrupt);
+        {
+            FlatSQLDatabase db = open(options);
+            assert(db.getLastSequence() == 9);
+            ingest(db, 5, 6);
+        }
+        FlatSQLDatabase reopened = open(options);
+        assert(reopened.getLastSequence() == 11);
+        assert(reopened.query("SELECT * FROM catalog WHERE name = 'OBJ-5'").rowCount() == 1);
+    }
+
+    // The log must start with the database
+    {
+        FlatSQLDatabase db = FlatSQLDatabase::fromSchema(schema, "late");
+        db.registerFileId("CATS", "catalog");
+        auto rec = makeNamedRecord("OBJ");
+        db.ingestOne(rec.data(), rec.size());
+        bool threw = false;
+        try {
+            db.openAppendLog(path);
+        } catch (const std::runtime_error&) {
+            threw = true;
+        }
+        assert(threw && db.getAppendLog() == nullptr);
+    }
+    assert(AppendLog::recover("/tmp/flatsql_missing.wal").empty());
+    std::remove(path);
+
+    std::cout << "Append log tests passed!" << std::endl;
+}
+
+void testChecksums() {
+    std::cout << "Testing CRC32C checksums..." << std::endl;
+
+    // Known value, and agreement with a bitwise reference at every length
+    // and alignment (covers the hardware and table paths' tails)
+    const char* check = "123456789";
+    assert(crc32c(reinterpret_cast<const uint8_t*>(check), 9) == 0xE3069283);
+    auto reference = [](const uint8_t* data, size_t length) {
+        uint32_t crc = 0xFFFFFFFF;
+        for (size_t i = 0; i < length; i++) {
+            crc ^= data[i];
+            for (int j = 0; j < 8; j++) crc = (crc >> 1) ^ (0x82F63B78 & -(crc & 1));
+        }
+        return ~crc;
+    };
+    std::vector<uint8_t> bytes(4096);
+    std::mt19937 rng(7);
+    for (auto& b : bytes) b = static_cast<uint8_t>(rng());
+    for (size_t offset = 0; offset < 8; offset++) {
+        for (size_t length = 0; length < 80; length++) {
+            assert(crc32c(bytes.data() + offset, length) == reference(bytes.data() + offset, length));
+        }
+    }
+    assert(crc32c(bytes.data(), bytes.size()) == reference(bytes.data(), bytes.size()));
+    assert(crc32c(bytes.data() + 1000, 3096, crc32c(bytes.data(), 1000)) == crc32c(bytes.data(), bytes.size()));
+
+    std::string schema = R"(
+        table catalog {
+            name: string (key);
+        }
+        table ticks {
+            epoch: double;
+        }
+    )";
+    auto open = [&](const char* name) {
+        FlatSQLDatabase db = FlatSQLDatabase::fromSchema(schema, name);
+        db.registerFileId("CATS", "catalog");
+        db.registerFileId("TICK", "ticks");
+        db.setFieldExtractor("catalog", extractNamedRecord);
+        db.setFieldExtractor("ticks", extractTickRecord);
+        return db;
+    };
+    FlatSQLDatabase source = open("source");
+    for (int i = 0; i < 1000; i++) {
+        auto rec = makeNamedRecord("OBJ-" + std::to_string(i));
+        source.ingestOne(rec.data(), rec.size());
+        auto tick = makeTickRecord(2460000.5 + i);
+        source.ingestOne(tick.data(), tick.size());
+    }
+    std::vector<uint8_t> raw = source.exportData();
+
+    // Checksummed exports reload to the same rows and sequences
+    source.setExportChecksums(4096);
+    std::vector<uint8_t> checked = source.exportData();
+    assert(checked.size() > raw.size() && checked.size() < raw.size() + 16 * (raw.size() / 4096 + 3));
+    {
+        FlatSQLDatabase copy = open("copy");
+        copy.loadAndRebuild(checked.data(), checked.size());
+        assert(copy.getLastSequence() == source.getLastSequence());
+        assert(copy.query("SELECT _rowid, name FROM catalog").rows == source.query("SELECT _rowid, name FROM catalog").rows);
+        assert(copy.query("SELECT * FROM catalog WHERE name = 'OBJ-777'").rowCount() == 1);
+    }
+
+    // Corrupt or truncated exports are rejected before anything is loaded
+    auto rejects = [&](const std::vector<uint8_t>& stream) {
+        FlatSQLDatabase copy = open("rejected");
+        try {
+            copy.loadAndRebuild(stream.data(), stream.size());
+        } catch (const std::runtime_error&) {
+            return copy.getLastSequence() == 0;
+        }
+        return false;
+    };
+    std::vector<uint8_t> corrupt = checked;
+    corrupt[corrupt.size() / 2] ^= 0x01;
+    assert(rejects(corrupt));
+    std::vector<uint8_t> truncated(checked.begin(), checked.end() - 16);
+    assert(rejects(truncated));
+
+    // Replicas apply only verified blocks of a checksummed change feed
+    source.markDeleted("catalog", 3);
+    uint64_t watermark = 0;
+    std::vector<uint8_t> feed = exportFeed(source, 0, watermark);
+    FlatSQLDatabase replica = open("replica");
+    size_t records = 0;
+    size_t consumed = replica.applyChanges(feed.data(), feed.size() - 16, &records);
+    assert(consumed < feed.size() - 16 && records > 0 && records < 2000);
+    assert(replica.getDeletedCount("catalog") == 0);  // The tombstone is in the last block
+    size_t rest = replica.applyChanges(feed.data() + consumed, feed.size() - consumed, &records);
+    assert(consumed + rest == feed.size());
+    assert(replica.getLastSequence() == 2000 && replica.getDeletedCount("catalog") == 1);
+    assert(replica.query("SELECT _rowid, name FROM catalog").rows == source.query("SELECT _rowid, name FROM catalog").rows);
+
+    auto tick = makeTickRecord(1.0);
+    source.ingestOne(tick.data(), tick.size());
+    feed = exportFeed(source, watermark, watermark);
+    feed[20] ^= 0x80;
+    bool threw = false;
+    try {
+        replica.applyChanges(feed.data(), feed.size());
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    assert(threw && replica.getLastSequence() == 2000);
+
+    std::cout << "CRC32C checksum tests passed!" << std::endl;
+}
+
+// A FlatBuffer of table { name: string; epoch: double; } with file
+// identifier SATS, laid out as flatc's builder would
+static std::vector<uint8_t> makeSatRecord(const std::string& name, double epoch) {
+    std::vector<uint8_t> b(36 + (name.size() + 1 + 3) / 4 * 4, 0);
+    auto put16 = [&](size_t at, uint16_t v) { std::memcpy(&b[at], &v, 2); };
+    auto put32 = [&](size_t at, uint32_t v) { std::memcpy(&b[at], &v, 4); };
+    put32(0, 16);                                            // Root table
+    std::memcpy(&b[4], "SATS", 4);
+    put16(8, 8); put16(10, 16); put16(12, 4); put16(14, 8);  // vtable: sizes, name, epoch
+    put32(16, 8);                                            // Table -> vtable
+    put32(20, 12);                                           // name -> string at 32
+    std::memcpy(&b[24], &epoch, 8);
+    put32(32, static_cast<uint32_t>(name.size()));
+    std::memcpy(&b[36], name.data(), name.size());
+    return b;
+}
+
+static Value extractSatRecord(const uint8_t* data, size_t length, const std::string& fieldName) {
+    if (fieldName == "epoch") {
+        double epoch;
+        return fbReadRootScalar<double>(data, length, 1, 0.0, epoch) ? Value(epoch) : Value();
+    }
+    uint32_t pos;
+    if (fieldName != "name" || !fbRootFieldPosition(data, length, 0, pos) || pos == 0) return std::monostate{};
+    uint32_t target, len;
+    std::memcpy(&target, data + pos, 4);
+    std::memcpy(&len, data + pos + target, 4);
+    return std::string(reinterpret_cast<const char*>(data + pos + target + 4), len);
+}
+
+void testIngestVerification() {
+    std::cout << "Testing ingest verification..." << std::endl;
+
+    FlatSQLDatabase db = FlatSQLDatabase::fromSchema(R"(
+        table sats {
+            name: string (key);
+            epoch: double;
+        }
+    )", "verified");
+    db.registerFileId("SATS", "sats");
+    db.setFieldExtractor("sats", extractSatRecord);
+    const TableDef& table = *db.getTableDef("sats");
+
+    // Schema-driven checks
+    auto good = makeSatRecord("ISS (ZARYA)", 2460000.5);
+    assert(fbVerifyRootTable(good.data(), good.size(), table));
+    auto badRoot = good;
+    badRoot[0] = 0xF0;
+    auto badVtable = good;
+    badVtable[16] = 0x7F;
+    auto longString = good;
+    longString[32] = 0xFF;
+    auto unterminated = good;
+    unterminated[36 + 11] = 'X';
+    auto shortTable = good;
+    shortTable[10] = 12;  // epoch no longer inside the table
+    for (const auto* bad : {&badRoot, &badVtable, &longString, &unterminated, &shortTable}) {
+        assert(!fbVerifyRootTable(bad->data(), bad->size(), table));
+    }
+    assert(!fbVerifyRootTable(good.data(), good.size() - 8, table));
+    auto noEpoch = good;
+    noEpoch[8] = 6;  // Older writer: vtable without the epoch slot
+    assert(fbVerifyRootTable(noEpoch.data(), noEpoch.size(), table));
+
+    // Batches: bad records are reported by position and skipped, the rest
+    // stored in order; unknown file IDs pass unchecked
+    std::vector<std::vector<uint8_t>> records;
+    for (int i = 0; i < 3000; i++) {
+        records.push_back(makeSatRecord("SAT-" + std::to_string(i), 2460000.5 + i));
+    }
+    records[5] = badRoot;
+    records[10] = makeNamedRecord("not a table of this schema");
+    records[1500] = longString;
+    records[2999] = unterminated;
+    std::vector<uint8_t> stream;
+    for (const auto& r : records) {
+        uint32_t size = static_cast<uint32_t>(r.size());
+        stream.insert(stream.end(), reinterpret_cast<uint8_t*>(&size), reinterpret_cast<uint8_t*>(&size) + 4);
+        stream.insert(stream.end(), r.begin(), r.end());
+    }
+
+    db.setIngestVerification(true, 4);
+    size_t stored = 0;
+    assert(db.ingest(stream.data(), stream.size(), &stored) == stream.size());
+    assert(stored == 2997 && db.getLastSequence() == 2997);
+    assert((db.getRejectedRecords() == std::vector<size_t>{5, 1500, 2999}));
+    assert(db.query("SELECT * FROM sats").rowCount() == 2996);
+    assert(db.query("SELECT epoch FROM sats WHERE name = 'SAT-2998'").rowCount() == 1);
+    assert(db.query("SELECT * FROM sats WHERE name = 'SAT-1500'").rowCount() == 0);
+
+    // ingestOne throws for a bad record
+    bool threw = false;
+    try {
+        db.ingestOne(badVtable.data(), badVtable.size());
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    assert(threw && db.getRejectedRecords().size() == 1 && db.getLastSequence() == 2997);
+    assert(db.ingestOne(good.data(), good.size()) == 2998 && db.getRejectedRecords().empty());
+
+    // A registered verifier replaces the schema checks
+    db.setRecordVerifier("sats", [](const uint8_t* data, size_t length) {
+        double epoch;
+        return fbVerifyRootTable(data, length, TableDef{}) &&
+               fbReadRootScalar<double>(data, length, 1, 0.0, epoch) && epoch > 0;
+    });
+    auto negative = makeSatRecord("DEBRIS", -1.0);
+    std::vector<uint8_t> pair;
+    for (const auto* r : {&negative, &good}) {
+        uint32_t size = static_cast<uint32_t>(r->size());
+        pair.insert(pair.end(), reinterpret_cast<uint8_t*>(&size), reinterpret_cast<uint8_t*>(&size) + 4);
+        pair.insert(pair.end(), r->begin(), r->end());
+    }
+    assert(db.ingest(pair.data(), pair.size(), &stored) == pair.size() && stored == 1);
+    assert((db.getRejectedRecords() == std::vector<size_t>{0}));
+
+    // After a union the columns' slots are unknown: the schema checks skip
+    // them, and the table needs a verifier of its own
+    FlatSQLDatabase unions = FlatSQLDatabase::fromSchema(R"(
+        table tagged {
+            payload: Payload;
+            label: string;
+        }
+    )", "unions");
+    unions.registerFileId("SATS", "tagged");
+    const TableDef& tagged = *unions.getTableDef("tagged");
+    assert(!tagged.columns[1].slotKnown);
+    assert(fbVerifyRootTable(good.data(), good.size(), tagged));
+    unions.setIngestVerification(true);
+    threw = false;
+    try {
+        unions.ingestOne(good.data(), good.size());
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    assert(threw && unions.getLastSequence() == 0);
+    unions.setRecordVerifier("tagged", [](const uint8_t* data, size_t length) {
+        return fbVerifyRootTable(data, length, TableDef{});
+    });
+    assert(unions.ingestOne(good.data(), good.size()) == 1);
+
+    // Off (the default), records are stored unchecked
+    db.setIngestVerification(false);
+    db.ingestOne(shortTable.data(), shortTable.size());
+    assert(db.getLastSequence() == 3000);
+
+    std::cout << "Ingest verification tests passed!" << std::endl;
+}
+
+void testRecordAlignment() {
+    std::cout << "Testing aligned record placement..." << std::endl;
+
+    // Every FlatBuffer starts on the boundary, whatever the sizes before it
+    StreamingFlatBufferStore store;
+    store.setRecordAlignment(8);
+    for (int i = 0; i < 40; i++) {
+        auto rec = makeNamedRecord(std::string(static_cast<size_t>(i % 11), 'x'));
+        store.ingestFlatBuffer(rec.data(), rec.size(), nullptr);
+    }
+    size_t records = 0;
+    store.iterateRecords([&](const StoredRecord& record) {
+        uint32_t length = 0;
+        const uint8_t* data = store.getDataAtOffset(record.offset, &length);
+        assert(reinterpret_cast<uintptr_t>(data) % 8 == 0);
+        assert(record.header.fileId == "CATS" && record.header.sequence == ++records);
+        return true;
+    });
+    assert(records == 40 && store.getRecordCountByFileId("CATS") == 40);
+
+    bool threw = false;
+    try {
+        store.setRecordAlignment(16);  // Records are already stored
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    assert(threw);
+    for (size_t bad : {size_t(0), size_t(3), size_t(4096)}) {
+        StreamingFlatBufferStore empty;
+        threw = false;
+        try {
+            empty.setRecordAlignment(bad);
+        } catch (const std::runtime_error&) {
+            threw = true;
+        }
+        assert(threw);
+    }
+
+    std::string schema = R"(
+        table catalog {
+            name: string (key);
+        }
+        table ticks {
+            epoch: double;
+        }
+    )";
+    auto open = [&](const char* name, size_t alignment) {
+        FlatSQLDatabase db = FlatSQLDatabase::fromSchema(schema, name);
+        db.registerFileId("CATS", "catalog");
+        db.registerFileId("TICK", "ticks");
+        db.setFieldExtractor("catalog", extractNamedRecord);
+        db.setFieldExtractor("ticks", extractTickRecord);
+        db.setRecordAlignment(alignment);
+        return db;
+    };
+    auto allAligned = [](const FlatSQLDatabase& db, size_t alignment) {
+        bool aligned = true;
+        db.getStorage().iterateRecords([&](const StoredRecord& record) {
+            uint32_t length = 0;
+            const uint8_t* data = db.getStorage().getDataAtOffset(record.offset, &length);
+            aligned = aligned && reinterpret_cast<uintptr_t>(data) % alignment == 0;
+            return true;
+        });
+        return aligned;
+    };
+    const char* sql = "SELECT _rowid, name FROM catalog";
+    FlatSQLDatabase packed = open("packed", 1);
+    FlatSQLDatabase aligned = open("aligned", 8);
+    std::vector<uint8_t> stream;
+    for (int i = 0; i < 500; i++) {
+        for (const auto& rec : {makeNamedRecord("OBJ-" + std::to_string(i)), makeTickRecord(2460000.5 + i)}) {
+            uint32_t size = static_cast<uint32_t>(rec.size());
+            stream.insert(stream.end(), reinterpret_cast<uint8_t*>(&size), reinterpret_cast<uint8_t*>(&size) + 4);
+            stream.insert(stream.end(), rec.begin(), rec.end());
+        }
+    }
+    packed.ingest(stream.data(), stream.size());
+    aligned.ingest(stream.data(), stream.size());
+    assert(allAligned(aligned, 8) && !allAligned(packed, 8));
+    assert(aligned.query(sql).rows == packed.query(sql).rows);
+    assert(aligned.query("SELECT * FROM catalog WHERE name = 'OBJ-321'").rowCount() == 1);
+    assert(aligned.query("SELECT epoch FROM ticks WHERE epoch > 2460400").rowCount() == 100);
+
+    // Aligned exports carry padding frames and load into either kind of
+    // store; packed exports are re-placed on load into an aligned one
+    std::vector<uint8_t> paddedExport = aligned.exportData();
+    assert(paddedExport.size() > stream.size() && packed.exportData() == stream);
+    for (size_t alignment : {size_t(1), size_t(8), size_t(16)}) {
+        for (const auto* source : {&paddedExport, &stream}) {
+            FlatSQLDatabase copy = open("copy", alignment);
+            copy.loadAndRebuild(source->data(), source->size());
+            assert(copy.getLastSequence() == 1000 && allAligned(copy, alignment));
+            assert(copy.query(sql).rows == packed.query(sql).rows);
+        }
+    }
+
+    // The change feed passes padding through; replicas skip it
+    aligned.markDeleted("catalog", 5);
+    uint64_t watermark = 0;
+    std::vector<uint8_t> feed = exportFeed(aligned, 0, watermark);
+    FlatSQLDatabase replica = open("replica", 1);
+    size_t applied = 0;
+    assert(replica.applyChanges(feed.data(), feed.size(), &applied) == feed.size() && applied == 1000);
+    assert(replica.getDeletedCount("catalog") == 1 && replica.getStorage().getDataSize() == stream.size());
+
+    std::cout << "Aligned record placement tests passed!" << std::endl;
+}
+
+void testClusteredStorage() {
+    std::cout << "Testing clustered storage..." << std::endl;
+
+    // A clustered file ID's records sit together in segments, tails padded
+    StreamingFlatBufferStore store;
+    store.setClustered("CATS", 256);
+    assert(store.isClustered("CATS") && !store.isClustered("TICK"));
+    for (int i = 0; i < 100; i++) {
+        auto rec = makeNamedRecord("OBJ-" + std::to_string(i));
+        store.ingestFlatBuffer(rec.data(), rec.size(), nullptr);
+        auto tick = makeTickRecord(2460000.5 + i);
+        store.ingestFlatBuffer(tick.data(), tick.size(), nullptr);
+    }
+    assert(!store.isSequential() && store.isRecordListSequenceOrdered());
+    const auto* cats = store.getRecordInfoVector("CATS");
+    assert(cats && cats->size() == 100);
+    size_t adjacent = 0;
+    for (size_t i = 1; i < cats->size(); i++) {
+        uint32_t length = 0;
+        store.getDataAtOffset((*cats)[i - 1].offset, &length);
+        assert((*cats)[i].offset > (*cats)[i - 1].offset);
+        if ((*cats)[i].offset == (*cats)[i - 1].offset + 4 + length) adjacent++;
+    }
+    assert(adjacent > 80);  // Only segment boundaries break a run
+    std::vector<uint8_t> seen(201, 0);  // Storage order, padding skipped
+    store.iterateRecords([&](const StoredRecord& record) {
+        assert(record.header.sequence <= 200 && !seen[record.header.sequence]++);
+        return true;
+    });
+    assert(std::count(seen.begin() + 1, seen.end(), 1) == 200);
+
+    bool threw = false;
+    try {
+        store.setClustered("TICK", 2);
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    assert(threw);
+
+    // A bad sequence list is rejected before any record moves
+    uint64_t firstOffset = (*cats)[0].offset;
+    for (const auto& bad : {std::vector<uint64_t>{2, 1, 999}, std::vector<uint64_t>{2, 1, 2}}) {
+        threw = false;
+        try {
+            store.relocate(bad);
+        } catch (const std::runtime_error&) {
+            threw = true;
+        }
+        assert(threw && store.getRecordCount() == 200 && cats->size() == 100);
+        assert((*cats)[0].offset == firstOffset && store.hasRecord(200));
+    }
+
+    std::string schema = R"(
+        table catalog {
+            name: string (key);
+        }
+        table ticks {
+            epoch: double;
+        }
+    )";
+    auto open = [&](const char* name, bool clustered) {
+        FlatSQLDatabase db = FlatSQLDatabase::fromSchema(schema, name);
+        db.registerFileId("CATS", "catalog");
+        db.registerFileId("TICK", "ticks");
+        db.setFieldExtractor("catalog", extractNamedRecord);
+        db.setFieldExtractor("ticks", extractTickRecord);
+        if (clustered) db.setClusteredStorage("catalog", 256);
+        return db;
+    };
+    const char* sql = "SELECT _rowid, name FROM catalog";
+    const char* tickSql = "SELECT _rowid, epoch FROM ticks";
+    FlatSQLDatabase packed = open("packed", false);
+    FlatSQLDatabase clustered = open("clustered", true);
+    std::vector<uint8_t> stream;
+    for (int i = 0; i < 500; i++) {
+        for (const auto& rec : {makeNamedRecord("OBJ-" + std::to_string(i)), makeTickRecord(2460000.5 + i)}) {
+            uint32_t size = static_cast<uint32_t>(rec.size());
+            stream.insert(stream.end(), reinterpret_cast<uint8_t*>(&size), reinterpret_cast<uint8_t*>(&size) + 4);
+            stream.insert(stream.end(), rec.begin(), rec.end());
+        }
+    }
+    packed.ingest(stream.data(), stream.size());
+    clustered.ingest(stream.data(), stream.size());
+    assert(clustered.query(sql).rows == packed.query(sql).rows);
+    assert(clustered.query(tickSql).rows == packed.query(tickSql).rows);
+    assert(clustered.query("SELECT * FROM catalog WHERE name = 'OBJ-321'").rowCount() == 1);
+    assert(clustered.query("SELECT name FROM catalog WHERE _rowid > 900").rowCount() == 50);
+
+    // Exports and the change feed come back in sequence order
+    assert(clustered.exportData() == stream);
+    FlatSQLDatabase copy = open("copy", true);
+    copy.loadAndRebuild(stream.data(), stream.size());
+    assert(copy.getLastSequence() == 1000 && copy.query(sql).rows == packed.query(sql).rows);
+    clustered.markDeleted("catalog", 5);
+    packed.markDeleted("catalog", 5);
+    uint64_t watermark = 0;
+    assert(exportFeed(clustered, 400, watermark) == exportFeed(packed, 400, watermark) && watermark == 1000);
+    FlatSQLDatabase replica = open("replica", false);
+    std::vector<uint8_t> feed = exportFeed(clustered, 0, watermark);
+    size_t applied = 0;
+    assert(replica.applyChanges(feed.data(), feed.size(), &applied) == feed.size() && applied == 1000);
+    assert(replica.getDeletedCount("catalog") == 1);
+    assert(replica.query(sql).rows == clustered.query(sql).rows);
+
+    // Reorganizing orders a table's records by key and keeps sequences,
+    // deletes and every lookup
+    const char* epochsDescending = "SELECT _rowid FROM ticks ORDER BY epoch DESC";
+    auto before = clustered.query(epochsDescending).rows;
+    clustered.reorganizeStorage({{"ticks", {"epoch"}}, {"catalog", {"name"}}});
+    assert(!clustered.getStorage().isRecordListSequenceOrdered());
+    assert(clustered.getLastSequence() == 1000 && clustered.getDeletedCount("catalog") == 1);
+    assert(clustered.query(epochsDescending).rows == before);
+    assert(clustered.query(tickSql).rows == packed.query(tickSql).rows);
+    auto names = clustered.query("SELECT name FROM catalog").rows;
+    assert(names.size() == 499);
+    for (size_t i = 1; i < names.size(); i++) {
+        assert(std::get<std::string>(names[i - 1][0]) < std::get<std::string>(names[i][0]));
+    }
+    assert(clustered.query("SELECT _rowid FROM catalog WHERE name = 'OBJ-321'").rows ==
+           packed.query("SELECT _rowid FROM catalog WHERE name = 'OBJ-321'").rows);
+    assert(clustered.query("SELECT * FROM catalog WHERE name = 'OBJ-2'").rowCount() == 0);  // Sequence 5
+    assert(clustered.query("SELECT name FROM catalog WHERE _rowid > 900").rowCount() == 50);
+    assert(clustered.query("SELECT name FROM catalog WHERE _rowid BETWEEN 101 AND 199").rowCount() == 50);
+    const auto* catalogRecords = clustered.getStorage().getRecordInfoVector("CATS");
+    assert(catalogRecords->size() == 500);
+    for (size_t i = 1; i < catalogRecords->size(); i++) {
+        uint32_t length = 0;
+        clustered.getStorage().getDataAtOffset((*catalogRecords)[i - 1].offset, &length);
+        assert((*catalogRecords)[i].offset == (*catalogRecords)[i - 1].offset + 4 + length);
+    }
+    assert(clustered.exportData() == stream);
+
+    // Later records go on as before
+    auto rec = makeNamedRecord("OBJ-new");
+    assert(clustered.ingestOne(rec.data(), rec.size()) == 1001);
+    assert(clustered.query("SELECT _rowid FROM catalog WHERE name = 'OBJ-new'").rows[0][0] == Value(int64_t(1001)));
+
+    // NaN keys sort after every number
+    FlatSQLDatabase nans = open("nans", false);
+    for (double epoch : {3.0, std::nan(""), 1.0, std::nan(""), 2.0}) {
+        auto tick = makeTickRecord(epoch);
+        nans.ingestOne(tick.data(), tick.size());
+    }
+    nans.reorganizeStorage({{"ticks", {"epoch"}}});
+    std::vector<uint64_t> tickOrder;
+    for (const auto& info : *nans.getStorage().getRecordInfoVector("TICK")) tickOrder.push_back(info.sequence);
+    assert((tickOrder == std::vector<uint64_t>{3, 5, 1, 2, 4}));
+
+    threw = false;
+    try {
+        clustered.reorganizeStorage({{"catalog", {"missing"}}});
+    } catch (const std::runtime_error&) {
+        threw = true;
+    }
+    assert(threw && clustered.query(sql).rowCount() == 500);
+
+    std::cout << "Clustered storage tests passed!" << std::endl;
+}
+
+void testPageMemory() {
+    std::cout << "Testing huge page buffers..." << std::endl;
+
+    HugePages saved = getHugePages();
+    for (HugePages mode : {HugePages::Off, HugePages::Transparent, HugePages::Explicit}) {
+        setHugePages(mode);
+        assert(getHugePages() == mode);
+        for (size_t bytes : {size_t(1), size_t(4096), HUGE_PAGE_SIZE - 1, HUGE_PAGE_SIZE, 3 * HUGE_PAGE_SIZE + 5}) {
+            auto* p = static_cast<uint8_t*>(allocatePages(bytes));
+#ifdef __linux__
+            if (bytes >= HUGE_PAGE_SIZE) assert(reinterpret_cast<uintptr_t>(p) % HUGE_PAGE_SIZE == 0);
+#endif
+            std::memset(p, 0xAB, bytes);
+            advisePages(p, bytes, PageAccess::Sequential);
+            advisePages(p, bytes, PageAccess::Normal);
+            assert(p[bytes - 1] == 0xAB);
+            freePages(p, bytes);
+        }
+
+        // The store keeps its records across the move to a mapped buffer
+        StreamingFlatBufferStore store(1024);
+        std::vector<uint64_t> offsets;
+        for (int i = 0; i < 60000; i++) {
+            auto rec = makeNamedRecord("OBJ-" + std::to_string(i));
+            store.ingestFlatBuffer(rec.data(), rec.size(), nullptr);
+        }
+        assert(store.getData().size() >= HUGE_PAGE_SIZE);
+        const auto* cats = store.getRecordInfoVector("CATS");
+        assert(cats && cats->size() == 60000);
+        uint32_t length = 0;
+        const uint8_t* data = store.getDataAtOffset((*cats)[54321].offset, &length);
+        assert(std::get<std::string>(extractNamedRecord(data, length, "name")) == "OBJ-54321");
+        size_t visited = 0;
+        store.iterateRecords([&](const StoredRecord&) { return ++visited > 0; });
+        assert(visited == 60000);
+
+        StreamingFlatBufferStore copy;
+        std::vector<uint8_t> exported = store.exportData();
+        copy.loadAndRebuild(exported.data(), exported.size(), nullptr);
+        assert(copy.getRecordCount() == 60000 && copy.exportData() == exported);
+    }
+    setHugePages(saved);
+
+    // LearnedIndex arrays past a huge page
+    LearnedIndex index("k", ValueType::Int64);
+    for (int64_t i = 0; i < 400000; i++) index.insert(Value(i * 3), static_cast<uint64_t>(i), static_cast<uint64_t>(i + 1));
+    IndexEntry entry;
+    assert(index.searchFirst(Value(int64_t(299997)), entry) && entry.sequence == 100000);
+
+    std::cout << "Huge page buffer tests passed!" << std::endl;
+}
+
+// Drain a cursor into (offset, sequence) pairs
+static std::vector<std::pair<uint64_t, uint64_t>> drainCursor(IndexCursor& cursor) {
+    std::vector<std::pair<uint64_t, uint64_t>> out;
+    uint64_t offset, sequence;
+    while (cursor.next(offset, sequence)) out.emplace_back(offset, sequence);
+    return out;
+}
+
+static std::vector<std::pair<uint64_t, uint64_t>> postings(const std::vector<IndexEntry>& entries) {
+    std::vector<std::pair<uint64_t, uint64_t>> out;
+    for (const auto& e : entries) out.emplace_back(e.dataOffset, e.sequence);
+    return out;
+}
+
+void testIndexCursor() {
+    std::cout << "Testing index cursors..." << std::endl;
+
+    // Runs of duplicates longer than a batch, so refills resume mid-key
+    sqlite3* db;
+    sqlite3_open(":memory:", &db);
+    for (IndexLayout layout : {IndexLayout::Rows, IndexLayout::Compact}) {
+        SqliteIndex index(db, layout == IndexLayout::Rows ? "cursor_rows" : "cursor_compact", "k",
+                          ValueType::Int64, layout);
+        for (uint64_t seq = 1; seq <= 2000; seq++) {
+            index.insert(static_cast<int64_t>(seq % 7), seq * 10, 0, seq);
+        }
+        IndexCursor cursor;
+        index.openSearch(int64_t(3), cursor);
+        assert(drainCursor(cursor) == postings(index.search(int64_t(3))));
+        index.openRange(int64_t(2), int64_t(4), cursor);
+        assert(drainCursor(cursor) == postings(index.range(int64_t(2), int64_t(4))));
+        index.openAll(cursor);
+        auto all = drainCursor(cursor);
+        assert(all.size() == 2000 && all == postings(index.all()));
+        index.openSearch(std::string("x"), cursor);  // No key of the type
+        assert(drainCursor(cursor).empty());
+
+        // Entries inserted while a cursor is open show up if they sort after it
+        index.openSearch(int64_t(5), cursor);
+        uint64_t offset, sequence;
+        for (int i = 0; i < 100; i++) assert(cursor.next(offset, sequence));
+        index.insert(int64_t(5), 1, 0, 5000);
+        index.insert(int64_t(4), 2, 0, 5001);
+        auto rest = drainCursor(cursor);
+        assert(rest.size() == 286 - 100 + 1 && rest.back().second == 5000);
+    }
+    {
+        SqliteIndex index(db, "cursor_prefix", "name", ValueType::String);
+        for (uint64_t seq = 1; seq <= 300; seq++) {
+            index.insert("STARLINK-" + std::to_string(seq), seq, 0, seq);
+            index.insert("ONEWEB-" + std::to_string(seq), seq, 0, 1000 + seq);
+        }
+        IndexCursor cursor;
+        index.openPrefixRange("STARLINK-1", "STARLINK-1", cursor);
+        assert(drainCursor(cursor) == postings(index.prefixRange("STARLINK-1", "STARLINK-1")));
+    }
+    sqlite3_close(db);
+
+    {
+        LearnedIndex index("ts", ValueType::Int64, 4);
+        for (uint64_t seq = 1; seq <= 3000; seq++) {
+            int64_t key = static_cast<int64_t>(seq / 100);
+            if (seq % 11 == 0) key -= 3;  // Late, into the pending buffer
+            index.insert(key, seq, seq);
+        }
+        using Op = LearnedIndex::Op;
+        IndexCursor cursor;
+        std::vector<std::vector<std::pair<Op, Value>>> queries = {
+            {{Op::Eq, int64_t(7)}}, {{Op::Gt, int64_t(5)}, {Op::Le, int64_t(12)}}, {}, {{Op::Lt, int64_t(-100)}}
+        };
+        for (const auto& q : queries) {
+            index.openQuery(q, cursor);
+            assert(drainCursor(cursor) == postings(index.query(q)));
+        }
+    }
+    {
+        RadixIndex index("id", ValueType::String);
+        for (uint64_t seq = 1; seq <= 3000; seq++) {
+            index.insert("OBJ-" + std::to_string(seq % 37), seq, seq);
+        }
+        using Op = RadixIndex::Op;
+        IndexCursor cursor;
+        std::vector<std::vector<std::pair<Op, Value>>> queries = {
+            {{Op::Eq, std::string("OBJ-5")}}, {{Op::Gt, std::string("OBJ-1")}, {Op::Lt, std::string("OBJ-3")}}, {}
+        };
+        for (const auto& q : queries) {
+            index.openQuery(q, cursor);
+            assert(drainCursor(cursor) == postings(index.query(q)));
+        }
+        index.openPrefixRange("OBJ-2", "OBJ-2", cursor);
+        assert(drainCursor(cursor) == postings(index.prefixRange("OBJ-2", "OBJ-2")));
+        index.openQuery({}, cursor);
+        cursor.close();
+        assert(drainCursor(cursor).empty());
+    }
+
+    std::cout << "Index cursor tests passed!" << std::endl;
+}
+
+// Fake record for spatial tests: [root offset][file_id "PLCE"][lat double][lon double]
+static std::vector<uint8_t> makePlaceRecord(double lat, double lon) {
+    std::vector<uint8_t> data = {0x08, 0x00, 0x00, 0x00, 'P', 'L', 'C', 'E'};
+    data.resize(8 + 2 * sizeof(double));
+    std::memcpy(data.data() + 8, &lat, sizeof(double));
+    std::memcpy(data.data() + 8 + sizeof(double), &lon, sizeof(double));
+    return data;
+}
+
+static Value extractPlaceRecord(const uint8_t* data, size_t length, const std::string& fieldName) {
+    if (length < 8 + 2 * sizeof(double)) return std::monostate{};
+    double v;
+    if (fieldName == "lat") {
+        std::memcpy(&v, data + 8, sizeof(double));
+    } else if (fieldName == "lon") {
+        std::memcpy(&v, data + 8 + sizeof(double), sizeof(double));
+    } else {
+        return std::monostate{};
+    }
+    return v;
+}
+
+void testSpatialIndex() {
+    std::cout << "Testing spatial index pushdown..." << std::endl;
+
+    std::string schema = R"(
+        table place {
+            lat: double;
+            lon: double;
+        }
+    )";
+
+    FlatSQLDatabase db = FlatSQLDatabase::fromSchema(schema, "spatial_test");
+    db.registerFileId("PLCE", "place");
+    db.setFieldExtractor("place", extractPlaceRecord);
+
+    // A coarse global grid plus points straddling the antimeridian and near the pole
+    std::vector<std::pair<double, double>> points;
+    for (int lat = -80; lat <= 80; lat += 10) {
+        for (int lon = -180; lon < 180; lon += 10) {
+            points.push_back({lat + 0.25, lon + 0.5});
+        }
+    }
+    points.push_back({0.1, 179.95});
+    points.push_back({-0.1, -179.95});
+    points.push_back({89.9, 0.0});
+    points.push_back({89.9, 180.0});
+
+    // Ingest half, register with SQLite, then create the index (backfill + reconnect)
+    size_t half = points.size() / 2;
+    for (size_t i = 0; i < half; i++) {
+        auto rec = makePlaceRecord(points[i].first, points[i].second);
+        db.ingestOne(rec.data(), rec.size());
+    }
+    assert(queryPlan(db, "SELECT * FROM place WHERE geo_within_radius(_geo, geo_circle(0, 0, 100))").find("INDEX 0:") != std::string::npos);
+    db.createSpatialIndex("place", "lat", "lon");
+    for (size_t i = half; i < points.size(); i++) {
+        auto rec = makePlaceRecord(points[i].first, points[i].second);
+        db.ingestOne(rec.data(), rec.size());
+    }
+
+    assert(queryPlan(db, "SELECT * FROM place WHERE geo_within_radius(_geo, geo_circle(0, 0, 100))").find("INDEX 6:") != std::string::npos);
+    assert(queryPlan(db, "SELECT * FROM place WHERE geo_bbox_contains(_geo, geo_bbox(0, 10, 0, 10))").find("INDEX 7:") != std::string::npos);
+
+    // Indexed results must match the scalar (full scan) forms exactly
+    struct Circle { double lat, lon, km; };
+    std::vector<Circle> circles = {
+        {40.7, -74.0, 1500}, {0.0, 180.0, 50}, {0.0, -179.9, 2000},
+        {90.0, 0.0, 100}, {-60.0, 120.0, 3000}, {10.25, 20.5, 0}
+    };
+    for (const auto& c : circles) {
+        std::vector<Value> params = {Value(c.lat), Value(c.lon), Value(c.km)};
+        size_t indexed = db.query(
+            "SELECT * FROM place WHERE geo_within_radius(_geo, geo_circle(?, ?, ?))", params).rowCount();
+        size_t scanned = db.query(
+            "SELECT * FROM place WHERE geo_within_radius(?1, ?2, lat, lon, ?3)", params).rowCount();
+        assert(indexed == scanned);
+    }
+    assert(db.query("SELECT * FROM place WHERE geo_within_radius(_geo, geo_circle(0, 180, 50))").rowCount() == 2);
+    assert(db.query("SELECT * FROM place WHERE geo_within_radius(_geo, geo_circle(90, 0, 100))").rowCount() == 2);
+    assert(db.query("SELECT * FROM place WHERE geo_within_radius(_geo, geo_circle(10.25, 20.5, 0))").rowCount() == 1);
+
+    size_t boxed = db.query("SELECT * FROM place WHERE geo_bbox_contains(_geo, geo_bbox(-20.5, 20.5, -30, 30))").rowCount();
+    assert(boxed == db.query("SELECT * FROM place WHERE geo_bbox_contains(-20.5, 20.5, -30, 30, lat, lon)").rowCount());
+    assert(boxed == 5 * 6);
+
+    // NULL shapes match nothing
+    assert(db.query("SELECT * FROM place WHERE geo_within_radius(_geo, NULL)").rowCount() == 0);
+
+    // geo_knn returns the same rows, in the same order, as sorting by distance
+    std::vector<Circle> probes = {{40.7, -74.0, 0}, {0.0, 179.99, 0}, {89.0, 45.0, 0}, {-33.9, 151.2, 0}};
+    for (const auto& p : probes) {
+        for (int k : {1, 5, 40}) {
+            std::vector<Value> params = {Value(p.lat), Value(p.lon), Value(static_cast<int64_t>(k))};
+            QueryResult knn = db.query(
+                "SELECT k._rowid, k.distance FROM geo_knn('place', ?1, ?2, ?3) AS k", params);
+            QueryResult sorted = db.query(
+                "SELECT _rowid, geo_distance(?1, ?2, lat, lon) AS d FROM place ORDER BY d LIMIT ?3", params);
+            assert(knn.rowCount() == static_cast<size_t>(k));
+            assert(knn.rowCount() == sorted.rowCount());
+            for (size_t i = 0; i < knn.rowCount(); i++) {
+                assert(std::fabs(std::get<double>(knn.rows[i][1]) - std::get<double>(sorted.rows[i][1])) < 1e-9);
+            }
+        }
+    }
+    QueryResult joined = db.query(
+        "SELECT p.lat, k.distance FROM geo_knn('place', 10.25, 20.5, 3) AS k "
+        "JOIN place AS p ON p.rowid = k._rowid");
+    assert(joined.rowCount() == 3);
+    assert(std::get<double>(joined.rows[0][0]) == 10.25);
+    assert(std::get<double>(joined.rows[0][1]) == 0.0);
+
+    // Polygon containment probes the index with the polygon's bounding box
+    std::string triangle = "geo_polygon(-45, -100, 60, 10, -30, 150)";
+    assert(queryPlan(db, "SELECT * FROM place WHERE geo_contains(_geo, " + triangle + ")").find("INDEX 8:") != std::string::npos);
+    size_t inTriangle = db.query("SELECT * FROM place WHERE geo_contains(_geo, " + triangle + ")").rowCount();
+    assert(inTriangle > 0);
+    assert(inTriangle == db.query("SELECT * FROM place WHERE geo_contains(" + triangle + ", lat, lon)").rowCount());
+    assert(db.query("SELECT * FROM place WHERE geo_contains(_geo, x'0102')").rowCount() == 0);
+
+    // Tombstoned records are skipped
+    QueryResult near = db.query("SELECT _rowid FROM place WHERE geo_within_radius(_geo, geo_circle(90, 0, 100))");
+    db.markDeleted("place", static_cast<uint64_t>(std::get<int64_t>(near.rows[0][0])));
+    assert(db.query("SELECT * FROM place WHERE geo_within_radius(_geo, geo_circle(90, 0, 100))").rowCount() == 1);
+    QueryResult knnPole = db.query("SELECT _rowid FROM geo_knn('place', 90, 0, 2)");
+    assert(knnPole.rowCount() == 2);
+    assert(knnPole.rows[0][0] != near.rows[0][0] && knnPole.rows[1][0] != near.rows[0][0]);
+
+    // Re-inserting a sequence moves its entry without counting it twice
+    sqlite3* raw = nullptr;
+    assert(sqlite3_open(":memory:", &raw) == SQLITE_OK);
+    {
+        SpatialIndex index(raw, "moved", "lat", "lon");
+        index.insert(10.0, 20.0, 100, 16, 1);
+        index.insert(11.0, 21.0, 200, 16, 2);
+        index.insert(-10.0, -20.0, 300, 16, 1);
+        assert(index.getEntryCount() == 2);
+        assert(index.searchBox(9.0, 12.0, 19.0, 22.0).size() == 1);
+        auto moved = index.searchBox(-11.0, -9.0, -21.0, -19.0);
+        assert(moved.size() == 1 && moved[0].sequence == 1 && moved[0].dataOffset == 300);
+    }
+    sqlite3_close(raw);
+
+    std::cout << "Spatial index pushdown tests passed!" << std::endl;
+}
+
+void testGeoKernels() {
+    std::cout << "Testing batch geo kernels (" << geoKernelIsa() << ")..." << std::endl;
+
+    // Deterministic pseudo-random points, including a few exact poles/antimeridian
+    uint64_t state = 0x9E3779B97F4A7C15ULL;
+    auto uniform = [&](double lo, double hi) {
+        state = state * 6364136223846793005ULL + 1442695040888963407ULL;
+        return lo + (hi - lo) * static_cast<double>(state >> 11) / 9007199254740992.0;
+    };
+    const size_t n = 4099;  // Not a multiple of the vector width
+    std::vector<double> lats(n), lons(n);
+    for (size_t i = 0; i < n; i++) {
+        lats[i] = uniform(-90.0, 90.0);
+        lons[i] = uniform(-180.0, 180.0);
+    }
+    lats[0] = 90.0; lats[1] = -90.0; lons[2] = 180.0; lons[3] = -180.0;
+
+    struct Center { double lat, lon; };
+    std::vector<Center> centers = {{0, 0}, {51.5, -0.13}, {-89.9, 10}, {12.0, 179.99}, {45, -180}};
+    std::vector<double> batch(n);
+    std::vector<uint8_t> mask(n);
+    for (const auto& c : centers) {
+        geoHaversineBatch(c.lat, c.lon, lats.data(), lons.data(), n, batch.data());
+        for (size_t i = 0; i < n; i++) {
+            double exact = geoHaversineKm(c.lat, c.lon, lats[i], lons[i]);
+            if (exact < 20000.0) assert(std::fabs(batch[i] - exact) <= GEO_BATCH_MAX_ERROR_KM);
+        }
+
+        // The radius predicate agrees exactly, including points on the boundary
+        double radius = geoHaversineKm(c.lat, c.lon, lats[7], lons[7]);
+        size_t matches = geoWithinRadiusBatch(c.lat, c.lon, radius, lats.data(), lons.data(), n, mask.data());
+        size_t expected = 0;
+        for (size_t i = 0; i < n; i++) {
+            bool in = geoHaversineKm(c.lat, c.lon, lats[i], lons[i]) <= radius;
+            assert(mask[i] == (in ? 1 : 0));
+            expected += in;
+        }
+        assert(matches == expected && mask[7] == 1);
+    }
+
+    size_t boxed = geoBboxContainsBatch(-10, 10, -20, 20, lats.data(), lons.data(), n, mask.data());
+    size_t expectedBoxed = 0;
+    for (size_t i = 0; i < n; i++) {
+        bool in = lats[i] >= -10 && lats[i] <= 10 && lons[i] >= -20 && lons[i] <= 20;
+        assert(mask[i] == (in ? 1 : 0));
+        expectedBoxed += in;
+    }
+    assert(boxed == expectedBoxed);
+
+    // Native scans match the SQL scalar functions, with and without the spatial index
+    std::string schema = R"(
+        table place {
+            lat: double;
+            lon: double;
+        }
+    )";
+    FlatSQLDatabase db = FlatSQLDatabase::fromSchema(schema, "geo_kernel_test");
+    db.registerFileId("PLCE", "place");
+    db.setFieldExtractor("place", extractPlaceRecord);
+    for (size_t i = 0; i < 1500; i++) {
+        auto rec = makePlaceRecord(lats[i], lons[i]);
+        db.ingestOne(rec.data(), rec.size());
+    }
+
+    for (int pass = 0; pass < 2; pass++) {
+        for (const auto& c : centers) {
+            std::vector<Value> params = {Value(c.lat), Value(c.lon), Value(2500.0)};
+            size_t sql = db.query("SELECT * FROM place WHERE geo_within_radius(?1, ?2, lat, lon, ?3)", params).rowCount();
+            assert(db.findWithinRadius("place", "lat", "lon", c.lat, c.lon, 2500.0).size() == sql);
+            assert(db.countWithinRadius("place", "lat", "lon", c.lat, c.lon, 2500.0) == sql);
+        }
+        auto inBox = db.findInBox("place", "lat", "lon", -30, 30, 100, 180);
+        assert(inBox.size() == db.query("SELECT * FROM place WHERE geo_bbox_contains(-30, 30, 100, 180, lat, lon)").rowCount());
+        for (const auto& record : inBox) {
+            assert(record.header.dataLength == 8 + 2 * sizeof(double));
+        }
+        if (pass == 0) db.createSpatialIndex("place", "lat", "lon");
+    }
+
+    std::cout << "Batch geo kernel tests passed!" << std::endl;
+}
+
+// Little-endian WKB polygon from rings of (lon, lat) pairs
+static std::vector<uint8_t> makeWkbPolygon(const std::vector<std::vector<double>>& rings) {
+    std::vector<uint8_t> out;
+    auto put = [&](const void* p, size_t n) {
+        out.insert(out.end(), static_cast<const uint8_t*>(p), static_cast<const uint8_t*>(p) + n);
+    };
+    uint32_t type = 3, numRings = static_cast<uint32_t>(rings.size());
+    out.push_back(1);
+    put(&type, 4);
+    put(&numRings, 4);
+    for (const auto& ring : rings) {
+        uint32_t numPoints = static_cast<uint32_t>(ring.size() / 2);
+        put(&numPoints, 4);
+        put(ring.data(), ring.size() * sizeof(double));
+    }
+    return out;
+}
+
+void testGeoPolygon() {
+    std::cout << "Testing prepared polygons..." << std::endl;
+
+    // Square with a square hole (lon, lat rings)
+    auto wkb = makeWkbPolygon({{0, 0, 10, 0, 10, 10, 0, 10, 0, 0}, {4, 4, 6, 4, 6, 6, 4, 6, 4, 4}});
+    auto holed = GeoPolygon::fromWkb(wkb.data(), wkb.size());
+    assert(holed);
+    assert(holed->contains(1, 1) && holed->contains(5, 8));
+    assert(!holed->contains(5, 5) && !holed->contains(-1, 5) && !holed->contains(5, 11));
+    assert(holed->getMinLat() == 0 && holed->getMaxLon() == 10);
+
+    // Malformed input is rejected
+    assert(!GeoPolygon::fromWkb(wkb.data(), wkb.size() - 3));
+    assert(!GeoPolygon::fromWkb(wkb.data(), 5));
+    wkb[1] = 2;  // LineString
+    assert(!GeoPolygon::fromWkb(wkb.data(), wkb.size()));
+
+    // A many-vertex star: the banded edge index must agree with a plain ray cast
+    std::vector<double> latLon;
+    const int spikes = 500;
+    for (int i = 0; i < 2 * spikes; i++) {
+        double angle = M_PI * i / spikes;
+        double r = (i % 2 == 0) ? 20.0 : 8.0;
+        latLon.push_back(r * std::sin(angle));
+        latLon.push_back(r * std::cos(angle));
+    }
+    auto starWkb = GeoPolygon::toWkb(latLon);
+    auto star = GeoPolygon::fromWkb(starWkb.data(), starWkb.size());
+    assert(star && star->getEdgeCount() == 2 * spikes && star->getBandCount() > 1);
+
+    size_t n = latLon.size() / 2;
+    int inside = 0;
+    for (int y = -210; y <= 210; y += 3) {
+        for (int x = -210; x <= 210; x += 3) {
+            double lat = y / 10.0 + 0.013, lon = x / 10.0 + 0.007;
+            bool expected = false;
+            for (size_t i = 0, j = n - 1; i < n; j = i++) {
+                double lat1 = latLon[2 * i], lon1 = latLon[2 * i + 1];
+                double lat2 = latLon[2 * j], lon2 = latLon[2 * j + 1];
+                if ((lat1 > lat) != (lat2 > lat) &&
+                    lon < lon1 + (lat - lat1) * (lon2 - lon1) / (lat2 - lat1)) {
+                    expected = !expected;
+                }
+            }
+            assert(star->contains(lat, lon) == expected);
+            inside += expected;
+        }
+    }
+    assert(inside > 0);
+
+    // SQL forms: constant polygons are parsed once per statement
+    SQLiteEngine engine;
+    QueryResult r = engine.execute(
+        "SELECT geo_contains(geo_polygon(0, 0, 0, 10, 10, 10, 10, 0), 5, 5), "
+        "geo_contains(geo_polygon(0, 0, 0, 10, 10, 10, 10, 0), 15, 5), "
+        "geo_contains(geo_point(3, 3), geo_polygon(0, 0, 0, 10, 10, 0)), "
+        "geo_contains(NULL, 5, 5)");
+    assert(std::get<int64_t>(r.rows[0][0]) == 1);
+    assert(std::get<int64_t>(r.rows[0][1]) == 0);
+    assert(std::get<int64_t>(r.rows[0][2]) == 1);
+    assert(std::holds_alternative<std::monostate>(r.rows[0][3]));
+
+    std::cout << "Prepared polygon tests passed!" << std::endl;
+}
+
+// Minimal real FlatBuffer for the MPE table: slot 0 (ENTITY_ID) absent,
+// slots 1-8 the eight element doubles, MEAN_ELEMENT_THEORY left at its default
+static std::vector<uint8_t> makeMpeRecord(const double (&elements)[8]) {
+    std::vector<uint8_t> data(104, 0);
+    auto putU16 = [&](size_t at, uint16_t v) { std::memcpy(data.data() + at, &v, 2); };
+    uint32_t root = 32;
+    std::memcpy(data.data(), &root, 4);
+    std::memcpy(data.data() + 4, "$MPE", 4);
+    putU16(8, 22);   // vtable size: 4 + 9 slots
+    putU16(10, 72);  // table size
+    for (int k = 1; k <= 8; k++) putU16(12 + 2 * k, static_cast<uint16_t>(8 + 8 * (k - 1)));
+    int32_t vtableDelta = 32 - 8;
+    std::memcpy(data.data() + 32, &vtableDelta, 4);
+    std::memcpy(data.data() + 40, elements, sizeof(elements));
+    return data;
+}
+
+void testSgp4Propagate() {
+    std::cout << "Testing sgp4_propagate..." << std::endl;
+
+    std::string schema = R"(
+        table MPE {
+            ENTITY_ID: string (key);
+            EPOCH: double;
+            MEAN_MOTION: double;
+            ECCENTRICITY: double;
+            INCLINATION: double;
+            RA_OF_ASC_NODE: double;
+            ARG_OF_PERICENTER: double;
+            MEAN_ANOMALY: double;
+            BSTAR: double;
+            MEAN_ELEMENT_THEORY: int;
+        }
+    )";
+    FlatSQLDatabase db = FlatSQLDatabase::fromSchema(schema, "sgp4_test");
+    db.registerFileId("$MPE", "MPE");
+
+    // Vanguard 1 (the reference implementation's first verification case)
+    // and a geostationary orbit, which needs deep-space SDP4
+    const double epoch = 962131819.73;
+    const double vanguard[8] = {epoch, 10.82419157, 0.1859667, 34.2682, 348.7242, 331.7664, 19.3264, 0.28098e-4};
+    const double geo[8] = {epoch, 1.00271, 0.0002, 0.05, 90.0, 0.0, 10.0, 0.0};
+    auto vanguardRec = makeMpeRecord(vanguard);
+    auto geoRec = makeMpeRecord(geo);
+    db.ingestOne(vanguardRec.data(), vanguardRec.size());
+    db.ingestOne(geoRec.data(), geoRec.size());
+    // More satellites than one block so propagation spans threads and blocks
+    for (int i = 0; i < 300; i++) {
+        double el[8] = {epoch, 15.0 + i * 0.001, 0.001, 51.6, i * 1.0, 90.0, i * 1.2, 0.0001};
+        auto rec = makeMpeRecord(el);
+        db.ingestOne(rec.data(), rec.size());
+    }
+
+    std::vector<Value> params = {Value(epoch), Value(epoch + 360 * 60.0), Value(360 * 60.0)};
+    QueryResult r = db.query(
+        "SELECT t, x, y, z, vx, vy, vz, error FROM sgp4_propagate('MPE', ?1, ?2, ?3) WHERE _rowid = 1", params);
+    assert(r.rowCount() == 2);
+    const double expected[2][6] = {
+        {7022.46529266, -1400.08296755, 0.03995155, 1.893841015, 6.405893759, 4.534807250},
+        {-7154.03120202, -3783.17682504, -3536.19412294, 4.741887409, -4.151817765, -2.093935425}
+    };
+    for (size_t row = 0; row < 2; row++) {
+        assert(std::get<int64_t>(r.rows[row][7]) == SGP4_OK);
+        for (int c = 0; c < 6; c++) {
+            assert(std::fabs(std::get<double>(r.rows[row][1 + c]) - expected[row][c]) < 1e-6);
+        }
+    }
+    assert(std::get<double>(r.rows[1][0]) == epoch + 360 * 60.0);
+
+    // Deep-space objects are flagged rather than mis-propagated
+    QueryResult deep = db.query("SELECT x, error FROM sgp4_propagate('MPE', ?1, ?2, ?3) WHERE _rowid = 2", params);
+    assert(deep.rowCount() == 2);
+    assert(std::get<int64_t>(deep.rows[0][1]) == SGP4_DEEP_SPACE);
+    assert(std::holds_alternative<std::monostate>(deep.rows[0][0]));
+
+    // Full grid: every satellite at every step, time-major; tombstones skipped
+    std::vector<Value> grid = {Value(epoch), Value(epoch + 86400.0), Value(60.0)};
+    QueryResult all = db.query("SELECT COUNT(*), COUNT(DISTINCT t), SUM(error = 0) FROM sgp4_propagate('mpe', ?1, ?2, ?3)", grid);
+    assert(std::get<int64_t>(all.rows[0][0]) == 302 * 1441);
+    assert(std::get<int64_t>(all.rows[0][1]) == 1441);
+    assert(std::get<int64_t>(all.rows[0][2]) == 301 * 1441);
+    db.markDeleted("MPE", 2);
+    assert(db.queryCount("SELECT * FROM sgp4_propagate('MPE', ?1, ?2, ?3)", grid) == 301 * 1441);
+
+    bool threw = false;
+    try {
+        db.query("SELECT * FROM sgp4_propagate('MPE', 0, 10, 0)");
+    } catch (const std::exception&) {
+        threw = true;
+    }
+    assert(threw);
+
+    std::cout << "sgp4_propagate tests passed!" << std::endl;
+}
+
+// Minimal "POST" FlatBuffer: { id: int; tags: [string]; scores: [int] }
+static std::vector<uint8_t> makePostRecord(int32_t id, const std::vector<std::string>& tags,
+                                           const std::vector<int32_t>& scores) {
+    std::vector<uint8_t> data(36, 0);
+    auto putU16 = [&](size_t at, uint16_t v) { std::memcpy(data.data() + at, &v, 2); };
+    auto putU32 = [&](size_t at, uint32_t v) { std::memcpy(data.data() + at, &v, 4); };
+    auto append32 = [&](uint32_t v) {
+        size_t at = data.size();
+        data.resize(at + 4);
+        putU32(at, v);
+        return at;
+    };
+    putU32(0, 20);
+    std::memcpy(data.data() + 4, "POST", 4);
+    putU16(8, 10);   // vtable size: 4 + 3 slots
+    putU16(10, 16);  // table size
+    putU16(12, 4);
+    putU16(14, 8);
+    putU16(16, 12);
+    putU32(20, 20 - 8);
+    std::memcpy(data.data() + 24, &id, 4);
+
+    // Vectors and strings follow the table; offsets are relative to their slot
+    size_t tagsVec = append32(static_cast<uint32_t>(tags.size()));
+    putU32(28, static_cast<uint32_t>(tagsVec - 28));
+    size_t slots = data.size();
+    data.resize(slots + 4 * tags.size());
+    for (size_t i = 0; i < tags.size(); i++) {
+        size_t str = append32(static_cast<uint32_t>(tags[i].size()));
+        data.insert(data.end(), tags[i].begin(), tags[i].end());
+        data.resize((data.size() + 4) & ~size_t(3));  // NUL terminator and padding
+        putU32(slots + 4 * i, static_cast<uint32_t>(str - (slots + 4 * i)));
+    }
+    size_t scoresVec = append32(static_cast<uint32_t>(scores.size()));
+    putU32(32, static_cast<uint32_t>(scoresVec - 32));
+    for (int32_t score : scores) append32(static_cast<uint32_t>(score));
+    return data;
+}
+
+void testArrayColumns() {
+    std::cout << "Testing vector columns, array_contains and fb_each..." << std::endl;
+
+    std::string schema = R"(
+        table Post {
+            id: int (id);
+            tags: [string] (index);
+            scores: [int];
+            raw: [ubyte];
+        }
+    )";
+    DatabaseSchema parsed = SchemaParser::parseIDL(schema);
+    const TableDef& def = parsed.tables[0];
+    assert(def.columns[1].isVector && def.columns[1].elementType == ValueType::String);
+    assert(def.columns[2].isVector && def.columns[2].elementType == ValueType::Int32);
+    assert(!def.columns[3].isVector && def.columns[3].type == ValueType::Bytes);
+
+    FlatSQLDatabase db = FlatSQLDatabase::fromSchema(schema, "array_test");
+    db.registerFileId("POST", "Post");
+    db.setFieldExtractor("Post", [](const uint8_t* data, size_t length, const std::string& field) -> Value {
+        int32_t id;
+        if (field != "id" || !fbReadRootScalar<int32_t>(data, length, 0, 0, id)) return std::monostate{};
+        return id;
+    });
+    db.setVectorsInPlace("Post");  // The extractor only knows id
+
+    const std::vector<std::pair<std::vector<std::string>, std::vector<int32_t>>> posts = {
+        {{"red", "blue"}, {1, 2, 3}},
+        {{"blue", "green", "blue"}, {5}},
+        {{}, {}},
+        {{"say \"hi\"\n"}, {-7}},
+    };
+    for (size_t i = 0; i < posts.size(); i++) {
+        auto rec = makePostRecord(static_cast<int32_t>(i + 1), posts[i].first, posts[i].second);
+        db.ingestOne(rec.data(), rec.size());
+    }
+
+    // Vectors read as JSON arrays
+    QueryResult r = db.query("SELECT tags, scores FROM Post WHERE id = 1");
+    assert(r.rowCount() == 1);
+    assert(std::get<std::string>(r.rows[0][0]) == "[\"red\",\"blue\"]");
+    assert(std::get<std::string>(r.rows[0][1]) == "[1,2,3]");
+    r = db.query("SELECT tags FROM Post WHERE id = 4");
+    assert(std::get<std::string>(r.rows[0][0]) == "[\"say \\\"hi\\\"\\u000a\"]");
+
+    // Indexed vector: the element index answers array_contains
+    std::string sql = "SELECT id FROM Post WHERE array_contains(tags, 'blue') ORDER BY id";
+    assert(queryPlan(db, sql).find("INDEX 265:") != std::string::npos);  // 9 + (column 1 << 8)
+    r = db.query(sql);
+    assert(r.rowCount() == 2);  // Post 2 lists "blue" twice but matches once
+    assert(std::get<int64_t>(r.rows[0][0]) == 1 && std::get<int64_t>(r.rows[1][0]) == 2);
+    assert(db.queryCount("SELECT * FROM Post WHERE array_contains(tags, ?)", {Value(std::string("say \"hi\"\n"))}) == 1);
+    assert(db.queryCount("SELECT * FROM Post WHERE array_contains(tags, 'purple')") == 0);
+    assert(db.queryCount("SELECT * FROM Post WHERE array_contains(tags, 5)") == 0);
+
+    // Unindexed vector: evaluated row by row over the JSON, same results
+    sql = "SELECT id FROM Post WHERE array_contains(scores, 5)";
+    assert(queryPlan(db, sql).find("INDEX 0:") != std::string::npos);
+    r = db.query(sql);
+    assert(r.rowCount() == 1 && std::get<int64_t>(r.rows[0][0]) == 2);
+    assert(db.queryCount("SELECT * FROM Post WHERE array_contains(scores, '5')") == 0);
+    assert(db.queryCount("SELECT * FROM Post WHERE array_contains(scores, -7.0)") == 1);
+
+    bool listed = false;
+    for (const auto& stats : db.getStats()) {
+        for (const auto& name : stats.indexes) listed = listed || name == "tags[]";
+    }
+    assert(listed);
+    auto tagStats = [&]() {
+        for (const auto& stats : db.getStats()) {
+            if (stats.tableName != "Post") continue;
+            assert(stats.indexStats.size() == stats.indexes.size());
+            for (const auto& is : stats.indexStats) {
+                if (is.name == "tags[]") return is;
+            }
+        }
+        assert(false);
+        return FlatSQLDatabase::IndexStats{};
+    };
+    auto rowStats = tagStats();
+    assert(!rowStats.compact && rowStats.entryCount > 0 && rowStats.bytesPerEntry > 0);
+
+    // Compact blocks are opt-in; switching rebuilds the entries
+    sql = "SELECT id FROM Post WHERE array_contains(tags, 'blue')";
+    auto blue = db.query(sql).rows;
+    db.setIndexLayout("Post", "tags", IndexLayout::Compact);
+    auto compactStats = tagStats();
+    assert(compactStats.compact && compactStats.entryCount == rowStats.entryCount);
+    assert(queryPlan(db, sql).find("INDEX 0:") == std::string::npos);
+    assert(db.query(sql).rows == blue);
+
+    // Plain JSON arrays
+    auto contains = [&](const std::string& expr) { return db.query("SELECT " + expr).rows[0][0]; };
+    assert(std::get<int64_t>(contains("array_contains('[1, 2.5, \"x\", [3], {\"a\": 3}, true]', 2.5)")) == 1);
+    assert(std::get<int64_t>(contains("array_contains('[1, 2.5, \"x\", [3], {\"a\": 3}, true]', 3)")) == 0);
+    assert(std::get<int64_t>(contains("array_contains('[1, 2.5, \"x\", [3], {\"a\": 3}, true]', 'x')")) == 1);
+    assert(std::get<int64_t>(contains("array_contains('[false]', 0)")) == 1);
+    assert(std::get<int64_t>(contains("array_contains('[\"caf\\u00e9\", \"\\ud83d\\ude00\"]', 'café')")) == 1);
+    assert(std::get<int64_t>(contains("array_contains('[\"\\ud83d\\ude00\"]', char(128512))")) == 1);
+    assert(std::get<int64_t>(contains("array_contains('[]', 1)")) == 0);
+    assert(std::holds_alternative<std::monostate>(contains("array_contains('[1,', 2)")));
+    assert(std::holds_alternative<std::monostate>(contains("array_contains('{}', 2)")));
+    assert(std::holds_alternative<std::monostate>(contains("array_contains('[1]', NULL)")));
+
+    // fb_each unnests in storage order; empty vectors produce no rows
+    r = db.query("SELECT _rowid, idx, value FROM fb_each('Post', 'tags')");
+    assert(r.rowCount() == 6);
+    assert(std::get<int64_t>(r.rows[2][0]) == 2 && std::get<int64_t>(r.rows[2][1]) == 0);
+    assert(std::get<std::string>(r.rows[2][2]) == "blue");
+    assert(std::get<int64_t>(r.rows[5][0]) == 4);
+    assert(std::get<std::string>(r.rows[5][2]) == "say \"hi\"\n");
+
+    // Joined per record through _rowid
+    r = db.query("SELECT p.id, e.value FROM Post AS p, fb_each('post', 'SCORES') AS e "
+                 "WHERE e._rowid = p.rowid AND p.id = 1 ORDER BY e.idx");
+    assert(r.rowCount() == 3);
+    assert(std::get<int64_t>(r.rows[2][1]) == 3);
+    r = db.query("SELECT value, COUNT(*) FROM fb_each('Post', 'tags') GROUP BY value ORDER BY 2 DESC, 1");
+    assert(std::get<std::string>(r.rows[0][0]) == "blue" && std::get<int64_t>(r.rows[0][1]) == 3);
+
+    bool threw = false;
+    try {
+        db.query("SELECT * FROM fb_each('Post', 'id')");
+    } catch (const std::exception&) {
+        threw = true;
+    }
+    assert(threw);
+
+    // Deleted records drop out of both
+    db.markDeleted("Post", 2);
+    assert(db.queryCount("SELECT * FROM Post WHERE array_contains(tags, 'blue')") == 1);
+    assert(db.queryCount("SELECT * FROM fb_each('Post', 'tags')") == 3);
+
+    // Without opting in, an extractor serves vector columns and its value
+    // is indexed whole
+    FlatSQLDatabase extracted = FlatSQLDatabase::fromSchema(schema, "array_extracted");
+    extracted.registerFileId("POST", "Post");
+    extracted.setFieldExtractor("Post", [](const uint8_t* data, size_t length, const std::string& field) -> Value {
+        int32_t id;
+        if (!fbReadRootScalar<int32_t>(data, length, 0, 0, id)) return std::monostate{};
+        if (field == "id") return id;
+        if (field == "tags") return std::string(id % 2 ? "[\"odd\"]" : "[\"even\"]");
+        return std::monostate{};
+    });
+    for (size_t i = 0; i < posts.size(); i++) {
+        auto rec = makePostRecord(static_cast<int32_t>(i + 1), posts[i].first, posts[i].second);
+        extracted.ingestOne(rec.data(), rec.size());
+    }
+    r = extracted.query("SELECT tags FROM Post WHERE id = 1");
+    assert(std::get<std::string>(r.rows[0][0]) == "[\"odd\"]");
+    assert(extracted.queryCount("SELECT * FROM Post WHERE array_contains(tags, 'even')") == 2);
+    assert(extracted.queryCount("SELECT * FROM Post WHERE tags = '[\"even\"]'") == 2);
+    for (const auto& stats : extracted.getStats()) {
+        if (stats.tableName != "Post") continue;
+        assert(std::find(stats.indexes.begin(), stats.indexes.end(), "tags") != stats.indexes.end());
+        assert(std::find(stats.indexes.begin(), stats.indexes.end(), "tags[]") == stats.indexes.end());
+    }
+
+    // A union takes two vtable slots, so fields after one (or after any
+    // type the parser doesn't know) are never read by position
+    DatabaseSchema withUnion = SchemaParser::parseIDL(R"(
+        table Shape {
+            id: int (id);
+            payload: Payload;
+            tags: [string] (index);
+        }
+    )");
+    const TableDef& shape = withUnion.tables[0];
+    assert(shape.columns[0].slotKnown && shape.columns[1].slotKnown && !shape.columns[2].slotKnown);
+    FlatSQLDatabase shapes(withUnion);
+    shapes.registerFileId("SHAP", "Shape");
+    shapes.setVectorsInPlace("Shape");
+    for (const auto& stats : shapes.getStats()) {
+        if (stats.tableName != "Shape") continue;
+        assert(std::find(stats.indexes.begin(), stats.indexes.end(), "tags[]") == stats.indexes.end());
+    }
+    threw = false;
+    try {
+        shapes.query("SELECT * FROM fb_each('Shape', 'tags')");
+    } catch (const std::exception&) {
+        threw = true;
+    }
+    assert(threw);
+
+    std::cout << "Vector column tests passed!" << std::endl;
+}
+
 void testStorage() {
     std::cout << "Testing streaming FlatBuffer storage..." << std::endl;
 
@@ -724,6 +3148,27 @@ int main() {
         testSchemaParser();
         testSQLiteEngine();
         testSqliteIndex();
+        testKeyCodec();
+        testPatternPushdown();
+        testLearnedIndex();
+        testRadixIndex();
+        testIndexCursor();
+        testRecordRefs();
+        testBatchedLookup();
+        testExecuteBatch();
+        testRecordRangeScan();
+        testChangeFeed();
+        testAppendLog();
+        testChecksums();
+        testIngestVerification();
+        testRecordAlignment();
+        testClusteredStorage();
+        testPageMemory();
+        testSpatialIndex();
+        testGeoKernels();
+        testGeoPolygon();
+        testSgp4Propagate();
+        testArrayColumns();
         testStorage();
         testDatabase();
         testSchemaAnalyzer();